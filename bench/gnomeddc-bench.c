@@ -0,0 +1,849 @@
+#include "gnomeddc-client.h"
+#include "gnomeddc-display.h"
+#include "gnomeddc-json.h"
+#include "gnomeddc-mock-service.h"
+#include "gnomeddc-profile-apply.h"
+#include "gnomeddc-window.h"
+#include "gnomeddc-write-coalescer.h"
+
+#include <glib/gstdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef HAVE_MALLINFO2
+#include <malloc.h>
+#endif
+
+extern GResource *gnomeddc_get_resource(void);
+
+/*
+ * Replays a recorded call trace against a mock ddcutil-service on a private
+ * bus and reports throughput, latency, heap growth and main loop stalls.
+ *
+ * A trace has one event per line, "OFFSET_MS ACTION ARGS...", offsets
+ * counted from the start of the trace; '#' starts a comment:
+ *
+ *   detect | list                 Detect / ListDetected
+ *   get D CODE                    GetVcp through the VCP cache
+ *   multi D CODE,CODE...          GetMultipleVcp
+ *   set D CODE VALUE              SetVcp through the write coalescer
+ *   apply D CODE=VALUE,...        a profile apply
+ *   caps D                        GetCapabilitiesMetadata
+ *   plug D | unplug D             ConnectedDisplaysChanged from the service
+ *   external D CODE VALUE         VcpValueChanged from another client
+ */
+
+enum {
+  EXIT_OK = 0,
+  EXIT_FAILED = 1,
+  EXIT_USAGE = 2
+};
+
+#define DDCA_EVENT_DISPLAY_CONNECTED 2
+#define DDCA_EVENT_DISPLAY_DISCONNECTED 3
+
+#define HEARTBEAT_MSEC 4
+/* Anything longer than a frame counts as a stall. */
+#define STALL_THRESHOLD_USEC (16 * G_TIME_SPAN_MILLISECOND)
+#define MAX_TRACE_CODES 32
+
+typedef enum {
+  EVENT_DETECT,
+  EVENT_LIST,
+  EVENT_GET,
+  EVENT_MULTI,
+  EVENT_SET,
+  EVENT_APPLY,
+  EVENT_CAPS,
+  EVENT_PLUG,
+  EVENT_UNPLUG,
+  EVENT_EXTERNAL
+} EventKind;
+
+typedef struct {
+  gint64 offset_usec;
+  EventKind kind;
+  gint display_number;
+  guint8 codes[MAX_TRACE_CODES];
+  guint16 values[MAX_TRACE_CODES];
+  guint n_codes;
+} TraceEvent;
+
+typedef struct {
+  GMainLoop *loop;
+  gint exit_status;
+  gboolean json;
+  gchar *trace_name;
+
+  GnomeDdcMockService *service;
+  GnomeDdcClient *client;
+  GnomeDdcWriteCoalescer *coalescer;
+  GtkWidget *window;
+  /* display number -> GnomeDdcDisplay, from the first ListDetected */
+  GHashTable *displays;
+
+  GArray *events;
+  guint repeat;
+  gboolean set_call_limits;
+  guint max_in_flight;
+  guint max_in_flight_per_display;
+  guint round;
+  guint next_event;
+  gint64 round_start;
+  gint64 start_time;
+  gint64 end_time;
+  guint replay_source_id;
+
+  guint outstanding;
+  guint64 n_issued;
+  guint64 n_failed;
+  guint64 n_superseded;
+  /* End-to-end latency of every call, queueing in the client included */
+  GArray *latencies;
+
+  guint heartbeat_id;
+  gint64 last_beat;
+  gint64 stall_total_usec;
+  gint64 stall_max_usec;
+  guint n_stalls;
+
+  gsize heap_start;
+  gsize heap_peak;
+  gsize heap_end;
+} Bench;
+
+typedef struct {
+  Bench *bench;
+  gint64 start_time;
+} PendingCall;
+
+static void replay_next(Bench *bench);
+
+static gsize
+heap_in_use(void)
+{
+#ifdef HAVE_MALLINFO2
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+#else
+  return 0;
+#endif
+}
+
+static gboolean
+parse_number(const gchar *text, guint64 max, guint64 *out_value)
+{
+  gchar *end = NULL;
+  if (text == NULL || *text == '\0') {
+    return FALSE;
+  }
+  guint64 value = g_ascii_strtoull(text, &end, 0);
+  if (end == NULL || *end != '\0' || value > max) {
+    return FALSE;
+  }
+  *out_value = value;
+  return TRUE;
+}
+
+static gboolean
+parse_event_codes(const gchar *text, gboolean with_values, TraceEvent *event)
+{
+  g_auto(GStrv) parts = g_strsplit(text, ",", -1);
+
+  for (guint i = 0; parts[i] != NULL; i++) {
+    guint64 code = 0;
+    guint64 value = 0;
+    g_auto(GStrv) pair = g_strsplit(parts[i], "=", 2);
+
+    if (event->n_codes == MAX_TRACE_CODES ||
+        !parse_number(pair[0], G_MAXUINT8, &code) ||
+        (with_values != (pair[1] != NULL)) ||
+        (with_values && !parse_number(pair[1], G_MAXUINT16, &value))) {
+      return FALSE;
+    }
+    event->codes[event->n_codes] = (guint8) code;
+    event->values[event->n_codes] = (guint16) value;
+    event->n_codes++;
+  }
+  return event->n_codes > 0;
+}
+
+static gboolean
+parse_trace_line(gchar **argv, gint argc, TraceEvent *event)
+{
+  static const struct {
+    const gchar *name;
+    EventKind kind;
+    gint n_args;
+  } actions[] = {
+    { "detect", EVENT_DETECT, 0 },
+    { "list", EVENT_LIST, 0 },
+    { "get", EVENT_GET, 2 },
+    { "multi", EVENT_MULTI, 2 },
+    { "set", EVENT_SET, 3 },
+    { "apply", EVENT_APPLY, 2 },
+    { "caps", EVENT_CAPS, 1 },
+    { "plug", EVENT_PLUG, 1 },
+    { "unplug", EVENT_UNPLUG, 1 },
+    { "external", EVENT_EXTERNAL, 3 },
+  };
+  guint64 number = 0;
+
+  if (argc < 2 || !parse_number(argv[0], G_MAXINT32, &number)) {
+    return FALSE;
+  }
+  event->offset_usec = (gint64) number * G_TIME_SPAN_MILLISECOND;
+
+  guint i;
+  for (i = 0; i < G_N_ELEMENTS(actions); i++) {
+    if (g_strcmp0(argv[1], actions[i].name) == 0) {
+      break;
+    }
+  }
+  if (i == G_N_ELEMENTS(actions) || argc != actions[i].n_args + 2) {
+    return FALSE;
+  }
+  event->kind = actions[i].kind;
+
+  if (actions[i].n_args == 0) {
+    return TRUE;
+  }
+  if (!parse_number(argv[2], G_MAXINT32, &number)) {
+    return FALSE;
+  }
+  event->display_number = (gint) number;
+
+  switch (event->kind) {
+  case EVENT_GET:
+  case EVENT_MULTI:
+    return parse_event_codes(argv[3], FALSE, event);
+  case EVENT_APPLY:
+    return parse_event_codes(argv[3], TRUE, event);
+  case EVENT_SET:
+  case EVENT_EXTERNAL: {
+    g_autofree gchar *pair = g_strdup_printf("%s=%s", argv[3], argv[4]);
+    return parse_event_codes(pair, TRUE, event);
+  }
+  default:
+    return TRUE;
+  }
+}
+
+static GArray *
+load_trace(const gchar *path, GError **error)
+{
+  g_autofree gchar *contents = NULL;
+  if (!g_file_get_contents(path, &contents, NULL, error)) {
+    return NULL;
+  }
+
+  g_autoptr(GArray) events = g_array_new(FALSE, TRUE, sizeof(TraceEvent));
+  g_auto(GStrv) lines = g_strsplit(contents, "\n", -1);
+  for (guint i = 0; lines[i] != NULL; i++) {
+    gchar *comment = strchr(lines[i], '#');
+    if (comment != NULL) {
+      *comment = '\0';
+    }
+    g_strstrip(lines[i]);
+    if (lines[i][0] == '\0') {
+      continue;
+    }
+
+    g_auto(GStrv) argv = NULL;
+    gint argc = 0;
+    TraceEvent event = { 0 };
+    if (!g_shell_parse_argv(lines[i], &argc, &argv, NULL) ||
+        !parse_trace_line(argv, argc, &event)) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "%s:%u: invalid event \"%s\"", path, i + 1, lines[i]);
+      return NULL;
+    }
+    if (events->len > 0 &&
+        event.offset_usec < g_array_index(events, TraceEvent, events->len - 1).offset_usec) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA,
+                  "%s:%u: events must be in time order", path, i + 1);
+      return NULL;
+    }
+    g_array_append_val(events, event);
+  }
+
+  if (events->len == 0) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_INVALID_DATA, "%s: no events", path);
+    return NULL;
+  }
+  return g_steal_pointer(&events);
+}
+
+static gboolean
+heartbeat_cb(gpointer user_data)
+{
+  Bench *bench = user_data;
+  gint64 now = g_get_monotonic_time();
+  gint64 gap = now - bench->last_beat;
+
+  if (gap > STALL_THRESHOLD_USEC) {
+    bench->stall_total_usec += gap - HEARTBEAT_MSEC * G_TIME_SPAN_MILLISECOND;
+    bench->stall_max_usec = MAX(bench->stall_max_usec, gap);
+    bench->n_stalls++;
+  }
+  bench->last_beat = now;
+  bench->heap_peak = MAX(bench->heap_peak, heap_in_use());
+  return G_SOURCE_CONTINUE;
+}
+
+static void
+bench_finish(Bench *bench, gint exit_status)
+{
+  if (bench->exit_status == EXIT_OK) {
+    bench->exit_status = exit_status;
+  }
+  g_main_loop_quit(bench->loop);
+}
+
+static void
+maybe_finish_round(Bench *bench)
+{
+  if (bench->outstanding > 0 || bench->next_event < bench->events->len) {
+    return;
+  }
+
+  bench->round++;
+  if (bench->round < bench->repeat) {
+    bench->next_event = 0;
+    bench->round_start = g_get_monotonic_time();
+    replay_next(bench);
+    return;
+  }
+
+  bench->end_time = g_get_monotonic_time();
+  bench_finish(bench, EXIT_OK);
+}
+
+static PendingCall *
+pending_call_new(Bench *bench)
+{
+  PendingCall *call = g_new(PendingCall, 1);
+  call->bench = bench;
+  call->start_time = g_get_monotonic_time();
+  bench->outstanding++;
+  bench->n_issued++;
+  return call;
+}
+
+static void
+pending_call_done(PendingCall *call, gboolean failed)
+{
+  Bench *bench = call->bench;
+  gint64 latency = g_get_monotonic_time() - call->start_time;
+
+  g_array_append_val(bench->latencies, latency);
+  if (failed) {
+    bench->n_failed++;
+  }
+  bench->outstanding--;
+  g_free(call);
+  maybe_finish_round(bench);
+}
+
+/* The status is the second-to-last member of every reply the trace
+ * can produce. */
+static gboolean
+reply_failed(GVariant *response)
+{
+  gint status = 0;
+  gsize n = g_variant_n_children(response);
+  if (n >= 2) {
+    g_autoptr(GVariant) child = g_variant_get_child_value(response, n - 2);
+    if (g_variant_is_of_type(child, G_VARIANT_TYPE_INT32)) {
+      status = g_variant_get_int32(child);
+    }
+  }
+  return status != 0;
+}
+
+static void
+call_finished_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  PendingCall *call = user_data;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(GNOMEDDC_CLIENT(source), result, &error);
+
+  pending_call_done(call, response == NULL || reply_failed(response));
+}
+
+static void
+write_finished_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  PendingCall *call = user_data;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_write_coalescer_set_vcp_finish(GNOMEDDC_WRITE_COALESCER(source),
+                                                                         result, &error);
+
+  /* A value replaced by a newer one is the coalescer doing its job. */
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    Bench *bench = call->bench;
+    bench->n_superseded++;
+    bench->outstanding--;
+    g_free(call);
+    maybe_finish_round(bench);
+    return;
+  }
+  pending_call_done(call, response == NULL || reply_failed(response));
+}
+
+static void
+apply_finished_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  PendingCall *call = user_data;
+  GnomeDdcProfileApply *apply = GNOMEDDC_PROFILE_APPLY(source);
+  g_autoptr(GError) error = NULL;
+  gboolean ok = gnomeddc_profile_apply_run_finish(apply, result, &error);
+
+  pending_call_done(call, !ok || gnomeddc_profile_apply_get_n_failed(apply, 0) > 0);
+}
+
+static void
+issue_event(Bench *bench, const TraceEvent *event)
+{
+  GnomeDdcDisplay *display = NULL;
+
+  if (event->kind != EVENT_DETECT && event->kind != EVENT_LIST) {
+    display = g_hash_table_lookup(bench->displays, GINT_TO_POINTER(event->display_number));
+    if (display == NULL) {
+      g_printerr("gnomeddc-bench: no display %d\n", event->display_number);
+      bench->n_failed++;
+      return;
+    }
+  }
+
+  switch (event->kind) {
+  case EVENT_DETECT:
+  case EVENT_LIST:
+    gnomeddc_client_call_async(bench->client,
+                               event->kind == EVENT_DETECT ? "Detect" : "ListDetected",
+                               g_variant_new("(u)", 0),
+                               NULL,
+                               call_finished_cb,
+                               pending_call_new(bench));
+    break;
+  case EVENT_GET:
+    gnomeddc_client_get_vcp_async(bench->client, display, event->codes[0], 0,
+                                  GNOMEDDC_CALL_FLAGS_NONE, NULL,
+                                  call_finished_cb, pending_call_new(bench));
+    break;
+  case EVENT_MULTI:
+    gnomeddc_client_get_multiple_vcp_async(bench->client, display, event->codes, event->n_codes, 0,
+                                           GNOMEDDC_CALL_FLAGS_NONE, NULL,
+                                           call_finished_cb, pending_call_new(bench));
+    break;
+  case EVENT_SET:
+    gnomeddc_write_coalescer_set_vcp_async(bench->coalescer,
+                                           gnomeddc_display_get_display_number(display),
+                                           gnomeddc_display_get_edid(display),
+                                           event->codes[0],
+                                           event->values[0],
+                                           NULL, 0, NULL,
+                                           write_finished_cb,
+                                           pending_call_new(bench));
+    break;
+  case EVENT_APPLY: {
+    g_autoptr(GnomeDdcProfileApply) apply = gnomeddc_profile_apply_new();
+    GnomeDdcProfileSetting settings[MAX_TRACE_CODES];
+    for (guint i = 0; i < event->n_codes; i++) {
+      settings[i].code = event->codes[i];
+      settings[i].value = event->values[i];
+    }
+    gnomeddc_profile_apply_add(apply, display, settings, event->n_codes);
+    gnomeddc_profile_apply_run_async(apply, bench->client, 0, NULL,
+                                     apply_finished_cb, pending_call_new(bench));
+    break;
+  }
+  case EVENT_CAPS:
+    gnomeddc_client_call_display_async(bench->client, "GetCapabilitiesMetadata", display, 0,
+                                       GNOMEDDC_CALL_FLAGS_NONE, NULL,
+                                       call_finished_cb, pending_call_new(bench));
+    break;
+  case EVENT_PLUG:
+  case EVENT_UNPLUG:
+    gnomeddc_mock_service_emit_display_changed(bench->service, event->display_number,
+                                               event->kind == EVENT_PLUG ?
+                                               DDCA_EVENT_DISPLAY_CONNECTED :
+                                               DDCA_EVENT_DISPLAY_DISCONNECTED);
+    break;
+  case EVENT_EXTERNAL:
+    gnomeddc_mock_service_emit_vcp_changed(bench->service, event->display_number,
+                                           event->codes[0], event->values[0]);
+    break;
+  }
+}
+
+static gboolean
+replay_timeout_cb(gpointer user_data)
+{
+  Bench *bench = user_data;
+  bench->replay_source_id = 0;
+  replay_next(bench);
+  return G_SOURCE_REMOVE;
+}
+
+/* Issues every event that is due and sleeps until the next one; a single
+ * timeout keeps long traces from flooding the main context with sources. */
+static void
+replay_next(Bench *bench)
+{
+  gint64 elapsed = g_get_monotonic_time() - bench->round_start;
+
+  while (bench->next_event < bench->events->len) {
+    const TraceEvent *event = &g_array_index(bench->events, TraceEvent, bench->next_event);
+    if (event->offset_usec > elapsed) {
+      guint delay = (guint) ((event->offset_usec - elapsed) / G_TIME_SPAN_MILLISECOND);
+      bench->replay_source_id = g_timeout_add(delay, replay_timeout_cb, bench);
+      return;
+    }
+    bench->next_event++;
+    issue_event(bench, event);
+  }
+
+  maybe_finish_round(bench);
+}
+
+static void
+list_finished_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  Bench *bench = user_data;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(bench->client, result, &error);
+
+  if (response == NULL) {
+    g_printerr("gnomeddc-bench: ListDetected failed: %s\n", error->message);
+    bench_finish(bench, EXIT_FAILED);
+    return;
+  }
+
+  g_autoptr(GVariant) array = g_variant_get_child_value(response, 1);
+  GVariantIter iter;
+  GVariant *entry;
+  g_variant_iter_init(&iter, array);
+  while ((entry = g_variant_iter_next_value(&iter)) != NULL) {
+    GnomeDdcDisplay *display = gnomeddc_display_new_from_variant(entry);
+    g_hash_table_replace(bench->displays,
+                         GINT_TO_POINTER(gnomeddc_display_get_display_number(display)),
+                         display);
+    g_variant_unref(entry);
+  }
+
+  /* Only the replay itself is measured. */
+  gnomeddc_call_stats_reset(gnomeddc_client_get_call_stats(bench->client));
+  bench->heap_start = heap_in_use();
+  bench->heap_peak = bench->heap_start;
+  bench->start_time = g_get_monotonic_time();
+  bench->round_start = bench->start_time;
+  bench->last_beat = bench->start_time;
+  bench->heartbeat_id = g_timeout_add_full(G_PRIORITY_HIGH, HEARTBEAT_MSEC, heartbeat_cb, bench, NULL);
+  replay_next(bench);
+}
+
+static void
+client_ready_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  Bench *bench = user_data;
+  g_autoptr(GError) error = NULL;
+
+  bench->client = gnomeddc_client_new_finish(result, &error);
+  if (bench->client == NULL) {
+    g_printerr("gnomeddc-bench: %s\n", error->message);
+    bench_finish(bench, EXIT_FAILED);
+    return;
+  }
+
+  if (bench->set_call_limits) {
+    gnomeddc_client_set_call_limits(bench->client, bench->max_in_flight, bench->max_in_flight_per_display);
+  }
+  bench->coalescer = gnomeddc_write_coalescer_new(bench->client);
+  gnomeddc_client_call_async(bench->client,
+                             "ListDetected",
+                             g_variant_new("(u)", 0),
+                             NULL,
+                             list_finished_cb,
+                             bench);
+}
+
+static gint
+compare_int64(gconstpointer a, gconstpointer b)
+{
+  gint64 x = *(const gint64 *) a;
+  gint64 y = *(const gint64 *) b;
+  return (x > y) - (x < y);
+}
+
+static gint64
+percentile(GArray *sorted, guint percent)
+{
+  if (sorted->len == 0) {
+    return 0;
+  }
+  guint index = (guint) (((guint64) sorted->len * percent + 99) / 100);
+  return g_array_index(sorted, gint64, MIN(MAX(index, 1), sorted->len) - 1);
+}
+
+static void
+print_report(Bench *bench)
+{
+  g_array_sort(bench->latencies, compare_int64);
+
+  gdouble seconds = (gdouble) (bench->end_time - bench->start_time) / G_TIME_SPAN_SECOND;
+  gdouble throughput = seconds > 0 ? bench->latencies->len / seconds : 0;
+  GnomeDdcCallStats *stats = gnomeddc_client_get_call_stats(bench->client);
+
+  if (bench->json) {
+    g_autofree gchar *stats_json = gnomeddc_call_stats_to_json(stats);
+    g_autoptr(GString) json = g_string_new("{\n\"trace\": ");
+    gnomeddc_json_append_string(json, bench->trace_name);
+    g_string_append_printf(json,
+                           ",\n\"rounds\": %u,\n"
+                           "\"wall_usec\": %" G_GINT64_FORMAT ",\n"
+                           "\"issued\": %" G_GUINT64_FORMAT ",\n"
+                           "\"completed\": %u,\n"
+                           "\"failed\": %" G_GUINT64_FORMAT ",\n"
+                           "\"superseded\": %" G_GUINT64_FORMAT ",\n"
+                           "\"service_calls\": %u,\n"
+                           "\"throughput_per_sec\": %.1f,\n"
+                           "\"latency_usec\": {\"p50\": %" G_GINT64_FORMAT ", \"p95\": %" G_GINT64_FORMAT
+                           ", \"p99\": %" G_GINT64_FORMAT ", \"max\": %" G_GINT64_FORMAT "},\n"
+                           "\"stalls\": {\"count\": %u, \"total_usec\": %" G_GINT64_FORMAT
+                           ", \"max_usec\": %" G_GINT64_FORMAT "},\n"
+                           "\"heap_bytes\": {\"start\": %" G_GSIZE_FORMAT ", \"peak\": %" G_GSIZE_FORMAT
+                           ", \"end\": %" G_GSIZE_FORMAT "},\n"
+                           "\"client\": %s\n}\n",
+                           bench->repeat,
+                           bench->end_time - bench->start_time,
+                           bench->n_issued,
+                           bench->latencies->len,
+                           bench->n_failed,
+                           bench->n_superseded,
+                           gnomeddc_mock_service_get_n_calls(bench->service),
+                           throughput,
+                           percentile(bench->latencies, 50),
+                           percentile(bench->latencies, 95),
+                           percentile(bench->latencies, 99),
+                           percentile(bench->latencies, 100),
+                           bench->n_stalls,
+                           bench->stall_total_usec,
+                           bench->stall_max_usec,
+                           bench->heap_start,
+                           bench->heap_peak,
+                           bench->heap_end,
+                           stats_json);
+    g_print("%s", json->str);
+    return;
+  }
+
+  g_print("%s, %u round(s) in %.2f s\n", bench->trace_name, bench->repeat, seconds);
+  g_print("  calls      %" G_GUINT64_FORMAT " issued, %u completed, %" G_GUINT64_FORMAT " failed, %"
+          G_GUINT64_FORMAT " superseded, %u reached the service\n",
+          bench->n_issued, bench->latencies->len, bench->n_failed, bench->n_superseded,
+          gnomeddc_mock_service_get_n_calls(bench->service));
+  g_print("  throughput %.1f calls/s\n", throughput);
+  g_print("  latency    p50 %.1f ms, p95 %.1f ms, p99 %.1f ms, max %.1f ms\n",
+          percentile(bench->latencies, 50) / 1000.0,
+          percentile(bench->latencies, 95) / 1000.0,
+          percentile(bench->latencies, 99) / 1000.0,
+          percentile(bench->latencies, 100) / 1000.0);
+  g_print("  stalls     %u over %d ms, %.1f ms in total, longest %.1f ms\n",
+          bench->n_stalls, (gint) (STALL_THRESHOLD_USEC / G_TIME_SPAN_MILLISECOND),
+          bench->stall_total_usec / 1000.0, bench->stall_max_usec / 1000.0);
+#ifdef HAVE_MALLINFO2
+  g_print("  heap       %+.1f KiB at the end, %+.1f KiB at the peak\n",
+          ((gdouble) bench->heap_end - (gdouble) bench->heap_start) / 1024.0,
+          ((gdouble) bench->heap_peak - (gdouble) bench->heap_start) / 1024.0);
+#endif
+
+  g_auto(GStrv) methods = gnomeddc_call_stats_dup_methods(stats);
+  for (guint i = 0; methods[i] != NULL; i++) {
+    GnomeDdcCallSummary summary;
+    gnomeddc_call_stats_get_summary(stats, methods[i], &summary);
+    g_print("  %-24s %6" G_GUINT64_FORMAT " calls, %4" G_GUINT64_FORMAT " errors, %5" G_GUINT64_FORMAT
+            " cached, %4" G_GUINT64_FORMAT " retried, p95 %.1f ms\n",
+            methods[i], summary.calls, summary.errors, summary.cache_hits, summary.retries,
+            summary.p95_usec / 1000.0);
+  }
+}
+
+static gboolean
+apply_method_options(GnomeDdcMockService *service, GStrv specs, gboolean rates, GError **error)
+{
+  for (guint i = 0; specs != NULL && specs[i] != NULL; i++) {
+    g_auto(GStrv) pair = g_strsplit(specs[i], "=", 2);
+    gchar *end = NULL;
+
+    if (pair[0] == NULL || pair[1] == NULL || pair[0][0] == '\0') {
+      g_set_error(error, G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE, "Expected METHOD=VALUE, got %s", specs[i]);
+      return FALSE;
+    }
+    gdouble value = g_ascii_strtod(pair[1], &end);
+    if (end == pair[1] || *end != '\0' || value < 0) {
+      g_set_error(error, G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE, "Invalid value in %s", specs[i]);
+      return FALSE;
+    }
+
+    if (rates) {
+      gnomeddc_mock_service_set_error_rate(service, pair[0], value);
+    } else {
+      gnomeddc_mock_service_set_latency(service, pair[0], (guint) value);
+    }
+  }
+  return TRUE;
+}
+
+static void
+remove_tree(const gchar *path)
+{
+  g_autoptr(GDir) dir = g_dir_open(path, 0, NULL);
+  const gchar *name;
+
+  while (dir != NULL && (name = g_dir_read_name(dir)) != NULL) {
+    g_autofree gchar *child = g_build_filename(path, name, NULL);
+    if (g_file_test(child, G_FILE_TEST_IS_DIR)) {
+      remove_tree(child);
+    } else {
+      g_unlink(child);
+    }
+  }
+  g_rmdir(path);
+}
+
+int
+main(int argc, char *argv[])
+{
+  g_autofree gchar *trace_path = NULL;
+  gint repeat = 1;
+  gint n_displays = 2;
+  g_autofree gchar *call_limits = NULL;
+  gboolean window = FALSE;
+  gboolean json = FALSE;
+  g_auto(GStrv) latency_specs = NULL;
+  g_auto(GStrv) error_specs = NULL;
+
+  const GOptionEntry entries[] = {
+    { "trace", 't', 0, G_OPTION_ARG_FILENAME, &trace_path, "Trace to replay", "FILE" },
+    { "repeat", 'r', 0, G_OPTION_ARG_INT, &repeat, "Replay the trace this many times", "N" },
+    { "displays", 'n', 0, G_OPTION_ARG_INT, &n_displays, "Number of mock displays", "N" },
+    { "latency", 'l', 0, G_OPTION_ARG_STRING_ARRAY, &latency_specs, "Service latency for a method (repeatable)", "METHOD=MSEC" },
+    { "error-rate", 'e', 0, G_OPTION_ARG_STRING_ARRAY, &error_specs, "Fraction of failing calls for a method (repeatable)", "METHOD=RATE" },
+    { "call-limits", 0, 0, G_OPTION_ARG_STRING, &call_limits, "Client limits on calls in flight, in total and per display; 0 for none", "MAX,PER_DISPLAY" },
+    { "window", 'w', 0, G_OPTION_ARG_NONE, &window, "Also show a GnomeDdcWindow on the mock service", NULL },
+    { "json", 'j', 0, G_OPTION_ARG_NONE, &json, "Print machine readable JSON", NULL },
+    { NULL }
+  };
+
+  g_autoptr(GOptionContext) context = g_option_context_new(NULL);
+  g_option_context_set_summary(context, "Replays a call trace against a mock ddcutil-service.");
+  g_option_context_add_main_entries(context, entries, NULL);
+
+  g_autoptr(GError) error = NULL;
+  if (!g_option_context_parse(context, &argc, &argv, &error)) {
+    g_printerr("gnomeddc-bench: %s\n", error->message);
+    return EXIT_USAGE;
+  }
+  if (trace_path == NULL || repeat < 1 || n_displays < 1) {
+    g_printerr("gnomeddc-bench: --trace is required, --repeat and --displays must be positive\n");
+    return EXIT_USAGE;
+  }
+
+  guint64 limits[2] = { 0, 0 };
+  if (call_limits != NULL) {
+    g_auto(GStrv) parts = g_strsplit(call_limits, ",", 3);
+    if (g_strv_length(parts) != 2 ||
+        !parse_number(parts[0], G_MAXUINT, &limits[0]) ||
+        !parse_number(parts[1], G_MAXUINT, &limits[1])) {
+      g_printerr("gnomeddc-bench: --call-limits expects MAX,PER_DISPLAY\n");
+      return EXIT_USAGE;
+    }
+  }
+
+  g_autoptr(GArray) events = load_trace(trace_path, &error);
+  if (events == NULL) {
+    g_printerr("gnomeddc-bench: %s\n", error->message);
+    return EXIT_USAGE;
+  }
+
+  g_autoptr(GnomeDdcMockService) service = gnomeddc_mock_service_new((guint) n_displays);
+  if (!apply_method_options(service, latency_specs, FALSE, &error) ||
+      !apply_method_options(service, error_specs, TRUE, &error)) {
+    g_printerr("gnomeddc-bench: %s\n", error->message);
+    return EXIT_USAGE;
+  }
+
+  /* Keep the window's state snapshot and profiles out of the user's home. */
+  g_autofree gchar *home = g_dir_make_tmp("gnomeddc-bench-XXXXXX", &error);
+  if (home == NULL) {
+    g_printerr("gnomeddc-bench: %s\n", error->message);
+    return EXIT_FAILED;
+  }
+  g_autofree gchar *cache_home = g_build_filename(home, "cache", NULL);
+  g_autofree gchar *config_home = g_build_filename(home, "config", NULL);
+  g_setenv("XDG_CACHE_HOME", cache_home, TRUE);
+  g_setenv("XDG_CONFIG_HOME", config_home, TRUE);
+
+  /* The client prefers the system bus, so point both at the private one. */
+  g_autoptr(GTestDBus) bus = g_test_dbus_new(G_TEST_DBUS_NONE);
+  g_test_dbus_up(bus);
+  g_setenv("DBUS_SYSTEM_BUS_ADDRESS", g_test_dbus_get_bus_address(bus), TRUE);
+
+  Bench bench = { 0 };
+  bench.json = json;
+  bench.trace_name = g_path_get_basename(trace_path);
+  bench.events = events;
+  bench.repeat = (guint) repeat;
+  bench.set_call_limits = call_limits != NULL;
+  bench.max_in_flight = (guint) limits[0];
+  bench.max_in_flight_per_display = (guint) limits[1];
+  bench.service = service;
+  bench.displays = g_hash_table_new_full(NULL, NULL, NULL, g_object_unref);
+  bench.latencies = g_array_new(FALSE, FALSE, sizeof(gint64));
+
+  if (!gnomeddc_mock_service_start(service, g_test_dbus_get_bus_address(bus), &error)) {
+    g_printerr("gnomeddc-bench: %s\n", error->message);
+    bench.exit_status = EXIT_FAILED;
+    goto out;
+  }
+
+  if (window) {
+    if (!gtk_init_check()) {
+      g_printerr("gnomeddc-bench: --window needs a display\n");
+      bench.exit_status = EXIT_FAILED;
+      goto out;
+    }
+    adw_init();
+    g_resources_register(gnomeddc_get_resource());
+    bench.window = g_object_ref_sink(g_object_new(GNOMEDDC_TYPE_WINDOW, NULL));
+    gtk_window_present(GTK_WINDOW(bench.window));
+  }
+
+  bench.loop = g_main_loop_new(NULL, FALSE);
+  gnomeddc_client_new_async(NULL, client_ready_cb, &bench);
+  g_main_loop_run(bench.loop);
+
+  if (bench.exit_status == EXIT_OK) {
+    bench.heap_end = heap_in_use();
+    print_report(&bench);
+  }
+
+out:
+  g_clear_handle_id(&bench.heartbeat_id, g_source_remove);
+  g_clear_handle_id(&bench.replay_source_id, g_source_remove);
+  if (bench.window != NULL) {
+    gtk_window_destroy(GTK_WINDOW(bench.window));
+    g_clear_object(&bench.window);
+  }
+  g_clear_object(&bench.coalescer);
+  g_clear_object(&bench.client);
+  g_clear_pointer(&bench.displays, g_hash_table_unref);
+  g_clear_pointer(&bench.latencies, g_array_unref);
+  g_clear_pointer(&bench.loop, g_main_loop_unref);
+  g_clear_pointer(&bench.trace_name, g_free);
+  gnomeddc_mock_service_stop(service);
+  g_test_dbus_down(bus);
+  remove_tree(home);
+  return bench.exit_status;
+}
@@ -0,0 +1,826 @@
+#include "gnomeddc-mock-service.h"
+
+#define DDCUTIL_SERVICE_NAME "com.ddcutil.DdcutilService"
+#define DDCUTIL_OBJECT_PATH "/com/ddcutil/DdcutilObject"
+#define DDCUTIL_INTERFACE_NAME "com.ddcutil.DdcutilInterface"
+
+#define DDCA_EVENT_DISPLAY_CONNECTED 2
+#define DDCA_EVENT_DISPLAY_DISCONNECTED 3
+
+/* Injected failures look like a monitor that did not answer. */
+#define MOCK_ERROR_STATUS -3001
+#define MOCK_ERROR_NAME "DDCRC_DDC_DATA"
+
+#define MOCK_MAX_VALUE 100
+
+/* Only the methods GnomeDDC calls; arguments and replies follow
+ * ddcutil-service's interface. */
+static const gchar introspection_xml[] =
+  "<node>"
+  "  <interface name='" DDCUTIL_INTERFACE_NAME "'>"
+  "    <method name='Detect'>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='number_of_displays' type='i' direction='out'/>"
+  "      <arg name='detected_displays' type='a(iiisssqsu)' direction='out'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='ListDetected'>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='number_of_displays' type='i' direction='out'/>"
+  "      <arg name='detected_displays' type='a(iiisssqsu)' direction='out'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='GetVcp'>"
+  "      <arg name='display_number' type='i' direction='in'/>"
+  "      <arg name='edid_txt' type='s' direction='in'/>"
+  "      <arg name='vcp_code' type='y' direction='in'/>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='vcp_current_value' type='q' direction='out'/>"
+  "      <arg name='vcp_max_value' type='q' direction='out'/>"
+  "      <arg name='vcp_formatted_value' type='s' direction='out'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='GetMultipleVcp'>"
+  "      <arg name='display_number' type='i' direction='in'/>"
+  "      <arg name='edid_txt' type='s' direction='in'/>"
+  "      <arg name='vcp_code' type='ay' direction='in'/>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='vcp_current_value' type='a(yqqs)' direction='out'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='SetVcp'>"
+  "      <arg name='display_number' type='i' direction='in'/>"
+  "      <arg name='edid_txt' type='s' direction='in'/>"
+  "      <arg name='vcp_code' type='y' direction='in'/>"
+  "      <arg name='vcp_new_value' type='q' direction='in'/>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='SetVcpWithContext'>"
+  "      <arg name='display_number' type='i' direction='in'/>"
+  "      <arg name='edid_txt' type='s' direction='in'/>"
+  "      <arg name='vcp_code' type='y' direction='in'/>"
+  "      <arg name='vcp_new_value' type='q' direction='in'/>"
+  "      <arg name='client_context' type='s' direction='in'/>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='GetVcpMetadata'>"
+  "      <arg name='display_number' type='i' direction='in'/>"
+  "      <arg name='edid_txt' type='s' direction='in'/>"
+  "      <arg name='vcp_code' type='y' direction='in'/>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='feature_name' type='s' direction='out'/>"
+  "      <arg name='feature_description' type='s' direction='out'/>"
+  "      <arg name='is_read_only' type='b' direction='out'/>"
+  "      <arg name='is_write_only' type='b' direction='out'/>"
+  "      <arg name='is_rw' type='b' direction='out'/>"
+  "      <arg name='is_complex' type='b' direction='out'/>"
+  "      <arg name='is_continuous' type='b' direction='out'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='GetCapabilitiesString'>"
+  "      <arg name='display_number' type='i' direction='in'/>"
+  "      <arg name='edid_txt' type='s' direction='in'/>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='capabilities_text' type='s' direction='out'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='GetCapabilitiesMetadata'>"
+  "      <arg name='display_number' type='i' direction='in'/>"
+  "      <arg name='edid_txt' type='s' direction='in'/>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='model_name' type='s' direction='out'/>"
+  "      <arg name='mccs_major' type='y' direction='out'/>"
+  "      <arg name='mccs_minor' type='y' direction='out'/>"
+  "      <arg name='commands' type='a{ys}' direction='out'/>"
+  "      <arg name='capabilities' type='a{y(ssa{ys})}' direction='out'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='GetDisplayState'>"
+  "      <arg name='display_number' type='i' direction='in'/>"
+  "      <arg name='edid_txt' type='s' direction='in'/>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='status' type='i' direction='out'/>"
+  "      <arg name='message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='GetSleepMultiplier'>"
+  "      <arg name='display_number' type='i' direction='in'/>"
+  "      <arg name='edid_txt' type='s' direction='in'/>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='current_multiplier' type='d' direction='out'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <method name='SetSleepMultiplier'>"
+  "      <arg name='display_number' type='i' direction='in'/>"
+  "      <arg name='edid_txt' type='s' direction='in'/>"
+  "      <arg name='new_multiplier' type='d' direction='in'/>"
+  "      <arg name='flags' type='u' direction='in'/>"
+  "      <arg name='error_status' type='i' direction='out'/>"
+  "      <arg name='error_message' type='s' direction='out'/>"
+  "    </method>"
+  "    <signal name='ConnectedDisplaysChanged'>"
+  "      <arg name='edid_txt' type='s'/>"
+  "      <arg name='event_type' type='i'/>"
+  "      <arg name='flags' type='u'/>"
+  "    </signal>"
+  "    <signal name='VcpValueChanged'>"
+  "      <arg name='display_number' type='i'/>"
+  "      <arg name='edid_txt' type='s'/>"
+  "      <arg name='vcp_code' type='y'/>"
+  "      <arg name='vcp_new_value' type='q'/>"
+  "      <arg name='source_client_name' type='s'/>"
+  "      <arg name='source_client_context' type='s'/>"
+  "      <arg name='flags' type='u'/>"
+  "    </signal>"
+  "    <property name='ServiceInterfaceVersion' type='s' access='read'/>"
+  "    <property name='DisplayEventTypes' type='a{is}' access='read'/>"
+  "    <property name='StatusValues' type='a{is}' access='read'/>"
+  "  </interface>"
+  "</node>";
+
+typedef struct {
+  gint display_number;
+  gchar *edid;
+  gboolean connected;
+  gdouble sleep_multiplier;
+  guint16 values[256];
+} MockDisplay;
+
+struct _GnomeDdcMockService {
+  GObject parent_instance;
+
+  /* Everything below except the counters is either set up before
+   * gnomeddc_mock_service_start() or only touched on the service thread. */
+  GPtrArray *displays;
+  GHashTable *latencies;
+  GHashTable *error_rates;
+  GRand *rand;
+
+  GMainContext *context;
+  GMainLoop *loop;
+  GThread *thread;
+  GDBusConnection *connection;
+  guint registration_id;
+
+  /* Like ddcutil-service, calls are answered one at a time. */
+  GQueue pending;
+  GSource *busy_source;
+
+  gint n_calls;
+  gint n_errors;
+};
+
+G_DEFINE_FINAL_TYPE(GnomeDdcMockService, gnomeddc_mock_service, G_TYPE_OBJECT)
+
+static void
+mock_display_free(MockDisplay *display)
+{
+  g_free(display->edid);
+  g_free(display);
+}
+
+static MockDisplay *
+find_display(GnomeDdcMockService *self, gint display_number, const gchar *edid)
+{
+  for (guint i = 0; i < self->displays->len; i++) {
+    MockDisplay *display = g_ptr_array_index(self->displays, i);
+    if (!display->connected) {
+      continue;
+    }
+    if (edid != NULL && edid[0] != '\0') {
+      if (g_ascii_strcasecmp(display->edid, edid) == 0) {
+        return display;
+      }
+    } else if (display->display_number == display_number) {
+      return display;
+    }
+  }
+  return NULL;
+}
+
+static GVariant *
+build_display_list(GnomeDdcMockService *self)
+{
+  GVariantBuilder builder;
+  gint n_connected = 0;
+
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("a(iiisssqsu)"));
+  for (guint i = 0; i < self->displays->len; i++) {
+    MockDisplay *display = g_ptr_array_index(self->displays, i);
+    if (!display->connected) {
+      continue;
+    }
+    g_autofree gchar *model = g_strdup_printf("Mock Monitor %d", display->display_number);
+    g_autofree gchar *serial = g_strdup_printf("MOCK%04d", display->display_number);
+    g_variant_builder_add(&builder, "(iiisssqsu)",
+                          display->display_number,
+                          display->display_number + 2,
+                          0,
+                          "MCK",
+                          model,
+                          serial,
+                          (guint16) (0x1000 + display->display_number),
+                          display->edid,
+                          (guint32) display->display_number);
+    n_connected++;
+  }
+
+  return g_variant_new("(ia(iiisssqsu)is)", n_connected, &builder, 0, "OK");
+}
+
+static GVariant *
+build_capabilities_metadata(MockDisplay *display, gint status, const gchar *message)
+{
+  GVariantBuilder commands;
+  GVariantBuilder features;
+
+  g_variant_builder_init(&commands, G_VARIANT_TYPE("a{ys}"));
+  g_variant_builder_add(&commands, "{ys}", 0x01, "VCP Request");
+  g_variant_builder_add(&commands, "{ys}", 0x03, "VCP Set");
+
+  g_variant_builder_init(&features, G_VARIANT_TYPE("a{y(ssa{ys})}"));
+  if (status == 0) {
+    const guint8 codes[] = { 0x10, 0x12, 0x16, 0x18, 0x1a, 0x60, 0x62 };
+    for (guint i = 0; i < G_N_ELEMENTS(codes); i++) {
+      GVariantBuilder values;
+      g_variant_builder_init(&values, G_VARIANT_TYPE("a{ys}"));
+      if (codes[i] == 0x60) {
+        g_variant_builder_add(&values, "{ys}", 0x0f, "DisplayPort-1");
+        g_variant_builder_add(&values, "{ys}", 0x11, "HDMI-1");
+      }
+      g_autofree gchar *name = g_strdup_printf("Feature %02X", codes[i]);
+      g_variant_builder_add(&features, "{y(ssa{ys})}", codes[i], name, "Mock feature", &values);
+    }
+  }
+
+  g_autofree gchar *model = display != NULL ? g_strdup_printf("Mock Monitor %d", display->display_number) : g_strdup("");
+  return g_variant_new("(syya{ys}a{y(ssa{ys})}is)", model, 2, 2, &commands, &features, status, message);
+}
+
+static guint
+latency_for(GnomeDdcMockService *self, const gchar *method, GVariant *parameters)
+{
+  guint latency = GPOINTER_TO_UINT(g_hash_table_lookup(self->latencies, method));
+
+  /* The service reads the codes one after another. */
+  if (g_strcmp0(method, "GetMultipleVcp") == 0) {
+    g_autoptr(GVariant) codes = g_variant_get_child_value(parameters, 2);
+    latency *= MAX(g_variant_n_children(codes), 1);
+  }
+  return latency;
+}
+
+static gboolean
+should_fail(GnomeDdcMockService *self, const gchar *method)
+{
+  gdouble *rate = g_hash_table_lookup(self->error_rates, method);
+  return rate != NULL && g_rand_double(self->rand) < *rate;
+}
+
+static void
+emit_vcp_value_changed(GnomeDdcMockService *self,
+                       MockDisplay *display,
+                       guint8 code,
+                       const gchar *source_client_name,
+                       const gchar *source_client_context)
+{
+  g_dbus_connection_emit_signal(self->connection,
+                                NULL,
+                                DDCUTIL_OBJECT_PATH,
+                                DDCUTIL_INTERFACE_NAME,
+                                "VcpValueChanged",
+                                g_variant_new("(isyqssu)",
+                                              display->display_number,
+                                              display->edid,
+                                              code,
+                                              display->values[code],
+                                              source_client_name,
+                                              source_client_context,
+                                              0),
+                                NULL);
+}
+
+static GVariant *
+build_reply(GnomeDdcMockService *self, GDBusMethodInvocation *invocation)
+{
+  const gchar *method = g_dbus_method_invocation_get_method_name(invocation);
+  GVariant *parameters = g_dbus_method_invocation_get_parameters(invocation);
+
+  if (g_strcmp0(method, "Detect") == 0 || g_strcmp0(method, "ListDetected") == 0) {
+    return build_display_list(self);
+  }
+
+  gint display_number = 0;
+  const gchar *edid = NULL;
+  g_variant_get_child(parameters, 0, "i", &display_number);
+  g_variant_get_child(parameters, 1, "&s", &edid);
+
+  MockDisplay *display = find_display(self, display_number, edid);
+  gboolean failed = display == NULL || should_fail(self, method);
+  gint status = failed ? MOCK_ERROR_STATUS : 0;
+  const gchar *message = failed ? MOCK_ERROR_NAME : "OK";
+  if (failed) {
+    g_atomic_int_inc(&self->n_errors);
+  }
+
+  if (g_strcmp0(method, "GetVcp") == 0) {
+    guint8 code;
+    g_variant_get_child(parameters, 2, "y", &code);
+    guint16 value = failed ? 0 : display->values[code];
+    g_autofree gchar *formatted = g_strdup_printf("%u", value);
+    return g_variant_new("(qqsis)", value, MOCK_MAX_VALUE, formatted, status, message);
+  }
+
+  if (g_strcmp0(method, "GetMultipleVcp") == 0) {
+    g_autoptr(GVariant) codes_variant = g_variant_get_child_value(parameters, 2);
+    gsize n_codes = 0;
+    const guint8 *codes = g_variant_get_fixed_array(codes_variant, &n_codes, sizeof(guint8));
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a(yqqs)"));
+    for (gsize i = 0; i < n_codes && !failed; i++) {
+      g_autofree gchar *formatted = g_strdup_printf("%u", display->values[codes[i]]);
+      g_variant_builder_add(&builder, "(yqqs)", codes[i], display->values[codes[i]], MOCK_MAX_VALUE, formatted);
+    }
+    return g_variant_new("(a(yqqs)is)", &builder, status, message);
+  }
+
+  if (g_strcmp0(method, "SetVcp") == 0 || g_strcmp0(method, "SetVcpWithContext") == 0) {
+    guint8 code;
+    guint16 value;
+    g_variant_get_child(parameters, 2, "y", &code);
+    g_variant_get_child(parameters, 3, "q", &value);
+    if (!failed) {
+      const gchar *context = "";
+      if (g_strcmp0(method, "SetVcpWithContext") == 0) {
+        g_variant_get_child(parameters, 4, "&s", &context);
+      }
+      display->values[code] = value;
+      const gchar *sender = g_dbus_method_invocation_get_sender(invocation);
+      emit_vcp_value_changed(self, display, code, sender != NULL ? sender : "", context);
+    }
+    return g_variant_new("(is)", status, message);
+  }
+
+  if (g_strcmp0(method, "GetVcpMetadata") == 0) {
+    guint8 code;
+    g_variant_get_child(parameters, 2, "y", &code);
+    g_autofree gchar *name = g_strdup_printf("Feature %02X", code);
+    return g_variant_new("(ssbbbbbis)", name, "Mock feature", FALSE, FALSE, TRUE, FALSE, TRUE, status, message);
+  }
+
+  if (g_strcmp0(method, "GetCapabilitiesString") == 0) {
+    return g_variant_new("(sis)",
+                         failed ? "" : "(prot(monitor)type(LCD)model(Mock)cmds(01 02 03)vcp(10 12 16 18 1A 60(0F 11) 62)mccs_ver(2.2))",
+                         status, message);
+  }
+
+  if (g_strcmp0(method, "GetCapabilitiesMetadata") == 0) {
+    return build_capabilities_metadata(display, status, message);
+  }
+
+  if (g_strcmp0(method, "GetDisplayState") == 0) {
+    return g_variant_new("(is)", status, message);
+  }
+
+  if (g_strcmp0(method, "GetSleepMultiplier") == 0) {
+    return g_variant_new("(dis)", failed ? 0.0 : display->sleep_multiplier, status, message);
+  }
+
+  if (g_strcmp0(method, "SetSleepMultiplier") == 0) {
+    if (!failed) {
+      g_variant_get_child(parameters, 2, "d", &display->sleep_multiplier);
+    }
+    return g_variant_new("(is)", status, message);
+  }
+
+  return NULL;
+}
+
+static void start_next_call(GnomeDdcMockService *self);
+
+static gboolean
+call_done_cb(gpointer user_data)
+{
+  GnomeDdcMockService *self = GNOMEDDC_MOCK_SERVICE(user_data);
+  GDBusMethodInvocation *invocation = g_queue_pop_head(&self->pending);
+
+  /* The reply is built once the latency has passed, so writes land in the
+   * order they were answered. */
+  GVariant *reply = build_reply(self, invocation);
+  if (reply != NULL) {
+    g_dbus_method_invocation_return_value(invocation, reply);
+  } else {
+    g_dbus_method_invocation_return_error(invocation, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_METHOD,
+                                          "Method %s is not mocked",
+                                          g_dbus_method_invocation_get_method_name(invocation));
+  }
+
+  g_clear_pointer(&self->busy_source, g_source_unref);
+  start_next_call(self);
+  return G_SOURCE_REMOVE;
+}
+
+static void
+start_next_call(GnomeDdcMockService *self)
+{
+  GDBusMethodInvocation *invocation = g_queue_peek_head(&self->pending);
+  if (invocation == NULL || self->busy_source != NULL) {
+    return;
+  }
+
+  guint latency = latency_for(self,
+                              g_dbus_method_invocation_get_method_name(invocation),
+                              g_dbus_method_invocation_get_parameters(invocation));
+  self->busy_source = g_timeout_source_new(latency);
+  g_source_set_callback(self->busy_source, call_done_cb, self, NULL);
+  g_source_attach(self->busy_source, self->context);
+}
+
+static void
+method_call_cb(GDBusConnection *connection G_GNUC_UNUSED,
+               const gchar *sender G_GNUC_UNUSED,
+               const gchar *object_path G_GNUC_UNUSED,
+               const gchar *interface_name G_GNUC_UNUSED,
+               const gchar *method_name G_GNUC_UNUSED,
+               GVariant *parameters G_GNUC_UNUSED,
+               GDBusMethodInvocation *invocation,
+               gpointer user_data)
+{
+  GnomeDdcMockService *self = GNOMEDDC_MOCK_SERVICE(user_data);
+
+  g_atomic_int_inc(&self->n_calls);
+  /* The vtable hands over its reference to the invocation. */
+  g_queue_push_tail(&self->pending, invocation);
+  start_next_call(self);
+}
+
+static GVariant *
+build_names_property(const gint *codes, const gchar * const *names, guint n)
+{
+  GVariantBuilder builder;
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("a{is}"));
+  for (guint i = 0; i < n; i++) {
+    g_variant_builder_add(&builder, "{is}", codes[i], names[i]);
+  }
+  return g_variant_builder_end(&builder);
+}
+
+static GVariant *
+get_property_cb(GDBusConnection *connection G_GNUC_UNUSED,
+                const gchar *sender G_GNUC_UNUSED,
+                const gchar *object_path G_GNUC_UNUSED,
+                const gchar *interface_name G_GNUC_UNUSED,
+                const gchar *property_name,
+                GError **error,
+                gpointer user_data G_GNUC_UNUSED)
+{
+  if (g_strcmp0(property_name, "ServiceInterfaceVersion") == 0) {
+    return g_variant_new_string("1.0.0-mock");
+  }
+
+  if (g_strcmp0(property_name, "DisplayEventTypes") == 0) {
+    const gint codes[] = { DDCA_EVENT_DISPLAY_CONNECTED, DDCA_EVENT_DISPLAY_DISCONNECTED };
+    const gchar * const names[] = { "DDCA_EVENT_DISPLAY_CONNECTED", "DDCA_EVENT_DISPLAY_DISCONNECTED" };
+    return build_names_property(codes, names, G_N_ELEMENTS(codes));
+  }
+
+  if (g_strcmp0(property_name, "StatusValues") == 0) {
+    const gint codes[] = { 0, MOCK_ERROR_STATUS };
+    const gchar * const names[] = { "DDCRC_OK", MOCK_ERROR_NAME };
+    return build_names_property(codes, names, G_N_ELEMENTS(codes));
+  }
+
+  g_set_error(error, G_DBUS_ERROR, G_DBUS_ERROR_UNKNOWN_PROPERTY,
+              "Property %s is not mocked", property_name);
+  return NULL;
+}
+
+static const GDBusInterfaceVTable interface_vtable = {
+  .method_call = method_call_cb,
+  .get_property = get_property_cb,
+};
+
+static gboolean
+quit_loop_cb(gpointer user_data)
+{
+  GnomeDdcMockService *self = GNOMEDDC_MOCK_SERVICE(user_data);
+  g_main_loop_quit(self->loop);
+  return G_SOURCE_REMOVE;
+}
+
+static gpointer
+service_thread_func(gpointer user_data)
+{
+  GnomeDdcMockService *self = GNOMEDDC_MOCK_SERVICE(user_data);
+
+  g_main_context_push_thread_default(self->context);
+  g_main_loop_run(self->loop);
+  g_main_context_pop_thread_default(self->context);
+  return NULL;
+}
+
+static void
+gnomeddc_mock_service_finalize(GObject *object)
+{
+  GnomeDdcMockService *self = GNOMEDDC_MOCK_SERVICE(object);
+
+  gnomeddc_mock_service_stop(self);
+  g_clear_pointer(&self->displays, g_ptr_array_unref);
+  g_clear_pointer(&self->latencies, g_hash_table_unref);
+  g_clear_pointer(&self->error_rates, g_hash_table_unref);
+  g_clear_pointer(&self->rand, g_rand_free);
+  g_clear_pointer(&self->loop, g_main_loop_unref);
+  g_clear_pointer(&self->context, g_main_context_unref);
+
+  G_OBJECT_CLASS(gnomeddc_mock_service_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_mock_service_class_init(GnomeDdcMockServiceClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_mock_service_finalize;
+}
+
+static void
+gnomeddc_mock_service_init(GnomeDdcMockService *self)
+{
+  self->displays = g_ptr_array_new_with_free_func((GDestroyNotify) mock_display_free);
+  self->latencies = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  self->error_rates = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, g_free);
+  /* A fixed seed keeps the injected failures the same from run to run. */
+  self->rand = g_rand_new_with_seed(0x0ddc);
+  self->context = g_main_context_new();
+  self->loop = g_main_loop_new(self->context, FALSE);
+  g_queue_init(&self->pending);
+
+  /* Rough figures for a DDC/CI monitor with the default sleep multiplier. */
+  gnomeddc_mock_service_set_latency(self, "Detect", 400);
+  gnomeddc_mock_service_set_latency(self, "GetVcp", 40);
+  gnomeddc_mock_service_set_latency(self, "GetMultipleVcp", 40);
+  gnomeddc_mock_service_set_latency(self, "SetVcp", 50);
+  gnomeddc_mock_service_set_latency(self, "SetVcpWithContext", 50);
+  gnomeddc_mock_service_set_latency(self, "GetVcpMetadata", 5);
+  gnomeddc_mock_service_set_latency(self, "GetCapabilitiesString", 300);
+  gnomeddc_mock_service_set_latency(self, "GetCapabilitiesMetadata", 300);
+  gnomeddc_mock_service_set_latency(self, "GetDisplayState", 40);
+}
+
+/* Serves @n_displays monitors numbered from 1, each with every VCP value
+ * at half scale. */
+GnomeDdcMockService *
+gnomeddc_mock_service_new(guint n_displays)
+{
+  GnomeDdcMockService *self = g_object_new(GNOMEDDC_TYPE_MOCK_SERVICE, NULL);
+
+  for (guint i = 0; i < n_displays; i++) {
+    MockDisplay *display = g_new0(MockDisplay, 1);
+    display->display_number = (gint) i + 1;
+    display->connected = TRUE;
+    display->sleep_multiplier = 1.0;
+    GString *edid = g_string_new("00FFFFFFFFFFFF00");
+    while (edid->len < 256) {
+      g_string_append_printf(edid, "%02X", (guint) ((i * 37 + edid->len) & 0xff));
+    }
+    display->edid = g_string_free(edid, FALSE);
+    for (guint code = 0; code < G_N_ELEMENTS(display->values); code++) {
+      display->values[code] = MOCK_MAX_VALUE / 2;
+    }
+    g_ptr_array_add(self->displays, display);
+  }
+
+  return self;
+}
+
+/* GetMultipleVcp's latency is per requested code. Latencies and error
+ * rates must be set before the service is started. */
+void
+gnomeddc_mock_service_set_latency(GnomeDdcMockService *self,
+                                  const gchar *method,
+                                  guint latency_msec)
+{
+  g_return_if_fail(GNOMEDDC_IS_MOCK_SERVICE(self));
+  g_return_if_fail(method != NULL);
+  g_return_if_fail(self->thread == NULL);
+
+  g_hash_table_replace(self->latencies, g_strdup(method), GUINT_TO_POINTER(latency_msec));
+}
+
+/* A failed call still gets a normal reply, carrying MOCK_ERROR_STATUS. */
+void
+gnomeddc_mock_service_set_error_rate(GnomeDdcMockService *self,
+                                     const gchar *method,
+                                     gdouble rate)
+{
+  g_return_if_fail(GNOMEDDC_IS_MOCK_SERVICE(self));
+  g_return_if_fail(method != NULL);
+  g_return_if_fail(self->thread == NULL);
+
+  gdouble *value = g_new(gdouble, 1);
+  *value = CLAMP(rate, 0.0, 1.0);
+  g_hash_table_replace(self->error_rates, g_strdup(method), value);
+}
+
+/* Connects to the bus at @address, takes the ddcutil-service name and
+ * answers calls on a thread of its own, so the caller's main loop only
+ * sees the client side. */
+gboolean
+gnomeddc_mock_service_start(GnomeDdcMockService *self,
+                            const gchar *address,
+                            GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_MOCK_SERVICE(self), FALSE);
+  g_return_val_if_fail(address != NULL, FALSE);
+  g_return_val_if_fail(self->connection == NULL, FALSE);
+
+  g_autoptr(GDBusNodeInfo) node = g_dbus_node_info_new_for_xml(introspection_xml, error);
+  if (node == NULL) {
+    return FALSE;
+  }
+
+  self->connection = g_dbus_connection_new_for_address_sync(address,
+                                                            G_DBUS_CONNECTION_FLAGS_AUTHENTICATION_CLIENT |
+                                                            G_DBUS_CONNECTION_FLAGS_MESSAGE_BUS_CONNECTION,
+                                                            NULL, NULL, error);
+  if (self->connection == NULL) {
+    return FALSE;
+  }
+
+  /* Method calls are dispatched in the context that was the thread default
+   * at registration. */
+  g_main_context_push_thread_default(self->context);
+  self->registration_id = g_dbus_connection_register_object(self->connection,
+                                                            DDCUTIL_OBJECT_PATH,
+                                                            node->interfaces[0],
+                                                            &interface_vtable,
+                                                            self, NULL,
+                                                            error);
+  g_main_context_pop_thread_default(self->context);
+  if (self->registration_id == 0) {
+    g_clear_object(&self->connection);
+    return FALSE;
+  }
+
+  g_autoptr(GVariant) reply = g_dbus_connection_call_sync(self->connection,
+                                                          "org.freedesktop.DBus",
+                                                          "/org/freedesktop/DBus",
+                                                          "org.freedesktop.DBus",
+                                                          "RequestName",
+                                                          g_variant_new("(su)", DDCUTIL_SERVICE_NAME,
+                                                                        (guint32) G_BUS_NAME_OWNER_FLAGS_DO_NOT_QUEUE),
+                                                          G_VARIANT_TYPE("(u)"),
+                                                          G_DBUS_CALL_FLAGS_NONE,
+                                                          -1, NULL, error);
+  guint32 result = 0;
+  if (reply != NULL) {
+    g_variant_get(reply, "(u)", &result);
+  }
+  /* 1 is DBUS_REQUEST_NAME_REPLY_PRIMARY_OWNER */
+  if (result != 1) {
+    if (reply != NULL) {
+      g_set_error(error, G_IO_ERROR, G_IO_ERROR_EXISTS, "%s is already owned", DDCUTIL_SERVICE_NAME);
+    }
+    g_dbus_connection_unregister_object(self->connection, self->registration_id);
+    self->registration_id = 0;
+    g_clear_object(&self->connection);
+    return FALSE;
+  }
+
+  self->thread = g_thread_new("mock-ddcutil", service_thread_func, self);
+  return TRUE;
+}
+
+void
+gnomeddc_mock_service_stop(GnomeDdcMockService *self)
+{
+  g_return_if_fail(GNOMEDDC_IS_MOCK_SERVICE(self));
+
+  if (self->connection == NULL) {
+    return;
+  }
+
+  g_dbus_connection_unregister_object(self->connection, self->registration_id);
+  self->registration_id = 0;
+
+  /* Quitting from inside the context also works if the thread has not
+   * reached g_main_loop_run() yet. */
+  g_main_context_invoke(self->context, quit_loop_cb, self);
+  g_clear_pointer(&self->thread, g_thread_join);
+
+  if (self->busy_source != NULL) {
+    g_source_destroy(self->busy_source);
+    g_clear_pointer(&self->busy_source, g_source_unref);
+  }
+  GDBusMethodInvocation *invocation;
+  while ((invocation = g_queue_pop_head(&self->pending)) != NULL) {
+    g_dbus_method_invocation_return_error_literal(invocation, G_IO_ERROR, G_IO_ERROR_CLOSED,
+                                                  "The mock service stopped");
+  }
+
+  g_dbus_connection_close_sync(self->connection, NULL, NULL);
+  g_clear_object(&self->connection);
+}
+
+typedef struct {
+  GnomeDdcMockService *self;
+  gint display_number;
+  gint event_type;
+  guint8 code;
+  guint16 value;
+} EmitData;
+
+static gboolean
+emit_display_changed_cb(gpointer user_data)
+{
+  EmitData *data = user_data;
+  GnomeDdcMockService *self = data->self;
+
+  for (guint i = 0; i < self->displays->len; i++) {
+    MockDisplay *display = g_ptr_array_index(self->displays, i);
+    if (display->display_number != data->display_number) {
+      continue;
+    }
+    display->connected = data->event_type != DDCA_EVENT_DISPLAY_DISCONNECTED;
+    g_dbus_connection_emit_signal(self->connection,
+                                  NULL,
+                                  DDCUTIL_OBJECT_PATH,
+                                  DDCUTIL_INTERFACE_NAME,
+                                  "ConnectedDisplaysChanged",
+                                  g_variant_new("(siu)", display->edid, data->event_type, 0),
+                                  NULL);
+  }
+  return G_SOURCE_REMOVE;
+}
+
+static gboolean
+emit_vcp_changed_cb(gpointer user_data)
+{
+  EmitData *data = user_data;
+  MockDisplay *display = find_display(data->self, data->display_number, NULL);
+
+  if (display != NULL) {
+    display->values[data->code] = data->value;
+    emit_vcp_value_changed(data->self, display, data->code, "gnomeddc-bench", "");
+  }
+  return G_SOURCE_REMOVE;
+}
+
+/* Plugs or unplugs a display as seen by Detect and ListDetected, and
+ * emits ConnectedDisplaysChanged for it. */
+void
+gnomeddc_mock_service_emit_display_changed(GnomeDdcMockService *self,
+                                           gint display_number,
+                                           gint event_type)
+{
+  g_return_if_fail(GNOMEDDC_IS_MOCK_SERVICE(self));
+  g_return_if_fail(self->thread != NULL);
+
+  EmitData *data = g_new0(EmitData, 1);
+  data->self = self;
+  data->display_number = display_number;
+  data->event_type = event_type;
+  g_main_context_invoke_full(self->context, G_PRIORITY_DEFAULT, emit_display_changed_cb, data, g_free);
+}
+
+/* Changes a value behind the client's back, as another program would. */
+void
+gnomeddc_mock_service_emit_vcp_changed(GnomeDdcMockService *self,
+                                       gint display_number,
+                                       guint8 code,
+                                       guint16 value)
+{
+  g_return_if_fail(GNOMEDDC_IS_MOCK_SERVICE(self));
+  g_return_if_fail(self->thread != NULL);
+
+  EmitData *data = g_new0(EmitData, 1);
+  data->self = self;
+  data->display_number = display_number;
+  data->code = code;
+  data->value = value;
+  g_main_context_invoke_full(self->context, G_PRIORITY_DEFAULT, emit_vcp_changed_cb, data, g_free);
+}
+
+guint
+gnomeddc_mock_service_get_n_calls(GnomeDdcMockService *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_MOCK_SERVICE(self), 0);
+  return (guint) g_atomic_int_get(&self->n_calls);
+}
+
+guint
+gnomeddc_mock_service_get_n_errors(GnomeDdcMockService *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_MOCK_SERVICE(self), 0);
+  return (guint) g_atomic_int_get(&self->n_errors);
+}
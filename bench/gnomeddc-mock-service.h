@@ -0,0 +1,39 @@
+#ifndef GNOMEDDC_MOCK_SERVICE_H
+#define GNOMEDDC_MOCK_SERVICE_H
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_MOCK_SERVICE (gnomeddc_mock_service_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcMockService, gnomeddc_mock_service, GNOMEDDC, MOCK_SERVICE, GObject)
+
+GnomeDdcMockService *gnomeddc_mock_service_new(guint n_displays);
+
+void gnomeddc_mock_service_set_latency(GnomeDdcMockService *self,
+                                       const gchar *method,
+                                       guint latency_msec);
+void gnomeddc_mock_service_set_error_rate(GnomeDdcMockService *self,
+                                          const gchar *method,
+                                          gdouble rate);
+
+gboolean gnomeddc_mock_service_start(GnomeDdcMockService *self,
+                                     const gchar *address,
+                                     GError **error);
+void gnomeddc_mock_service_stop(GnomeDdcMockService *self);
+
+void gnomeddc_mock_service_emit_display_changed(GnomeDdcMockService *self,
+                                                gint display_number,
+                                                gint event_type);
+void gnomeddc_mock_service_emit_vcp_changed(GnomeDdcMockService *self,
+                                            gint display_number,
+                                            guint8 code,
+                                            guint16 value);
+
+guint gnomeddc_mock_service_get_n_calls(GnomeDdcMockService *self);
+guint gnomeddc_mock_service_get_n_errors(GnomeDdcMockService *self);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_MOCK_SERVICE_H */
@@ -1,17 +1,98 @@
 #include "gnomeddc-application.h"
 
+#include "gnomeddc-display.h"
+#include "gnomeddc-state-snapshot.h"
 #include "gnomeddc-window.h"
 
 #include <gio/gio.h>
+#include <string.h>
 
 extern GResource *gnomeddc_get_resource(void);
 
+#define VCP_BRIGHTNESS 0x10
+
+/* What the resident instance knows about one display's brightness, so a
+ * hotkey press only costs the write. */
+typedef struct {
+  GnomeDdcApplication *app;
+  guint64 id;
+  /* -1 until read from the display */
+  gint value;
+  guint16 max_value;
+  /* Steps that arrived while the first read was in flight */
+  gint pending_percent;
+  gboolean reading;
+  guint writes_in_flight;
+  /* Tells a state apart from an earlier one for the same display */
+  guint generation;
+} BrightnessState;
+
 struct _GnomeDdcApplication {
   AdwApplication parent_instance;
+
+  /* Set when started with --daemon or by D-Bus activation: the
+   * application holds itself and keeps the client, the display list and
+   * the caches warm for actions such as app.brightness-step. */
+  gboolean resident;
+  gboolean skip_activate;
+
+  /* One of each per process, shared by every window and action, so each
+   * Detect, cache entry and queued write exists once. */
+  GnomeDdcClient *client;
+  GnomeDdcDisplayModel *displays;
+  GnomeDdcWriteCoalescer *write_coalescer;
+  GnomeDdcCapabilitiesCache *capabilities_cache;
+  GnomeDdcProfileStore *profile_store;
+  GnomeDdcGroupStore *group_store;
+  GnomeDdcStateSnapshot *state_snapshot;
+  /* display id -> BrightnessState */
+  GHashTable *brightness;
+  guint brightness_generation;
+  /* (si) steps received before the display list was known */
+  GPtrArray *queued_steps;
 };
 
 G_DEFINE_FINAL_TYPE(GnomeDdcApplication, gnome_ddc_application, ADW_TYPE_APPLICATION)
 
+/* Brightness reads and writes only carry the display id and the state's
+ * generation, as the state they belong to is dropped when its display goes
+ * away and may have been created anew by the time they finish. */
+typedef struct {
+  GnomeDdcApplication *self;
+  guint64 id;
+  guint generation;
+} BrightnessCall;
+
+static BrightnessCall *
+brightness_call_new(GnomeDdcApplication *self, BrightnessState *state)
+{
+  BrightnessCall *call = g_new(BrightnessCall, 1);
+  call->self = g_object_ref(self);
+  call->id = state->id;
+  call->generation = state->generation;
+  return call;
+}
+
+static void
+brightness_call_free(BrightnessCall *call)
+{
+  g_object_unref(call->self);
+  g_free(call);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(BrightnessCall, brightness_call_free)
+
+/* The state @call was made for, or NULL if it has been dropped since. */
+static BrightnessState *
+brightness_call_get_state(BrightnessCall *call)
+{
+  if (call->self->brightness == NULL) {
+    return NULL;
+  }
+  BrightnessState *state = g_hash_table_lookup(call->self->brightness, &call->id);
+  return state != NULL && state->generation == call->generation ? state : NULL;
+}
+
 static void
 ensure_resources_registered(void)
 {
@@ -23,9 +104,430 @@ ensure_resources_registered(void)
   }
 }
 
+static void
+brightness_state_free(BrightnessState *state)
+{
+  g_free(state);
+}
+
+static BrightnessState *
+brightness_state_ref_or_new(GnomeDdcApplication *self, GnomeDdcDisplay *display)
+{
+  guint64 id = gnomeddc_display_get_id(display);
+  BrightnessState *state = g_hash_table_lookup(self->brightness, &id);
+
+  if (state == NULL) {
+    state = g_new0(BrightnessState, 1);
+    state->app = self;
+    state->id = id;
+    state->value = -1;
+    state->generation = ++self->brightness_generation;
+    g_hash_table_insert(self->brightness, &state->id, state);
+  }
+  return state;
+}
+
+static void
+brightness_write_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(BrightnessCall) call = user_data;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_write_coalescer_set_vcp_finish(GNOMEDDC_WRITE_COALESCER(source),
+                                                                         result, &error);
+  gint status = 0;
+  if (response != NULL) {
+    g_variant_get(response, "(i&s)", &status, NULL);
+  }
+
+  BrightnessState *state = brightness_call_get_state(call);
+  if (state == NULL) {
+    return;
+  }
+  state->writes_in_flight--;
+
+  /* A superseded value is fine; anything else means the display may not
+   * be where we think, so read it again next time. */
+  if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED) && (error != NULL || status != 0)) {
+    g_warning("Brightness change failed: %s", error != NULL ? error->message : "service error");
+    state->value = -1;
+  }
+}
+
+static void
+brightness_apply_step(BrightnessState *state, GnomeDdcDisplay *display, gint percent)
+{
+  GnomeDdcApplication *self = state->app;
+  gint step = percent * state->max_value / 100;
+  if (step == 0 && percent != 0) {
+    step = percent > 0 ? 1 : -1;
+  }
+
+  gint target = CLAMP(state->value + step, 0, (gint) state->max_value);
+  if (target == state->value) {
+    return;
+  }
+
+  /* Held keys repeat faster than the bus; the coalescer only keeps the
+   * newest target. */
+  state->value = target;
+  state->writes_in_flight++;
+  gnomeddc_write_coalescer_set_vcp_async(self->write_coalescer,
+                                         gnomeddc_display_get_display_number(display),
+                                         gnomeddc_display_get_edid(display),
+                                         VCP_BRIGHTNESS,
+                                         (guint16) target,
+                                         NULL,
+                                         0,
+                                         NULL,
+                                         brightness_write_cb,
+                                         brightness_call_new(self, state));
+}
+
+static void
+brightness_read_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(BrightnessCall) call = user_data;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(GNOMEDDC_CLIENT(source), result, &error);
+
+  BrightnessState *state = brightness_call_get_state(call);
+  if (state == NULL) {
+    return;
+  }
+  state->reading = FALSE;
+
+  guint16 current = 0;
+  guint16 max_value = 0;
+  gint status = -1;
+  if (response != NULL) {
+    g_variant_get(response, "(qq&si&s)", &current, &max_value, NULL, &status, NULL);
+  }
+  if (status != 0 || max_value == 0) {
+    g_warning("Unable to read the brightness: %s", error != NULL ? error->message : "service error");
+    state->pending_percent = 0;
+    return;
+  }
+
+  state->value = current;
+  state->max_value = max_value;
+
+  GnomeDdcDisplay *display = call->self->displays != NULL ? gnomeddc_display_model_find(call->self->displays, call->id) : NULL;
+  gint percent = state->pending_percent;
+  state->pending_percent = 0;
+  if (display != NULL && percent != 0) {
+    brightness_apply_step(state, display, percent);
+  }
+}
+
+static void
+brightness_step_display(GnomeDdcApplication *self, GnomeDdcDisplay *display, gint percent)
+{
+  BrightnessState *state = brightness_state_ref_or_new(self, display);
+
+  if (state->value >= 0) {
+    brightness_apply_step(state, display, percent);
+    return;
+  }
+
+  state->pending_percent += percent;
+  if (!state->reading) {
+    state->reading = TRUE;
+    gnomeddc_client_get_vcp_async(self->client,
+                                  display,
+                                  VCP_BRIGHTNESS,
+                                  0,
+                                  GNOMEDDC_CALL_FLAGS_NONE,
+                                  NULL,
+                                  brightness_read_cb,
+                                  brightness_call_new(self, state));
+  }
+}
+
+/* An empty selector means every display; otherwise it is a display number
+ * or the start of an EDID. */
+static gboolean
+display_matches(GnomeDdcDisplay *display, const gchar *selector)
+{
+  if (selector[0] == '\0') {
+    return TRUE;
+  }
+
+  gchar *end = NULL;
+  gint64 number = g_ascii_strtoll(selector, &end, 10);
+  if (end != selector && *end == '\0') {
+    return gnomeddc_display_get_display_number(display) == number;
+  }
+
+  const gchar *edid = gnomeddc_display_get_edid(display);
+  return g_ascii_strncasecmp(edid, selector, strlen(selector)) == 0;
+}
+
+static void
+run_brightness_step(GnomeDdcApplication *self, GVariant *parameter)
+{
+  const gchar *selector;
+  gint percent;
+  g_variant_get(parameter, "(&si)", &selector, &percent);
+
+  GListModel *model = G_LIST_MODEL(self->displays);
+  guint n_items = g_list_model_get_n_items(model);
+  for (guint i = 0; i < n_items; i++) {
+    g_autoptr(GnomeDdcDisplay) display = g_list_model_get_item(model, i);
+    if (display_matches(display, selector)) {
+      brightness_step_display(self, display, percent);
+    }
+  }
+}
+
+static void
+brightness_step_activated(GSimpleAction *action G_GNUC_UNUSED,
+                          GVariant *parameter,
+                          gpointer user_data)
+{
+  GnomeDdcApplication *self = GNOMEDDC_APPLICATION(user_data);
+
+  if (!gnomeddc_display_model_is_ready(self->displays)) {
+    g_ptr_array_add(self->queued_steps, g_variant_ref(parameter));
+    return;
+  }
+  run_brightness_step(self, parameter);
+}
+
+/* Drops the stored values of displays that went away. Displays that stay,
+ * including those a reconcile replaced with a new object, keep theirs along
+ * with the count of writes still in flight. */
+static void
+displays_changed_cb(GListModel *model G_GNUC_UNUSED,
+                    guint position G_GNUC_UNUSED,
+                    guint removed,
+                    guint added G_GNUC_UNUSED,
+                    gpointer user_data)
+{
+  GnomeDdcApplication *self = GNOMEDDC_APPLICATION(user_data);
+
+  if (removed == 0) {
+    return;
+  }
+
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init(&iter, self->brightness);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    BrightnessState *state = value;
+    if (gnomeddc_display_model_find(self->displays, state->id) == NULL) {
+      g_hash_table_iter_remove(&iter);
+    }
+  }
+}
+
+/* The display a service signal names, by EDID or, for displays without
+ * one, by number. The model keeps it alive. */
+static GnomeDdcDisplay *
+find_signalled_display(GnomeDdcApplication *self, gint display_number, const gchar *edid)
+{
+  if (edid != NULL && *edid != '\0') {
+    GnomeDdcDisplay *display = gnomeddc_display_model_find(self->displays, gnomeddc_display_id_for_edid(edid));
+    return display != NULL && g_str_equal(gnomeddc_display_get_edid(display), edid) ? display : NULL;
+  }
+
+  GListModel *model = G_LIST_MODEL(self->displays);
+  guint n_items = g_list_model_get_n_items(model);
+  for (guint i = 0; i < n_items; i++) {
+    g_autoptr(GnomeDdcDisplay) display = g_list_model_get_item(model, i);
+    if (*gnomeddc_display_get_edid(display) == '\0' &&
+        gnomeddc_display_get_display_number(display) == display_number) {
+      return display;
+    }
+  }
+  return NULL;
+}
+
+static void
+displays_refreshed_cb(GnomeDdcDisplayModel *model G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcApplication *self = GNOMEDDC_APPLICATION(user_data);
+
+  g_autoptr(GPtrArray) queued = g_steal_pointer(&self->queued_steps);
+  self->queued_steps = g_ptr_array_new_with_free_func((GDestroyNotify) g_variant_unref);
+  for (guint i = 0; i < queued->len; i++) {
+    run_brightness_step(self, g_ptr_array_index(queued, i));
+  }
+}
+
+/* Keeps the stored brightness in step with changes made elsewhere. Our own
+ * writes are skipped while they are in flight, since a late signal for an
+ * older step would undo the newer ones. */
+static void
+client_vcp_value_changed_cb(GnomeDdcClient *client G_GNUC_UNUSED,
+                            gint display_number,
+                            const gchar *edid,
+                            guint code,
+                            guint value,
+                            const gchar *source_client_name G_GNUC_UNUSED,
+                            const gchar *source_client_context G_GNUC_UNUSED,
+                            guint flags G_GNUC_UNUSED,
+                            gpointer user_data)
+{
+  GnomeDdcApplication *self = GNOMEDDC_APPLICATION(user_data);
+
+  if (code != VCP_BRIGHTNESS) {
+    return;
+  }
+  GnomeDdcDisplay *display = find_signalled_display(self, display_number, edid);
+  if (display == NULL) {
+    return;
+  }
+  guint64 id = gnomeddc_display_get_id(display);
+  BrightnessState *state = g_hash_table_lookup(self->brightness, &id);
+  if (state != NULL && state->writes_in_flight == 0 && state->value >= 0) {
+    state->value = MIN((gint) value, (gint) state->max_value);
+  }
+}
+
+/* Paints the state saved by the previous run. The live ListDetected reply
+ * and the proxy's properties are reconciled against it, so displays that
+ * are still present keep their rows and the selection. */
+static void
+restore_state_snapshot(GnomeDdcApplication *self)
+{
+  if (!gnomeddc_state_snapshot_load(self->state_snapshot)) {
+    return;
+  }
+
+  GVariant *properties = gnomeddc_state_snapshot_get_properties(self->state_snapshot);
+  if (properties != NULL) {
+    gnomeddc_service_properties_load_dict(gnomeddc_client_get_service_properties(self->client), properties);
+  }
+
+  GVariant *array = gnomeddc_state_snapshot_get_displays(self->state_snapshot);
+  if (array == NULL || g_variant_n_children(array) == 0) {
+    return;
+  }
+
+  /* Only used for the few entries of the snapshot; live replies are
+   * decoded by the display model. */
+  g_autoptr(GPtrArray) displays = g_ptr_array_new_full(g_variant_n_children(array), g_object_unref);
+  GVariantIter iter;
+  GVariant *entry;
+  g_variant_iter_init(&iter, array);
+  while ((entry = g_variant_iter_next_value(&iter)) != NULL) {
+    g_ptr_array_add(displays, gnomeddc_display_new_from_variant(entry));
+    g_variant_unref(entry);
+  }
+  gnomeddc_display_model_apply(self->displays, displays);
+}
+
+static void
+save_state_snapshot(GnomeDdcApplication *self)
+{
+  GListModel *model = G_LIST_MODEL(self->displays);
+  guint n_items = g_list_model_get_n_items(model);
+  g_autoptr(GVariantBuilder) builder = g_variant_builder_new(G_VARIANT_TYPE("a" GNOMEDDC_DISPLAY_ENTRY_TYPE));
+
+  for (guint i = 0; i < n_items; i++) {
+    g_autoptr(GnomeDdcDisplay) display = g_list_model_get_item(model, i);
+    g_variant_builder_add_value(builder, gnomeddc_display_get_entry(display));
+  }
+  gnomeddc_state_snapshot_set_displays(self->state_snapshot, g_variant_builder_end(builder));
+  gnomeddc_state_snapshot_set_properties(self->state_snapshot,
+                                         gnomeddc_service_properties_dup_dict(gnomeddc_client_get_service_properties(self->client)));
+
+  g_autoptr(GError) error = NULL;
+  if (!gnomeddc_state_snapshot_save(self->state_snapshot, &error)) {
+    g_warning("Unable to save window state: %s", error->message);
+  }
+}
+
+static void
+start_shared_state(GnomeDdcApplication *self)
+{
+  self->client = gnomeddc_client_new();
+  self->displays = gnomeddc_display_model_new(self->client);
+  self->write_coalescer = gnomeddc_write_coalescer_new(self->client);
+  self->capabilities_cache = gnomeddc_capabilities_cache_new();
+  self->profile_store = gnomeddc_profile_store_new();
+  self->group_store = gnomeddc_group_store_new();
+  self->state_snapshot = gnomeddc_state_snapshot_new();
+  restore_state_snapshot(self);
+  g_signal_connect(self->client, "vcp-value-changed", G_CALLBACK(client_vcp_value_changed_cb), self);
+  g_signal_connect(self->displays, "items-changed", G_CALLBACK(displays_changed_cb), self);
+  g_signal_connect(self->displays, "refreshed", G_CALLBACK(displays_refreshed_cb), self);
+}
+
+static const GActionEntry app_actions[] = {
+  /* (selector, percent): see display_matches() */
+  { "brightness-step", brightness_step_activated, "(si)", NULL, NULL, { 0 } },
+};
+
+static gint
+gnome_ddc_application_handle_local_options(GApplication *app, GVariantDict *options)
+{
+  GnomeDdcApplication *self = GNOMEDDC_APPLICATION(app);
+
+  if (!g_variant_dict_contains(options, "daemon")) {
+    return -1;
+  }
+
+  g_autoptr(GError) error = NULL;
+  if (!g_application_register(app, NULL, &error)) {
+    g_printerr("gnomeddc: %s\n", error->message);
+    return 1;
+  }
+  /* An instance is already running; resident or not, it owns the
+   * actions, so there is nothing left to do here. */
+  if (g_application_get_is_remote(app)) {
+    return 0;
+  }
+
+  self->resident = TRUE;
+  self->skip_activate = TRUE;
+  g_application_hold(app);
+  return -1;
+}
+
+static void
+gnome_ddc_application_startup(GApplication *app)
+{
+  GnomeDdcApplication *self = GNOMEDDC_APPLICATION(app);
+
+  G_APPLICATION_CLASS(gnome_ddc_application_parent_class)->startup(app);
+
+  /* Only the primary instance gets here, so remote invocations never
+   * connect to the service themselves. */
+  start_shared_state(self);
+
+  /* D-Bus activation starts us with --gapplication-service; stay around
+   * like --daemon instead of exiting after the inactivity timeout. */
+  if (!self->resident && (g_application_get_flags(app) & G_APPLICATION_IS_SERVICE)) {
+    self->resident = TRUE;
+    g_application_hold(app);
+  }
+}
+
+/* The snapshot is written once, when the primary instance exits, no
+ * matter how many windows it had open. */
+static void
+gnome_ddc_application_shutdown(GApplication *app)
+{
+  GnomeDdcApplication *self = GNOMEDDC_APPLICATION(app);
+
+  if (self->state_snapshot != NULL) {
+    save_state_snapshot(self);
+  }
+
+  G_APPLICATION_CLASS(gnome_ddc_application_parent_class)->shutdown(app);
+}
+
 static void
 gnome_ddc_application_activate(GApplication *app)
 {
+  GnomeDdcApplication *self = GNOMEDDC_APPLICATION(app);
+
+  if (self->skip_activate) {
+    self->skip_activate = FALSE;
+    return;
+  }
+
   ensure_resources_registered();
 
   GList *windows = gtk_application_get_windows(GTK_APPLICATION(app));
@@ -34,16 +536,43 @@ gnome_ddc_application_activate(GApplication *app)
     return;
   }
 
-  GnomeDdcWindow *window = g_object_new(GNOMEDDC_TYPE_WINDOW,
-                                        "application", app,
-                                        NULL);
+  GnomeDdcWindow *window = gnomeddc_window_new(self);
   gtk_window_present(GTK_WINDOW(window));
 }
 
+static void
+gnome_ddc_application_dispose(GObject *object)
+{
+  GnomeDdcApplication *self = GNOMEDDC_APPLICATION(object);
+
+  if (self->client != NULL) {
+    g_signal_handlers_disconnect_by_data(self->client, self);
+  }
+  if (self->displays != NULL) {
+    g_signal_handlers_disconnect_by_data(self->displays, self);
+  }
+  g_clear_object(&self->state_snapshot);
+  g_clear_object(&self->group_store);
+  g_clear_object(&self->profile_store);
+  g_clear_object(&self->capabilities_cache);
+  g_clear_object(&self->write_coalescer);
+  g_clear_object(&self->displays);
+  g_clear_object(&self->client);
+  g_clear_pointer(&self->brightness, g_hash_table_unref);
+  g_clear_pointer(&self->queued_steps, g_ptr_array_unref);
+
+  G_OBJECT_CLASS(gnome_ddc_application_parent_class)->dispose(object);
+}
+
 static void
 gnome_ddc_application_class_init(GnomeDdcApplicationClass *klass)
 {
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
   GApplicationClass *app_class = G_APPLICATION_CLASS(klass);
+  object_class->dispose = gnome_ddc_application_dispose;
+  app_class->handle_local_options = gnome_ddc_application_handle_local_options;
+  app_class->startup = gnome_ddc_application_startup;
+  app_class->shutdown = gnome_ddc_application_shutdown;
   app_class->activate = gnome_ddc_application_activate;
 }
 
@@ -51,6 +580,17 @@ static void
 gnome_ddc_application_init(GnomeDdcApplication *self)
 {
   g_application_set_resource_base_path(G_APPLICATION(self), "/com/ddcutil/GnomeDDC");
+
+  self->brightness = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, (GDestroyNotify) brightness_state_free);
+  self->queued_steps = g_ptr_array_new_with_free_func((GDestroyNotify) g_variant_unref);
+  g_action_map_add_action_entries(G_ACTION_MAP(self), app_actions, G_N_ELEMENTS(app_actions), self);
+
+  const GOptionEntry options[] = {
+    { "daemon", 0, 0, G_OPTION_ARG_NONE, NULL,
+      "Stay in the background without a window and serve app.brightness-step", NULL },
+    { NULL }
+  };
+  g_application_add_main_option_entries(G_APPLICATION(self), options);
 }
 
 GnomeDdcApplication *
@@ -61,3 +601,45 @@ gnome_ddc_application_new(void)
                       "flags", G_APPLICATION_HANDLES_OPEN,
                       NULL);
 }
+
+GnomeDdcClient *
+gnome_ddc_application_get_client(GnomeDdcApplication *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_APPLICATION(self), NULL);
+  return self->client;
+}
+
+GnomeDdcDisplayModel *
+gnome_ddc_application_get_display_model(GnomeDdcApplication *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_APPLICATION(self), NULL);
+  return self->displays;
+}
+
+GnomeDdcWriteCoalescer *
+gnome_ddc_application_get_write_coalescer(GnomeDdcApplication *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_APPLICATION(self), NULL);
+  return self->write_coalescer;
+}
+
+GnomeDdcCapabilitiesCache *
+gnome_ddc_application_get_capabilities_cache(GnomeDdcApplication *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_APPLICATION(self), NULL);
+  return self->capabilities_cache;
+}
+
+GnomeDdcProfileStore *
+gnome_ddc_application_get_profile_store(GnomeDdcApplication *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_APPLICATION(self), NULL);
+  return self->profile_store;
+}
+
+GnomeDdcGroupStore *
+gnome_ddc_application_get_group_store(GnomeDdcApplication *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_APPLICATION(self), NULL);
+  return self->group_store;
+}
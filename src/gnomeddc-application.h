@@ -3,6 +3,13 @@
 
 #include <adwaita.h>
 
+#include "gnomeddc-capabilities-cache.h"
+#include "gnomeddc-client.h"
+#include "gnomeddc-display-model.h"
+#include "gnomeddc-group-store.h"
+#include "gnomeddc-profile-store.h"
+#include "gnomeddc-write-coalescer.h"
+
 G_BEGIN_DECLS
 
 #define GNOMEDDC_TYPE_APPLICATION (gnome_ddc_application_get_type())
@@ -11,6 +18,13 @@ G_DECLARE_FINAL_TYPE(GnomeDdcApplication, gnome_ddc_application, GNOMEDDC, APPLI
 
 GnomeDdcApplication *gnome_ddc_application_new(void);
 
+GnomeDdcClient *gnome_ddc_application_get_client(GnomeDdcApplication *self);
+GnomeDdcDisplayModel *gnome_ddc_application_get_display_model(GnomeDdcApplication *self);
+GnomeDdcWriteCoalescer *gnome_ddc_application_get_write_coalescer(GnomeDdcApplication *self);
+GnomeDdcCapabilitiesCache *gnome_ddc_application_get_capabilities_cache(GnomeDdcApplication *self);
+GnomeDdcProfileStore *gnome_ddc_application_get_profile_store(GnomeDdcApplication *self);
+GnomeDdcGroupStore *gnome_ddc_application_get_group_store(GnomeDdcApplication *self);
+
 G_END_DECLS
 
 #endif /* GNOMEDDC_APPLICATION_H */
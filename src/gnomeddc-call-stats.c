@@ -0,0 +1,360 @@
+#include "gnomeddc-call-stats.h"
+
+#include "gnomeddc-json.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Per-method counters for calls into ddcutil-service. Latencies go into a
+ * log-linear histogram (four buckets per power of two, so percentiles are
+ * within ~19% of the real value) which keeps recording O(1) and the memory
+ * per method fixed no matter how many calls are made.
+ */
+
+#define BUCKETS_PER_OCTAVE 4
+#define N_BUCKETS (BUCKETS_PER_OCTAVE * 32)
+
+typedef struct {
+  guint64 calls;
+  guint in_flight;
+  guint64 errors;
+  guint64 cache_hits;
+  guint64 retries;
+  gint64 total_usec;
+  gint64 max_usec;
+  guint64 buckets[N_BUCKETS];
+  /* ddcutil status code from the (…is) reply tail → count */
+  GHashTable *status_counts;
+} MethodStats;
+
+struct _GnomeDdcCallStats {
+  GObject parent_instance;
+
+  GHashTable *methods;
+};
+
+G_DEFINE_FINAL_TYPE(GnomeDdcCallStats, gnomeddc_call_stats, G_TYPE_OBJECT)
+
+static void
+method_stats_free(MethodStats *stats)
+{
+  g_clear_pointer(&stats->status_counts, g_hash_table_unref);
+  g_free(stats);
+}
+
+static MethodStats *
+ensure_method(GnomeDdcCallStats *self, const gchar *method)
+{
+  MethodStats *stats = g_hash_table_lookup(self->methods, method);
+  if (stats == NULL) {
+    stats = g_new0(MethodStats, 1);
+    stats->status_counts = g_hash_table_new(g_direct_hash, g_direct_equal);
+    g_hash_table_insert(self->methods, g_strdup(method), stats);
+  }
+  return stats;
+}
+
+static guint
+bucket_for_usec(gint64 usec)
+{
+  if (usec < 1) {
+    return 0;
+  }
+
+  /* Octave from the highest set bit, sub-bucket from the next two bits. */
+  guint octave = g_bit_storage((gulong) usec) - 1;
+  guint sub = 0;
+  if (octave >= 2) {
+    sub = (guint) ((usec >> (octave - 2)) & (BUCKETS_PER_OCTAVE - 1));
+  } else {
+    sub = (guint) ((usec << (2 - octave)) & (BUCKETS_PER_OCTAVE - 1));
+  }
+  return MIN(octave * BUCKETS_PER_OCTAVE + sub, N_BUCKETS - 1);
+}
+
+/* Upper bound of a bucket, in microseconds. */
+static gint64
+bucket_limit(guint bucket)
+{
+  guint octave = bucket / BUCKETS_PER_OCTAVE;
+  guint sub = bucket % BUCKETS_PER_OCTAVE;
+  gint64 base = (gint64) 1 << octave;
+  return base + (base * (sub + 1)) / BUCKETS_PER_OCTAVE;
+}
+
+static gint64
+percentile(const MethodStats *stats, guint64 samples, guint permille)
+{
+  if (samples == 0) {
+    return 0;
+  }
+
+  guint64 rank = MAX((samples * permille + 999) / 1000, 1);
+  guint64 seen = 0;
+  for (guint i = 0; i < N_BUCKETS; i++) {
+    seen += stats->buckets[i];
+    if (seen >= rank) {
+      return MIN(bucket_limit(i), stats->max_usec);
+    }
+  }
+  return stats->max_usec;
+}
+
+static void
+gnomeddc_call_stats_finalize(GObject *object)
+{
+  GnomeDdcCallStats *self = GNOMEDDC_CALL_STATS(object);
+  g_clear_pointer(&self->methods, g_hash_table_unref);
+  G_OBJECT_CLASS(gnomeddc_call_stats_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_call_stats_class_init(GnomeDdcCallStatsClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_call_stats_finalize;
+}
+
+static void
+gnomeddc_call_stats_init(GnomeDdcCallStats *self)
+{
+  self->methods = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) method_stats_free);
+}
+
+GnomeDdcCallStats *
+gnomeddc_call_stats_new(void)
+{
+  return g_object_new(GNOMEDDC_TYPE_CALL_STATS, NULL);
+}
+
+/* Marks a call as in flight; pass the returned timestamp to
+ * gnomeddc_call_stats_end() once it completes. */
+gint64
+gnomeddc_call_stats_begin(GnomeDdcCallStats *self, const gchar *method)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CALL_STATS(self), 0);
+  g_return_val_if_fail(method != NULL, 0);
+
+  ensure_method(self, method)->in_flight++;
+  return g_get_monotonic_time();
+}
+
+void
+gnomeddc_call_stats_end(GnomeDdcCallStats *self,
+                        const gchar *method,
+                        gint64 start_time,
+                        GVariant *response,
+                        const GError *error)
+{
+  g_return_if_fail(GNOMEDDC_IS_CALL_STATS(self));
+  g_return_if_fail(method != NULL);
+
+  MethodStats *stats = ensure_method(self, method);
+  gint64 elapsed = MAX(g_get_monotonic_time() - start_time, 0);
+
+  if (stats->in_flight > 0) {
+    stats->in_flight--;
+  }
+  stats->calls++;
+  stats->total_usec += elapsed;
+  stats->max_usec = MAX(stats->max_usec, elapsed);
+  stats->buckets[bucket_for_usec(elapsed)]++;
+
+  if (error != NULL || response == NULL) {
+    stats->errors++;
+    return;
+  }
+
+  /* Most service methods end their reply with (…, status, message). */
+  gsize n_children = g_variant_is_container(response) ? g_variant_n_children(response) : 0;
+  if (n_children >= 2) {
+    g_autoptr(GVariant) status = g_variant_get_child_value(response, n_children - 2);
+    g_autoptr(GVariant) message = g_variant_get_child_value(response, n_children - 1);
+    if (g_variant_is_of_type(status, G_VARIANT_TYPE_INT32) &&
+        g_variant_is_of_type(message, G_VARIANT_TYPE_STRING)) {
+      gpointer code = GINT_TO_POINTER(g_variant_get_int32(status));
+      guint count = GPOINTER_TO_UINT(g_hash_table_lookup(stats->status_counts, code));
+      g_hash_table_insert(stats->status_counts, code, GUINT_TO_POINTER(count + 1));
+    }
+  }
+}
+
+void
+gnomeddc_call_stats_record_cache_hit(GnomeDdcCallStats *self, const gchar *method)
+{
+  g_return_if_fail(GNOMEDDC_IS_CALL_STATS(self));
+  g_return_if_fail(method != NULL);
+
+  ensure_method(self, method)->cache_hits++;
+}
+
+/* Counts a call the client sent again after a transient failure; the
+ * attempts themselves are recorded as ordinary calls. */
+void
+gnomeddc_call_stats_record_retry(GnomeDdcCallStats *self, const gchar *method)
+{
+  g_return_if_fail(GNOMEDDC_IS_CALL_STATS(self));
+  g_return_if_fail(method != NULL);
+
+  ensure_method(self, method)->retries++;
+}
+
+/* Clears every counter except the in-flight ones, which still have calls
+ * outstanding that will end later. */
+void
+gnomeddc_call_stats_reset(GnomeDdcCallStats *self)
+{
+  g_return_if_fail(GNOMEDDC_IS_CALL_STATS(self));
+
+  GHashTableIter iter;
+  gpointer value;
+  g_hash_table_iter_init(&iter, self->methods);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    MethodStats *stats = value;
+    guint in_flight = stats->in_flight;
+    GHashTable *status_counts = stats->status_counts;
+
+    g_hash_table_remove_all(status_counts);
+    memset(stats, 0, sizeof(*stats));
+    stats->in_flight = in_flight;
+    stats->status_counts = status_counts;
+  }
+}
+
+static gint
+compare_method_names(gconstpointer a, gconstpointer b)
+{
+  return g_strcmp0(*(const gchar * const *) a, *(const gchar * const *) b);
+}
+
+/* Sorted method names that have been seen so far. */
+GStrv
+gnomeddc_call_stats_dup_methods(GnomeDdcCallStats *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CALL_STATS(self), NULL);
+
+  guint n_methods = 0;
+  gchar **methods = (gchar **) g_hash_table_get_keys_as_array(self->methods, &n_methods);
+  for (guint i = 0; i < n_methods; i++) {
+    methods[i] = g_strdup(methods[i]);
+  }
+  qsort(methods, n_methods, sizeof(gchar *), compare_method_names);
+  return methods;
+}
+
+gboolean
+gnomeddc_call_stats_get_summary(GnomeDdcCallStats *self,
+                                const gchar *method,
+                                GnomeDdcCallSummary *summary)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CALL_STATS(self), FALSE);
+  g_return_val_if_fail(method != NULL, FALSE);
+  g_return_val_if_fail(summary != NULL, FALSE);
+
+  const MethodStats *stats = g_hash_table_lookup(self->methods, method);
+  if (stats == NULL) {
+    return FALSE;
+  }
+
+  summary->calls = stats->calls;
+  summary->in_flight = stats->in_flight;
+  summary->errors = stats->errors;
+  summary->cache_hits = stats->cache_hits;
+  summary->retries = stats->retries;
+  summary->p50_usec = percentile(stats, stats->calls, 500);
+  summary->p95_usec = percentile(stats, stats->calls, 950);
+  summary->p99_usec = percentile(stats, stats->calls, 990);
+  summary->max_usec = stats->max_usec;
+  summary->mean_usec = stats->calls > 0 ? stats->total_usec / (gint64) stats->calls : 0;
+  return TRUE;
+}
+
+static gint
+compare_status_codes(gconstpointer a, gconstpointer b)
+{
+  gint code_a = GPOINTER_TO_INT(*(gconstpointer *) a);
+  gint code_b = GPOINTER_TO_INT(*(gconstpointer *) b);
+  return (code_a > code_b) - (code_a < code_b);
+}
+
+/* a{iu}: ddcutil status code → number of replies that carried it. */
+GVariant *
+gnomeddc_call_stats_dup_status_counts(GnomeDdcCallStats *self, const gchar *method)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CALL_STATS(self), NULL);
+  g_return_val_if_fail(method != NULL, NULL);
+
+  GVariantBuilder builder;
+  g_variant_builder_init(&builder, G_VARIANT_TYPE("a{iu}"));
+
+  const MethodStats *stats = g_hash_table_lookup(self->methods, method);
+  if (stats != NULL) {
+    guint n_codes = 0;
+    gpointer *codes = g_hash_table_get_keys_as_array(stats->status_counts, &n_codes);
+    qsort(codes, n_codes, sizeof(gpointer), compare_status_codes);
+    for (guint i = 0; i < n_codes; i++) {
+      g_variant_builder_add(&builder, "{iu}",
+                            GPOINTER_TO_INT(codes[i]),
+                            GPOINTER_TO_UINT(g_hash_table_lookup(stats->status_counts, codes[i])));
+    }
+    g_free(codes);
+  }
+  return g_variant_ref_sink(g_variant_builder_end(&builder));
+}
+
+gchar *
+gnomeddc_call_stats_to_json(GnomeDdcCallStats *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CALL_STATS(self), NULL);
+
+  g_auto(GStrv) methods = gnomeddc_call_stats_dup_methods(self);
+  GString *json = g_string_new("{\n  \"methods\": {");
+
+  for (guint i = 0; methods[i] != NULL; i++) {
+    GnomeDdcCallSummary summary;
+    gnomeddc_call_stats_get_summary(self, methods[i], &summary);
+
+    g_string_append(json, i > 0 ? ",\n    " : "\n    ");
+    gnomeddc_json_append_string(json, methods[i]);
+    g_string_append_printf(json,
+                           ": {\n"
+                           "      \"calls\": %" G_GUINT64_FORMAT ",\n"
+                           "      \"in_flight\": %u,\n"
+                           "      \"errors\": %" G_GUINT64_FORMAT ",\n"
+                           "      \"cache_hits\": %" G_GUINT64_FORMAT ",\n"
+                           "      \"retries\": %" G_GUINT64_FORMAT ",\n"
+                           "      \"latency_usec\": {"
+                           "\"p50\": %" G_GINT64_FORMAT ", "
+                           "\"p95\": %" G_GINT64_FORMAT ", "
+                           "\"p99\": %" G_GINT64_FORMAT ", "
+                           "\"max\": %" G_GINT64_FORMAT ", "
+                           "\"mean\": %" G_GINT64_FORMAT "},\n"
+                           "      \"status\": {",
+                           summary.calls,
+                           summary.in_flight,
+                           summary.errors,
+                           summary.cache_hits,
+                           summary.retries,
+                           summary.p50_usec,
+                           summary.p95_usec,
+                           summary.p99_usec,
+                           summary.max_usec,
+                           summary.mean_usec);
+
+    g_autoptr(GVariant) status_counts = gnomeddc_call_stats_dup_status_counts(self, methods[i]);
+    GVariantIter iter;
+    gint code;
+    guint count;
+    gboolean first = TRUE;
+    g_variant_iter_init(&iter, status_counts);
+    while (g_variant_iter_next(&iter, "{iu}", &code, &count)) {
+      g_string_append_printf(json, "%s\"%d\": %u", first ? "" : ", ", code, count);
+      first = FALSE;
+    }
+    g_string_append(json, "}\n    }");
+  }
+
+  g_string_append(json, methods[0] != NULL ? "\n  }\n}\n" : "}\n}\n");
+  return g_string_free(json, FALSE);
+}
@@ -0,0 +1,50 @@
+#ifndef GNOMEDDC_CALL_STATS_H
+#define GNOMEDDC_CALL_STATS_H
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_CALL_STATS (gnomeddc_call_stats_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcCallStats, gnomeddc_call_stats, GNOMEDDC, CALL_STATS, GObject)
+
+typedef struct {
+  guint64 calls;
+  guint in_flight;
+  guint64 errors;
+  guint64 cache_hits;
+  guint64 retries;
+  gint64 p50_usec;
+  gint64 p95_usec;
+  gint64 p99_usec;
+  gint64 max_usec;
+  gint64 mean_usec;
+} GnomeDdcCallSummary;
+
+GnomeDdcCallStats *gnomeddc_call_stats_new(void);
+
+gint64 gnomeddc_call_stats_begin(GnomeDdcCallStats *self,
+                                 const gchar *method);
+void gnomeddc_call_stats_end(GnomeDdcCallStats *self,
+                             const gchar *method,
+                             gint64 start_time,
+                             GVariant *response,
+                             const GError *error);
+void gnomeddc_call_stats_record_cache_hit(GnomeDdcCallStats *self,
+                                          const gchar *method);
+void gnomeddc_call_stats_record_retry(GnomeDdcCallStats *self,
+                                      const gchar *method);
+void gnomeddc_call_stats_reset(GnomeDdcCallStats *self);
+
+GStrv gnomeddc_call_stats_dup_methods(GnomeDdcCallStats *self);
+gboolean gnomeddc_call_stats_get_summary(GnomeDdcCallStats *self,
+                                         const gchar *method,
+                                         GnomeDdcCallSummary *summary);
+GVariant *gnomeddc_call_stats_dup_status_counts(GnomeDdcCallStats *self,
+                                                const gchar *method);
+gchar *gnomeddc_call_stats_to_json(GnomeDdcCallStats *self);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_CALL_STATS_H */
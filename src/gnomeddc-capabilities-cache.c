@@ -0,0 +1,222 @@
+#include "gnomeddc-capabilities-cache.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+
+/*
+ * One file per EDID, holding a serialized GVariant:
+ *
+ *   (u format, ms capabilities string, m(syya{ys}a{y(ssa{ys})}) metadata)
+ *
+ * Files are written in little-endian byte order, so on the common case the
+ * mapped file is used directly as the variant's backing store.
+ */
+#define CACHE_FORMAT_VERSION 1
+#define CACHE_ENTRY_TYPE "(ums" "m" GNOMEDDC_CAPABILITIES_METADATA_TYPE ")"
+
+struct _GnomeDdcCapabilitiesCache {
+  GObject parent_instance;
+
+  gchar *directory;
+  /* EDID -> loaded entry, or a NULL value for a known miss */
+  GHashTable *entries;
+};
+
+G_DEFINE_FINAL_TYPE(GnomeDdcCapabilitiesCache, gnomeddc_capabilities_cache, G_TYPE_OBJECT)
+
+static void
+entry_unref(gpointer entry)
+{
+  if (entry != NULL) {
+    g_variant_unref(entry);
+  }
+}
+
+static void
+gnomeddc_capabilities_cache_finalize(GObject *object)
+{
+  GnomeDdcCapabilitiesCache *self = GNOMEDDC_CAPABILITIES_CACHE(object);
+  g_clear_pointer(&self->directory, g_free);
+  g_clear_pointer(&self->entries, g_hash_table_unref);
+  G_OBJECT_CLASS(gnomeddc_capabilities_cache_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_capabilities_cache_class_init(GnomeDdcCapabilitiesCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_capabilities_cache_finalize;
+}
+
+static void
+gnomeddc_capabilities_cache_init(GnomeDdcCapabilitiesCache *self)
+{
+  self->entries = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, entry_unref);
+}
+
+GnomeDdcCapabilitiesCache *
+gnomeddc_capabilities_cache_new(void)
+{
+  g_autofree gchar *directory = g_build_filename(g_get_user_cache_dir(), "gnomeddc", NULL);
+  return gnomeddc_capabilities_cache_new_for_directory(directory);
+}
+
+GnomeDdcCapabilitiesCache *
+gnomeddc_capabilities_cache_new_for_directory(const gchar *directory)
+{
+  g_return_val_if_fail(directory != NULL, NULL);
+
+  GnomeDdcCapabilitiesCache *self = g_object_new(GNOMEDDC_TYPE_CAPABILITIES_CACHE, NULL);
+  self->directory = g_strdup(directory);
+  return self;
+}
+
+static gchar *
+entry_path(GnomeDdcCapabilitiesCache *self, const gchar *edid)
+{
+  g_autofree gchar *checksum = g_compute_checksum_for_string(G_CHECKSUM_SHA256, edid, -1);
+  g_autofree gchar *basename = g_strdup_printf("capabilities-%s.gvariant", checksum);
+  return g_build_filename(self->directory, basename, NULL);
+}
+
+static GVariant *
+load_entry(GnomeDdcCapabilitiesCache *self, const gchar *edid)
+{
+  if (edid == NULL || *edid == '\0') {
+    return NULL;
+  }
+
+  gpointer cached = NULL;
+  if (g_hash_table_lookup_extended(self->entries, edid, NULL, &cached)) {
+    return cached;
+  }
+
+  g_autofree gchar *path = entry_path(self, edid);
+  GVariant *entry = NULL;
+  GMappedFile *mapped = g_mapped_file_new(path, FALSE, NULL);
+  if (mapped != NULL) {
+    g_autoptr(GBytes) bytes = g_mapped_file_get_bytes(mapped);
+    g_mapped_file_unref(mapped);
+
+    entry = g_variant_ref_sink(g_variant_new_from_bytes(G_VARIANT_TYPE(CACHE_ENTRY_TYPE), bytes, FALSE));
+    if (G_BYTE_ORDER != G_LITTLE_ENDIAN) {
+      GVariant *swapped = g_variant_byteswap(entry);
+      g_variant_unref(entry);
+      entry = swapped;
+    }
+
+    guint32 version = 0;
+    g_variant_get_child(entry, 0, "u", &version);
+    if (version != CACHE_FORMAT_VERSION) {
+      g_clear_pointer(&entry, g_variant_unref);
+    }
+  }
+
+  g_hash_table_insert(self->entries, g_strdup(edid), entry);
+  return entry;
+}
+
+static void
+save_entry(GnomeDdcCapabilitiesCache *self, const gchar *edid, const gchar *capabilities, GVariant *metadata)
+{
+  g_autoptr(GVariant) entry = g_variant_ref_sink(
+    g_variant_new("(u@ms@m" GNOMEDDC_CAPABILITIES_METADATA_TYPE ")",
+                  CACHE_FORMAT_VERSION,
+                  g_variant_new_maybe(G_VARIANT_TYPE_STRING,
+                                      capabilities != NULL ? g_variant_new_string(capabilities) : NULL),
+                  g_variant_new_maybe(G_VARIANT_TYPE(GNOMEDDC_CAPABILITIES_METADATA_TYPE), metadata)));
+
+  g_hash_table_replace(self->entries, g_strdup(edid), g_variant_ref(entry));
+
+  g_autoptr(GVariant) on_disk = G_BYTE_ORDER == G_LITTLE_ENDIAN
+                                  ? g_variant_get_normal_form(entry)
+                                  : g_variant_byteswap(entry);
+  g_autoptr(GError) error = NULL;
+  g_autofree gchar *path = entry_path(self, edid);
+
+  if (g_mkdir_with_parents(self->directory, 0700) != 0 ||
+      !g_file_set_contents(path,
+                           g_variant_get_data(on_disk),
+                           g_variant_get_size(on_disk),
+                           &error)) {
+    g_warning("Unable to write capabilities cache %s: %s",
+              path, error != NULL ? error->message : g_strerror(errno));
+  }
+}
+
+gchar *
+gnomeddc_capabilities_cache_dup_string(GnomeDdcCapabilitiesCache *self, const gchar *edid)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CAPABILITIES_CACHE(self), NULL);
+
+  GVariant *entry = load_entry(self, edid);
+  if (entry == NULL) {
+    return NULL;
+  }
+
+  gchar *capabilities = NULL;
+  g_variant_get_child(entry, 1, "ms", &capabilities);
+  return capabilities;
+}
+
+GVariant *
+gnomeddc_capabilities_cache_lookup_metadata(GnomeDdcCapabilitiesCache *self, const gchar *edid)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CAPABILITIES_CACHE(self), NULL);
+
+  GVariant *entry = load_entry(self, edid);
+  if (entry == NULL) {
+    return NULL;
+  }
+
+  g_autoptr(GVariant) maybe = g_variant_get_child_value(entry, 2);
+  return g_variant_get_maybe(maybe);
+}
+
+void
+gnomeddc_capabilities_cache_store_string(GnomeDdcCapabilitiesCache *self,
+                                         const gchar *edid,
+                                         const gchar *capabilities)
+{
+  g_return_if_fail(GNOMEDDC_IS_CAPABILITIES_CACHE(self));
+
+  if (edid == NULL || *edid == '\0') {
+    return;
+  }
+
+  g_autoptr(GVariant) metadata = gnomeddc_capabilities_cache_lookup_metadata(self, edid);
+  save_entry(self, edid, capabilities, metadata);
+}
+
+void
+gnomeddc_capabilities_cache_store_metadata(GnomeDdcCapabilitiesCache *self,
+                                           const gchar *edid,
+                                           GVariant *metadata)
+{
+  g_return_if_fail(GNOMEDDC_IS_CAPABILITIES_CACHE(self));
+  g_return_if_fail(metadata == NULL ||
+                   g_variant_is_of_type(metadata, G_VARIANT_TYPE(GNOMEDDC_CAPABILITIES_METADATA_TYPE)));
+
+  if (edid == NULL || *edid == '\0') {
+    return;
+  }
+
+  g_autofree gchar *capabilities = gnomeddc_capabilities_cache_dup_string(self, edid);
+  save_entry(self, edid, capabilities, metadata);
+}
+
+void
+gnomeddc_capabilities_cache_remove(GnomeDdcCapabilitiesCache *self, const gchar *edid)
+{
+  g_return_if_fail(GNOMEDDC_IS_CAPABILITIES_CACHE(self));
+
+  if (edid == NULL || *edid == '\0') {
+    return;
+  }
+
+  g_autofree gchar *path = entry_path(self, edid);
+  if (g_unlink(path) != 0 && errno != ENOENT) {
+    g_warning("Unable to remove capabilities cache %s: %s", path, g_strerror(errno));
+  }
+  g_hash_table_replace(self->entries, g_strdup(edid), NULL);
+}
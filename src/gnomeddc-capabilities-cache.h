@@ -0,0 +1,36 @@
+#ifndef GNOMEDDC_CAPABILITIES_CACHE_H
+#define GNOMEDDC_CAPABILITIES_CACHE_H
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_CAPABILITIES_CACHE (gnomeddc_capabilities_cache_get_type())
+
+/* Parsed capabilities as returned by GetCapabilitiesMetadata, minus the
+ * trailing status and message. */
+#define GNOMEDDC_CAPABILITIES_METADATA_TYPE "(syya{ys}a{y(ssa{ys})})"
+
+G_DECLARE_FINAL_TYPE(GnomeDdcCapabilitiesCache, gnomeddc_capabilities_cache, GNOMEDDC, CAPABILITIES_CACHE, GObject)
+
+GnomeDdcCapabilitiesCache *gnomeddc_capabilities_cache_new(void);
+GnomeDdcCapabilitiesCache *gnomeddc_capabilities_cache_new_for_directory(const gchar *directory);
+
+gchar *gnomeddc_capabilities_cache_dup_string(GnomeDdcCapabilitiesCache *self,
+                                              const gchar *edid);
+GVariant *gnomeddc_capabilities_cache_lookup_metadata(GnomeDdcCapabilitiesCache *self,
+                                                      const gchar *edid);
+
+void gnomeddc_capabilities_cache_store_string(GnomeDdcCapabilitiesCache *self,
+                                              const gchar *edid,
+                                              const gchar *capabilities);
+void gnomeddc_capabilities_cache_store_metadata(GnomeDdcCapabilitiesCache *self,
+                                                const gchar *edid,
+                                                GVariant *metadata);
+
+void gnomeddc_capabilities_cache_remove(GnomeDdcCapabilitiesCache *self,
+                                        const gchar *edid);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_CAPABILITIES_CACHE_H */
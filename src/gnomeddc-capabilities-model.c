@@ -0,0 +1,104 @@
+#include "gnomeddc-capabilities-model.h"
+
+/*
+ * A GListModel over the a{y(ssa{ys})} feature table of parsed capabilities.
+ * Feature objects are created the first time a list asks for them, so a
+ * list view only pays for the rows that were scrolled into view.
+ */
+
+struct _GnomeDdcCapabilitiesModel {
+  GObject parent_instance;
+
+  GVariant *features;
+  /* Index -> GnomeDdcCapabilityFeature, NULL until requested */
+  GPtrArray *items;
+};
+
+static void gnomeddc_capabilities_model_list_model_iface_init(GListModelInterface *iface);
+
+G_DEFINE_FINAL_TYPE_WITH_CODE(GnomeDdcCapabilitiesModel, gnomeddc_capabilities_model, G_TYPE_OBJECT,
+                              G_IMPLEMENT_INTERFACE(G_TYPE_LIST_MODEL,
+                                                    gnomeddc_capabilities_model_list_model_iface_init))
+
+static void
+item_unref(gpointer item)
+{
+  if (item != NULL) {
+    g_object_unref(item);
+  }
+}
+
+static GType
+gnomeddc_capabilities_model_get_item_type(GListModel *list G_GNUC_UNUSED)
+{
+  return GNOMEDDC_TYPE_CAPABILITY_FEATURE;
+}
+
+static guint
+gnomeddc_capabilities_model_get_n_items(GListModel *list)
+{
+  GnomeDdcCapabilitiesModel *self = GNOMEDDC_CAPABILITIES_MODEL(list);
+  return self->items->len;
+}
+
+static gpointer
+gnomeddc_capabilities_model_get_item(GListModel *list, guint position)
+{
+  GnomeDdcCapabilitiesModel *self = GNOMEDDC_CAPABILITIES_MODEL(list);
+
+  if (position >= self->items->len) {
+    return NULL;
+  }
+
+  GnomeDdcCapabilityFeature *feature = g_ptr_array_index(self->items, position);
+  if (feature == NULL) {
+    g_autoptr(GVariant) entry = g_variant_get_child_value(self->features, position);
+    feature = gnomeddc_capability_feature_new_from_variant(entry);
+    g_ptr_array_index(self->items, position) = feature;
+  }
+  return g_object_ref(feature);
+}
+
+static void
+gnomeddc_capabilities_model_list_model_iface_init(GListModelInterface *iface)
+{
+  iface->get_item_type = gnomeddc_capabilities_model_get_item_type;
+  iface->get_n_items = gnomeddc_capabilities_model_get_n_items;
+  iface->get_item = gnomeddc_capabilities_model_get_item;
+}
+
+static void
+gnomeddc_capabilities_model_finalize(GObject *object)
+{
+  GnomeDdcCapabilitiesModel *self = GNOMEDDC_CAPABILITIES_MODEL(object);
+  g_clear_pointer(&self->items, g_ptr_array_unref);
+  g_clear_pointer(&self->features, g_variant_unref);
+  G_OBJECT_CLASS(gnomeddc_capabilities_model_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_capabilities_model_class_init(GnomeDdcCapabilitiesModelClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_capabilities_model_finalize;
+}
+
+static void
+gnomeddc_capabilities_model_init(GnomeDdcCapabilitiesModel *self G_GNUC_UNUSED)
+{
+}
+
+GnomeDdcCapabilitiesModel *
+gnomeddc_capabilities_model_new(GVariant *features)
+{
+  g_return_val_if_fail(features != NULL, NULL);
+  g_return_val_if_fail(g_variant_is_of_type(features, G_VARIANT_TYPE("a{y(ssa{ys})}")), NULL);
+
+  GnomeDdcCapabilitiesModel *self = g_object_new(GNOMEDDC_TYPE_CAPABILITIES_MODEL, NULL);
+  self->features = g_variant_ref_sink(features);
+
+  guint n_features = g_variant_n_children(features);
+  self->items = g_ptr_array_new_full(n_features, item_unref);
+  g_ptr_array_set_size(self->items, n_features);
+  return self;
+}
@@ -0,0 +1,18 @@
+#ifndef GNOMEDDC_CAPABILITIES_MODEL_H
+#define GNOMEDDC_CAPABILITIES_MODEL_H
+
+#include <gio/gio.h>
+
+#include "gnomeddc-capability-feature.h"
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_CAPABILITIES_MODEL (gnomeddc_capabilities_model_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcCapabilitiesModel, gnomeddc_capabilities_model, GNOMEDDC, CAPABILITIES_MODEL, GObject)
+
+GnomeDdcCapabilitiesModel *gnomeddc_capabilities_model_new(GVariant *features);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_CAPABILITIES_MODEL_H */
@@ -0,0 +1,174 @@
+#include "gnomeddc-capability-feature.h"
+
+#include <string.h>
+
+/*
+ * One feature of a GetCapabilitiesMetadata reply and its permitted values.
+ * Like GnomeDdcDisplay, both keep their dictionary entry alive and hand out
+ * strings borrowed from it.
+ */
+
+struct _GnomeDdcCapabilityFeature {
+  GObject parent_instance;
+
+  /* {y(ssa{ys})} */
+  GVariant *entry;
+  guint8 code;
+  const gchar *name;
+  const gchar *description;
+  GVariant *values;
+  gchar *search_key;
+};
+
+struct _GnomeDdcCapabilityValue {
+  GObject parent_instance;
+
+  /* {ys} */
+  GVariant *entry;
+  guint8 code;
+  const gchar *name;
+};
+
+G_DEFINE_FINAL_TYPE(GnomeDdcCapabilityFeature, gnomeddc_capability_feature, G_TYPE_OBJECT)
+G_DEFINE_FINAL_TYPE(GnomeDdcCapabilityValue, gnomeddc_capability_value, G_TYPE_OBJECT)
+
+static void
+gnomeddc_capability_feature_finalize(GObject *object)
+{
+  GnomeDdcCapabilityFeature *self = GNOMEDDC_CAPABILITY_FEATURE(object);
+  g_clear_pointer(&self->values, g_variant_unref);
+  g_clear_pointer(&self->entry, g_variant_unref);
+  g_clear_pointer(&self->search_key, g_free);
+  G_OBJECT_CLASS(gnomeddc_capability_feature_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_capability_feature_class_init(GnomeDdcCapabilityFeatureClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_capability_feature_finalize;
+}
+
+static void
+gnomeddc_capability_feature_init(GnomeDdcCapabilityFeature *self G_GNUC_UNUSED)
+{
+}
+
+GnomeDdcCapabilityFeature *
+gnomeddc_capability_feature_new_from_variant(GVariant *entry)
+{
+  g_return_val_if_fail(entry != NULL, NULL);
+  g_return_val_if_fail(g_variant_is_of_type(entry, G_VARIANT_TYPE("{y(ssa{ys})}")), NULL);
+
+  GnomeDdcCapabilityFeature *self = g_object_new(GNOMEDDC_TYPE_CAPABILITY_FEATURE, NULL);
+  self->entry = g_variant_ref_sink(entry);
+  g_variant_get(self->entry, "{y(&s&s@a{ys})}", &self->code, &self->name, &self->description, &self->values);
+  return self;
+}
+
+guint8
+gnomeddc_capability_feature_get_code(GnomeDdcCapabilityFeature *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CAPABILITY_FEATURE(self), 0);
+  return self->code;
+}
+
+const gchar *
+gnomeddc_capability_feature_get_name(GnomeDdcCapabilityFeature *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CAPABILITY_FEATURE(self), NULL);
+  return self->name;
+}
+
+const gchar *
+gnomeddc_capability_feature_get_description(GnomeDdcCapabilityFeature *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CAPABILITY_FEATURE(self), NULL);
+  return self->description;
+}
+
+guint
+gnomeddc_capability_feature_get_n_values(GnomeDdcCapabilityFeature *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CAPABILITY_FEATURE(self), 0);
+  return g_variant_n_children(self->values);
+}
+
+/* Builds the value objects; meant to be called when the feature's row is
+ * expanded, not up front. */
+GListModel *
+gnomeddc_capability_feature_create_values_model(GnomeDdcCapabilityFeature *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CAPABILITY_FEATURE(self), NULL);
+
+  GListStore *store = g_list_store_new(GNOMEDDC_TYPE_CAPABILITY_VALUE);
+  gsize n_values = g_variant_n_children(self->values);
+  g_autoptr(GPtrArray) values = g_ptr_array_new_full(n_values, g_object_unref);
+  for (gsize i = 0; i < n_values; i++) {
+    g_autoptr(GVariant) entry = g_variant_get_child_value(self->values, i);
+    g_ptr_array_add(values, gnomeddc_capability_value_new_from_variant(entry));
+  }
+  g_list_store_splice(store, 0, 0, values->pdata, values->len);
+  return G_LIST_MODEL(store);
+}
+
+/* @folded_query must already be passed through g_utf8_casefold(). Matches
+ * the code written as "10" or "0x10", the name and the description. */
+gboolean
+gnomeddc_capability_feature_matches(GnomeDdcCapabilityFeature *self, const gchar *folded_query)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CAPABILITY_FEATURE(self), FALSE);
+  g_return_val_if_fail(folded_query != NULL, FALSE);
+
+  if (self->search_key == NULL) {
+    g_autofree gchar *haystack = g_strdup_printf("0x%02x\n%s\n%s", self->code, self->name, self->description);
+    self->search_key = g_utf8_casefold(haystack, -1);
+  }
+  return strstr(self->search_key, folded_query) != NULL;
+}
+
+static void
+gnomeddc_capability_value_finalize(GObject *object)
+{
+  GnomeDdcCapabilityValue *self = GNOMEDDC_CAPABILITY_VALUE(object);
+  g_clear_pointer(&self->entry, g_variant_unref);
+  G_OBJECT_CLASS(gnomeddc_capability_value_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_capability_value_class_init(GnomeDdcCapabilityValueClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_capability_value_finalize;
+}
+
+static void
+gnomeddc_capability_value_init(GnomeDdcCapabilityValue *self G_GNUC_UNUSED)
+{
+}
+
+GnomeDdcCapabilityValue *
+gnomeddc_capability_value_new_from_variant(GVariant *entry)
+{
+  g_return_val_if_fail(entry != NULL, NULL);
+  g_return_val_if_fail(g_variant_is_of_type(entry, G_VARIANT_TYPE("{ys}")), NULL);
+
+  GnomeDdcCapabilityValue *self = g_object_new(GNOMEDDC_TYPE_CAPABILITY_VALUE, NULL);
+  self->entry = g_variant_ref_sink(entry);
+  g_variant_get(self->entry, "{y&s}", &self->code, &self->name);
+  return self;
+}
+
+guint8
+gnomeddc_capability_value_get_code(GnomeDdcCapabilityValue *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CAPABILITY_VALUE(self), 0);
+  return self->code;
+}
+
+const gchar *
+gnomeddc_capability_value_get_name(GnomeDdcCapabilityValue *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CAPABILITY_VALUE(self), NULL);
+  return self->name;
+}
@@ -0,0 +1,31 @@
+#ifndef GNOMEDDC_CAPABILITY_FEATURE_H
+#define GNOMEDDC_CAPABILITY_FEATURE_H
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_CAPABILITY_FEATURE (gnomeddc_capability_feature_get_type())
+#define GNOMEDDC_TYPE_CAPABILITY_VALUE (gnomeddc_capability_value_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcCapabilityFeature, gnomeddc_capability_feature, GNOMEDDC, CAPABILITY_FEATURE, GObject)
+G_DECLARE_FINAL_TYPE(GnomeDdcCapabilityValue, gnomeddc_capability_value, GNOMEDDC, CAPABILITY_VALUE, GObject)
+
+GnomeDdcCapabilityFeature *gnomeddc_capability_feature_new_from_variant(GVariant *entry);
+
+guint8 gnomeddc_capability_feature_get_code(GnomeDdcCapabilityFeature *self);
+const gchar *gnomeddc_capability_feature_get_name(GnomeDdcCapabilityFeature *self);
+const gchar *gnomeddc_capability_feature_get_description(GnomeDdcCapabilityFeature *self);
+guint gnomeddc_capability_feature_get_n_values(GnomeDdcCapabilityFeature *self);
+GListModel *gnomeddc_capability_feature_create_values_model(GnomeDdcCapabilityFeature *self);
+gboolean gnomeddc_capability_feature_matches(GnomeDdcCapabilityFeature *self,
+                                             const gchar *folded_query);
+
+GnomeDdcCapabilityValue *gnomeddc_capability_value_new_from_variant(GVariant *entry);
+
+guint8 gnomeddc_capability_value_get_code(GnomeDdcCapabilityValue *self);
+const gchar *gnomeddc_capability_value_get_name(GnomeDdcCapabilityValue *self);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_CAPABILITY_FEATURE_H */
@@ -0,0 +1,650 @@
+#include "gnomeddc-cli.h"
+
+#include "gnomeddc-client.h"
+#include "gnomeddc-display.h"
+#include "gnomeddc-json.h"
+#include "gnomeddc-profile-apply.h"
+#include "gnomeddc-profile-store.h"
+#include "gnomeddc-vcp-batch.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * Headless mode: talks to ddcutil-service through GnomeDdcClient only and
+ * never touches GTK, so it is cheap enough to run from scripts and cron.
+ * The --json output is meant to be parsed; keys are only ever added.
+ */
+
+enum {
+  EXIT_OK = 0,
+  EXIT_FAILED = 1,
+  EXIT_USAGE = 2
+};
+
+typedef struct {
+  guint8 code;
+  guint16 value;
+} CliWrite;
+
+typedef struct {
+  GMainLoop *loop;
+  GnomeDdcClient *client;
+  gint exit_status;
+
+  gboolean detect;
+  gboolean json;
+  gint display_number;
+  gchar *edid;
+  guint flags;
+  GArray *read_codes;
+  GArray *writes;
+  gchar *profile;
+
+  GPtrArray *targets;
+  guint write_index;
+  GString *output;
+  gboolean first_result;
+} CliContext;
+
+/* Options that switch main() into this mode instead of starting the GUI,
+ * as accepted by gnomeddc_cli_run(). Help is shown here too, since the
+ * GUI has no options worth a page of their own besides --daemon. */
+static const gchar * const cli_options[] = {
+  "--list",
+  "--detect",
+  "--get",
+  "--set",
+  "--json",
+  "--display",
+  "--edid",
+  "--flags",
+  "--apply-profile",
+  "--help",
+  "--help-all",
+  NULL
+};
+
+/* Short forms; GOption also accepts them grouped, as in -lj, or with the
+ * value attached, as in -d1. */
+static const gchar cli_short_options[] = "lgspdejh?";
+
+gboolean
+gnomeddc_cli_is_requested(int argc, char **argv)
+{
+  for (int i = 1; i < argc; i++) {
+    if (g_str_equal(argv[i], "--")) {
+      break;
+    }
+    if (argv[i][0] == '-' && argv[i][1] != '-' && argv[i][1] != '\0' &&
+        strchr(cli_short_options, argv[i][1]) != NULL) {
+      return TRUE;
+    }
+    for (guint j = 0; cli_options[j] != NULL; j++) {
+      gsize length = strlen(cli_options[j]);
+      if (strncmp(argv[i], cli_options[j], length) == 0 &&
+          (argv[i][length] == '\0' || argv[i][length] == '=')) {
+        return TRUE;
+      }
+    }
+  }
+  return FALSE;
+}
+
+static gboolean
+parse_number(const gchar *text, guint64 max, guint64 *out)
+{
+  gchar *endptr = NULL;
+  if (text == NULL || *text == '\0') {
+    return FALSE;
+  }
+  guint64 value = g_ascii_strtoull(text, &endptr, 0);
+  if (endptr == NULL || *endptr != '\0' || value > max) {
+    return FALSE;
+  }
+  *out = value;
+  return TRUE;
+}
+
+/* --get takes codes separated by commas and may be repeated. */
+static gboolean
+parse_read_codes(gchar **specs, GArray *codes, GError **error)
+{
+  for (guint i = 0; specs != NULL && specs[i] != NULL; i++) {
+    g_auto(GStrv) parts = g_strsplit(specs[i], ",", -1);
+    for (guint j = 0; parts[j] != NULL; j++) {
+      guint64 code = 0;
+      if (!parse_number(g_strstrip(parts[j]), G_MAXUINT8, &code)) {
+        g_set_error(error, G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+                    "Invalid VCP code “%s”", parts[j]);
+        return FALSE;
+      }
+      guint8 value = (guint8) code;
+      g_array_append_val(codes, value);
+    }
+  }
+  return TRUE;
+}
+
+/* --set takes CODE=VALUE and may be repeated. */
+static gboolean
+parse_writes(gchar **specs, GArray *writes, GError **error)
+{
+  for (guint i = 0; specs != NULL && specs[i] != NULL; i++) {
+    g_auto(GStrv) parts = g_strsplit(specs[i], "=", 2);
+    guint64 code = 0;
+    guint64 value = 0;
+    if (g_strv_length(parts) != 2 ||
+        !parse_number(g_strstrip(parts[0]), G_MAXUINT8, &code) ||
+        !parse_number(g_strstrip(parts[1]), G_MAXUINT16, &value)) {
+      g_set_error(error, G_OPTION_ERROR, G_OPTION_ERROR_BAD_VALUE,
+                  "Invalid write “%s”, expected CODE=VALUE", specs[i]);
+      return FALSE;
+    }
+    CliWrite write = { (guint8) code, (guint16) value };
+    g_array_append_val(writes, write);
+  }
+  return TRUE;
+}
+
+static void
+cli_finish(CliContext *ctx, gint exit_status)
+{
+  if (ctx->output != NULL && ctx->output->len > 0) {
+    fputs(ctx->output->str, stdout);
+    fflush(stdout);
+  }
+  ctx->exit_status = exit_status;
+  g_main_loop_quit(ctx->loop);
+}
+
+static void
+cli_fail(CliContext *ctx, const gchar *format, ...) G_GNUC_PRINTF(2, 3);
+
+static void
+cli_fail(CliContext *ctx, const gchar *format, ...)
+{
+  va_list args;
+  va_start(args, format);
+  g_autofree gchar *message = g_strdup_vprintf(format, args);
+  va_end(args);
+
+  if (ctx->json) {
+    g_string_truncate(ctx->output, 0);
+    g_string_append(ctx->output, "{\"error\": ");
+    gnomeddc_json_append_string(ctx->output, message);
+    g_string_append(ctx->output, "}\n");
+  } else {
+    g_printerr("gnomeddc: %s\n", message);
+  }
+  cli_finish(ctx, EXIT_FAILED);
+}
+
+static void
+append_display_json(GString *json, GnomeDdcDisplay *display)
+{
+  g_string_append_printf(json, "\"display_number\": %d, ", gnomeddc_display_get_display_number(display));
+  g_string_append(json, "\"edid\": ");
+  gnomeddc_json_append_string(json, gnomeddc_display_get_edid(display));
+}
+
+static void
+print_display_list(CliContext *ctx)
+{
+  GString *out = ctx->output;
+
+  if (ctx->json) {
+    g_string_append(out, "{\"displays\": [");
+  }
+
+  for (guint i = 0; i < ctx->targets->len; i++) {
+    GnomeDdcDisplay *display = g_ptr_array_index(ctx->targets, i);
+    if (ctx->json) {
+      g_string_append(out, i > 0 ? ",\n  {" : "\n  {");
+      append_display_json(out, display);
+      g_string_append_printf(out, ", \"usb_bus\": %d, \"usb_device\": %d",
+                             gnomeddc_display_get_usb_bus(display),
+                             gnomeddc_display_get_usb_device(display));
+      g_string_append(out, ", \"manufacturer\": ");
+      gnomeddc_json_append_string(out, gnomeddc_display_get_manufacturer(display));
+      g_string_append(out, ", \"model\": ");
+      gnomeddc_json_append_string(out, gnomeddc_display_get_model(display));
+      g_string_append(out, ", \"serial\": ");
+      gnomeddc_json_append_string(out, gnomeddc_display_get_serial(display));
+      g_string_append_printf(out, ", \"product_code\": %u, \"binary_serial\": %u}",
+                             gnomeddc_display_get_product_code(display),
+                             gnomeddc_display_get_binary_serial(display));
+    } else {
+      g_autofree gchar *name = gnomeddc_display_dup_full_name(display);
+      g_string_append_printf(out, "Display %d: %s", gnomeddc_display_get_display_number(display), name);
+      if (*gnomeddc_display_get_serial(display) != '\0') {
+        g_string_append_printf(out, " (%s)", gnomeddc_display_get_serial(display));
+      }
+      g_string_append_printf(out, "\n  EDID: %s\n", gnomeddc_display_get_edid(display));
+    }
+  }
+
+  if (ctx->json) {
+    g_string_append(out, ctx->targets->len > 0 ? "\n]}\n" : "]}\n");
+  }
+  cli_finish(ctx, EXIT_OK);
+}
+
+static void
+read_finished_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  CliContext *ctx = user_data;
+  GnomeDdcVcpBatch *batch = GNOMEDDC_VCP_BATCH(source);
+  g_autoptr(GError) error = NULL;
+
+  if (!gnomeddc_vcp_batch_read_finish(batch, result, &error)) {
+    cli_fail(ctx, "%s", error->message);
+    g_object_unref(batch);
+    return;
+  }
+
+  GString *out = ctx->output;
+  gint exit_status = EXIT_OK;
+  guint n_entries = gnomeddc_vcp_batch_get_n_entries(batch);
+
+  if (ctx->json) {
+    g_string_append(out, "{\"results\": [");
+  }
+
+  for (guint i = 0; i < n_entries; i++) {
+    GnomeDdcDisplay *display = gnomeddc_vcp_batch_get_display(batch, i);
+    const GError *entry_error = gnomeddc_vcp_batch_get_error(batch, i);
+    gint status = gnomeddc_vcp_batch_get_status(batch, i);
+    const gchar *message = gnomeddc_vcp_batch_get_message(batch, i);
+    gsize n_values = 0;
+    const GnomeDdcVcpValue *values = gnomeddc_vcp_batch_get_value_array(batch, i, &n_values);
+
+    if (entry_error != NULL || status != 0) {
+      exit_status = EXIT_FAILED;
+    }
+
+    if (ctx->json) {
+      g_string_append(out, i > 0 ? ",\n  {" : "\n  {");
+      append_display_json(out, display);
+      if (entry_error != NULL) {
+        g_string_append(out, ", \"error\": ");
+        gnomeddc_json_append_string(out, entry_error->message);
+        g_string_append(out, ", \"values\": []}");
+        continue;
+      }
+      g_string_append_printf(out, ", \"status\": %d, \"message\": ", status);
+      gnomeddc_json_append_string(out, message);
+      g_string_append(out, ", \"values\": [");
+      for (gsize j = 0; j < n_values; j++) {
+        g_string_append_printf(out, "%s{\"code\": %u, \"current\": %u, \"max\": %u, \"formatted\": ",
+                               j > 0 ? ", " : "",
+                               values[j].code, values[j].current, values[j].max);
+        gnomeddc_json_append_string(out, values[j].formatted);
+        g_string_append_c(out, '}');
+      }
+      g_string_append(out, "]}");
+    } else if (entry_error != NULL) {
+      g_printerr("gnomeddc: display %d: %s\n",
+                 gnomeddc_display_get_display_number(display), entry_error->message);
+    } else {
+      if (status != 0) {
+        g_printerr("gnomeddc: display %d: status %d: %s\n",
+                   gnomeddc_display_get_display_number(display), status, message);
+      }
+      for (gsize j = 0; j < n_values; j++) {
+        g_string_append_printf(out, "%d 0x%02X %u %u %s\n",
+                               gnomeddc_display_get_display_number(display),
+                               values[j].code, values[j].current, values[j].max,
+                               values[j].formatted);
+      }
+    }
+  }
+
+  if (ctx->json) {
+    g_string_append(out, n_entries > 0 ? "\n]}\n" : "]}\n");
+  }
+  g_object_unref(batch);
+  cli_finish(ctx, exit_status);
+}
+
+static void
+start_reads(CliContext *ctx)
+{
+  GnomeDdcVcpBatch *batch = gnomeddc_vcp_batch_new();
+  for (guint i = 0; i < ctx->targets->len; i++) {
+    gnomeddc_vcp_batch_add(batch,
+                           g_ptr_array_index(ctx->targets, i),
+                           (const guint8 *) ctx->read_codes->data,
+                           ctx->read_codes->len);
+  }
+  gnomeddc_vcp_batch_read_async(batch, ctx->client, ctx->flags, NULL, read_finished_cb, ctx);
+}
+
+static void run_next_write(CliContext *ctx);
+
+static void
+write_finished_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  CliContext *ctx = user_data;
+  guint n_writes = ctx->writes->len;
+  GnomeDdcDisplay *display = g_ptr_array_index(ctx->targets, ctx->write_index / n_writes);
+  const CliWrite *write = &g_array_index(ctx->writes, CliWrite, ctx->write_index % n_writes);
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(ctx->client, result, &error);
+
+  gint status = 0;
+  const gchar *message = "";
+  if (response != NULL) {
+    g_variant_get(response, "(i&s)", &status, &message);
+  }
+  if (error != NULL || status != 0) {
+    ctx->exit_status = EXIT_FAILED;
+  }
+
+  if (ctx->json) {
+    g_string_append(ctx->output, ctx->first_result ? "\n  {" : ",\n  {");
+    append_display_json(ctx->output, display);
+    g_string_append_printf(ctx->output, ", \"code\": %u, \"value\": %u", write->code, write->value);
+    if (error != NULL) {
+      g_string_append(ctx->output, ", \"error\": ");
+      gnomeddc_json_append_string(ctx->output, error->message);
+    } else {
+      g_string_append_printf(ctx->output, ", \"status\": %d, \"message\": ", status);
+      gnomeddc_json_append_string(ctx->output, message);
+    }
+    g_string_append_c(ctx->output, '}');
+  } else if (error != NULL || status != 0) {
+    g_printerr("gnomeddc: display %d: setting 0x%02X failed: %s\n",
+               gnomeddc_display_get_display_number(display), write->code,
+               error != NULL ? error->message : message);
+  }
+  ctx->first_result = FALSE;
+
+  ctx->write_index++;
+  run_next_write(ctx);
+}
+
+/* Writes go out one at a time, display by display, in command line order;
+ * DDC writes are rarely the bottleneck for a handful of settings. */
+static void
+run_next_write(CliContext *ctx)
+{
+  guint n_writes = ctx->writes->len;
+  if (ctx->write_index >= ctx->targets->len * n_writes) {
+    if (ctx->json) {
+      g_string_append(ctx->output, ctx->first_result ? "]}\n" : "\n]}\n");
+    }
+    cli_finish(ctx, ctx->exit_status);
+    return;
+  }
+
+  GnomeDdcDisplay *display = g_ptr_array_index(ctx->targets, ctx->write_index / n_writes);
+  const CliWrite *write = &g_array_index(ctx->writes, CliWrite, ctx->write_index % n_writes);
+  gnomeddc_client_set_vcp_async(ctx->client,
+                                display,
+                                write->code,
+                                write->value,
+                                ctx->flags,
+                                GNOMEDDC_CALL_FLAGS_NONE,
+                                NULL,
+                                write_finished_cb,
+                                ctx);
+}
+
+static void
+apply_finished_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  CliContext *ctx = user_data;
+  GnomeDdcProfileApply *apply = GNOMEDDC_PROFILE_APPLY(source);
+  g_autoptr(GError) error = NULL;
+
+  if (!gnomeddc_profile_apply_run_finish(apply, result, &error)) {
+    cli_fail(ctx, "%s", error->message);
+    g_object_unref(apply);
+    return;
+  }
+
+  GString *out = ctx->output;
+  gint exit_status = EXIT_OK;
+  guint n_entries = gnomeddc_profile_apply_get_n_entries(apply);
+
+  if (ctx->json) {
+    g_string_append(out, "{\"profile\": ");
+    gnomeddc_json_append_string(out, ctx->profile);
+    g_string_append(out, ", \"results\": [");
+  }
+
+  for (guint i = 0; i < n_entries; i++) {
+    GnomeDdcDisplay *display = gnomeddc_profile_apply_get_display(apply, i);
+    guint written = gnomeddc_profile_apply_get_n_written(apply, i);
+    guint skipped = gnomeddc_profile_apply_get_n_skipped(apply, i);
+    guint failed = gnomeddc_profile_apply_get_n_failed(apply, i);
+    const gchar *message = gnomeddc_profile_apply_get_error(apply, i);
+
+    if (failed > 0) {
+      exit_status = EXIT_FAILED;
+    }
+
+    if (ctx->json) {
+      g_string_append(out, i > 0 ? ",\n  {" : "\n  {");
+      append_display_json(out, display);
+      g_string_append_printf(out, ", \"written\": %u, \"skipped\": %u, \"failed\": %u",
+                             written, skipped, failed);
+      if (message != NULL) {
+        g_string_append(out, ", \"error\": ");
+        gnomeddc_json_append_string(out, message);
+      }
+      g_string_append_c(out, '}');
+    } else {
+      g_string_append_printf(out, "Display %d: %u written, %u already set, %u failed\n",
+                             gnomeddc_display_get_display_number(display), written, skipped, failed);
+      if (message != NULL) {
+        g_printerr("gnomeddc: display %d: %s\n", gnomeddc_display_get_display_number(display), message);
+      }
+    }
+  }
+
+  if (ctx->json) {
+    g_string_append(out, n_entries > 0 ? "\n]}\n" : "]}\n");
+  }
+  g_object_unref(apply);
+  cli_finish(ctx, exit_status);
+}
+
+static void
+start_profile(CliContext *ctx)
+{
+  g_autoptr(GnomeDdcProfileStore) store = gnomeddc_profile_store_new();
+  if (!gnomeddc_profile_store_has_profile(store, ctx->profile)) {
+    cli_fail(ctx, "No profile named “%s”", ctx->profile);
+    return;
+  }
+
+  GnomeDdcProfileApply *apply = gnomeddc_profile_apply_new();
+  gnomeddc_profile_apply_add_profile(apply, store, ctx->profile, ctx->targets);
+  gnomeddc_profile_apply_run_async(apply, ctx->client, ctx->flags, NULL, apply_finished_cb, ctx);
+}
+
+static void
+start_writes(CliContext *ctx)
+{
+  if (ctx->json) {
+    g_string_append(ctx->output, "{\"results\": [");
+  }
+  ctx->first_result = TRUE;
+  ctx->write_index = 0;
+  run_next_write(ctx);
+}
+
+/* An EDID selector may be abbreviated as long as it is unambiguous. */
+static gboolean
+select_targets(CliContext *ctx, GPtrArray *displays)
+{
+  for (guint i = 0; i < displays->len; i++) {
+    GnomeDdcDisplay *display = g_ptr_array_index(displays, i);
+    if (ctx->display_number > 0 && gnomeddc_display_get_display_number(display) != ctx->display_number) {
+      continue;
+    }
+    if (ctx->edid != NULL && g_ascii_strncasecmp(gnomeddc_display_get_edid(display), ctx->edid, strlen(ctx->edid)) != 0) {
+      continue;
+    }
+    g_ptr_array_add(ctx->targets, g_object_ref(display));
+  }
+
+  if (ctx->edid != NULL && ctx->targets->len > 1) {
+    cli_fail(ctx, "EDID “%s” matches %u displays", ctx->edid, ctx->targets->len);
+    return FALSE;
+  }
+  if ((ctx->display_number > 0 || ctx->edid != NULL) && ctx->targets->len == 0) {
+    cli_fail(ctx, "No matching display");
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static void
+list_finished_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  CliContext *ctx = user_data;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(ctx->client, result, &error);
+  if (response == NULL) {
+    cli_fail(ctx, "%s", error->message);
+    return;
+  }
+
+  g_autoptr(GVariant) array = NULL;
+  gint status = 0;
+  const gchar *message = NULL;
+  g_variant_get(response, "(i@a(iiisssqsu)i&s)", NULL, &array, &status, &message);
+  if (status != 0) {
+    cli_fail(ctx, "Detection failed with status %d: %s", status, message);
+    return;
+  }
+
+  g_autoptr(GPtrArray) displays = g_ptr_array_new_with_free_func(g_object_unref);
+  GVariantIter iter;
+  GVariant *entry;
+  g_variant_iter_init(&iter, array);
+  while ((entry = g_variant_iter_next_value(&iter)) != NULL) {
+    g_ptr_array_add(displays, gnomeddc_display_new_from_variant(entry));
+    g_variant_unref(entry);
+  }
+
+  if (!select_targets(ctx, displays)) {
+    return;
+  }
+
+  if (ctx->profile != NULL) {
+    start_profile(ctx);
+  } else if (ctx->writes->len > 0) {
+    start_writes(ctx);
+  } else if (ctx->read_codes->len > 0) {
+    start_reads(ctx);
+  } else {
+    print_display_list(ctx);
+  }
+}
+
+static void
+client_ready_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  CliContext *ctx = user_data;
+  g_autoptr(GError) error = NULL;
+
+  ctx->client = gnomeddc_client_new_finish(result, &error);
+  if (ctx->client == NULL) {
+    cli_fail(ctx, "%s", error->message);
+    return;
+  }
+
+  gnomeddc_client_call_async(ctx->client,
+                             ctx->detect ? "Detect" : "ListDetected",
+                             g_variant_new("(u)", 0),
+                             NULL,
+                             list_finished_cb,
+                             ctx);
+}
+
+int
+gnomeddc_cli_run(int argc, char **argv)
+{
+  gboolean list = FALSE;
+  gboolean detect = FALSE;
+  gboolean json = FALSE;
+  gint display_number = 0;
+  g_autofree gchar *edid = NULL;
+  g_autofree gchar *flags_text = NULL;
+  g_autofree gchar *profile = NULL;
+  g_auto(GStrv) get_specs = NULL;
+  g_auto(GStrv) set_specs = NULL;
+
+  const GOptionEntry entries[] = {
+    { "list", 'l', 0, G_OPTION_ARG_NONE, &list, "List detected displays", NULL },
+    { "detect", 0, 0, G_OPTION_ARG_NONE, &detect, "Rescan the buses instead of using the service's list", NULL },
+    { "get", 'g', 0, G_OPTION_ARG_STRING_ARRAY, &get_specs, "Read VCP codes (comma separated, repeatable)", "CODES" },
+    { "set", 's', 0, G_OPTION_ARG_STRING_ARRAY, &set_specs, "Write a VCP value (repeatable)", "CODE=VALUE" },
+    { "apply-profile", 'p', 0, G_OPTION_ARG_STRING, &profile, "Apply a saved profile, writing only values that differ", "NAME" },
+    { "display", 'd', 0, G_OPTION_ARG_INT, &display_number, "Only act on this display number", "N" },
+    { "edid", 'e', 0, G_OPTION_ARG_STRING, &edid, "Only act on the display with this EDID (or unique prefix)", "HEX" },
+    { "flags", 0, 0, G_OPTION_ARG_STRING, &flags_text, "Flags passed to the service", "FLAGS" },
+    { "json", 'j', 0, G_OPTION_ARG_NONE, &json, "Print machine readable JSON", NULL },
+    { NULL }
+  };
+
+  g_autoptr(GOptionContext) context = g_option_context_new(NULL);
+  g_option_context_set_summary(context,
+                               "Without a selector, --get, --set and --apply-profile act on every detected display.");
+  g_option_context_set_description(context,
+                                   "Without any of these options the main window opens. "
+                                   "--daemon stays in the background instead and serves the app.brightness-step action.");
+  g_option_context_add_main_entries(context, entries, NULL);
+
+  g_autoptr(GError) error = NULL;
+  if (!g_option_context_parse(context, &argc, &argv, &error)) {
+    g_printerr("gnomeddc: %s\n", error->message);
+    return EXIT_USAGE;
+  }
+
+  CliContext ctx = { 0 };
+  ctx.display_number = display_number;
+  ctx.edid = edid;
+  ctx.json = json;
+  ctx.detect = detect;
+  ctx.profile = profile;
+  ctx.read_codes = g_array_new(FALSE, FALSE, sizeof(guint8));
+  ctx.writes = g_array_new(FALSE, FALSE, sizeof(CliWrite));
+  ctx.targets = g_ptr_array_new_with_free_func(g_object_unref);
+  ctx.output = g_string_new(NULL);
+
+  guint64 flags = 0;
+  if ((flags_text != NULL && !parse_number(flags_text, G_MAXUINT32, &flags)) ||
+      !parse_read_codes(get_specs, ctx.read_codes, &error) ||
+      !parse_writes(set_specs, ctx.writes, &error)) {
+    g_printerr("gnomeddc: %s\n", error != NULL ? error->message : "Invalid flags");
+    ctx.exit_status = EXIT_USAGE;
+    goto out;
+  }
+  ctx.flags = (guint) flags;
+
+  if ((ctx.read_codes->len > 0) + (ctx.writes->len > 0) + (ctx.profile != NULL) > 1) {
+    g_printerr("gnomeddc: --get, --set and --apply-profile cannot be combined\n");
+    ctx.exit_status = EXIT_USAGE;
+    goto out;
+  }
+
+  ctx.loop = g_main_loop_new(NULL, FALSE);
+  gnomeddc_client_new_async(NULL, client_ready_cb, &ctx);
+  g_main_loop_run(ctx.loop);
+
+out:
+  g_clear_pointer(&ctx.loop, g_main_loop_unref);
+  g_clear_object(&ctx.client);
+  g_clear_pointer(&ctx.read_codes, g_array_unref);
+  g_clear_pointer(&ctx.writes, g_array_unref);
+  g_clear_pointer(&ctx.targets, g_ptr_array_unref);
+  if (ctx.output != NULL) {
+    g_string_free(ctx.output, TRUE);
+  }
+  return ctx.exit_status;
+}
@@ -0,0 +1,13 @@
+#ifndef GNOMEDDC_CLI_H
+#define GNOMEDDC_CLI_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+gboolean gnomeddc_cli_is_requested(int argc, char **argv);
+int gnomeddc_cli_run(int argc, char **argv);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_CLI_H */
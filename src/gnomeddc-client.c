@@ -1,18 +1,104 @@
 #include "gnomeddc-client.h"
 
+#include <string.h>
+
+#include "gnomeddc-trace.h"
+
 #define DDCUTIL_SERVICE_NAME "com.ddcutil.DdcutilService"
 #define DDCUTIL_OBJECT_PATH "/com/ddcutil/DdcutilObject"
 #define DDCUTIL_INTERFACE_NAME "com.ddcutil.DdcutilInterface"
 
+#define DEFAULT_TIMEOUT_MSEC 10000
+#define DEFAULT_MAX_IN_FLIGHT 4
+#define DEFAULT_MAX_IN_FLIGHT_PER_DISPLAY 1
+#define DEFAULT_MAX_RETRIES 3
+#define DEFAULT_RETRY_DEADLINE_MSEC 5000
+
+/* Backoff before retry n is RETRY_BASE_MSEC * 2^n, capped, of which a
+ * random half is dropped so displays on one bus do not retry in step. */
+#define RETRY_BASE_MSEC 100
+#define RETRY_MAX_BACKOFF_MSEC 2000
+
+/* Each display may retry this often per window; a monitor that keeps
+ * failing is left alone instead of being hammered. */
+#define RETRY_BUDGET_PER_DISPLAY 6
+#define RETRY_BUDGET_WINDOW_USEC (10 * G_TIME_SPAN_SECOND)
+
+/* DDCA_Display_Event_Type values, used when the service does not publish
+ * DisplayEventTypes. */
+#define DDCA_EVENT_DISPLAY_CONNECTED 2
+#define DDCA_EVENT_DISPLAY_DISCONNECTED 3
+
+/* Calls wait in one of these lanes until the in-flight limits allow them
+ * through. Within the limits the queued call with the earliest deadline,
+ * its queue time plus the lane's delay, goes first. Writes therefore
+ * overtake reads and reads overtake background work, but nothing waits
+ * forever behind a stream of more urgent calls. */
+typedef enum {
+  CALL_LANE_WRITE,
+  CALL_LANE_READ,
+  CALL_LANE_BACKGROUND,
+  N_CALL_LANES
+} CallLane;
+
+static const gint64 lane_delay_usec[N_CALL_LANES] = {
+  [CALL_LANE_WRITE] = 0,
+  [CALL_LANE_READ] = 500 * G_TIME_SPAN_MILLISECOND,
+  [CALL_LANE_BACKGROUND] = 5 * G_TIME_SPAN_SECOND,
+};
+
 struct _GnomeDdcClient {
   GObject parent_instance;
 
   GDBusProxy *proxy;
   GnomeDdcClientBusType bus_type;
   gchar *last_error;
+  GnomeDdcVcpCache *vcp_cache;
+  GHashTable *method_timeouts;
+  gint default_timeout;
+  GnomeDdcCallStats *call_stats;
+  GnomeDdcServiceProperties *service_properties;
+
+  GQueue lanes[N_CALL_LANES];
+  /* display id -> number of calls in flight */
+  GHashTable *display_in_flight;
+  guint n_in_flight;
+  guint max_in_flight;
+  guint max_in_flight_per_display;
+  guint pump_source_id;
+
+  guint max_retries;
+  gint64 retry_deadline_usec;
+  /* display id -> RetryBudget */
+  GHashTable *retry_budgets;
+  /* read key -> PendingRead, for reads that others may still join */
+  GHashTable *pending_reads;
 };
 
-G_DEFINE_FINAL_TYPE(GnomeDdcClient, gnomeddc_client, G_TYPE_OBJECT)
+typedef struct {
+  guint64 display_id;
+  gint64 window_start;
+  guint used;
+} RetryBudget;
+
+enum {
+  SIGNAL_CONNECTED,
+  SIGNAL_CONNECTION_FAILED,
+  SIGNAL_DISPLAYS_CHANGED,
+  SIGNAL_VCP_VALUE_CHANGED,
+  SIGNAL_SERVICE_INITIALIZED,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+static void gnomeddc_client_async_initable_iface_init(GAsyncInitableIface *iface);
+static void pump_calls(GnomeDdcClient *self);
+static void enqueue_call(GnomeDdcClient *self, GTask *task);
+
+G_DEFINE_FINAL_TYPE_WITH_CODE(GnomeDdcClient, gnomeddc_client, G_TYPE_OBJECT,
+                              G_IMPLEMENT_INTERFACE(G_TYPE_ASYNC_INITABLE,
+                                                    gnomeddc_client_async_initable_iface_init))
 
 static void
 set_last_error(GnomeDdcClient *self, const gchar *message)
@@ -23,55 +109,221 @@ set_last_error(GnomeDdcClient *self, const gchar *message)
   }
 }
 
+typedef struct {
+  GDBusConnection *system_connection;
+  GDBusConnection *session_connection;
+  GError *system_error;
+  GError *session_error;
+  gboolean system_done;
+  gboolean session_done;
+  gboolean proxy_requested;
+} ConnectData;
+
 static void
-gnomeddc_client_constructed(GObject *object)
+connect_data_free(ConnectData *data)
 {
-  G_OBJECT_CLASS(gnomeddc_client_parent_class)->constructed(object);
+  g_clear_object(&data->system_connection);
+  g_clear_object(&data->session_connection);
+  g_clear_error(&data->system_error);
+  g_clear_error(&data->session_error);
+  g_free(data);
+}
 
-  GnomeDdcClient *self = GNOMEDDC_CLIENT(object);
-  g_autoptr(GError) error = NULL;
-  GDBusConnection *connection = g_bus_get_sync(G_BUS_TYPE_SYSTEM, NULL, &error);
+static void
+connect_failed(GTask *task, GError *error)
+{
+  GnomeDdcClient *self = g_task_get_source_object(task);
 
-  if (connection == NULL) {
-    set_last_error(self, error != NULL ? error->message : "");
-    g_clear_error(&error);
-    connection = g_bus_get_sync(G_BUS_TYPE_SESSION, NULL, &error);
-    self->bus_type = GNOMEDDC_CLIENT_BUS_SESSION;
-  } else {
+  set_last_error(self, error->message);
+  g_warning("Unable to reach %s: %s", DDCUTIL_SERVICE_NAME, self->last_error);
+  g_signal_emit(self, signals[SIGNAL_CONNECTION_FAILED], 0, self->last_error);
+  g_task_return_error(task, error);
+}
+
+static void
+proxy_signal_cb(GDBusProxy *proxy G_GNUC_UNUSED,
+                const gchar *sender_name G_GNUC_UNUSED,
+                const gchar *signal_name,
+                GVariant *parameters,
+                gpointer user_data)
+{
+  GnomeDdcClient *self = GNOMEDDC_CLIENT(user_data);
+
+  /* The caches are invalidated before re-emitting so handlers that read
+   * back a value get a fresh one. */
+  if (g_strcmp0(signal_name, "ConnectedDisplaysChanged") == 0 &&
+      g_variant_is_of_type(parameters, G_VARIANT_TYPE("(siu)"))) {
+    const gchar *edid;
+    gint event_type;
+    guint flags;
+    g_variant_get(parameters, "(&siu)", &edid, &event_type, &flags);
+    gnomeddc_vcp_cache_invalidate_display(self->vcp_cache, gnomeddc_display_id_for_edid(edid));
+    g_signal_emit(self, signals[SIGNAL_DISPLAYS_CHANGED], 0, edid, event_type, flags);
+  } else if (g_strcmp0(signal_name, "VcpValueChanged") == 0 &&
+             g_variant_is_of_type(parameters, G_VARIANT_TYPE("(isyqssu)"))) {
+    gint display_number;
+    const gchar *edid;
+    guint8 code;
+    guint16 value;
+    const gchar *source_client_name;
+    const gchar *source_client_context;
+    guint flags;
+    g_variant_get(parameters, "(i&syq&s&su)",
+                  &display_number, &edid, &code, &value,
+                  &source_client_name, &source_client_context, &flags);
+    gnomeddc_vcp_cache_invalidate(self->vcp_cache, gnomeddc_display_id_for_edid(edid), code);
+    g_signal_emit(self, signals[SIGNAL_VCP_VALUE_CHANGED], 0,
+                  display_number, edid, (guint) code, (guint) value,
+                  source_client_name, source_client_context, flags);
+  } else if (g_strcmp0(signal_name, "ServiceInitialized") == 0) {
+    guint flags = 0;
+    if (g_variant_is_of_type(parameters, G_VARIANT_TYPE("(u)"))) {
+      g_variant_get(parameters, "(u)", &flags);
+    }
+    gnomeddc_vcp_cache_clear(self->vcp_cache);
+    gnomeddc_service_properties_refresh(self->service_properties);
+    g_signal_emit(self, signals[SIGNAL_SERVICE_INITIALIZED], 0, flags);
+  }
+}
+
+static void
+proxy_new_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  GnomeDdcClient *self = g_task_get_source_object(task);
+  GError *error = NULL;
+
+  GDBusProxy *proxy = g_dbus_proxy_new_finish(result, &error);
+  if (proxy == NULL) {
+    connect_failed(task, error);
+    return;
+  }
+
+  self->proxy = proxy;
+  g_signal_connect_object(proxy, "g-signal", G_CALLBACK(proxy_signal_cb), self, 0);
+  gnomeddc_service_properties_set_proxy(self->service_properties, proxy);
+  set_last_error(self, NULL);
+  g_signal_emit(self, signals[SIGNAL_CONNECTED], 0);
+  g_task_return_boolean(task, TRUE);
+}
+
+/* Both buses are requested at once; the system bus wins whenever it is
+ * reachable, the session bus is only used once the system bus has failed. */
+static void
+maybe_create_proxy(GTask *task)
+{
+  GnomeDdcClient *self = g_task_get_source_object(task);
+  ConnectData *data = g_task_get_task_data(task);
+  GDBusConnection *connection = NULL;
+
+  if (data->proxy_requested || !data->system_done) {
+    return;
+  }
+
+  if (data->system_connection != NULL) {
+    connection = data->system_connection;
     self->bus_type = GNOMEDDC_CLIENT_BUS_SYSTEM;
+  } else if (!data->session_done) {
+    return;
+  } else if (data->session_connection != NULL) {
+    connection = data->session_connection;
+    self->bus_type = GNOMEDDC_CLIENT_BUS_SESSION;
   }
 
+  data->proxy_requested = TRUE;
+
   if (connection == NULL) {
-    set_last_error(self, error != NULL ? error->message : "Failed to connect to D-Bus");
-    g_warning("Unable to connect to D-Bus: %s", self->last_error ? self->last_error : "unknown error");
+    GError *error = data->session_error != NULL ? data->session_error : data->system_error;
+    if (error != NULL) {
+      connect_failed(task, g_error_copy(error));
+    } else {
+      connect_failed(task, g_error_new_literal(G_IO_ERROR, G_IO_ERROR_FAILED, "Failed to connect to D-Bus"));
+    }
     return;
   }
 
-  g_autoptr(GError) proxy_error = NULL;
-  self->proxy = g_dbus_proxy_new_sync(connection,
-                                      G_DBUS_PROXY_FLAGS_NONE,
-                                      NULL,
-                                      DDCUTIL_SERVICE_NAME,
-                                      DDCUTIL_OBJECT_PATH,
-                                      DDCUTIL_INTERFACE_NAME,
-                                      NULL,
-                                      &proxy_error);
-  g_object_unref(connection);
+  g_dbus_proxy_new(connection,
+                   G_DBUS_PROXY_FLAGS_NONE,
+                   NULL,
+                   DDCUTIL_SERVICE_NAME,
+                   DDCUTIL_OBJECT_PATH,
+                   DDCUTIL_INTERFACE_NAME,
+                   g_task_get_cancellable(task),
+                   proxy_new_cb,
+                   g_object_ref(task));
+}
 
-  if (self->proxy == NULL) {
-    set_last_error(self, proxy_error != NULL ? proxy_error->message : "Unable to create D-Bus proxy");
-    g_warning("Unable to create proxy for %s: %s", DDCUTIL_SERVICE_NAME, self->last_error ? self->last_error : "");
-    return;
+static void
+system_bus_get_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  ConnectData *data = g_task_get_task_data(task);
+
+  data->system_connection = g_bus_get_finish(result, &data->system_error);
+  data->system_done = TRUE;
+  if (data->system_connection == NULL) {
+    set_last_error(g_task_get_source_object(task), data->system_error->message);
   }
+  maybe_create_proxy(task);
+}
 
-  set_last_error(self, NULL);
+static void
+session_bus_get_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  ConnectData *data = g_task_get_task_data(task);
+
+  data->session_connection = g_bus_get_finish(result, &data->session_error);
+  data->session_done = TRUE;
+  maybe_create_proxy(task);
+}
+
+static void
+gnomeddc_client_init_async(GAsyncInitable *initable,
+                           int io_priority,
+                           GCancellable *cancellable,
+                           GAsyncReadyCallback callback,
+                           gpointer user_data)
+{
+  GnomeDdcClient *self = GNOMEDDC_CLIENT(initable);
+  GTask *task = g_task_new(self, cancellable, callback, user_data);
+  g_task_set_source_tag(task, gnomeddc_client_init_async);
+  g_task_set_priority(task, io_priority);
+  g_task_set_task_data(task, g_new0(ConnectData, 1), (GDestroyNotify) connect_data_free);
+
+  g_bus_get(G_BUS_TYPE_SYSTEM, cancellable, system_bus_get_cb, g_object_ref(task));
+  g_bus_get(G_BUS_TYPE_SESSION, cancellable, session_bus_get_cb, g_object_ref(task));
+  g_object_unref(task);
+}
+
+static gboolean
+gnomeddc_client_init_finish(GAsyncInitable *initable,
+                            GAsyncResult *result,
+                            GError **error)
+{
+  g_return_val_if_fail(g_task_is_valid(result, initable), FALSE);
+  return g_task_propagate_boolean(G_TASK(result), error);
+}
+
+static void
+gnomeddc_client_async_initable_iface_init(GAsyncInitableIface *iface)
+{
+  iface->init_async = gnomeddc_client_init_async;
+  iface->init_finish = gnomeddc_client_init_finish;
 }
 
 static void
 gnomeddc_client_finalize(GObject *object)
 {
   GnomeDdcClient *self = GNOMEDDC_CLIENT(object);
+  g_clear_object(&self->service_properties);
   g_clear_object(&self->proxy);
+  g_clear_object(&self->vcp_cache);
+  g_clear_object(&self->call_stats);
+  g_clear_pointer(&self->method_timeouts, g_hash_table_unref);
+  g_clear_pointer(&self->display_in_flight, g_hash_table_unref);
+  g_clear_pointer(&self->retry_budgets, g_hash_table_unref);
+  g_clear_pointer(&self->pending_reads, g_hash_table_unref);
   g_clear_pointer(&self->last_error, g_free);
   G_OBJECT_CLASS(gnomeddc_client_parent_class)->finalize(object);
 }
@@ -80,20 +332,114 @@ static void
 gnomeddc_client_class_init(GnomeDdcClientClass *klass)
 {
   GObjectClass *object_class = G_OBJECT_CLASS(klass);
-  object_class->constructed = gnomeddc_client_constructed;
   object_class->finalize = gnomeddc_client_finalize;
+
+  /* Emitted once the proxy for ddcutil-service is ready. */
+  signals[SIGNAL_CONNECTED] =
+    g_signal_new("connected",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 0);
+
+  /* Emitted when neither bus could provide a proxy; carries the error message. */
+  signals[SIGNAL_CONNECTION_FAILED] =
+    g_signal_new("connection-failed",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 1, G_TYPE_STRING);
+
+  /* ConnectedDisplaysChanged: EDID, raw DDCA event type and flags. Use
+   * gnomeddc_client_classify_display_event() to interpret the event type. */
+  signals[SIGNAL_DISPLAYS_CHANGED] =
+    g_signal_new("displays-changed",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 3, G_TYPE_STRING, G_TYPE_INT, G_TYPE_UINT);
+
+  /* VcpValueChanged: display number, EDID, code, new value, the name and
+   * context of the client that made the change, and flags. */
+  signals[SIGNAL_VCP_VALUE_CHANGED] =
+    g_signal_new("vcp-value-changed",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 7,
+                 G_TYPE_INT, G_TYPE_STRING, G_TYPE_UINT, G_TYPE_UINT,
+                 G_TYPE_STRING, G_TYPE_STRING, G_TYPE_UINT);
+
+  /* ServiceInitialized: the service (re)started and forgot every display. */
+  signals[SIGNAL_SERVICE_INITIALIZED] =
+    g_signal_new("service-initialized",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 1, G_TYPE_UINT);
 }
 
 static void
 gnomeddc_client_init(GnomeDdcClient *self)
 {
   self->bus_type = GNOMEDDC_CLIENT_BUS_SYSTEM;
+  self->vcp_cache = gnomeddc_vcp_cache_new();
+  self->call_stats = gnomeddc_call_stats_new();
+  self->service_properties = gnomeddc_service_properties_new();
+  self->default_timeout = DEFAULT_TIMEOUT_MSEC;
+  self->method_timeouts = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, NULL);
+  self->display_in_flight = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, NULL);
+  self->max_in_flight = DEFAULT_MAX_IN_FLIGHT;
+  self->max_in_flight_per_display = DEFAULT_MAX_IN_FLIGHT_PER_DISPLAY;
+  self->max_retries = DEFAULT_MAX_RETRIES;
+  self->retry_deadline_usec = DEFAULT_RETRY_DEADLINE_MSEC * G_TIME_SPAN_MILLISECOND;
+  self->retry_budgets = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL, g_free);
+  self->pending_reads = g_hash_table_new(g_str_hash, g_str_equal);
+  for (guint i = 0; i < N_CALL_LANES; i++) {
+    g_queue_init(&self->lanes[i]);
+  }
+
+  /* Full bus scans and capability reads legitimately take several seconds. */
+  gnomeddc_client_set_method_timeout(self, "Detect", 60000);
+  gnomeddc_client_set_method_timeout(self, "GetCapabilitiesString", 20000);
+  gnomeddc_client_set_method_timeout(self, "GetCapabilitiesMetadata", 20000);
+  gnomeddc_client_set_method_timeout(self, "Restart", 30000);
 }
 
+/* Returns immediately; both buses are probed in the background and
+ * "connected" or "connection-failed" is emitted once the outcome is known. */
 GnomeDdcClient *
 gnomeddc_client_new(void)
 {
-  return g_object_new(GNOMEDDC_TYPE_CLIENT, NULL);
+  GnomeDdcClient *self = g_object_new(GNOMEDDC_TYPE_CLIENT, NULL);
+  g_async_initable_init_async(G_ASYNC_INITABLE(self), G_PRIORITY_DEFAULT, NULL, NULL, NULL);
+  return self;
+}
+
+void
+gnomeddc_client_new_async(GCancellable *cancellable,
+                          GAsyncReadyCallback callback,
+                          gpointer user_data)
+{
+  g_async_initable_new_async(GNOMEDDC_TYPE_CLIENT,
+                             G_PRIORITY_DEFAULT,
+                             cancellable,
+                             callback,
+                             user_data,
+                             NULL);
+}
+
+GnomeDdcClient *
+gnomeddc_client_new_finish(GAsyncResult *result, GError **error)
+{
+  g_autoptr(GObject) source = g_async_result_get_source_object(result);
+  GObject *object = g_async_initable_new_finish(G_ASYNC_INITABLE(source), result, error);
+  return object != NULL ? GNOMEDDC_CLIENT(object) : NULL;
 }
 
 GDBusProxy *
@@ -124,6 +470,89 @@ gnomeddc_client_get_last_error(GnomeDdcClient *self)
   return self->last_error;
 }
 
+GnomeDdcVcpCache *
+gnomeddc_client_get_vcp_cache(GnomeDdcClient *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(self), NULL);
+  return self->vcp_cache;
+}
+
+void
+gnomeddc_client_set_default_timeout(GnomeDdcClient *self, gint timeout_msec)
+{
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
+  g_return_if_fail(timeout_msec > 0);
+  self->default_timeout = timeout_msec;
+}
+
+/* A timeout of zero or less makes the method use the default again. */
+void
+gnomeddc_client_set_method_timeout(GnomeDdcClient *self, const gchar *method, gint timeout_msec)
+{
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
+  g_return_if_fail(method != NULL);
+
+  if (timeout_msec <= 0) {
+    g_hash_table_remove(self->method_timeouts, method);
+    return;
+  }
+
+  g_hash_table_replace(self->method_timeouts, g_strdup(method), GINT_TO_POINTER(timeout_msec));
+}
+
+gint
+gnomeddc_client_get_method_timeout(GnomeDdcClient *self, const gchar *method)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(self), -1);
+
+  gpointer value = NULL;
+  if (method != NULL && g_hash_table_lookup_extended(self->method_timeouts, method, NULL, &value)) {
+    return GPOINTER_TO_INT(value);
+  }
+  return self->default_timeout;
+}
+
+/* Limits how many calls are outstanding at the service, in total and per
+ * display; zero lifts a limit. Calls beyond the limits wait in the client. */
+void
+gnomeddc_client_set_call_limits(GnomeDdcClient *self,
+                                guint max_in_flight,
+                                guint max_in_flight_per_display)
+{
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
+
+  self->max_in_flight = max_in_flight;
+  self->max_in_flight_per_display = max_in_flight_per_display;
+  pump_calls(self);
+}
+
+/* Idempotent calls whose reply carries a transient ddcutil status are sent
+ * again, at most @max_retries times and only while @deadline_msec after the
+ * first attempt has not passed. Zero @max_retries turns retrying off. */
+void
+gnomeddc_client_set_retry_policy(GnomeDdcClient *self,
+                                 guint max_retries,
+                                 guint deadline_msec)
+{
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
+
+  self->max_retries = max_retries;
+  self->retry_deadline_usec = (gint64) deadline_msec * G_TIME_SPAN_MILLISECOND;
+}
+
+/* Number of calls waiting for an in-flight slot. */
+guint
+gnomeddc_client_get_n_queued(GnomeDdcClient *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(self), 0);
+
+  guint n_queued = 0;
+  for (guint lane = 0; lane < N_CALL_LANES; lane++) {
+    n_queued += self->lanes[lane].length;
+  }
+  return n_queued;
+}
+
 static GVariant *
 ensure_parameters(GVariant *parameters)
 {
@@ -134,6 +563,650 @@ ensure_parameters(GVariant *parameters)
   return g_variant_ref_sink(g_variant_new_tuple(NULL, 0));
 }
 
+typedef struct {
+  gchar *method;
+  GVariant *parameters;
+  gint64 start_time;
+  /* when the first attempt was queued, and how many retries followed */
+  gint64 first_queued;
+  guint retries;
+  GnomeDdcCallFlags flags;
+  CallLane lane;
+  gint64 deadline;
+  /* 0 for calls that do not address a display */
+  guint64 display_id;
+  /* 0 when the VCP cache does not hold the display, as without an EDID */
+  guint64 cache_id;
+  /* -1 for calls that do not address a display; only used for tracing */
+  gint display_number;
+  /* NULL for calls that cannot be shared */
+  gchar *read_key;
+  GCancellable *cancellable;
+  gulong cancelled_id;
+  /* Set on the call that went to the service for a shared read */
+  struct _PendingRead *pending;
+} CallData;
+
+/* Identical reads that are in flight together share one call. The first
+ * one goes to the service; the others wait for its reply, and those that
+ * were cancelled meanwhile complete with G_IO_ERROR_CANCELLED then. */
+typedef struct _PendingRead {
+  gchar *key;
+  guint64 display_id;
+  GTask *leader;
+  GQueue followers;
+} PendingRead;
+
+static void
+call_data_free(CallData *data)
+{
+  g_free(data->method);
+  g_clear_pointer(&data->parameters, g_variant_unref);
+  g_free(data->read_key);
+  g_clear_object(&data->cancellable);
+  g_free(data);
+}
+
+static void
+pending_read_free(PendingRead *pending)
+{
+  g_queue_clear_full(&pending->followers, g_object_unref);
+  g_free(pending->key);
+  g_free(pending);
+}
+
+/* Per-display reads whose reply depends only on the arguments and the
+ * monitor's state. */
+static gboolean
+is_shareable_read(const gchar *method)
+{
+  static const gchar * const methods[] = {
+    "GetVcp",
+    "GetMultipleVcp",
+    "GetVcpMetadata",
+    "GetCapabilitiesString",
+    "GetCapabilitiesMetadata",
+    "GetDisplayState",
+    "GetSleepMultiplier",
+    NULL
+  };
+
+  return g_strv_contains(methods, method);
+}
+
+/* The method, the display identity and every argument after the
+ * (display_number, edid) prefix; the number is not part of the identity
+ * once an EDID is known. */
+static gchar *
+dup_read_key(const gchar *method, guint64 display_id, GVariant *parameters)
+{
+  GString *key = g_string_new(method);
+
+  g_string_append_printf(key, "\n%016" G_GINT64_MODIFIER "x", display_id);
+  for (gsize i = 2; i < g_variant_n_children(parameters); i++) {
+    g_autoptr(GVariant) child = g_variant_get_child_value(parameters, i);
+    g_string_append_c(key, '\n');
+    g_variant_print_string(child, key, TRUE);
+  }
+  return g_string_free(key, FALSE);
+}
+
+/* Stops later reads of @display_id, or of every display when 0, from
+ * joining calls that started before a write. Calls already joined still
+ * get the reply they asked for. */
+static void
+detach_pending_reads(GnomeDdcClient *self, guint64 display_id)
+{
+  GHashTableIter iter;
+  gpointer value;
+
+  g_hash_table_iter_init(&iter, self->pending_reads);
+  while (g_hash_table_iter_next(&iter, NULL, &value)) {
+    PendingRead *pending = value;
+    if (display_id == 0 || pending->display_id == display_id) {
+      g_hash_table_iter_remove(&iter);
+    }
+  }
+}
+
+static void
+start_pending_read(GnomeDdcClient *self, GTask *task, GQueue *followers)
+{
+  CallData *data = g_task_get_task_data(task);
+  PendingRead *pending = g_new0(PendingRead, 1);
+
+  pending->key = g_strdup(data->read_key);
+  pending->display_id = data->display_id;
+  pending->leader = task;
+  g_queue_init(&pending->followers);
+  if (followers != NULL) {
+    pending->followers = *followers;
+    g_queue_init(followers);
+  }
+  data->pending = pending;
+  /* A newer call for the same read may already exist if this one takes
+   * over from a detached call; later reads join the newer one. */
+  if (!g_hash_table_contains(self->pending_reads, pending->key)) {
+    g_hash_table_insert(self->pending_reads, pending->key, pending);
+  }
+}
+
+/* Completes @task, and the reads that joined it, with @response or
+ * @error; takes ownership of both. When only the call that went out was
+ * cancelled, the first follower still waiting is sent in its place. */
+static void
+return_call(GnomeDdcClient *self, GTask *task, GVariant *response, GError *error)
+{
+  CallData *data = g_task_get_task_data(task);
+  PendingRead *pending = g_steal_pointer(&data->pending);
+
+  if (pending != NULL && g_hash_table_lookup(self->pending_reads, pending->key) == pending) {
+    g_hash_table_remove(self->pending_reads, pending->key);
+  }
+
+  if (response != NULL) {
+    g_task_return_pointer(task, g_variant_ref(response), (GDestroyNotify) g_variant_unref);
+  } else {
+    g_task_return_error(task, g_error_copy(error));
+  }
+
+  if (pending != NULL) {
+    gboolean leader_cancelled = g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    GTask *follower;
+
+    while ((follower = g_queue_pop_head(&pending->followers)) != NULL) {
+      if (g_task_return_error_if_cancelled(follower)) {
+        g_object_unref(follower);
+        continue;
+      }
+      if (leader_cancelled) {
+        start_pending_read(self, follower, &pending->followers);
+        enqueue_call(self, follower);
+        break;
+      }
+      if (response != NULL) {
+        g_task_return_pointer(follower, g_variant_ref(response), (GDestroyNotify) g_variant_unref);
+      } else {
+        g_task_return_error(follower, g_error_copy(error));
+      }
+      g_object_unref(follower);
+    }
+    pending_read_free(pending);
+  }
+
+  g_clear_pointer(&response, g_variant_unref);
+  g_clear_error(&error);
+}
+
+static CallLane
+classify_call_lane(const gchar *method, GnomeDdcCallFlags flags)
+{
+  static const gchar * const write_methods[] = {
+    "SetVcp",
+    "SetVcpWithContext",
+    "SetSleepMultiplier",
+    "Restart",
+    "org.freedesktop.DBus.Properties.Set",
+    NULL
+  };
+  static const gchar * const slow_methods[] = {
+    "Detect",
+    "GetCapabilitiesString",
+    "GetCapabilitiesMetadata",
+    NULL
+  };
+
+  if ((flags & GNOMEDDC_CALL_FLAGS_BACKGROUND) != 0 || g_strv_contains(slow_methods, method)) {
+    return CALL_LANE_BACKGROUND;
+  }
+  if (g_strv_contains(write_methods, method)) {
+    return CALL_LANE_WRITE;
+  }
+  return CALL_LANE_READ;
+}
+
+/* Every per-display method takes (display_number, edid, ...). The EDID is
+ * the stable identity; the number is only used when no EDID was given,
+ * and such displays are not cached. Calls that address no display get a
+ * number of -1 and ids of 0. */
+static void
+parse_call_display(GVariant *parameters, gint *display_number, guint64 *display_id, guint64 *cache_id)
+{
+  *display_number = -1;
+  *display_id = 0;
+  *cache_id = 0;
+
+  if (!g_str_has_prefix(g_variant_get_type_string(parameters), "(is")) {
+    return;
+  }
+
+  g_autoptr(GVariant) number_value = g_variant_get_child_value(parameters, 0);
+  g_autoptr(GVariant) edid_value = g_variant_get_child_value(parameters, 1);
+  const gchar *edid = g_variant_get_string(edid_value, NULL);
+  *display_number = g_variant_get_int32(number_value);
+
+  if (*edid != '\0') {
+    *display_id = gnomeddc_display_id_for_edid(edid);
+    *cache_id = *display_id;
+  } else {
+    g_autofree gchar *key = g_strdup_printf("#%d", *display_number);
+    *display_id = gnomeddc_edid_hash((const guint8 *) key, strlen(key));
+  }
+}
+
+static void call_done_cb(GObject *source, GAsyncResult *result, gpointer user_data);
+
+static gboolean
+display_has_capacity(GnomeDdcClient *self, CallData *data)
+{
+  if (data->display_id == 0 || self->max_in_flight_per_display == 0) {
+    return TRUE;
+  }
+  guint n = GPOINTER_TO_UINT(g_hash_table_lookup(self->display_in_flight, &data->display_id));
+  return n < self->max_in_flight_per_display;
+}
+
+static void
+dispatch_call(GnomeDdcClient *self, GTask *task)
+{
+  CallData *data = g_task_get_task_data(task);
+
+  if (data->cancelled_id != 0) {
+    g_cancellable_disconnect(data->cancellable, data->cancelled_id);
+    data->cancelled_id = 0;
+  }
+
+  self->n_in_flight++;
+  if (data->display_id != 0) {
+    guint n = GPOINTER_TO_UINT(g_hash_table_lookup(self->display_in_flight, &data->display_id));
+    g_hash_table_replace(self->display_in_flight, g_memdup2(&data->display_id, sizeof(data->display_id)),
+                         GUINT_TO_POINTER(n + 1));
+  }
+
+  gnomeddc_trace_mark(data->deadline - lane_delay_usec[data->lane], "client", "queued",
+                      "%s display %d", data->method, data->display_number);
+  data->start_time = gnomeddc_call_stats_begin(self->call_stats, data->method);
+  g_dbus_proxy_call(self->proxy,
+                    data->method,
+                    data->parameters,
+                    G_DBUS_CALL_FLAGS_NONE,
+                    gnomeddc_client_get_method_timeout(self, data->method),
+                    data->cancellable,
+                    call_done_cb,
+                    task);
+}
+
+static void
+release_call(GnomeDdcClient *self, CallData *data)
+{
+  self->n_in_flight--;
+  if (data->display_id != 0) {
+    guint n = GPOINTER_TO_UINT(g_hash_table_lookup(self->display_in_flight, &data->display_id));
+    if (n > 1) {
+      g_hash_table_replace(self->display_in_flight, g_memdup2(&data->display_id, sizeof(data->display_id)),
+                           GUINT_TO_POINTER(n - 1));
+    } else {
+      g_hash_table_remove(self->display_in_flight, &data->display_id);
+    }
+  }
+}
+
+/* Completes queued calls whose cancellable fired. */
+static void
+drop_cancelled_calls(GnomeDdcClient *self)
+{
+  for (guint lane = 0; lane < N_CALL_LANES; lane++) {
+    GList *link = self->lanes[lane].head;
+    while (link != NULL) {
+      GList *next = link->next;
+      GTask *task = link->data;
+      CallData *data = g_task_get_task_data(task);
+
+      if (g_cancellable_is_cancelled(data->cancellable)) {
+        g_queue_delete_link(&self->lanes[lane], link);
+        g_cancellable_disconnect(data->cancellable, data->cancelled_id);
+        data->cancelled_id = 0;
+        GError *error = NULL;
+        g_cancellable_set_error_if_cancelled(data->cancellable, &error);
+        return_call(self, task, NULL, error);
+        g_object_unref(task);
+      }
+      link = next;
+    }
+  }
+}
+
+static void
+pump_calls(GnomeDdcClient *self)
+{
+  while (self->max_in_flight == 0 || self->n_in_flight < self->max_in_flight) {
+    GQueue *best_lane = NULL;
+    GList *best_link = NULL;
+    gint64 best_deadline = G_MAXINT64;
+
+    /* Deadlines only grow along a lane, so the first call that may run is
+     * the lane's candidate. */
+    for (guint lane = 0; lane < N_CALL_LANES; lane++) {
+      for (GList *link = self->lanes[lane].head; link != NULL; link = link->next) {
+        CallData *data = g_task_get_task_data(link->data);
+        if (!display_has_capacity(self, data)) {
+          continue;
+        }
+        if (data->deadline < best_deadline) {
+          best_lane = &self->lanes[lane];
+          best_link = link;
+          best_deadline = data->deadline;
+        }
+        break;
+      }
+    }
+
+    if (best_link == NULL) {
+      return;
+    }
+
+    GTask *task = best_link->data;
+    g_queue_delete_link(best_lane, best_link);
+    dispatch_call(self, task);
+  }
+}
+
+static gboolean
+pump_calls_idle_cb(gpointer user_data)
+{
+  GnomeDdcClient *self = GNOMEDDC_CLIENT(user_data);
+  self->pump_source_id = 0;
+  drop_cancelled_calls(self);
+  pump_calls(self);
+  return G_SOURCE_REMOVE;
+}
+
+/* Runs from g_cancellable_cancel(), where the handler cannot be
+ * disconnected yet; the queue is cleaned up from an idle instead. */
+static void
+queued_call_cancelled_cb(GCancellable *cancellable G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcClient *self = GNOMEDDC_CLIENT(user_data);
+  if (self->pump_source_id == 0) {
+    self->pump_source_id = g_idle_add_full(G_PRIORITY_DEFAULT,
+                                           pump_calls_idle_cb,
+                                           g_object_ref(self),
+                                           g_object_unref);
+  }
+}
+
+static void
+enqueue_call(GnomeDdcClient *self, GTask *task)
+{
+  CallData *data = g_task_get_task_data(task);
+
+  data->deadline = g_get_monotonic_time() + lane_delay_usec[data->lane];
+  g_queue_push_tail(&self->lanes[data->lane], task);
+  if (data->cancellable != NULL) {
+    data->cancelled_id = g_cancellable_connect(data->cancellable,
+                                               G_CALLBACK(queued_call_cancelled_cb),
+                                               self, NULL);
+  }
+  pump_calls(self);
+}
+
+/* Answers GetVcp and GetMultipleVcp from the VCP cache when every requested
+ * feature is still fresh; returns NULL when the service has to be asked. */
+static GVariant *
+lookup_cached_response(GnomeDdcClient *self, const gchar *method, GVariant *parameters, guint64 cache_id)
+{
+  guint16 current = 0;
+  guint16 max_value = 0;
+  const gchar *formatted = NULL;
+  const gchar *message = NULL;
+
+  if (g_strcmp0(method, "GetVcp") == 0 &&
+      g_variant_is_of_type(parameters, G_VARIANT_TYPE("(isyu)"))) {
+    guint8 code;
+    guint flags;
+    g_variant_get(parameters, "(i&syu)", NULL, NULL, &code, &flags);
+    if (!gnomeddc_vcp_cache_lookup(self->vcp_cache, cache_id, code, flags,
+                                   &current, &max_value, &formatted, &message)) {
+      return NULL;
+    }
+    return g_variant_ref_sink(g_variant_new("(qqsis)", current, max_value, formatted, 0, message));
+  }
+
+  if (g_strcmp0(method, "GetMultipleVcp") == 0 &&
+      g_variant_is_of_type(parameters, G_VARIANT_TYPE("(isayu)"))) {
+    g_autoptr(GVariant) codes = NULL;
+    guint flags;
+    g_variant_get(parameters, "(i&s@ayu)", NULL, NULL, &codes, &flags);
+
+    gsize n_codes = 0;
+    const guint8 *code_data = g_variant_get_fixed_array(codes, &n_codes, sizeof(guint8));
+    if (n_codes == 0) {
+      return NULL;
+    }
+
+    GVariantBuilder builder;
+    g_variant_builder_init(&builder, G_VARIANT_TYPE("a(yqqs)"));
+    for (gsize i = 0; i < n_codes; i++) {
+      if (!gnomeddc_vcp_cache_lookup(self->vcp_cache, cache_id, code_data[i], flags,
+                                     &current, &max_value, &formatted, &message)) {
+        g_variant_builder_clear(&builder);
+        return NULL;
+      }
+      g_variant_builder_add(&builder, "(yqqs)", code_data[i], current, max_value, formatted);
+    }
+    return g_variant_ref_sink(g_variant_new("(a(yqqs)is)", &builder, 0, message));
+  }
+
+  return NULL;
+}
+
+static void
+update_vcp_cache(GnomeDdcClient *self, const gchar *method, GVariant *parameters, guint64 cache_id, GVariant *response)
+{
+  if (g_strcmp0(method, "GetVcp") == 0 &&
+      g_variant_is_of_type(parameters, G_VARIANT_TYPE("(isyu)")) &&
+      g_variant_is_of_type(response, G_VARIANT_TYPE("(qqsis)"))) {
+    guint8 code;
+    guint flags;
+    guint16 current;
+    guint16 max_value;
+    const gchar *formatted;
+    gint status;
+    const gchar *message;
+    g_variant_get(parameters, "(i&syu)", NULL, NULL, &code, &flags);
+    g_variant_get(response, "(qq&si&s)", &current, &max_value, &formatted, &status, &message);
+    if (status == 0) {
+      gnomeddc_vcp_cache_store(self->vcp_cache, cache_id, code, flags, current, max_value, formatted, message);
+    }
+  } else if (g_strcmp0(method, "GetMultipleVcp") == 0 &&
+             g_variant_is_of_type(parameters, G_VARIANT_TYPE("(isayu)")) &&
+             g_variant_is_of_type(response, G_VARIANT_TYPE("(a(yqqs)is)"))) {
+    guint flags;
+    g_autoptr(GVariantIter) values = NULL;
+    gint status;
+    const gchar *message;
+    g_variant_get(parameters, "(i&sayu)", NULL, NULL, NULL, &flags);
+    g_variant_get(response, "(a(yqqs)i&s)", &values, &status, &message);
+    if (status != 0) {
+      return;
+    }
+
+    guint8 code;
+    guint16 current;
+    guint16 max_value;
+    const gchar *formatted;
+    while (g_variant_iter_next(values, "(yqq&s)", &code, &current, &max_value, &formatted)) {
+      gnomeddc_vcp_cache_store(self->vcp_cache, cache_id, code, flags, current, max_value, formatted, message);
+    }
+  } else if ((g_strcmp0(method, "SetVcp") == 0 &&
+              g_variant_is_of_type(parameters, G_VARIANT_TYPE("(isyqu)"))) ||
+             (g_strcmp0(method, "SetVcpWithContext") == 0 &&
+              g_variant_is_of_type(parameters, G_VARIANT_TYPE("(isyqsu)")))) {
+    g_autoptr(GVariant) code_value = g_variant_get_child_value(parameters, 2);
+    gnomeddc_vcp_cache_invalidate(self->vcp_cache, cache_id, g_variant_get_byte(code_value));
+  }
+}
+
+/* Reads, and writes of absolute values, can be repeated without changing
+ * the outcome; Detect, Restart and the setters cannot. */
+static gboolean
+is_idempotent_method(const gchar *method)
+{
+  static const gchar * const methods[] = {
+    "GetVcp",
+    "GetMultipleVcp",
+    "GetVcpMetadata",
+    "GetCapabilitiesString",
+    "GetCapabilitiesMetadata",
+    "GetDisplayState",
+    "GetSleepMultiplier",
+    "SetVcp",
+    "SetVcpWithContext",
+    NULL
+  };
+
+  return g_strv_contains(methods, method);
+}
+
+/* Whether the (…is) tail of @response reports a transient DDC failure. The
+ * codes are matched by name through the service's StatusValues, since the
+ * numbers differ between ddcutil releases; without the table nothing
+ * counts as transient. */
+static gboolean
+is_retryable_response(GnomeDdcClient *self, GVariant *response)
+{
+  static const gchar * const transient_names[] = {
+    "DDCRC_DDC_DATA",
+    "DDCRC_NULL_RESPONSE",
+    "DDCRC_READ_ALL_ZERO",
+    "DDCRC_ALL_TRIES_ZERO",
+    "DDCRC_ALL_RESPONSES_NULL",
+    "DDCRC_MULTI_PART_READ_FRAGMENT",
+    "DDCRC_RETRIES",
+    "DDCRC_BAD_DATA",
+    NULL
+  };
+
+  gsize n_children = g_variant_n_children(response);
+  if (n_children < 2) {
+    return FALSE;
+  }
+  g_autoptr(GVariant) status = g_variant_get_child_value(response, n_children - 2);
+  if (!g_variant_is_of_type(status, G_VARIANT_TYPE_INT32) || g_variant_get_int32(status) == 0) {
+    return FALSE;
+  }
+
+  const gchar *name = gnomeddc_service_properties_lookup_name(self->service_properties,
+                                                              "StatusValues",
+                                                              g_variant_get_int32(status));
+  return name != NULL && g_strv_contains(transient_names, name);
+}
+
+/* Takes one retry from the display's budget, if any is left. */
+static gboolean
+take_retry_budget(GnomeDdcClient *self, guint64 display_id, gint64 now)
+{
+  RetryBudget *budget = g_hash_table_lookup(self->retry_budgets, &display_id);
+  if (budget == NULL) {
+    budget = g_new0(RetryBudget, 1);
+    budget->display_id = display_id;
+    g_hash_table_insert(self->retry_budgets, &budget->display_id, budget);
+  }
+  if (now - budget->window_start >= RETRY_BUDGET_WINDOW_USEC) {
+    budget->window_start = now;
+    budget->used = 0;
+  }
+  if (budget->used >= RETRY_BUDGET_PER_DISPLAY) {
+    return FALSE;
+  }
+  budget->used++;
+  return TRUE;
+}
+
+static guint
+retry_backoff_msec(guint retry)
+{
+  guint backoff = RETRY_BASE_MSEC << MIN(retry, 8);
+  backoff = MIN(backoff, RETRY_MAX_BACKOFF_MSEC);
+  return backoff / 2 + (guint) g_random_int_range(0, (gint32) (backoff / 2) + 1);
+}
+
+static gboolean
+retry_call_cb(gpointer user_data)
+{
+  GTask *task = user_data;
+  GnomeDdcClient *self = g_task_get_source_object(task);
+  CallData *data = g_task_get_task_data(task);
+
+  GError *error = NULL;
+  if (g_cancellable_set_error_if_cancelled(data->cancellable, &error)) {
+    return_call(self, task, NULL, error);
+    return G_SOURCE_REMOVE;
+  }
+
+  gnomeddc_call_stats_record_retry(self->call_stats, data->method);
+  enqueue_call(self, g_object_ref(task));
+  return G_SOURCE_REMOVE;
+}
+
+/* Schedules another attempt of @task when its reply was a transient
+ * failure and the policy, the deadline and the display's budget all allow
+ * one. The task goes back through the lanes, so a retry waits for a free
+ * slot like any other call. */
+static gboolean
+maybe_retry_call(GnomeDdcClient *self, GTask *task, GVariant *response)
+{
+  CallData *data = g_task_get_task_data(task);
+
+  if (data->retries >= self->max_retries ||
+      (data->flags & GNOMEDDC_CALL_FLAGS_NO_RETRY) != 0 ||
+      data->display_id == 0 ||
+      !is_idempotent_method(data->method) ||
+      !is_retryable_response(self, response) ||
+      g_cancellable_is_cancelled(data->cancellable)) {
+    return FALSE;
+  }
+
+  guint backoff = retry_backoff_msec(data->retries);
+  gint64 now = g_get_monotonic_time();
+  if (now + (gint64) backoff * G_TIME_SPAN_MILLISECOND > data->first_queued + self->retry_deadline_usec ||
+      !take_retry_budget(self, data->display_id, now)) {
+    return FALSE;
+  }
+
+  data->retries++;
+  g_timeout_add_full(G_PRIORITY_DEFAULT, backoff, retry_call_cb,
+                     g_object_ref(task), g_object_unref);
+  return TRUE;
+}
+
+static void
+call_done_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  GnomeDdcClient *self = g_task_get_source_object(task);
+  CallData *data = g_task_get_task_data(task);
+  GError *error = NULL;
+
+  GVariant *response = g_dbus_proxy_call_finish(G_DBUS_PROXY(source), result, &error);
+  gnomeddc_call_stats_end(self->call_stats, data->method, data->start_time, response, error);
+  gnomeddc_trace_mark(data->start_time, "client", data->method, "display %d%s",
+                      data->display_number, response != NULL ? "" : " failed");
+  release_call(self, data);
+  pump_calls(self);
+  if (response == NULL) {
+    return_call(self, task, NULL, error);
+    return;
+  }
+  if (maybe_retry_call(self, task, response)) {
+    g_variant_unref(response);
+    return;
+  }
+
+  update_vcp_cache(self, data->method, data->parameters, data->cache_id, response);
+  return_call(self, task, response, NULL);
+}
+
 void
 gnomeddc_client_call_async(GnomeDdcClient *self,
                                 const gchar *method,
@@ -141,27 +1214,83 @@ gnomeddc_client_call_async(GnomeDdcClient *self,
                                 GCancellable *cancellable,
                                 GAsyncReadyCallback callback,
                                 gpointer user_data)
+{
+  gnomeddc_client_call_full_async(self, method, parameters, GNOMEDDC_CALL_FLAGS_NONE,
+                                  cancellable, callback, user_data);
+}
+
+/* Like gnomeddc_client_call_async(); finish with gnomeddc_client_call_finish(). */
+void
+gnomeddc_client_call_full_async(GnomeDdcClient *self,
+                                const gchar *method,
+                                GVariant *parameters,
+                                GnomeDdcCallFlags flags,
+                                GCancellable *cancellable,
+                                GAsyncReadyCallback callback,
+                                gpointer user_data)
 {
   g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
   g_return_if_fail(method != NULL);
 
+  GVariant *params = ensure_parameters(parameters);
+  GTask *task = g_task_new(self, cancellable, callback, user_data);
+  g_task_set_source_tag(task, gnomeddc_client_call_async);
+
   if (self->proxy == NULL) {
-    GTask *task = g_task_new(self, cancellable, callback, user_data);
     g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", self->last_error ? self->last_error : "Proxy unavailable");
     g_object_unref(task);
+    g_variant_unref(params);
     return;
   }
 
-  GVariant *params = ensure_parameters(parameters);
-  g_dbus_proxy_call(self->proxy,
-                    method,
-                    params,
-                    G_DBUS_CALL_FLAGS_NONE,
-                    -1,
-                    cancellable,
-                    callback,
-                    user_data);
-  g_variant_unref(params);
+  gint display_number;
+  guint64 display_id;
+  guint64 cache_id;
+  parse_call_display(params, &display_number, &display_id, &cache_id);
+
+  GVariant *cached = NULL;
+  if ((flags & GNOMEDDC_CALL_FLAGS_BYPASS_CACHE) == 0) {
+    cached = lookup_cached_response(self, method, params, cache_id);
+  }
+  if (cached != NULL) {
+    gnomeddc_call_stats_record_cache_hit(self->call_stats, method);
+    g_task_return_pointer(task, cached, (GDestroyNotify) g_variant_unref);
+    g_object_unref(task);
+    g_variant_unref(params);
+    return;
+  }
+
+  CallData *data = g_new0(CallData, 1);
+  data->method = g_strdup(method);
+  data->parameters = params;
+  data->flags = flags;
+  data->lane = classify_call_lane(method, flags);
+  data->display_number = display_number;
+  data->display_id = display_id;
+  data->cache_id = cache_id;
+  data->cancellable = cancellable != NULL ? g_object_ref(cancellable) : NULL;
+  data->first_queued = g_get_monotonic_time();
+  g_task_set_task_data(task, data, (GDestroyNotify) call_data_free);
+
+  if (data->lane == CALL_LANE_WRITE) {
+    /* A read that started before the write may return the old value.
+     * Writes that address no display, like Restart, affect all of them. */
+    detach_pending_reads(self, data->display_id);
+  } else if (data->display_id != 0 && is_shareable_read(method) &&
+             (flags & GNOMEDDC_CALL_FLAGS_NO_RETRY) == 0) {
+    /* A shared leader may be retried, which a NO_RETRY caller opted out of. */
+    data->read_key = dup_read_key(method, data->display_id, params);
+    PendingRead *pending = g_hash_table_lookup(self->pending_reads, data->read_key);
+    if (pending != NULL) {
+      /* Answered without a transaction of its own, like a cache hit. */
+      gnomeddc_call_stats_record_cache_hit(self->call_stats, method);
+      g_queue_push_tail(&pending->followers, task);
+      return;
+    }
+    start_pending_read(self, task, NULL);
+  }
+
+  enqueue_call(self, task);
 }
 
 GVariant *
@@ -170,14 +1299,182 @@ gnomeddc_client_call_finish(GnomeDdcClient *self,
                                       GError **error)
 {
   g_return_val_if_fail(GNOMEDDC_IS_CLIENT(self), NULL);
-  g_return_val_if_fail(G_IS_ASYNC_RESULT(result), NULL);
+  g_return_val_if_fail(g_task_is_valid(result, self), NULL);
 
-  if (self->proxy == NULL) {
-    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", self->last_error ? self->last_error : "Proxy unavailable");
-    return NULL;
+  return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+/* Builds (i s ...) from the display's cached prefix and @args, which may
+ * be floating. */
+static void
+call_display_method(GnomeDdcClient *self,
+                    const gchar *method,
+                    GnomeDdcDisplay *display,
+                    GVariant **args,
+                    gsize n_args,
+                    GnomeDdcCallFlags call_flags,
+                    GCancellable *cancellable,
+                    GAsyncReadyCallback callback,
+                    gpointer user_data)
+{
+  GVariant *children[5];
+  g_assert(n_args + 2 <= G_N_ELEMENTS(children));
+
+  gnomeddc_display_get_call_prefix(display, &children[0], &children[1]);
+  for (gsize i = 0; i < n_args; i++) {
+    children[i + 2] = args[i];
+  }
+  gnomeddc_client_call_full_async(self, method, g_variant_new_tuple(children, n_args + 2),
+                                  call_flags, cancellable, callback, user_data);
+}
+
+/* For the (isu) methods: GetDisplayState, GetSleepMultiplier,
+ * GetCapabilitiesString and GetCapabilitiesMetadata. */
+void
+gnomeddc_client_call_display_async(GnomeDdcClient *self,
+                                   const gchar *method,
+                                   GnomeDdcDisplay *display,
+                                   guint flags,
+                                   GnomeDdcCallFlags call_flags,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
+  g_return_if_fail(method != NULL);
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY(display));
+
+  GVariant *args[] = { g_variant_new_uint32(flags) };
+  call_display_method(self, method, display, args, G_N_ELEMENTS(args),
+                      call_flags, cancellable, callback, user_data);
+}
+
+void
+gnomeddc_client_get_vcp_async(GnomeDdcClient *self,
+                              GnomeDdcDisplay *display,
+                              guint8 code,
+                              guint flags,
+                              GnomeDdcCallFlags call_flags,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY(display));
+
+  GVariant *args[] = { g_variant_new_byte(code), g_variant_new_uint32(flags) };
+  call_display_method(self, "GetVcp", display, args, G_N_ELEMENTS(args),
+                      call_flags, cancellable, callback, user_data);
+}
+
+void
+gnomeddc_client_get_vcp_metadata_async(GnomeDdcClient *self,
+                                       GnomeDdcDisplay *display,
+                                       guint8 code,
+                                       guint flags,
+                                       GnomeDdcCallFlags call_flags,
+                                       GCancellable *cancellable,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY(display));
+
+  GVariant *args[] = { g_variant_new_byte(code), g_variant_new_uint32(flags) };
+  call_display_method(self, "GetVcpMetadata", display, args, G_N_ELEMENTS(args),
+                      call_flags, cancellable, callback, user_data);
+}
+
+void
+gnomeddc_client_get_multiple_vcp_async(GnomeDdcClient *self,
+                                       GnomeDdcDisplay *display,
+                                       const guint8 *codes,
+                                       gsize n_codes,
+                                       guint flags,
+                                       GnomeDdcCallFlags call_flags,
+                                       GCancellable *cancellable,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY(display));
+  g_return_if_fail(codes != NULL || n_codes == 0);
+
+  GVariant *args[] = {
+    g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, codes, n_codes, sizeof(guint8)),
+    g_variant_new_uint32(flags),
+  };
+  call_display_method(self, "GetMultipleVcp", display, args, G_N_ELEMENTS(args),
+                      call_flags, cancellable, callback, user_data);
+}
+
+void
+gnomeddc_client_set_vcp_async(GnomeDdcClient *self,
+                              GnomeDdcDisplay *display,
+                              guint8 code,
+                              guint16 value,
+                              guint flags,
+                              GnomeDdcCallFlags call_flags,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY(display));
+
+  GVariant *args[] = {
+    g_variant_new_byte(code),
+    g_variant_new_uint16(value),
+    g_variant_new_uint32(flags),
+  };
+  call_display_method(self, "SetVcp", display, args, G_N_ELEMENTS(args),
+                      call_flags, cancellable, callback, user_data);
+}
+
+/* Latency and status counters for every call made through
+ * gnomeddc_client_call_async(). */
+GnomeDdcCallStats *
+gnomeddc_client_get_call_stats(GnomeDdcClient *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(self), NULL);
+  return self->call_stats;
+}
+
+GnomeDdcServiceProperties *
+gnomeddc_client_get_service_properties(GnomeDdcClient *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(self), NULL);
+  return self->service_properties;
+}
+
+/* Maps a raw event type from "displays-changed" through the service's
+ * DisplayEventTypes table, falling back to the libddcutil numbering. */
+GnomeDdcDisplayEvent
+gnomeddc_client_classify_display_event(GnomeDdcClient *self, gint event_type)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(self), GNOMEDDC_DISPLAY_EVENT_OTHER);
+
+  const gchar *name = gnomeddc_service_properties_lookup_name(self->service_properties,
+                                                              "DisplayEventTypes",
+                                                              event_type);
+  if (name != NULL) {
+    if (g_str_has_suffix(name, "DISPLAY_CONNECTED")) {
+      return GNOMEDDC_DISPLAY_EVENT_CONNECTED;
+    }
+    if (g_str_has_suffix(name, "DISPLAY_DISCONNECTED")) {
+      return GNOMEDDC_DISPLAY_EVENT_DISCONNECTED;
+    }
+    return GNOMEDDC_DISPLAY_EVENT_OTHER;
   }
 
-  return g_dbus_proxy_call_finish(self->proxy, result, error);
+  switch (event_type) {
+  case DDCA_EVENT_DISPLAY_CONNECTED:
+    return GNOMEDDC_DISPLAY_EVENT_CONNECTED;
+  case DDCA_EVENT_DISPLAY_DISCONNECTED:
+    return GNOMEDDC_DISPLAY_EVENT_DISCONNECTED;
+  default:
+    return GNOMEDDC_DISPLAY_EVENT_OTHER;
+  }
 }
 
 GVariant *
@@ -187,15 +1484,8 @@ gnomeddc_client_get_cached_property(GnomeDdcClient *self,
   g_return_val_if_fail(GNOMEDDC_IS_CLIENT(self), NULL);
   g_return_val_if_fail(property_name != NULL, NULL);
 
-  if (self->proxy == NULL) {
-    return NULL;
-  }
-
-  GVariant *value = g_dbus_proxy_get_cached_property(self->proxy, property_name);
-  if (value != NULL) {
-    return g_variant_ref(value);
-  }
-  return NULL;
+  GVariant *value = gnomeddc_service_properties_get_value(self->service_properties, property_name);
+  return value != NULL ? g_variant_ref(value) : NULL;
 }
 
 void
@@ -209,21 +1499,15 @@ gnomeddc_client_set_property_async(GnomeDdcClient *self,
   g_return_if_fail(GNOMEDDC_IS_CLIENT(self));
   g_return_if_fail(property_name != NULL);
 
-  if (self->proxy == NULL) {
-    GTask *task = g_task_new(self, cancellable, callback, user_data);
-    g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", self->last_error ? self->last_error : "Proxy unavailable");
-    g_object_unref(task);
-    return;
-  }
-
-  g_dbus_proxy_call(self->proxy,
-                    "org.freedesktop.DBus.Properties.Set",
-                    g_variant_new("(ssv)", DDCUTIL_INTERFACE_NAME, property_name, value),
-                    G_DBUS_CALL_FLAGS_NONE,
-                    -1,
-                    cancellable,
-                    callback,
-                    user_data);
+  /* Goes through the write lane like the other setters, so it waits for
+   * calls already on the bus. */
+  gnomeddc_client_call_full_async(self,
+                                  "org.freedesktop.DBus.Properties.Set",
+                                  g_variant_new("(ssv)", DDCUTIL_INTERFACE_NAME, property_name, value),
+                                  GNOMEDDC_CALL_FLAGS_NONE,
+                                  cancellable,
+                                  callback,
+                                  user_data);
 }
 
 GVariant *
@@ -231,13 +1515,5 @@ gnomeddc_client_set_property_finish(GnomeDdcClient *self,
                                               GAsyncResult *result,
                                               GError **error)
 {
-  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(self), NULL);
-  g_return_val_if_fail(G_IS_ASYNC_RESULT(result), NULL);
-
-  if (self->proxy == NULL) {
-    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED, "%s", self->last_error ? self->last_error : "Proxy unavailable");
-    return NULL;
-  }
-
-  return g_dbus_proxy_call_finish(self->proxy, result, error);
+  return gnomeddc_client_call_finish(self, result, error);
 }
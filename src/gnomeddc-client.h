@@ -3,6 +3,11 @@
 
 #include <gio/gio.h>
 
+#include "gnomeddc-call-stats.h"
+#include "gnomeddc-display.h"
+#include "gnomeddc-service-properties.h"
+#include "gnomeddc-vcp-cache.h"
+
 G_BEGIN_DECLS
 
 #define GNOMEDDC_TYPE_CLIENT (gnomeddc_client_get_type())
@@ -14,14 +19,55 @@ typedef enum {
   GNOMEDDC_CLIENT_BUS_SESSION
 } GnomeDdcClientBusType;
 
+typedef enum {
+  GNOMEDDC_DISPLAY_EVENT_OTHER,
+  GNOMEDDC_DISPLAY_EVENT_CONNECTED,
+  GNOMEDDC_DISPLAY_EVENT_DISCONNECTED
+} GnomeDdcDisplayEvent;
+
+typedef enum {
+  GNOMEDDC_CALL_FLAGS_NONE = 0,
+  /* Always ask the service, even if the VCP cache could answer. The reply
+   * still refreshes the cache. */
+  GNOMEDDC_CALL_FLAGS_BYPASS_CACHE = 1 << 0,
+  /* Queue the call behind interactive work, e.g. for polling. */
+  GNOMEDDC_CALL_FLAGS_BACKGROUND = 1 << 1,
+  /* Report transient DDC failures as they are instead of retrying, e.g.
+   * when measuring how reliable the bus is. */
+  GNOMEDDC_CALL_FLAGS_NO_RETRY = 1 << 2
+} GnomeDdcCallFlags;
+
 G_DECLARE_FINAL_TYPE(GnomeDdcClient, gnomeddc_client, GNOMEDDC, CLIENT, GObject)
 
 GnomeDdcClient *gnomeddc_client_new(void);
+void gnomeddc_client_new_async(GCancellable *cancellable,
+                               GAsyncReadyCallback callback,
+                               gpointer user_data);
+GnomeDdcClient *gnomeddc_client_new_finish(GAsyncResult *result,
+                                           GError **error);
 
 GDBusProxy *gnomeddc_client_get_proxy(GnomeDdcClient *self);
 gboolean gnomeddc_client_is_connected(GnomeDdcClient *self);
 GnomeDdcClientBusType gnomeddc_client_get_bus_type(GnomeDdcClient *self);
 const gchar *gnomeddc_client_get_last_error(GnomeDdcClient *self);
+GnomeDdcVcpCache *gnomeddc_client_get_vcp_cache(GnomeDdcClient *self);
+GnomeDdcCallStats *gnomeddc_client_get_call_stats(GnomeDdcClient *self);
+GnomeDdcServiceProperties *gnomeddc_client_get_service_properties(GnomeDdcClient *self);
+
+void gnomeddc_client_set_default_timeout(GnomeDdcClient *self,
+                                         gint timeout_msec);
+void gnomeddc_client_set_method_timeout(GnomeDdcClient *self,
+                                        const gchar *method,
+                                        gint timeout_msec);
+gint gnomeddc_client_get_method_timeout(GnomeDdcClient *self,
+                                        const gchar *method);
+void gnomeddc_client_set_call_limits(GnomeDdcClient *self,
+                                     guint max_in_flight,
+                                     guint max_in_flight_per_display);
+void gnomeddc_client_set_retry_policy(GnomeDdcClient *self,
+                                      guint max_retries,
+                                      guint deadline_msec);
+guint gnomeddc_client_get_n_queued(GnomeDdcClient *self);
 
 void gnomeddc_client_call_async(GnomeDdcClient *self,
                                 const gchar *method,
@@ -30,10 +76,66 @@ void gnomeddc_client_call_async(GnomeDdcClient *self,
                                 GAsyncReadyCallback callback,
                                 gpointer user_data);
 
+void gnomeddc_client_call_full_async(GnomeDdcClient *self,
+                                     const gchar *method,
+                                     GVariant *parameters,
+                                     GnomeDdcCallFlags flags,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data);
+
 GVariant *gnomeddc_client_call_finish(GnomeDdcClient *self,
                                       GAsyncResult *result,
                                       GError **error);
 
+/* Typed wrappers for the per-display methods; the @flags are the service's
+ * own flags argument. Finish with gnomeddc_client_call_finish(). */
+void gnomeddc_client_call_display_async(GnomeDdcClient *self,
+                                        const gchar *method,
+                                        GnomeDdcDisplay *display,
+                                        guint flags,
+                                        GnomeDdcCallFlags call_flags,
+                                        GCancellable *cancellable,
+                                        GAsyncReadyCallback callback,
+                                        gpointer user_data);
+void gnomeddc_client_get_vcp_async(GnomeDdcClient *self,
+                                   GnomeDdcDisplay *display,
+                                   guint8 code,
+                                   guint flags,
+                                   GnomeDdcCallFlags call_flags,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data);
+void gnomeddc_client_get_vcp_metadata_async(GnomeDdcClient *self,
+                                            GnomeDdcDisplay *display,
+                                            guint8 code,
+                                            guint flags,
+                                            GnomeDdcCallFlags call_flags,
+                                            GCancellable *cancellable,
+                                            GAsyncReadyCallback callback,
+                                            gpointer user_data);
+void gnomeddc_client_get_multiple_vcp_async(GnomeDdcClient *self,
+                                            GnomeDdcDisplay *display,
+                                            const guint8 *codes,
+                                            gsize n_codes,
+                                            guint flags,
+                                            GnomeDdcCallFlags call_flags,
+                                            GCancellable *cancellable,
+                                            GAsyncReadyCallback callback,
+                                            gpointer user_data);
+void gnomeddc_client_set_vcp_async(GnomeDdcClient *self,
+                                   GnomeDdcDisplay *display,
+                                   guint8 code,
+                                   guint16 value,
+                                   guint flags,
+                                   GnomeDdcCallFlags call_flags,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data);
+
+GnomeDdcDisplayEvent gnomeddc_client_classify_display_event(GnomeDdcClient *self,
+                                                            gint event_type);
+
 GVariant *gnomeddc_client_get_cached_property(GnomeDdcClient *self,
                                               const gchar *property_name);
 
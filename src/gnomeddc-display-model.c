@@ -0,0 +1,437 @@
+#include "gnomeddc-display-model.h"
+
+#include "gnomeddc-reply-decoder.h"
+#include "gnomeddc-trace.h"
+
+/*
+ * The displays the service reports, kept once per process. Windows, the
+ * resident instance and its actions all list the same GnomeDdcDisplay
+ * objects, and hotplug signals trigger a single ListDetected no matter how
+ * many of them are watching.
+ */
+
+struct _GnomeDdcDisplayModel {
+  GObject parent_instance;
+
+  GnomeDdcClient *client;
+  GListStore *store;
+  /* display id -> GnomeDdcDisplay in the store, for lookups by id */
+  GHashTable *by_id;
+  gboolean ready;
+  /* Replaced by every reply, so decodes are never applied out of order */
+  GCancellable *decode_cancellable;
+  GCancellable *hotplug_cancellable;
+};
+
+enum {
+  SIGNAL_REFRESHED,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+static void gnomeddc_display_model_list_model_iface_init(GListModelInterface *iface);
+
+G_DEFINE_FINAL_TYPE_WITH_CODE(GnomeDdcDisplayModel, gnomeddc_display_model, G_TYPE_OBJECT,
+                              G_IMPLEMENT_INTERFACE(G_TYPE_LIST_MODEL,
+                                                    gnomeddc_display_model_list_model_iface_init))
+
+static GType
+gnomeddc_display_model_get_item_type(GListModel *list G_GNUC_UNUSED)
+{
+  return GNOMEDDC_TYPE_DISPLAY;
+}
+
+static guint
+gnomeddc_display_model_get_n_items(GListModel *list)
+{
+  GnomeDdcDisplayModel *self = GNOMEDDC_DISPLAY_MODEL(list);
+  return g_list_model_get_n_items(G_LIST_MODEL(self->store));
+}
+
+static gpointer
+gnomeddc_display_model_get_item(GListModel *list, guint position)
+{
+  GnomeDdcDisplayModel *self = GNOMEDDC_DISPLAY_MODEL(list);
+  return g_list_model_get_item(G_LIST_MODEL(self->store), position);
+}
+
+static void
+gnomeddc_display_model_list_model_iface_init(GListModelInterface *iface)
+{
+  iface->get_item_type = gnomeddc_display_model_get_item_type;
+  iface->get_n_items = gnomeddc_display_model_get_n_items;
+  iface->get_item = gnomeddc_display_model_get_item;
+}
+
+/* Removed items are gone by the time the store signals, so the index is
+ * rebuilt; a display list holds a handful of entries. */
+static void
+store_items_changed_cb(GListModel *store,
+                       guint position,
+                       guint removed,
+                       guint added,
+                       gpointer user_data)
+{
+  GnomeDdcDisplayModel *self = GNOMEDDC_DISPLAY_MODEL(user_data);
+  guint n_items = g_list_model_get_n_items(store);
+
+  g_hash_table_remove_all(self->by_id);
+  for (guint i = 0; i < n_items; i++) {
+    /* The store keeps its own reference. */
+    GnomeDdcDisplay *display = g_list_model_get_item(store, i);
+    g_object_unref(display);
+
+    guint64 id = gnomeddc_display_get_id(display);
+    if (!g_hash_table_contains(self->by_id, &id)) {
+      g_hash_table_insert(self->by_id, g_memdup2(&id, sizeof(id)), display);
+    }
+  }
+
+  g_list_model_items_changed(G_LIST_MODEL(self), position, removed, added);
+}
+
+static void
+gnomeddc_display_model_dispose(GObject *object)
+{
+  GnomeDdcDisplayModel *self = GNOMEDDC_DISPLAY_MODEL(object);
+
+  g_cancellable_cancel(self->decode_cancellable);
+  g_clear_object(&self->decode_cancellable);
+  g_cancellable_cancel(self->hotplug_cancellable);
+  g_clear_object(&self->hotplug_cancellable);
+  if (self->client != NULL) {
+    g_signal_handlers_disconnect_by_data(self->client, self);
+    g_clear_object(&self->client);
+  }
+  if (self->store != NULL) {
+    g_signal_handlers_disconnect_by_data(self->store, self);
+    g_clear_object(&self->store);
+  }
+  g_hash_table_remove_all(self->by_id);
+  G_OBJECT_CLASS(gnomeddc_display_model_parent_class)->dispose(object);
+}
+
+static void
+gnomeddc_display_model_finalize(GObject *object)
+{
+  GnomeDdcDisplayModel *self = GNOMEDDC_DISPLAY_MODEL(object);
+
+  g_clear_pointer(&self->by_id, g_hash_table_unref);
+  G_OBJECT_CLASS(gnomeddc_display_model_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_display_model_class_init(GnomeDdcDisplayModelClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->dispose = gnomeddc_display_model_dispose;
+  object_class->finalize = gnomeddc_display_model_finalize;
+
+  /* Emitted after a detection result was applied, changed or not. */
+  signals[SIGNAL_REFRESHED] =
+    g_signal_new("refreshed",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 0);
+}
+
+static void
+gnomeddc_display_model_init(GnomeDdcDisplayModel *self)
+{
+  self->store = g_list_store_new(GNOMEDDC_TYPE_DISPLAY);
+  self->by_id = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free, NULL);
+  g_signal_connect(self->store, "items-changed", G_CALLBACK(store_items_changed_cb), self);
+}
+
+static void
+background_refresh_cb(GObject *source, GAsyncResult *result, gpointer user_data G_GNUC_UNUSED)
+{
+  g_autoptr(GError) error = NULL;
+
+  if (!gnomeddc_display_model_refresh_finish(GNOMEDDC_DISPLAY_MODEL(source), result, NULL, &error) &&
+      !g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    g_warning("Failed to refresh displays: %s", error->message);
+  }
+}
+
+/* ListDetected only reports what the service already knows about, so this
+ * is cheap compared to a Detect bus scan. */
+static void
+refresh_in_background(GnomeDdcDisplayModel *self)
+{
+  g_cancellable_cancel(self->hotplug_cancellable);
+  g_clear_object(&self->hotplug_cancellable);
+  self->hotplug_cancellable = g_cancellable_new();
+
+  gnomeddc_display_model_refresh_async(self, FALSE, self->hotplug_cancellable,
+                                       background_refresh_cb, NULL);
+}
+
+static gboolean
+remove_display_by_edid(GnomeDdcDisplayModel *self, const gchar *edid)
+{
+  GnomeDdcDisplay *display = gnomeddc_display_model_find(self, gnomeddc_display_id_for_edid(edid));
+  guint position;
+
+  if (display == NULL || g_strcmp0(gnomeddc_display_get_edid(display), edid) != 0 ||
+      !g_list_store_find(self->store, display, &position)) {
+    return FALSE;
+  }
+  g_list_store_remove(self->store, position);
+  return TRUE;
+}
+
+static void
+client_connected_cb(GnomeDdcClient *client G_GNUC_UNUSED, gpointer user_data)
+{
+  refresh_in_background(GNOMEDDC_DISPLAY_MODEL(user_data));
+}
+
+static void
+client_displays_changed_cb(GnomeDdcClient *client,
+                           const gchar *edid,
+                           gint event_type,
+                           guint flags G_GNUC_UNUSED,
+                           gpointer user_data)
+{
+  GnomeDdcDisplayModel *self = GNOMEDDC_DISPLAY_MODEL(user_data);
+
+  switch (gnomeddc_client_classify_display_event(client, event_type)) {
+  case GNOMEDDC_DISPLAY_EVENT_DISCONNECTED:
+    /* Display numbers of the remaining monitors are stable, so dropping
+     * the one entry is enough; an unknown EDID means our list is stale. */
+    if (edid == NULL || *edid == '\0' || !remove_display_by_edid(self, edid)) {
+      refresh_in_background(self);
+    }
+    break;
+  case GNOMEDDC_DISPLAY_EVENT_CONNECTED:
+    /* The new display number is only known to the service. */
+    refresh_in_background(self);
+    break;
+  case GNOMEDDC_DISPLAY_EVENT_OTHER:
+  default:
+    break;
+  }
+}
+
+static void
+client_service_initialized_cb(GnomeDdcClient *client G_GNUC_UNUSED,
+                              guint flags G_GNUC_UNUSED,
+                              gpointer user_data)
+{
+  refresh_in_background(GNOMEDDC_DISPLAY_MODEL(user_data));
+}
+
+/* Follows @client's hotplug signals. The first ListDetected runs once the
+ * client is connected, or right away if it already is. */
+GnomeDdcDisplayModel *
+gnomeddc_display_model_new(GnomeDdcClient *client)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(client), NULL);
+
+  GnomeDdcDisplayModel *self = g_object_new(GNOMEDDC_TYPE_DISPLAY_MODEL, NULL);
+  self->client = g_object_ref(client);
+  g_signal_connect(client, "connected", G_CALLBACK(client_connected_cb), self);
+  g_signal_connect(client, "displays-changed", G_CALLBACK(client_displays_changed_cb), self);
+  g_signal_connect(client, "service-initialized", G_CALLBACK(client_service_initialized_cb), self);
+  if (gnomeddc_client_is_connected(client)) {
+    refresh_in_background(self);
+  }
+  return self;
+}
+
+GnomeDdcClient *
+gnomeddc_display_model_get_client(GnomeDdcDisplayModel *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY_MODEL(self), NULL);
+  return self->client;
+}
+
+/* Whether a detection result has been applied yet. Before that the model
+ * is empty or holds what a caller restored with
+ * gnomeddc_display_model_apply(). */
+gboolean
+gnomeddc_display_model_is_ready(GnomeDdcDisplayModel *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY_MODEL(self), FALSE);
+  return self->ready;
+}
+
+/* The display with gnomeddc_display_get_id() @id, owned by the model. */
+GnomeDdcDisplay *
+gnomeddc_display_model_find(GnomeDdcDisplayModel *self, guint64 id)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY_MODEL(self), NULL);
+
+  return g_hash_table_lookup(self->by_id, &id);
+}
+
+/* Brings the model in line with @displays while keeping every unchanged
+ * GnomeDdcDisplay (and with it selections and bound rows). Only vanished,
+ * changed and new entries are spliced. */
+void
+gnomeddc_display_model_apply(GnomeDdcDisplayModel *self, GPtrArray *displays)
+{
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY_MODEL(self));
+  g_return_if_fail(displays != NULL);
+  GNOMEDDC_TRACE_FUNCTION("model");
+
+  GListModel *model = G_LIST_MODEL(self->store);
+  /* Keyed by display identity, so lookups hash a precomputed id instead of
+   * the whole EDID string. */
+  g_autoptr(GHashTable) incoming = g_hash_table_new(gnomeddc_display_hash, gnomeddc_display_key_equal);
+  g_autoptr(GHashTable) kept = g_hash_table_new(gnomeddc_display_hash, gnomeddc_display_key_equal);
+
+  for (guint i = 0; i < displays->len; i++) {
+    GnomeDdcDisplay *display = g_ptr_array_index(displays, i);
+    if (!g_hash_table_insert(incoming, display, display)) {
+      /* Ambiguous identities cannot be matched up; start over. */
+      g_list_store_splice(self->store, 0, g_list_model_get_n_items(model),
+                          displays->pdata, displays->len);
+      return;
+    }
+  }
+
+  guint n_items = g_list_model_get_n_items(model);
+  guint run_end = n_items;
+  for (guint position = n_items; position-- > 0;) {
+    g_autoptr(GnomeDdcDisplay) current = g_list_model_get_item(model, position);
+    GnomeDdcDisplay *replacement = g_hash_table_lookup(incoming, current);
+
+    if (replacement == NULL || !gnomeddc_display_equal(current, replacement)) {
+      continue;
+    }
+
+    g_hash_table_add(kept, replacement);
+    if (run_end > position + 1) {
+      g_list_store_splice(self->store, position + 1, run_end - position - 1, NULL, 0);
+    }
+    run_end = position;
+  }
+  if (run_end > 0) {
+    g_list_store_splice(self->store, 0, run_end, NULL, 0);
+  }
+
+  /* The survivors must appear in the same relative order as in the new
+   * result, otherwise merging would duplicate them. */
+  guint kept_position = 0;
+  for (guint i = 0; i < displays->len; i++) {
+    GnomeDdcDisplay *display = g_ptr_array_index(displays, i);
+    if (!g_hash_table_contains(kept, display)) {
+      continue;
+    }
+    g_autoptr(GnomeDdcDisplay) current = g_list_model_get_item(model, kept_position++);
+    if (!gnomeddc_display_key_equal(current, display)) {
+      g_list_store_splice(self->store, 0, g_list_model_get_n_items(model),
+                          displays->pdata, displays->len);
+      return;
+    }
+  }
+
+  g_autoptr(GPtrArray) additions = g_ptr_array_new();
+  guint position = 0;
+  for (guint i = 0; i < displays->len; i++) {
+    GnomeDdcDisplay *display = g_ptr_array_index(displays, i);
+    if (!g_hash_table_contains(kept, display)) {
+      g_ptr_array_add(additions, display);
+      continue;
+    }
+
+    if (additions->len > 0) {
+      g_list_store_splice(self->store, position, 0, additions->pdata, additions->len);
+      position += additions->len;
+      g_ptr_array_set_size(additions, 0);
+    }
+    position++;
+  }
+  if (additions->len > 0) {
+    g_list_store_splice(self->store, position, 0, additions->pdata, additions->len);
+  }
+}
+
+static void
+refresh_decoded_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  GnomeDdcDisplayModel *self = g_task_get_source_object(task);
+  GError *error = NULL;
+  g_autoptr(GnomeDdcDisplayListReply) reply = gnomeddc_decode_display_list_finish(result, &error);
+
+  if (reply == NULL) {
+    g_task_return_error(task, error);
+    return;
+  }
+
+  gnomeddc_display_model_apply(self, reply->displays);
+  self->ready = TRUE;
+  g_signal_emit(self, signals[SIGNAL_REFRESHED], 0);
+
+  g_task_set_task_data(task, g_steal_pointer(&reply->message), g_free);
+  g_task_return_boolean(task, TRUE);
+}
+
+static void
+refresh_listed_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  GTask *task = user_data;
+  GnomeDdcDisplayModel *self = g_task_get_source_object(task);
+  GError *error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(GNOMEDDC_CLIENT(source), result, &error);
+
+  if (response == NULL) {
+    g_task_return_error(task, error);
+    g_object_unref(task);
+    return;
+  }
+
+  /* A newer reply cancels the decode of an older one. */
+  g_cancellable_cancel(self->decode_cancellable);
+  g_clear_object(&self->decode_cancellable);
+  self->decode_cancellable = g_cancellable_new();
+  gnomeddc_decode_display_list_async(response, self->decode_cancellable, refresh_decoded_cb, task);
+}
+
+/* Runs Detect (a full bus scan) or ListDetected and applies the result.
+ * A refresh whose reply is overtaken by a newer one fails with
+ * G_IO_ERROR_CANCELLED. */
+void
+gnomeddc_display_model_refresh_async(GnomeDdcDisplayModel *self,
+                                     gboolean detect,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY_MODEL(self));
+
+  GTask *task = g_task_new(self, cancellable, callback, user_data);
+  g_task_set_source_tag(task, gnomeddc_display_model_refresh_async);
+
+  gnomeddc_client_call_async(self->client,
+                             detect ? "Detect" : "ListDetected",
+                             g_variant_new("(u)", 0),
+                             cancellable,
+                             refresh_listed_cb,
+                             task);
+}
+
+/* @message, if given, receives the service's status message. */
+gboolean
+gnomeddc_display_model_refresh_finish(GnomeDdcDisplayModel *self,
+                                      GAsyncResult *result,
+                                      gchar **message,
+                                      GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY_MODEL(self), FALSE);
+  g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+
+  if (!g_task_propagate_boolean(G_TASK(result), error)) {
+    return FALSE;
+  }
+  if (message != NULL) {
+    *message = g_strdup(g_task_get_task_data(G_TASK(result)));
+  }
+  return TRUE;
+}
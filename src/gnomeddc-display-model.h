@@ -0,0 +1,36 @@
+#ifndef GNOMEDDC_DISPLAY_MODEL_H
+#define GNOMEDDC_DISPLAY_MODEL_H
+
+#include <gio/gio.h>
+
+#include "gnomeddc-client.h"
+#include "gnomeddc-display.h"
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_DISPLAY_MODEL (gnomeddc_display_model_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcDisplayModel, gnomeddc_display_model, GNOMEDDC, DISPLAY_MODEL, GObject)
+
+GnomeDdcDisplayModel *gnomeddc_display_model_new(GnomeDdcClient *client);
+
+GnomeDdcClient *gnomeddc_display_model_get_client(GnomeDdcDisplayModel *self);
+gboolean gnomeddc_display_model_is_ready(GnomeDdcDisplayModel *self);
+GnomeDdcDisplay *gnomeddc_display_model_find(GnomeDdcDisplayModel *self,
+                                             guint64 id);
+void gnomeddc_display_model_apply(GnomeDdcDisplayModel *self,
+                                  GPtrArray *displays);
+
+void gnomeddc_display_model_refresh_async(GnomeDdcDisplayModel *self,
+                                          gboolean detect,
+                                          GCancellable *cancellable,
+                                          GAsyncReadyCallback callback,
+                                          gpointer user_data);
+gboolean gnomeddc_display_model_refresh_finish(GnomeDdcDisplayModel *self,
+                                               GAsyncResult *result,
+                                               gchar **message,
+                                               GError **error);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_DISPLAY_MODEL_H */
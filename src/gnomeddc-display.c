@@ -1,17 +1,33 @@
 #include "gnomeddc-display.h"
 
+#include <string.h>
+
 struct _GnomeDdcDisplay {
   GObject parent_instance;
 
+  /* The (iiisssqsu) entry from ListDetected/Detect. The string fields
+   * below point into it rather than being copies. */
+  GVariant *entry;
   gint display_number;
   gint usb_bus;
   gint usb_device;
-  gchar *manufacturer;
-  gchar *model;
-  gchar *serial;
+  const gchar *manufacturer;
+  const gchar *model;
+  const gchar *serial;
   guint16 product_code;
-  gchar *edid;
+  const gchar *edid;
   guint32 binary_serial;
+  const gchar *key;
+  gchar *fallback_key;
+  /* Hash of the binary EDID, or of the fallback key */
+  guint64 id;
+  gchar *search_key;
+  /* Decoded on first use */
+  GBytes *edid_bytes;
+  GnomeDdcEdidInfo *edid_info;
+  gboolean edid_decoded;
+  /* Display number and EDID as call arguments, taken from the entry */
+  GVariant *call_prefix[2];
 };
 
 G_DEFINE_FINAL_TYPE(GnomeDdcDisplay, gnomeddc_display, G_TYPE_OBJECT)
@@ -21,10 +37,13 @@ gnomeddc_display_finalize(GObject *object)
 {
   GnomeDdcDisplay *self = GNOMEDDC_DISPLAY(object);
 
-  g_clear_pointer(&self->manufacturer, g_free);
-  g_clear_pointer(&self->model, g_free);
-  g_clear_pointer(&self->serial, g_free);
-  g_clear_pointer(&self->edid, g_free);
+  g_clear_pointer(&self->entry, g_variant_unref);
+  g_clear_pointer(&self->fallback_key, g_free);
+  g_clear_pointer(&self->search_key, g_free);
+  g_clear_pointer(&self->edid_bytes, g_bytes_unref);
+  g_clear_pointer(&self->edid_info, g_free);
+  g_clear_pointer(&self->call_prefix[0], g_variant_unref);
+  g_clear_pointer(&self->call_prefix[1], g_variant_unref);
 
   G_OBJECT_CLASS(gnomeddc_display_parent_class)->finalize(object);
 }
@@ -41,6 +60,42 @@ gnomeddc_display_init(GnomeDdcDisplay *self)
 {
 }
 
+/* Keeps a reference to @entry, which must be of type (iiisssqsu), and
+ * hands out strings borrowed from it. An entry taken from a detection reply
+ * with g_variant_iter_next_value() shares the reply's buffer, so building
+ * the display list does not copy any of the strings. */
+GnomeDdcDisplay *
+gnomeddc_display_new_from_variant(GVariant *entry)
+{
+  g_return_val_if_fail(entry != NULL, NULL);
+  g_return_val_if_fail(g_variant_is_of_type(entry, G_VARIANT_TYPE(GNOMEDDC_DISPLAY_ENTRY_TYPE)), NULL);
+
+  GnomeDdcDisplay *self = g_object_new(GNOMEDDC_TYPE_DISPLAY, NULL);
+  self->entry = g_variant_ref_sink(entry);
+  g_variant_get(self->entry, "(iii&s&s&sq&su)",
+                &self->display_number,
+                &self->usb_bus,
+                &self->usb_device,
+                &self->manufacturer,
+                &self->model,
+                &self->serial,
+                &self->product_code,
+                &self->edid,
+                &self->binary_serial);
+
+  if (self->edid[0] != '\0') {
+    self->key = self->edid;
+  } else {
+    self->fallback_key = g_strdup_printf("%08X:%04X", self->binary_serial, self->product_code);
+    self->key = self->fallback_key;
+  }
+
+  self->id = self->fallback_key != NULL
+               ? gnomeddc_edid_hash((const guint8 *) self->key, strlen(self->key))
+               : gnomeddc_display_id_for_edid(self->edid);
+  return self;
+}
+
 GnomeDdcDisplay *
 gnomeddc_display_new(gint display_number,
                       gint usb_bus,
@@ -52,17 +107,41 @@ gnomeddc_display_new(gint display_number,
                       const gchar *edid,
                       guint32 binary_serial)
 {
-  GnomeDdcDisplay *self = g_object_new(GNOMEDDC_TYPE_DISPLAY, NULL);
-  self->display_number = display_number;
-  self->usb_bus = usb_bus;
-  self->usb_device = usb_device;
-  self->manufacturer = g_strdup(manufacturer ? manufacturer : "");
-  self->model = g_strdup(model ? model : "");
-  self->serial = g_strdup(serial ? serial : "");
-  self->product_code = product_code;
-  self->edid = g_strdup(edid ? edid : "");
-  self->binary_serial = binary_serial;
-  return self;
+  return gnomeddc_display_new_from_variant(g_variant_new(GNOMEDDC_DISPLAY_ENTRY_TYPE,
+                                                         display_number,
+                                                         usb_bus,
+                                                         usb_device,
+                                                         manufacturer ? manufacturer : "",
+                                                         model ? model : "",
+                                                         serial ? serial : "",
+                                                         product_code,
+                                                         edid ? edid : "",
+                                                         binary_serial));
+}
+
+/* The (iiisssqsu) entry the display was built from. */
+GVariant *
+gnomeddc_display_get_entry(GnomeDdcDisplay *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(self), NULL);
+  return self->entry;
+}
+
+/* The leading (i s) arguments of every per-display method. Both are
+ * children of the entry, so they share its buffer, and are made once per
+ * display instead of once per call. */
+void
+gnomeddc_display_get_call_prefix(GnomeDdcDisplay *self, GVariant **display_number, GVariant **edid)
+{
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY(self));
+  g_return_if_fail(display_number != NULL && edid != NULL);
+
+  if (self->call_prefix[0] == NULL) {
+    self->call_prefix[0] = g_variant_get_child_value(self->entry, 0);
+    self->call_prefix[1] = g_variant_get_child_value(self->entry, 7);
+  }
+  *display_number = self->call_prefix[0];
+  *edid = self->call_prefix[1];
 }
 
 gint
@@ -121,6 +200,38 @@ gnomeddc_display_get_edid(GnomeDdcDisplay *self)
   return self->edid;
 }
 
+/* The binary EDID, or NULL if the service did not report a valid one. */
+GBytes *
+gnomeddc_display_get_edid_bytes(GnomeDdcDisplay *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(self), NULL);
+
+  if (!self->edid_decoded) {
+    self->edid_decoded = TRUE;
+    if (self->edid[0] != '\0') {
+      self->edid_bytes = gnomeddc_edid_bytes_from_hex(self->edid);
+    }
+    if (self->edid_bytes != NULL) {
+      GnomeDdcEdidInfo info;
+      if (gnomeddc_edid_parse(self->edid_bytes, &info)) {
+        self->edid_info = g_memdup2(&info, sizeof(info));
+      }
+    }
+  }
+  return self->edid_bytes;
+}
+
+/* Manufacturer ID, date and native resolution from the EDID, or NULL if
+ * there is no EDID or it cannot be parsed. */
+const GnomeDdcEdidInfo *
+gnomeddc_display_get_edid_info(GnomeDdcDisplay *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(self), NULL);
+
+  gnomeddc_display_get_edid_bytes(self);
+  return self->edid_info;
+}
+
 guint32
 gnomeddc_display_get_binary_serial(GnomeDdcDisplay *self)
 {
@@ -147,3 +258,121 @@ gnomeddc_display_dup_full_name(GnomeDdcDisplay *self)
 
   return g_strdup_printf("%s %s", self->manufacturer, self->model);
 }
+
+/* Stable identity across detection passes: the EDID when the service reports
+ * one, otherwise the binary serial number and product code. */
+const gchar *
+gnomeddc_display_get_key(GnomeDdcDisplay *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(self), "");
+  return self->key;
+}
+
+/* FNV-1a hash of the binary EDID, or of the fallback key for displays
+ * without one, computed once per display. See gnomeddc_display_hash() for
+ * tables keyed by identity. */
+guint64
+gnomeddc_display_get_id(GnomeDdcDisplay *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(self), 0);
+  return self->id;
+}
+
+/* The id of the display with @edid, as gnomeddc_display_get_id() gives it,
+ * for code that only has the EDID a call or signal carried. 0 for an empty
+ * EDID. */
+guint64
+gnomeddc_display_id_for_edid(const gchar *edid)
+{
+  guint64 id = 0;
+
+  if (edid == NULL || *edid == '\0') {
+    return 0;
+  }
+
+  /* A malformed EDID still identifies the display; hash its text. */
+  if (!gnomeddc_edid_hash_hex(edid, &id)) {
+    id = gnomeddc_edid_hash((const guint8 *) edid, strlen(edid));
+  }
+  return id;
+}
+
+/* GHashFunc and GEqualFunc over display identity, for hash tables keyed
+ * by GnomeDdcDisplay. Lookups only compare the full keys on a hash hit. */
+guint
+gnomeddc_display_hash(gconstpointer display)
+{
+  const GnomeDdcDisplay *self = display;
+  return (guint) (self->id ^ (self->id >> 32));
+}
+
+gboolean
+gnomeddc_display_key_equal(gconstpointer a, gconstpointer b)
+{
+  const GnomeDdcDisplay *display_a = a;
+  const GnomeDdcDisplay *display_b = b;
+  return display_a->id == display_b->id && g_str_equal(display_a->key, display_b->key);
+}
+
+/* Displays that share a bus key sit behind the same bus and have to be
+ * talked to one at a time. USB attached monitors share their USB bus,
+ * every other display is on an I2C bus of its own. */
+gint
+gnomeddc_display_get_bus_key(GnomeDdcDisplay *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(self), 0);
+
+  if (self->usb_bus > 0) {
+    return self->usb_bus;
+  }
+  return -(self->display_number + 1);
+}
+
+const gchar *
+gnomeddc_display_get_search_key(GnomeDdcDisplay *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(self), "");
+
+  /* Folded on first use so the sidebar filter is a plain strstr(). The
+   * fields are newline separated so a match cannot span two of them.
+   * The EDID itself is matched by prefix in the filter; in place of its
+   * few hundred hex digits the haystack holds its decoded maker ID and
+   * native mode. */
+  if (self->search_key == NULL) {
+    g_autofree gchar *full_name = gnomeddc_display_dup_full_name(self);
+    const GnomeDdcEdidInfo *info = gnomeddc_display_get_edid_info(self);
+    g_autofree gchar *edid_fields = info != NULL
+                                      ? g_strdup_printf("%s\n%ux%u",
+                                                        info->manufacturer_id,
+                                                        info->native_width,
+                                                        info->native_height)
+                                      : g_strdup("");
+    g_autofree gchar *haystack = g_strjoin("\n",
+                                           self->manufacturer,
+                                           self->model,
+                                           self->serial,
+                                           edid_fields,
+                                           full_name,
+                                           NULL);
+    self->search_key = g_utf8_casefold(haystack, -1);
+  }
+  return self->search_key;
+}
+
+gboolean
+gnomeddc_display_equal(GnomeDdcDisplay *a, GnomeDdcDisplay *b)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(a), FALSE);
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(b), FALSE);
+
+  return a->id == b->id &&
+         a->display_number == b->display_number &&
+         a->usb_bus == b->usb_bus &&
+         a->usb_device == b->usb_device &&
+         a->product_code == b->product_code &&
+         a->binary_serial == b->binary_serial &&
+         g_str_equal(a->manufacturer, b->manufacturer) &&
+         g_str_equal(a->model, b->model) &&
+         g_str_equal(a->serial, b->serial) &&
+         g_str_equal(a->edid, b->edid);
+}
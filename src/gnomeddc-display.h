@@ -3,10 +3,15 @@
 
 #include <glib-object.h>
 
+#include "gnomeddc-edid.h"
+
 G_BEGIN_DECLS
 
 #define GNOMEDDC_TYPE_DISPLAY (gnomeddc_display_get_type())
 
+/* One element of the ListDetected/Detect display array. */
+#define GNOMEDDC_DISPLAY_ENTRY_TYPE "(iiisssqsu)"
+
 G_DECLARE_FINAL_TYPE(GnomeDdcDisplay, gnomeddc_display, GNOMEDDC, DISPLAY, GObject)
 
 GnomeDdcDisplay *gnomeddc_display_new(gint display_number,
@@ -18,6 +23,11 @@ GnomeDdcDisplay *gnomeddc_display_new(gint display_number,
                                       guint16 product_code,
                                       const gchar *edid,
                                       guint32 binary_serial);
+GnomeDdcDisplay *gnomeddc_display_new_from_variant(GVariant *entry);
+GVariant *gnomeddc_display_get_entry(GnomeDdcDisplay *self);
+void gnomeddc_display_get_call_prefix(GnomeDdcDisplay *self,
+                                      GVariant **display_number,
+                                      GVariant **edid);
 
 gint gnomeddc_display_get_display_number(GnomeDdcDisplay *self);
 gint gnomeddc_display_get_usb_bus(GnomeDdcDisplay *self);
@@ -27,8 +37,19 @@ const gchar *gnomeddc_display_get_model(GnomeDdcDisplay *self);
 const gchar *gnomeddc_display_get_serial(GnomeDdcDisplay *self);
 guint16 gnomeddc_display_get_product_code(GnomeDdcDisplay *self);
 const gchar *gnomeddc_display_get_edid(GnomeDdcDisplay *self);
+GBytes *gnomeddc_display_get_edid_bytes(GnomeDdcDisplay *self);
+const GnomeDdcEdidInfo *gnomeddc_display_get_edid_info(GnomeDdcDisplay *self);
 guint32 gnomeddc_display_get_binary_serial(GnomeDdcDisplay *self);
 char *gnomeddc_display_dup_full_name(GnomeDdcDisplay *self);
+const gchar *gnomeddc_display_get_key(GnomeDdcDisplay *self);
+guint64 gnomeddc_display_get_id(GnomeDdcDisplay *self);
+guint64 gnomeddc_display_id_for_edid(const gchar *edid);
+guint gnomeddc_display_hash(gconstpointer display);
+gboolean gnomeddc_display_key_equal(gconstpointer a,
+                                    gconstpointer b);
+const gchar *gnomeddc_display_get_search_key(GnomeDdcDisplay *self);
+gint gnomeddc_display_get_bus_key(GnomeDdcDisplay *self);
+gboolean gnomeddc_display_equal(GnomeDdcDisplay *a, GnomeDdcDisplay *b);
 
 G_END_DECLS
 
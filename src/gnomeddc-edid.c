@@ -0,0 +1,124 @@
+#include "gnomeddc-edid.h"
+
+#include <string.h>
+
+/*
+ * ddcutil-service passes EDIDs around as hex strings of 256 or 512
+ * characters. Displays are identified by a 64-bit FNV-1a hash of the
+ * binary EDID, which can be computed straight from the hex without
+ * decoding it first; the bytes and the decoded fields are only produced
+ * when something asks for them.
+ */
+
+#define FNV_OFFSET_BASIS G_GUINT64_CONSTANT(0xcbf29ce484222325)
+#define FNV_PRIME G_GUINT64_CONSTANT(0x100000001b3)
+
+#define EDID_BLOCK_SIZE 128
+
+static const guint8 edid_header[8] = { 0x00, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x00 };
+
+static inline guint64
+fnv1a_step(guint64 hash, guint8 byte)
+{
+  return (hash ^ byte) * FNV_PRIME;
+}
+
+guint64
+gnomeddc_edid_hash(const guint8 *data, gsize length)
+{
+  g_return_val_if_fail(data != NULL || length == 0, 0);
+
+  guint64 hash = FNV_OFFSET_BASIS;
+  for (gsize i = 0; i < length; i++) {
+    hash = fnv1a_step(hash, data[i]);
+  }
+  return hash;
+}
+
+/* Hashes the bytes @hex encodes, as gnomeddc_edid_hash() would. Fails for
+ * an empty string, an odd length or a non-hex digit. */
+gboolean
+gnomeddc_edid_hash_hex(const gchar *hex, guint64 *out_hash)
+{
+  g_return_val_if_fail(hex != NULL, FALSE);
+  g_return_val_if_fail(out_hash != NULL, FALSE);
+
+  guint64 hash = FNV_OFFSET_BASIS;
+  gsize i;
+  for (i = 0; hex[i] != '\0'; i += 2) {
+    gint high = g_ascii_xdigit_value(hex[i]);
+    gint low = hex[i + 1] != '\0' ? g_ascii_xdigit_value(hex[i + 1]) : -1;
+    if (high < 0 || low < 0) {
+      return FALSE;
+    }
+    hash = fnv1a_step(hash, (guint8) (high << 4 | low));
+  }
+  if (i == 0) {
+    return FALSE;
+  }
+
+  *out_hash = hash;
+  return TRUE;
+}
+
+/* Returns NULL if @hex is not a whole number of hex encoded bytes. */
+GBytes *
+gnomeddc_edid_bytes_from_hex(const gchar *hex)
+{
+  g_return_val_if_fail(hex != NULL, NULL);
+
+  gsize length = strlen(hex);
+  if (length == 0 || length % 2 != 0) {
+    return NULL;
+  }
+
+  guint8 *data = g_malloc(length / 2);
+  for (gsize i = 0; i < length / 2; i++) {
+    gint high = g_ascii_xdigit_value(hex[2 * i]);
+    gint low = g_ascii_xdigit_value(hex[2 * i + 1]);
+    if (high < 0 || low < 0) {
+      g_free(data);
+      return NULL;
+    }
+    data[i] = (guint8) (high << 4 | low);
+  }
+  return g_bytes_new_take(data, length / 2);
+}
+
+/* Decodes the base block of @edid. Returns FALSE if it is too short or
+ * lacks the EDID header. */
+gboolean
+gnomeddc_edid_parse(GBytes *edid, GnomeDdcEdidInfo *info)
+{
+  g_return_val_if_fail(edid != NULL, FALSE);
+  g_return_val_if_fail(info != NULL, FALSE);
+
+  gsize length = 0;
+  const guint8 *data = g_bytes_get_data(edid, &length);
+  if (length < EDID_BLOCK_SIZE || memcmp(data, edid_header, sizeof(edid_header)) != 0) {
+    return FALSE;
+  }
+
+  memset(info, 0, sizeof(*info));
+
+  /* Three 5-bit letters, 'A' being 1, big endian */
+  guint16 pnp = (guint16) (data[8] << 8 | data[9]);
+  info->manufacturer_id[0] = (gchar) ('A' - 1 + ((pnp >> 10) & 0x1F));
+  info->manufacturer_id[1] = (gchar) ('A' - 1 + ((pnp >> 5) & 0x1F));
+  info->manufacturer_id[2] = (gchar) ('A' - 1 + (pnp & 0x1F));
+
+  info->product_code = (guint16) (data[10] | data[11] << 8);
+  info->serial = (guint32) data[12] | (guint32) data[13] << 8 | (guint32) data[14] << 16 | (guint32) data[15] << 24;
+  /* Week 0xFF marks the year as the model year. */
+  info->week = data[16] <= 54 ? data[16] : 0;
+  info->year = (guint16) (1990 + data[17]);
+
+  /* The first descriptor is the preferred timing if its pixel clock is
+   * set. */
+  const guint8 *timing = data + 54;
+  if (timing[0] != 0 || timing[1] != 0) {
+    info->native_width = (guint16) (timing[2] | (timing[4] & 0xF0) << 4);
+    info->native_height = (guint16) (timing[5] | (timing[7] & 0xF0) << 4);
+  }
+  return TRUE;
+}
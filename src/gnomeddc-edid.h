@@ -0,0 +1,32 @@
+#ifndef GNOMEDDC_EDID_H
+#define GNOMEDDC_EDID_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/* Fields decoded from the base EDID block. */
+typedef struct {
+  /* Three letter PNP ID, e.g. "DEL" */
+  gchar manufacturer_id[4];
+  guint16 product_code;
+  guint32 serial;
+  /* 0 when not given */
+  guint8 week;
+  guint16 year;
+  /* Preferred mode, 0x0 when there is no detailed timing */
+  guint16 native_width;
+  guint16 native_height;
+} GnomeDdcEdidInfo;
+
+guint64 gnomeddc_edid_hash(const guint8 *data,
+                           gsize length);
+gboolean gnomeddc_edid_hash_hex(const gchar *hex,
+                                guint64 *out_hash);
+GBytes *gnomeddc_edid_bytes_from_hex(const gchar *hex);
+gboolean gnomeddc_edid_parse(GBytes *edid,
+                             GnomeDdcEdidInfo *info);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_EDID_H */
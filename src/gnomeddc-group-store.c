@@ -0,0 +1,278 @@
+#include "gnomeddc-group-store.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+/*
+ * Display groups live in $XDG_CONFIG_HOME/gnomeddc/groups.ini, one group
+ * per display group. Members are listed by EDID; a member may also have a
+ * key of its own with per-code offsets for panels that do not match:
+ *
+ *   [Group desk]
+ *   Members=00FFFFFFFFFFFF00…;00FFFFFFFFFFFF00…;
+ *   00FFFFFFFFFFFF00…=0x10=-8;0x12=+5;
+ *
+ * The offset is added to the value written to the group for that code.
+ */
+
+#define GROUP_PREFIX "Group "
+#define MEMBERS_KEY "Members"
+
+struct _GnomeDdcGroupStore {
+  GObject parent_instance;
+
+  gchar *path;
+  GKeyFile *key_file;
+};
+
+enum {
+  SIGNAL_CHANGED,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+G_DEFINE_FINAL_TYPE(GnomeDdcGroupStore, gnomeddc_group_store, G_TYPE_OBJECT)
+
+static void
+gnomeddc_group_store_finalize(GObject *object)
+{
+  GnomeDdcGroupStore *self = GNOMEDDC_GROUP_STORE(object);
+  g_clear_pointer(&self->path, g_free);
+  g_clear_pointer(&self->key_file, g_key_file_unref);
+  G_OBJECT_CLASS(gnomeddc_group_store_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_group_store_class_init(GnomeDdcGroupStoreClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_group_store_finalize;
+
+  /* Emitted whenever the groups in memory change, saved or not, so
+   * everything listing them can follow. */
+  signals[SIGNAL_CHANGED] =
+    g_signal_new("changed",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 0);
+}
+
+static void
+gnomeddc_group_store_init(GnomeDdcGroupStore *self)
+{
+  self->key_file = g_key_file_new();
+}
+
+GnomeDdcGroupStore *
+gnomeddc_group_store_new(void)
+{
+  g_autofree gchar *path = g_build_filename(g_get_user_config_dir(), "gnomeddc", "groups.ini", NULL);
+  return gnomeddc_group_store_new_for_path(path);
+}
+
+/* Loads @path right away; a missing or unreadable file is an empty store. */
+GnomeDdcGroupStore *
+gnomeddc_group_store_new_for_path(const gchar *path)
+{
+  g_return_val_if_fail(path != NULL, NULL);
+
+  GnomeDdcGroupStore *self = g_object_new(GNOMEDDC_TYPE_GROUP_STORE, NULL);
+  self->path = g_strdup(path);
+
+  g_autoptr(GError) error = NULL;
+  if (!gnomeddc_group_store_reload(self, &error) &&
+      !g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+    g_warning("Ignoring unreadable %s: %s", self->path, error->message);
+  }
+  return self;
+}
+
+gboolean
+gnomeddc_group_store_reload(GnomeDdcGroupStore *self, GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_GROUP_STORE(self), FALSE);
+
+  g_autoptr(GKeyFile) key_file = g_key_file_new();
+  if (!g_key_file_load_from_file(key_file, self->path, G_KEY_FILE_KEEP_COMMENTS, error)) {
+    return FALSE;
+  }
+  g_key_file_unref(self->key_file);
+  self->key_file = g_steal_pointer(&key_file);
+  g_signal_emit(self, signals[SIGNAL_CHANGED], 0);
+  return TRUE;
+}
+
+gboolean
+gnomeddc_group_store_save(GnomeDdcGroupStore *self, GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_GROUP_STORE(self), FALSE);
+
+  g_autofree gchar *directory = g_path_get_dirname(self->path);
+  if (g_mkdir_with_parents(directory, 0700) != 0) {
+    gint saved_errno = errno;
+    g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(saved_errno),
+                "Failed to create %s: %s", directory, g_strerror(saved_errno));
+    return FALSE;
+  }
+  return g_key_file_save_to_file(self->key_file, self->path, error);
+}
+
+static gchar *
+group_for_name(const gchar *name)
+{
+  return g_strconcat(GROUP_PREFIX, name, NULL);
+}
+
+static gint
+compare_names(gconstpointer a, gconstpointer b)
+{
+  return g_utf8_collate(*(const gchar * const *) a, *(const gchar * const *) b);
+}
+
+/* Group names, sorted for display. */
+GStrv
+gnomeddc_group_store_dup_names(GnomeDdcGroupStore *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_GROUP_STORE(self), NULL);
+
+  g_auto(GStrv) groups = g_key_file_get_groups(self->key_file, NULL);
+  GPtrArray *names = g_ptr_array_new();
+  for (guint i = 0; groups[i] != NULL; i++) {
+    if (g_str_has_prefix(groups[i], GROUP_PREFIX) && groups[i][sizeof(GROUP_PREFIX) - 1] != '\0') {
+      g_ptr_array_add(names, g_strdup(groups[i] + sizeof(GROUP_PREFIX) - 1));
+    }
+  }
+  g_ptr_array_sort(names, compare_names);
+  g_ptr_array_add(names, NULL);
+  return (GStrv) g_ptr_array_free(names, FALSE);
+}
+
+/* The EDIDs in group @name, in file order; empty for an unknown group. */
+GStrv
+gnomeddc_group_store_dup_members(GnomeDdcGroupStore *self, const gchar *name)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_GROUP_STORE(self), NULL);
+  g_return_val_if_fail(name != NULL, NULL);
+
+  g_autofree gchar *group = group_for_name(name);
+  GStrv members = g_key_file_get_string_list(self->key_file, group, MEMBERS_KEY, NULL, NULL);
+  return members != NULL ? members : g_new0(gchar *, 1);
+}
+
+/* Adds @edid to group @name, creating the group if needed. Call
+ * gnomeddc_group_store_save() to persist. */
+gboolean
+gnomeddc_group_store_add_member(GnomeDdcGroupStore *self, const gchar *name, const gchar *edid)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_GROUP_STORE(self), FALSE);
+  g_return_val_if_fail(name != NULL, FALSE);
+
+  /* Group names cannot hold brackets or line breaks. Displays without an
+   * EDID cannot be told apart across runs. */
+  if (*name == '\0' || strpbrk(name, "[]\n\r") != NULL || edid == NULL || *edid == '\0') {
+    return FALSE;
+  }
+
+  g_auto(GStrv) members = gnomeddc_group_store_dup_members(self, name);
+  if (g_strv_contains((const gchar * const *) members, edid)) {
+    return TRUE;
+  }
+
+  g_autoptr(GStrvBuilder) builder = g_strv_builder_new();
+  g_strv_builder_addv(builder, (const gchar **) members);
+  g_strv_builder_add(builder, edid);
+  g_auto(GStrv) updated = g_strv_builder_end(builder);
+
+  g_autofree gchar *group = group_for_name(name);
+  g_key_file_set_string_list(self->key_file, group, MEMBERS_KEY,
+                             (const gchar * const *) updated, g_strv_length(updated));
+  g_signal_emit(self, signals[SIGNAL_CHANGED], 0);
+  return TRUE;
+}
+
+/* Drops @edid and its offsets from group @name; the group goes away with
+ * its last member. */
+void
+gnomeddc_group_store_remove_member(GnomeDdcGroupStore *self, const gchar *name, const gchar *edid)
+{
+  g_return_if_fail(GNOMEDDC_IS_GROUP_STORE(self));
+  g_return_if_fail(name != NULL);
+  g_return_if_fail(edid != NULL);
+
+  g_autofree gchar *group = group_for_name(name);
+  g_auto(GStrv) members = gnomeddc_group_store_dup_members(self, name);
+  g_autoptr(GStrvBuilder) builder = g_strv_builder_new();
+  for (guint i = 0; members[i] != NULL; i++) {
+    if (!g_str_equal(members[i], edid)) {
+      g_strv_builder_add(builder, members[i]);
+    }
+  }
+  g_auto(GStrv) updated = g_strv_builder_end(builder);
+
+  if (g_strv_length(updated) == g_strv_length(members)) {
+    return;
+  }
+  if (updated[0] == NULL) {
+    g_key_file_remove_group(self->key_file, group, NULL);
+  } else {
+    g_key_file_set_string_list(self->key_file, group, MEMBERS_KEY,
+                               (const gchar * const *) updated, g_strv_length(updated));
+    g_key_file_remove_key(self->key_file, group, edid, NULL);
+  }
+  g_signal_emit(self, signals[SIGNAL_CHANGED], 0);
+}
+
+/* The offset the member with @edid has for @code, 0 if none. Malformed
+ * items are skipped. */
+gint
+gnomeddc_group_store_get_offset(GnomeDdcGroupStore *self, const gchar *name, const gchar *edid, guint8 code)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_GROUP_STORE(self), 0);
+  g_return_val_if_fail(name != NULL, 0);
+
+  if (edid == NULL || *edid == '\0') {
+    return 0;
+  }
+
+  g_autofree gchar *group = group_for_name(name);
+  g_auto(GStrv) items = g_key_file_get_string_list(self->key_file, group, edid, NULL, NULL);
+  for (guint i = 0; items != NULL && items[i] != NULL; i++) {
+    g_auto(GStrv) parts = g_strsplit(items[i], "=", 2);
+    gchar *endptr = NULL;
+    if (g_strv_length(parts) != 2) {
+      continue;
+    }
+    /* The parsers accept an empty string as 0. */
+    const gchar *code_text = g_strstrip(parts[0]);
+    const gchar *offset_text = g_strstrip(parts[1]);
+    if (*code_text == '\0' || *offset_text == '\0') {
+      continue;
+    }
+    guint64 item_code = g_ascii_strtoull(code_text, &endptr, 0);
+    if (*endptr != '\0' || item_code != code) {
+      continue;
+    }
+    gint64 offset = g_ascii_strtoll(offset_text, &endptr, 0);
+    if (*endptr != '\0' || offset < -G_MAXUINT16 || offset > G_MAXUINT16) {
+      continue;
+    }
+    return (gint) offset;
+  }
+  return 0;
+}
+
+void
+gnomeddc_group_store_remove(GnomeDdcGroupStore *self, const gchar *name)
+{
+  g_return_if_fail(GNOMEDDC_IS_GROUP_STORE(self));
+  g_return_if_fail(name != NULL);
+
+  g_autofree gchar *group = group_for_name(name);
+  if (g_key_file_remove_group(self->key_file, group, NULL)) {
+    g_signal_emit(self, signals[SIGNAL_CHANGED], 0);
+  }
+}
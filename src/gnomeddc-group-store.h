@@ -0,0 +1,38 @@
+#ifndef GNOMEDDC_GROUP_STORE_H
+#define GNOMEDDC_GROUP_STORE_H
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_GROUP_STORE (gnomeddc_group_store_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcGroupStore, gnomeddc_group_store, GNOMEDDC, GROUP_STORE, GObject)
+
+GnomeDdcGroupStore *gnomeddc_group_store_new(void);
+GnomeDdcGroupStore *gnomeddc_group_store_new_for_path(const gchar *path);
+
+gboolean gnomeddc_group_store_reload(GnomeDdcGroupStore *self,
+                                     GError **error);
+gboolean gnomeddc_group_store_save(GnomeDdcGroupStore *self,
+                                   GError **error);
+
+GStrv gnomeddc_group_store_dup_names(GnomeDdcGroupStore *self);
+GStrv gnomeddc_group_store_dup_members(GnomeDdcGroupStore *self,
+                                       const gchar *name);
+gboolean gnomeddc_group_store_add_member(GnomeDdcGroupStore *self,
+                                         const gchar *name,
+                                         const gchar *edid);
+void gnomeddc_group_store_remove_member(GnomeDdcGroupStore *self,
+                                        const gchar *name,
+                                        const gchar *edid);
+gint gnomeddc_group_store_get_offset(GnomeDdcGroupStore *self,
+                                     const gchar *name,
+                                     const gchar *edid,
+                                     guint8 code);
+void gnomeddc_group_store_remove(GnomeDdcGroupStore *self,
+                                 const gchar *name);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_GROUP_STORE_H */
@@ -0,0 +1,209 @@
+#include "gnomeddc-group-write.h"
+
+/*
+ * Writes one VCP value to every connected member of a display group. All
+ * members are queued on the write coalescer at once, which runs them in
+ * parallel across buses and in turn on a shared bus, so the group settles
+ * within one DDC transaction per bus rather than one per display.
+ */
+
+typedef struct {
+  guint8 vcp_code;
+  guint flags;
+  guint outstanding;
+  guint n_written;
+  guint n_failed;
+} FanOutData;
+
+/* A member whose maximum for the code is not cached yet; written once a
+ * GetVcp has told it. */
+typedef struct {
+  GTask *task;
+  GnomeDdcDisplay *display;
+  /* The group value plus the member's offset, not clamped yet */
+  gint target;
+} MemberWrite;
+
+static MemberWrite *
+member_write_new(GTask *task, GnomeDdcDisplay *display, gint target)
+{
+  MemberWrite *member = g_new(MemberWrite, 1);
+  member->task = g_object_ref(task);
+  member->display = g_object_ref(display);
+  member->target = target;
+  return member;
+}
+
+static void
+member_write_free(MemberWrite *member)
+{
+  g_object_unref(member->task);
+  g_object_unref(member->display);
+  g_free(member);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(MemberWrite, member_write_free)
+
+static void
+member_write_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  GTask *task = user_data;
+  FanOutData *data = g_task_get_task_data(task);
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_write_coalescer_set_vcp_finish(GNOMEDDC_WRITE_COALESCER(source),
+                                                                         result, &error);
+
+  gint status = 0;
+  if (response != NULL) {
+    g_variant_get(response, "(i&s)", &status, NULL);
+  }
+
+  /* A member superseded by a newer group write is neither. */
+  if (response != NULL && status == 0) {
+    data->n_written++;
+  } else if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    data->n_failed++;
+  }
+
+  if (--data->outstanding == 0) {
+    g_task_return_boolean(task, TRUE);
+  }
+  g_object_unref(task);
+}
+
+/* A @max_value of 0 means the maximum is unknown, and only the VCP range
+ * applies. */
+static void
+queue_member_write(GTask *task, GnomeDdcDisplay *display, gint target, guint16 max_value)
+{
+  GnomeDdcWriteCoalescer *coalescer = g_task_get_source_object(task);
+  FanOutData *data = g_task_get_task_data(task);
+
+  gnomeddc_write_coalescer_set_display_vcp_async(coalescer,
+                                                 display,
+                                                 data->vcp_code,
+                                                 (guint16) CLAMP(target, 0, max_value > 0 ? max_value : G_MAXUINT16),
+                                                 NULL,
+                                                 data->flags,
+                                                 g_task_get_cancellable(task),
+                                                 member_write_cb,
+                                                 g_object_ref(task));
+}
+
+static void
+member_read_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(MemberWrite) member = user_data;
+  FanOutData *data = g_task_get_task_data(member->task);
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(GNOMEDDC_CLIENT(source), result, &error);
+
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    if (--data->outstanding == 0) {
+      g_task_return_boolean(member->task, TRUE);
+    }
+    return;
+  }
+
+  /* A failed read does not hold the write back; the display then gets
+   * the value clamped to the VCP range, as before it was known. */
+  guint16 max_value = 0;
+  gint status = -1;
+  if (response != NULL) {
+    g_variant_get(response, "(qq&si&s)", NULL, &max_value, NULL, &status, NULL);
+  }
+  queue_member_write(member->task, member->display, member->target, status == 0 ? max_value : 0);
+}
+
+/* Members are matched against @displays, the connected displays, by EDID.
+ * Each gets @value plus its offset for @vcp_code from @store, clamped to
+ * the maximum the member reports for the code. That comes from the VCP
+ * cache, or from one GetVcp per member when it is not cached. Fails with
+ * G_IO_ERROR_NOT_FOUND if no member is connected. */
+void
+gnomeddc_group_write_set_vcp_async(GnomeDdcWriteCoalescer *coalescer,
+                                   GnomeDdcGroupStore *store,
+                                   const gchar *name,
+                                   GListModel *displays,
+                                   guint8 vcp_code,
+                                   guint16 value,
+                                   guint flags,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_WRITE_COALESCER(coalescer));
+  g_return_if_fail(GNOMEDDC_IS_GROUP_STORE(store));
+  g_return_if_fail(name != NULL);
+  g_return_if_fail(G_IS_LIST_MODEL(displays));
+
+  g_autoptr(GTask) task = g_task_new(coalescer, cancellable, callback, user_data);
+  g_task_set_source_tag(task, gnomeddc_group_write_set_vcp_async);
+  FanOutData *data = g_new0(FanOutData, 1);
+  data->vcp_code = vcp_code;
+  data->flags = flags;
+  g_task_set_task_data(task, data, g_free);
+
+  g_auto(GStrv) members = gnomeddc_group_store_dup_members(store, name);
+  g_autoptr(GPtrArray) targets = g_ptr_array_new_with_free_func(g_object_unref);
+  guint n_items = g_list_model_get_n_items(displays);
+  for (guint i = 0; i < n_items; i++) {
+    g_autoptr(GnomeDdcDisplay) display = g_list_model_get_item(displays, i);
+    if (g_strv_contains((const gchar * const *) members, gnomeddc_display_get_edid(display))) {
+      g_ptr_array_add(targets, g_steal_pointer(&display));
+    }
+  }
+
+  if (targets->len == 0) {
+    g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_NOT_FOUND,
+                            "No display of group “%s” is connected", name);
+    return;
+  }
+
+  GnomeDdcClient *client = gnomeddc_write_coalescer_get_client(coalescer);
+  GnomeDdcVcpCache *cache = gnomeddc_client_get_vcp_cache(client);
+  /* Count every member before the first reply can come back. */
+  data->outstanding = targets->len;
+  for (guint i = 0; i < targets->len; i++) {
+    GnomeDdcDisplay *display = g_ptr_array_index(targets, i);
+    gint offset = gnomeddc_group_store_get_offset(store, name, gnomeddc_display_get_edid(display), vcp_code);
+    gint target = (gint) value + offset;
+    guint16 max_value = 0;
+
+    if (gnomeddc_vcp_cache_lookup(cache, gnomeddc_display_get_id(display), vcp_code, 0,
+                                  NULL, &max_value, NULL, NULL)) {
+      queue_member_write(task, display, target, max_value);
+      continue;
+    }
+    gnomeddc_client_get_vcp_async(client,
+                                  display,
+                                  vcp_code,
+                                  0,
+                                  GNOMEDDC_CALL_FLAGS_NONE,
+                                  cancellable,
+                                  member_read_cb,
+                                  member_write_new(task, display, target));
+  }
+}
+
+/* Returns FALSE only if the write could not start; per-member failures
+ * are counted in @n_failed. */
+gboolean
+gnomeddc_group_write_set_vcp_finish(GnomeDdcWriteCoalescer *coalescer,
+                                    GAsyncResult *result,
+                                    guint *n_written,
+                                    guint *n_failed,
+                                    GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_WRITE_COALESCER(coalescer), FALSE);
+  g_return_val_if_fail(g_task_is_valid(result, coalescer), FALSE);
+
+  FanOutData *data = g_task_get_task_data(G_TASK(result));
+  if (n_written != NULL) {
+    *n_written = data->n_written;
+  }
+  if (n_failed != NULL) {
+    *n_failed = data->n_failed;
+  }
+  return g_task_propagate_boolean(G_TASK(result), error);
+}
@@ -0,0 +1,27 @@
+#ifndef GNOMEDDC_GROUP_WRITE_H
+#define GNOMEDDC_GROUP_WRITE_H
+
+#include "gnomeddc-group-store.h"
+#include "gnomeddc-write-coalescer.h"
+
+G_BEGIN_DECLS
+
+void gnomeddc_group_write_set_vcp_async(GnomeDdcWriteCoalescer *coalescer,
+                                        GnomeDdcGroupStore *store,
+                                        const gchar *name,
+                                        GListModel *displays,
+                                        guint8 vcp_code,
+                                        guint16 value,
+                                        guint flags,
+                                        GCancellable *cancellable,
+                                        GAsyncReadyCallback callback,
+                                        gpointer user_data);
+gboolean gnomeddc_group_write_set_vcp_finish(GnomeDdcWriteCoalescer *coalescer,
+                                             GAsyncResult *result,
+                                             guint *n_written,
+                                             guint *n_failed,
+                                             GError **error);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_GROUP_WRITE_H */
@@ -0,0 +1,35 @@
+#include "gnomeddc-json.h"
+
+/* Appends @value as a quoted JSON string. Input is expected to be UTF-8,
+ * which is what the service reports. */
+void
+gnomeddc_json_append_string(GString *json, const gchar *value)
+{
+  g_return_if_fail(json != NULL);
+
+  g_string_append_c(json, '"');
+  for (const gchar *p = value != NULL ? value : ""; *p != '\0'; p++) {
+    switch (*p) {
+    case '"':
+      g_string_append(json, "\\\"");
+      break;
+    case '\\':
+      g_string_append(json, "\\\\");
+      break;
+    case '\n':
+      g_string_append(json, "\\n");
+      break;
+    case '\t':
+      g_string_append(json, "\\t");
+      break;
+    default:
+      if ((guchar) *p < 0x20) {
+        g_string_append_printf(json, "\\u%04x", (guchar) *p);
+      } else {
+        g_string_append_c(json, *p);
+      }
+      break;
+    }
+  }
+  g_string_append_c(json, '"');
+}
@@ -0,0 +1,13 @@
+#ifndef GNOMEDDC_JSON_H
+#define GNOMEDDC_JSON_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+void gnomeddc_json_append_string(GString *json,
+                                 const gchar *value);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_JSON_H */
@@ -0,0 +1,419 @@
+#include "gnomeddc-profile-apply.h"
+
+#include "gnomeddc-vcp-batch.h"
+
+/*
+ * Applies profile settings with as few DDC writes as possible: the current
+ * values are fetched first with one GetMultipleVcp per display (through
+ * GnomeDdcVcpBatch), then SetVcp is only sent for codes that differ. Writes
+ * run in parallel across buses and one after another on a shared bus.
+ */
+
+typedef struct {
+  GnomeDdcDisplay *display;
+  GArray *settings;
+  /* indices into settings that still need a write */
+  GArray *pending;
+  guint next_write;
+  guint n_written;
+  guint n_skipped;
+  guint n_failed;
+  gchar *error;
+} ApplyEntry;
+
+typedef struct {
+  GQueue entries;
+} WriteLane;
+
+typedef struct {
+  GnomeDdcClient *client;
+  guint flags;
+  GnomeDdcVcpBatch *batch;
+  GHashTable *lanes;
+  guint outstanding;
+} RunData;
+
+struct _GnomeDdcProfileApply {
+  GObject parent_instance;
+
+  GPtrArray *entries;
+  gboolean running;
+};
+
+G_DEFINE_FINAL_TYPE(GnomeDdcProfileApply, gnomeddc_profile_apply, G_TYPE_OBJECT)
+
+static void
+apply_entry_reset(ApplyEntry *entry)
+{
+  g_array_set_size(entry->pending, 0);
+  entry->next_write = 0;
+  entry->n_written = 0;
+  entry->n_skipped = 0;
+  entry->n_failed = 0;
+  g_clear_pointer(&entry->error, g_free);
+}
+
+static void
+apply_entry_free(ApplyEntry *entry)
+{
+  g_clear_object(&entry->display);
+  g_clear_pointer(&entry->settings, g_array_unref);
+  g_clear_pointer(&entry->pending, g_array_unref);
+  g_clear_pointer(&entry->error, g_free);
+  g_free(entry);
+}
+
+static void
+write_lane_free(WriteLane *lane)
+{
+  g_queue_clear(&lane->entries);
+  g_free(lane);
+}
+
+static void
+run_data_free(RunData *data)
+{
+  g_clear_object(&data->client);
+  g_clear_object(&data->batch);
+  g_clear_pointer(&data->lanes, g_hash_table_unref);
+  g_free(data);
+}
+
+static void
+gnomeddc_profile_apply_finalize(GObject *object)
+{
+  GnomeDdcProfileApply *self = GNOMEDDC_PROFILE_APPLY(object);
+  g_clear_pointer(&self->entries, g_ptr_array_unref);
+  G_OBJECT_CLASS(gnomeddc_profile_apply_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_profile_apply_class_init(GnomeDdcProfileApplyClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_profile_apply_finalize;
+}
+
+static void
+gnomeddc_profile_apply_init(GnomeDdcProfileApply *self)
+{
+  self->entries = g_ptr_array_new_with_free_func((GDestroyNotify) apply_entry_free);
+}
+
+GnomeDdcProfileApply *
+gnomeddc_profile_apply_new(void)
+{
+  return g_object_new(GNOMEDDC_TYPE_PROFILE_APPLY, NULL);
+}
+
+void
+gnomeddc_profile_apply_add(GnomeDdcProfileApply *self,
+                           GnomeDdcDisplay *display,
+                           const GnomeDdcProfileSetting *settings,
+                           gsize n_settings)
+{
+  g_return_if_fail(GNOMEDDC_IS_PROFILE_APPLY(self));
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY(display));
+  g_return_if_fail(settings != NULL || n_settings == 0);
+  g_return_if_fail(!self->running);
+
+  ApplyEntry *entry = g_new0(ApplyEntry, 1);
+  entry->display = g_object_ref(display);
+  entry->settings = g_array_sized_new(FALSE, FALSE, sizeof(GnomeDdcProfileSetting), n_settings);
+  g_array_append_vals(entry->settings, settings, n_settings);
+  entry->pending = g_array_new(FALSE, FALSE, sizeof(guint));
+  g_ptr_array_add(self->entries, entry);
+}
+
+/* Adds every display in @displays that profile @name has settings for;
+ * returns how many were added. */
+guint
+gnomeddc_profile_apply_add_profile(GnomeDdcProfileApply *self,
+                                   GnomeDdcProfileStore *store,
+                                   const gchar *name,
+                                   GPtrArray *displays)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_APPLY(self), 0);
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_STORE(store), 0);
+  g_return_val_if_fail(name != NULL, 0);
+  g_return_val_if_fail(displays != NULL, 0);
+
+  guint added = 0;
+  for (guint i = 0; i < displays->len; i++) {
+    GnomeDdcDisplay *display = g_ptr_array_index(displays, i);
+    g_autoptr(GArray) settings = gnomeddc_profile_store_dup_settings(store, name, gnomeddc_display_get_edid(display));
+    if (settings->len == 0) {
+      continue;
+    }
+    gnomeddc_profile_apply_add(self, display, (const GnomeDdcProfileSetting *) settings->data, settings->len);
+    added++;
+  }
+  return added;
+}
+
+guint
+gnomeddc_profile_apply_get_n_entries(GnomeDdcProfileApply *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_APPLY(self), 0);
+  return self->entries->len;
+}
+
+static ApplyEntry *
+get_entry(GnomeDdcProfileApply *self, guint index)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_APPLY(self), NULL);
+  g_return_val_if_fail(index < self->entries->len, NULL);
+  return g_ptr_array_index(self->entries, index);
+}
+
+GnomeDdcDisplay *
+gnomeddc_profile_apply_get_display(GnomeDdcProfileApply *self, guint index)
+{
+  ApplyEntry *entry = get_entry(self, index);
+  return entry != NULL ? entry->display : NULL;
+}
+
+guint
+gnomeddc_profile_apply_get_n_written(GnomeDdcProfileApply *self, guint index)
+{
+  ApplyEntry *entry = get_entry(self, index);
+  return entry != NULL ? entry->n_written : 0;
+}
+
+/* Settings that already had the wanted value. */
+guint
+gnomeddc_profile_apply_get_n_skipped(GnomeDdcProfileApply *self, guint index)
+{
+  ApplyEntry *entry = get_entry(self, index);
+  return entry != NULL ? entry->n_skipped : 0;
+}
+
+guint
+gnomeddc_profile_apply_get_n_failed(GnomeDdcProfileApply *self, guint index)
+{
+  ApplyEntry *entry = get_entry(self, index);
+  return entry != NULL ? entry->n_failed : 0;
+}
+
+/* The first failure for the display, if any. */
+const gchar *
+gnomeddc_profile_apply_get_error(GnomeDdcProfileApply *self, guint index)
+{
+  ApplyEntry *entry = get_entry(self, index);
+  return entry != NULL ? entry->error : NULL;
+}
+
+static void
+record_failure(ApplyEntry *entry, const gchar *message)
+{
+  entry->n_failed++;
+  if (entry->error == NULL) {
+    entry->error = g_strdup(message);
+  }
+}
+
+static void lane_pump(GTask *task, WriteLane *lane);
+
+typedef struct {
+  GTask *task;
+  WriteLane *lane;
+  ApplyEntry *entry;
+} WriteCall;
+
+static void
+write_done_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  WriteCall *call = user_data;
+  GTask *task = call->task;
+  RunData *data = g_task_get_task_data(task);
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(data->client, result, &error);
+
+  if (response == NULL) {
+    record_failure(call->entry, error->message);
+  } else {
+    gint status = 0;
+    const gchar *message = NULL;
+    g_variant_get(response, "(i&s)", &status, &message);
+    if (status != 0) {
+      g_autofree gchar *text = g_strdup_printf("Status %d: %s", status, message);
+      record_failure(call->entry, text);
+    } else {
+      call->entry->n_written++;
+    }
+  }
+
+  call->entry->next_write++;
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    /* Drop the rest of this lane. */
+    g_queue_clear(&call->lane->entries);
+  }
+  lane_pump(task, call->lane);
+
+  g_object_unref(task);
+  g_free(call);
+}
+
+static void
+lane_pump(GTask *task, WriteLane *lane)
+{
+  GnomeDdcProfileApply *self = g_task_get_source_object(task);
+  RunData *data = g_task_get_task_data(task);
+
+  ApplyEntry *entry;
+  while ((entry = g_queue_peek_head(&lane->entries)) != NULL &&
+         entry->next_write >= entry->pending->len) {
+    g_queue_pop_head(&lane->entries);
+  }
+
+  if (entry == NULL) {
+    if (--data->outstanding == 0) {
+      self->running = FALSE;
+      g_task_return_boolean(task, TRUE);
+    }
+    return;
+  }
+
+  guint setting_index = g_array_index(entry->pending, guint, entry->next_write);
+  const GnomeDdcProfileSetting *setting = &g_array_index(entry->settings, GnomeDdcProfileSetting, setting_index);
+  WriteCall *call = g_new0(WriteCall, 1);
+  call->task = g_object_ref(task);
+  call->lane = lane;
+  call->entry = entry;
+
+  gnomeddc_client_set_vcp_async(data->client,
+                                entry->display,
+                                setting->code,
+                                setting->value,
+                                data->flags,
+                                GNOMEDDC_CALL_FLAGS_NONE,
+                                g_task_get_cancellable(task),
+                                write_done_cb,
+                                call);
+}
+
+/* Works out which settings differ from what the display reported. When
+ * the read failed nothing is known, so every setting is written. */
+static void
+plan_writes(ApplyEntry *entry, GnomeDdcVcpBatch *batch, guint index)
+{
+  gsize n_values = 0;
+  const GnomeDdcVcpValue *values = NULL;
+  if (gnomeddc_vcp_batch_get_error(batch, index) == NULL &&
+      gnomeddc_vcp_batch_get_status(batch, index) == 0) {
+    values = gnomeddc_vcp_batch_get_value_array(batch, index, &n_values);
+  }
+
+  for (guint i = 0; i < entry->settings->len; i++) {
+    const GnomeDdcProfileSetting *setting = &g_array_index(entry->settings, GnomeDdcProfileSetting, i);
+    gboolean up_to_date = FALSE;
+    for (gsize j = 0; j < n_values; j++) {
+      if (values[j].code == setting->code) {
+        up_to_date = values[j].current == setting->value;
+        break;
+      }
+    }
+
+    if (up_to_date) {
+      entry->n_skipped++;
+    } else {
+      g_array_append_val(entry->pending, i);
+    }
+  }
+}
+
+static void
+read_done_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  GnomeDdcProfileApply *self = g_task_get_source_object(task);
+  RunData *data = g_task_get_task_data(task);
+  GError *error = NULL;
+
+  if (!gnomeddc_vcp_batch_read_finish(GNOMEDDC_VCP_BATCH(source), result, &error)) {
+    self->running = FALSE;
+    g_task_return_error(task, error);
+    return;
+  }
+
+  for (guint i = 0; i < self->entries->len; i++) {
+    ApplyEntry *entry = g_ptr_array_index(self->entries, i);
+    plan_writes(entry, data->batch, i);
+    if (entry->pending->len == 0) {
+      continue;
+    }
+
+    gpointer bus_key = GINT_TO_POINTER(gnomeddc_display_get_bus_key(entry->display));
+    WriteLane *lane = g_hash_table_lookup(data->lanes, bus_key);
+    if (lane == NULL) {
+      lane = g_new0(WriteLane, 1);
+      g_queue_init(&lane->entries);
+      g_hash_table_insert(data->lanes, bus_key, lane);
+    }
+    g_queue_push_tail(&lane->entries, entry);
+  }
+
+  data->outstanding = g_hash_table_size(data->lanes);
+  if (data->outstanding == 0) {
+    self->running = FALSE;
+    g_task_return_boolean(task, TRUE);
+    return;
+  }
+
+  GHashTableIter iter;
+  gpointer lane;
+  g_hash_table_iter_init(&iter, data->lanes);
+  while (g_hash_table_iter_next(&iter, NULL, &lane)) {
+    lane_pump(task, lane);
+  }
+}
+
+/* Completes once every display has been handled; per-display failures are
+ * reported through the getters, only cancellation fails the whole run. */
+void
+gnomeddc_profile_apply_run_async(GnomeDdcProfileApply *self,
+                                 GnomeDdcClient *client,
+                                 guint flags,
+                                 GCancellable *cancellable,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_PROFILE_APPLY(self));
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(client));
+  g_return_if_fail(!self->running);
+
+  GTask *task = g_task_new(self, cancellable, callback, user_data);
+  g_task_set_source_tag(task, gnomeddc_profile_apply_run_async);
+  g_task_set_check_cancellable(task, TRUE);
+
+  RunData *data = g_new0(RunData, 1);
+  data->client = g_object_ref(client);
+  data->flags = flags;
+  data->batch = gnomeddc_vcp_batch_new();
+  data->lanes = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) write_lane_free);
+  g_task_set_task_data(task, data, (GDestroyNotify) run_data_free);
+
+  g_autoptr(GArray) codes = g_array_new(FALSE, FALSE, sizeof(guint8));
+  for (guint i = 0; i < self->entries->len; i++) {
+    ApplyEntry *entry = g_ptr_array_index(self->entries, i);
+    apply_entry_reset(entry);
+
+    g_array_set_size(codes, 0);
+    for (guint j = 0; j < entry->settings->len; j++) {
+      guint8 code = g_array_index(entry->settings, GnomeDdcProfileSetting, j).code;
+      g_array_append_val(codes, code);
+    }
+    gnomeddc_vcp_batch_add(data->batch, entry->display, (const guint8 *) codes->data, codes->len);
+  }
+
+  self->running = TRUE;
+  gnomeddc_vcp_batch_read_async(data->batch, client, flags, cancellable, read_done_cb, task);
+}
+
+gboolean
+gnomeddc_profile_apply_run_finish(GnomeDdcProfileApply *self, GAsyncResult *result, GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_APPLY(self), FALSE);
+  g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+  return g_task_propagate_boolean(G_TASK(result), error);
+}
@@ -0,0 +1,49 @@
+#ifndef GNOMEDDC_PROFILE_APPLY_H
+#define GNOMEDDC_PROFILE_APPLY_H
+
+#include "gnomeddc-client.h"
+#include "gnomeddc-display.h"
+#include "gnomeddc-profile-store.h"
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_PROFILE_APPLY (gnomeddc_profile_apply_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcProfileApply, gnomeddc_profile_apply, GNOMEDDC, PROFILE_APPLY, GObject)
+
+GnomeDdcProfileApply *gnomeddc_profile_apply_new(void);
+
+void gnomeddc_profile_apply_add(GnomeDdcProfileApply *self,
+                                GnomeDdcDisplay *display,
+                                const GnomeDdcProfileSetting *settings,
+                                gsize n_settings);
+guint gnomeddc_profile_apply_add_profile(GnomeDdcProfileApply *self,
+                                         GnomeDdcProfileStore *store,
+                                         const gchar *name,
+                                         GPtrArray *displays);
+
+guint gnomeddc_profile_apply_get_n_entries(GnomeDdcProfileApply *self);
+GnomeDdcDisplay *gnomeddc_profile_apply_get_display(GnomeDdcProfileApply *self,
+                                                    guint index);
+guint gnomeddc_profile_apply_get_n_written(GnomeDdcProfileApply *self,
+                                           guint index);
+guint gnomeddc_profile_apply_get_n_skipped(GnomeDdcProfileApply *self,
+                                           guint index);
+guint gnomeddc_profile_apply_get_n_failed(GnomeDdcProfileApply *self,
+                                          guint index);
+const gchar *gnomeddc_profile_apply_get_error(GnomeDdcProfileApply *self,
+                                              guint index);
+
+void gnomeddc_profile_apply_run_async(GnomeDdcProfileApply *self,
+                                      GnomeDdcClient *client,
+                                      guint flags,
+                                      GCancellable *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data);
+gboolean gnomeddc_profile_apply_run_finish(GnomeDdcProfileApply *self,
+                                           GAsyncResult *result,
+                                           GError **error);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_PROFILE_APPLY_H */
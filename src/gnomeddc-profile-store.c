@@ -0,0 +1,263 @@
+#include "gnomeddc-profile-store.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+#include <string.h>
+
+/*
+ * Profiles live in $XDG_CONFIG_HOME/gnomeddc/profiles.ini, one group per
+ * profile and one key per EDID:
+ *
+ *   [Profile night]
+ *   *=0x10=30;0x12=40;
+ *   00FFFFFFFFFFFF00…=0x10=20;
+ *
+ * "*" applies to every display; an EDID entry overrides it per code.
+ */
+
+#define GROUP_PREFIX "Profile "
+
+struct _GnomeDdcProfileStore {
+  GObject parent_instance;
+
+  gchar *path;
+  GKeyFile *key_file;
+};
+
+enum {
+  SIGNAL_CHANGED,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+G_DEFINE_FINAL_TYPE(GnomeDdcProfileStore, gnomeddc_profile_store, G_TYPE_OBJECT)
+
+static void
+gnomeddc_profile_store_finalize(GObject *object)
+{
+  GnomeDdcProfileStore *self = GNOMEDDC_PROFILE_STORE(object);
+  g_clear_pointer(&self->path, g_free);
+  g_clear_pointer(&self->key_file, g_key_file_unref);
+  G_OBJECT_CLASS(gnomeddc_profile_store_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_profile_store_class_init(GnomeDdcProfileStoreClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_profile_store_finalize;
+
+  /* Emitted whenever the profiles in memory change, saved or not, so
+   * everything listing them can follow. */
+  signals[SIGNAL_CHANGED] =
+    g_signal_new("changed",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 0);
+}
+
+static void
+gnomeddc_profile_store_init(GnomeDdcProfileStore *self)
+{
+  self->key_file = g_key_file_new();
+}
+
+GnomeDdcProfileStore *
+gnomeddc_profile_store_new(void)
+{
+  g_autofree gchar *path = g_build_filename(g_get_user_config_dir(), "gnomeddc", "profiles.ini", NULL);
+  return gnomeddc_profile_store_new_for_path(path);
+}
+
+/* Loads @path right away; a missing or unreadable file is an empty store. */
+GnomeDdcProfileStore *
+gnomeddc_profile_store_new_for_path(const gchar *path)
+{
+  g_return_val_if_fail(path != NULL, NULL);
+
+  GnomeDdcProfileStore *self = g_object_new(GNOMEDDC_TYPE_PROFILE_STORE, NULL);
+  self->path = g_strdup(path);
+
+  g_autoptr(GError) error = NULL;
+  if (!gnomeddc_profile_store_reload(self, &error) &&
+      !g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+    g_warning("Ignoring unreadable %s: %s", self->path, error->message);
+  }
+  return self;
+}
+
+gboolean
+gnomeddc_profile_store_reload(GnomeDdcProfileStore *self, GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_STORE(self), FALSE);
+
+  g_autoptr(GKeyFile) key_file = g_key_file_new();
+  if (!g_key_file_load_from_file(key_file, self->path, G_KEY_FILE_KEEP_COMMENTS, error)) {
+    return FALSE;
+  }
+  g_key_file_unref(self->key_file);
+  self->key_file = g_steal_pointer(&key_file);
+  g_signal_emit(self, signals[SIGNAL_CHANGED], 0);
+  return TRUE;
+}
+
+gboolean
+gnomeddc_profile_store_save(GnomeDdcProfileStore *self, GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_STORE(self), FALSE);
+
+  g_autofree gchar *directory = g_path_get_dirname(self->path);
+  if (g_mkdir_with_parents(directory, 0700) != 0) {
+    gint saved_errno = errno;
+    g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(saved_errno),
+                "Failed to create %s: %s", directory, g_strerror(saved_errno));
+    return FALSE;
+  }
+  return g_key_file_save_to_file(self->key_file, self->path, error);
+}
+
+static gchar *
+group_for_profile(const gchar *name)
+{
+  return g_strconcat(GROUP_PREFIX, name, NULL);
+}
+
+static gint
+compare_names(gconstpointer a, gconstpointer b)
+{
+  return g_utf8_collate(*(const gchar * const *) a, *(const gchar * const *) b);
+}
+
+/* Profile names, sorted for display. */
+GStrv
+gnomeddc_profile_store_dup_names(GnomeDdcProfileStore *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_STORE(self), NULL);
+
+  g_auto(GStrv) groups = g_key_file_get_groups(self->key_file, NULL);
+  GPtrArray *names = g_ptr_array_new();
+  for (guint i = 0; groups[i] != NULL; i++) {
+    if (g_str_has_prefix(groups[i], GROUP_PREFIX) && groups[i][sizeof(GROUP_PREFIX) - 1] != '\0') {
+      g_ptr_array_add(names, g_strdup(groups[i] + sizeof(GROUP_PREFIX) - 1));
+    }
+  }
+  g_ptr_array_sort(names, compare_names);
+  g_ptr_array_add(names, NULL);
+  return (GStrv) g_ptr_array_free(names, FALSE);
+}
+
+gboolean
+gnomeddc_profile_store_has_profile(GnomeDdcProfileStore *self, const gchar *name)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_STORE(self), FALSE);
+  g_return_val_if_fail(name != NULL, FALSE);
+
+  g_autofree gchar *group = group_for_profile(name);
+  return g_key_file_has_group(self->key_file, group);
+}
+
+/* Merges one "CODE=VALUE" list into @settings, replacing earlier entries
+ * for the same code. Malformed items are skipped. */
+static void
+merge_settings(GArray *settings, gchar **items)
+{
+  for (guint i = 0; items != NULL && items[i] != NULL; i++) {
+    g_auto(GStrv) parts = g_strsplit(items[i], "=", 2);
+    gchar *endptr = NULL;
+    if (g_strv_length(parts) != 2) {
+      continue;
+    }
+    /* g_ascii_strtoull() accepts an empty string as 0. */
+    const gchar *code_text = g_strstrip(parts[0]);
+    const gchar *value_text = g_strstrip(parts[1]);
+    if (*code_text == '\0' || *value_text == '\0') {
+      continue;
+    }
+    guint64 code = g_ascii_strtoull(code_text, &endptr, 0);
+    if (*endptr != '\0' || code > G_MAXUINT8) {
+      continue;
+    }
+    guint64 value = g_ascii_strtoull(value_text, &endptr, 0);
+    if (*endptr != '\0' || value > G_MAXUINT16) {
+      continue;
+    }
+
+    GnomeDdcProfileSetting setting = { (guint8) code, (guint16) value };
+    guint j;
+    for (j = 0; j < settings->len; j++) {
+      if (g_array_index(settings, GnomeDdcProfileSetting, j).code == setting.code) {
+        g_array_index(settings, GnomeDdcProfileSetting, j) = setting;
+        break;
+      }
+    }
+    if (j == settings->len) {
+      g_array_append_val(settings, setting);
+    }
+  }
+}
+
+/* The settings profile @name has for the display with @edid, in file
+ * order; empty when the profile does not cover it. */
+GArray *
+gnomeddc_profile_store_dup_settings(GnomeDdcProfileStore *self, const gchar *name, const gchar *edid)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_STORE(self), NULL);
+  g_return_val_if_fail(name != NULL, NULL);
+
+  GArray *settings = g_array_new(FALSE, FALSE, sizeof(GnomeDdcProfileSetting));
+  g_autofree gchar *group = group_for_profile(name);
+
+  g_auto(GStrv) any = g_key_file_get_string_list(self->key_file, group, GNOMEDDC_PROFILE_ANY_DISPLAY, NULL, NULL);
+  merge_settings(settings, any);
+
+  if (edid != NULL && *edid != '\0') {
+    g_auto(GStrv) own = g_key_file_get_string_list(self->key_file, group, edid, NULL, NULL);
+    merge_settings(settings, own);
+  }
+  return settings;
+}
+
+/* Replaces the settings for @edid (or GNOMEDDC_PROFILE_ANY_DISPLAY) in
+ * profile @name, creating the profile if needed. Call
+ * gnomeddc_profile_store_save() to persist. */
+gboolean
+gnomeddc_profile_store_set_settings(GnomeDdcProfileStore *self,
+                                    const gchar *name,
+                                    const gchar *edid,
+                                    const GnomeDdcProfileSetting *settings,
+                                    gsize n_settings)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_PROFILE_STORE(self), FALSE);
+  g_return_val_if_fail(name != NULL, FALSE);
+  g_return_val_if_fail(settings != NULL || n_settings == 0, FALSE);
+
+  /* Group names cannot hold brackets or line breaks. */
+  if (*name == '\0' || strpbrk(name, "[]\n\r") != NULL || edid == NULL || *edid == '\0') {
+    return FALSE;
+  }
+
+  g_autofree gchar *group = group_for_profile(name);
+  g_autoptr(GPtrArray) items = g_ptr_array_new_full(n_settings, g_free);
+  for (gsize i = 0; i < n_settings; i++) {
+    g_ptr_array_add(items, g_strdup_printf("0x%02X=%u", settings[i].code, settings[i].value));
+  }
+  g_key_file_set_string_list(self->key_file, group, edid,
+                             (const gchar * const *) items->pdata, items->len);
+  g_signal_emit(self, signals[SIGNAL_CHANGED], 0);
+  return TRUE;
+}
+
+void
+gnomeddc_profile_store_remove(GnomeDdcProfileStore *self, const gchar *name)
+{
+  g_return_if_fail(GNOMEDDC_IS_PROFILE_STORE(self));
+  g_return_if_fail(name != NULL);
+
+  g_autofree gchar *group = group_for_profile(name);
+  if (g_key_file_remove_group(self->key_file, group, NULL)) {
+    g_signal_emit(self, signals[SIGNAL_CHANGED], 0);
+  }
+}
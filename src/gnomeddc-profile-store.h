@@ -0,0 +1,44 @@
+#ifndef GNOMEDDC_PROFILE_STORE_H
+#define GNOMEDDC_PROFILE_STORE_H
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_PROFILE_STORE (gnomeddc_profile_store_get_type())
+
+/* Settings stored under this EDID apply to every display. */
+#define GNOMEDDC_PROFILE_ANY_DISPLAY "*"
+
+G_DECLARE_FINAL_TYPE(GnomeDdcProfileStore, gnomeddc_profile_store, GNOMEDDC, PROFILE_STORE, GObject)
+
+typedef struct {
+  guint8 code;
+  guint16 value;
+} GnomeDdcProfileSetting;
+
+GnomeDdcProfileStore *gnomeddc_profile_store_new(void);
+GnomeDdcProfileStore *gnomeddc_profile_store_new_for_path(const gchar *path);
+
+gboolean gnomeddc_profile_store_reload(GnomeDdcProfileStore *self,
+                                       GError **error);
+gboolean gnomeddc_profile_store_save(GnomeDdcProfileStore *self,
+                                     GError **error);
+
+GStrv gnomeddc_profile_store_dup_names(GnomeDdcProfileStore *self);
+gboolean gnomeddc_profile_store_has_profile(GnomeDdcProfileStore *self,
+                                            const gchar *name);
+GArray *gnomeddc_profile_store_dup_settings(GnomeDdcProfileStore *self,
+                                            const gchar *name,
+                                            const gchar *edid);
+gboolean gnomeddc_profile_store_set_settings(GnomeDdcProfileStore *self,
+                                             const gchar *name,
+                                             const gchar *edid,
+                                             const GnomeDdcProfileSetting *settings,
+                                             gsize n_settings);
+void gnomeddc_profile_store_remove(GnomeDdcProfileStore *self,
+                                   const gchar *name);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_PROFILE_STORE_H */
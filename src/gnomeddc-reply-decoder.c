@@ -0,0 +1,261 @@
+#include "gnomeddc-reply-decoder.h"
+
+#include "gnomeddc-display.h"
+#include "gnomeddc-trace.h"
+
+/*
+ * Decoding of the larger service replies on a GTask worker thread. Replies
+ * are immutable, so the worker only reads them and hands back finished
+ * objects; nothing it creates is touched by another thread until the
+ * callback runs on the caller's main context.
+ */
+
+typedef struct {
+  GVariant *reply;
+  gint status;
+  gchar *message;
+} DecodeData;
+
+static void
+decode_data_free(DecodeData *data)
+{
+  g_variant_unref(data->reply);
+  g_free(data->message);
+  g_free(data);
+}
+
+static GTask *
+decode_task_new(GVariant *reply,
+                gpointer source_tag,
+                GCancellable *cancellable,
+                GAsyncReadyCallback callback,
+                gpointer user_data)
+{
+  GTask *task = g_task_new(NULL, cancellable, callback, user_data);
+  g_task_set_source_tag(task, source_tag);
+
+  DecodeData *data = g_new0(DecodeData, 1);
+  data->reply = g_variant_ref_sink(reply);
+  g_task_set_task_data(task, data, (GDestroyNotify) decode_data_free);
+  return task;
+}
+
+void
+gnomeddc_display_list_reply_free(GnomeDdcDisplayListReply *reply)
+{
+  if (reply == NULL) {
+    return;
+  }
+  g_clear_pointer(&reply->displays, g_ptr_array_unref);
+  g_free(reply->message);
+  g_free(reply);
+}
+
+void
+gnomeddc_capabilities_reply_free(GnomeDdcCapabilitiesReply *reply)
+{
+  if (reply == NULL) {
+    return;
+  }
+  g_clear_pointer(&reply->metadata, g_variant_unref);
+  g_clear_object(&reply->features);
+  g_free(reply->model_name);
+  g_free(reply->message);
+  g_free(reply->summary);
+  g_free(reply);
+}
+
+/* Appends one "0xCC — current/max — formatted" line per value. */
+void
+gnomeddc_vcp_values_format(GString *text,
+                           const gchar *indent,
+                           const GnomeDdcVcpValue *values,
+                           gsize n_values)
+{
+  g_return_if_fail(text != NULL);
+  g_return_if_fail(values != NULL || n_values == 0);
+
+  for (gsize i = 0; i < n_values; i++) {
+    g_string_append_printf(text, "%s0x%02X — %u/%u — %s\n",
+                           indent != NULL ? indent : "",
+                           values[i].code,
+                           values[i].current,
+                           values[i].max,
+                           values[i].formatted);
+  }
+}
+
+static void
+decode_display_list_thread(GTask *task,
+                           gpointer source_object G_GNUC_UNUSED,
+                           gpointer task_data,
+                           GCancellable *cancellable G_GNUC_UNUSED)
+{
+  GNOMEDDC_TRACE_FUNCTION("decode");
+  DecodeData *data = task_data;
+  GnomeDdcDisplayListReply *reply = g_new0(GnomeDdcDisplayListReply, 1);
+  gint reported_count = 0;
+  g_autoptr(GVariant) array = NULL;
+
+  g_variant_get(data->reply, "(i@a" GNOMEDDC_DISPLAY_ENTRY_TYPE "is)",
+                &reported_count, &array, &reply->status, &reply->message);
+
+  /* Each display keeps its entry (and so the reply buffer) alive instead
+   * of copying the strings out of it. */
+  reply->displays = g_ptr_array_new_full(g_variant_n_children(array), g_object_unref);
+  GVariantIter iter;
+  GVariant *entry;
+  g_variant_iter_init(&iter, array);
+  while ((entry = g_variant_iter_next_value(&iter)) != NULL) {
+    g_ptr_array_add(reply->displays, gnomeddc_display_new_from_variant(entry));
+    g_variant_unref(entry);
+  }
+
+  g_task_return_pointer(task, reply, (GDestroyNotify) gnomeddc_display_list_reply_free);
+}
+
+/* Decodes a ListDetected or Detect reply. */
+void
+gnomeddc_decode_display_list_async(GVariant *reply,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data)
+{
+  g_return_if_fail(reply != NULL);
+  g_return_if_fail(g_variant_is_of_type(reply, G_VARIANT_TYPE("(ia" GNOMEDDC_DISPLAY_ENTRY_TYPE "is)")));
+
+  g_autoptr(GTask) task = decode_task_new(reply, gnomeddc_decode_display_list_async,
+                                          cancellable, callback, user_data);
+  g_task_run_in_thread(task, decode_display_list_thread);
+}
+
+GnomeDdcDisplayListReply *
+gnomeddc_decode_display_list_finish(GAsyncResult *result, GError **error)
+{
+  g_return_val_if_fail(g_task_is_valid(result, NULL), NULL);
+  g_return_val_if_fail(g_task_get_source_tag(G_TASK(result)) == gnomeddc_decode_display_list_async, NULL);
+
+  return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+format_vcp_values_thread(GTask *task,
+                         gpointer source_object G_GNUC_UNUSED,
+                         gpointer task_data,
+                         GCancellable *cancellable G_GNUC_UNUSED)
+{
+  GNOMEDDC_TRACE_FUNCTION("decode");
+  DecodeData *data = task_data;
+  gsize n_values = 0;
+  g_autofree GnomeDdcVcpValue *values = gnomeddc_vcp_values_decode(data->reply, &n_values);
+  GString *text = g_string_sized_new(n_values * 32);
+
+  gnomeddc_vcp_values_format(text, "", values, n_values);
+  g_task_return_pointer(task, g_string_free(text, FALSE), g_free);
+}
+
+/* Formats the a(yqqs) array of a GetMultipleVcp reply as text. */
+void
+gnomeddc_format_vcp_values_async(GVariant *values,
+                                 GCancellable *cancellable,
+                                 GAsyncReadyCallback callback,
+                                 gpointer user_data)
+{
+  g_return_if_fail(values != NULL);
+  g_return_if_fail(g_variant_is_of_type(values, G_VARIANT_TYPE("a(yqqs)")));
+
+  g_autoptr(GTask) task = decode_task_new(values, gnomeddc_format_vcp_values_async,
+                                          cancellable, callback, user_data);
+  g_task_run_in_thread(task, format_vcp_values_thread);
+}
+
+gchar *
+gnomeddc_format_vcp_values_finish(GAsyncResult *result, GError **error)
+{
+  g_return_val_if_fail(g_task_is_valid(result, NULL), NULL);
+  g_return_val_if_fail(g_task_get_source_tag(G_TASK(result)) == gnomeddc_format_vcp_values_async, NULL);
+
+  return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void
+decode_capabilities_thread(GTask *task,
+                           gpointer source_object G_GNUC_UNUSED,
+                           gpointer task_data,
+                           GCancellable *cancellable G_GNUC_UNUSED)
+{
+  GNOMEDDC_TRACE_FUNCTION("decode");
+  DecodeData *data = task_data;
+  GnomeDdcCapabilitiesReply *reply = g_new0(GnomeDdcCapabilitiesReply, 1);
+  g_autoptr(GVariant) commands = NULL;
+  g_autoptr(GVariant) features = NULL;
+
+  reply->metadata = g_variant_ref(data->reply);
+  reply->status = data->status;
+  reply->message = g_strdup(data->message);
+  g_variant_get(data->reply, "(syy@a{ys}@a{y(ssa{ys})})",
+                &reply->model_name,
+                &reply->mccs_major,
+                &reply->mccs_minor,
+                &commands,
+                &features);
+
+  GString *text = g_string_new(NULL);
+  g_string_append_printf(text,
+                         "Model: %s\n"
+                         "MCCS: %u.%u\n"
+                         "Status: %d (%s)\n"
+                         "\n"
+                         "Commands:\n",
+                         reply->model_name,
+                         reply->mccs_major,
+                         reply->mccs_minor,
+                         reply->status,
+                         reply->message != NULL ? reply->message : "");
+
+  GVariantIter cmd_iter;
+  guint8 cmd_code;
+  const gchar *cmd_desc;
+  g_variant_iter_init(&cmd_iter, commands);
+  while (g_variant_iter_next(&cmd_iter, "{y&s}", &cmd_code, &cmd_desc)) {
+    g_string_append_printf(text, "  0x%02X — %s\n", cmd_code, cmd_desc);
+  }
+  g_string_append_printf(text, "\nFeatures: %" G_GSIZE_FORMAT "\n", g_variant_n_children(features));
+  reply->summary = g_string_free(text, FALSE);
+
+  /* The feature objects themselves are still created by the model as the
+   * list view scrolls to them. */
+  reply->features = gnomeddc_capabilities_model_new(features);
+
+  g_task_return_pointer(task, reply, (GDestroyNotify) gnomeddc_capabilities_reply_free);
+}
+
+/* Builds the summary and feature model of a capabilities record, either
+ * cached or split off a GetCapabilitiesMetadata reply. */
+void
+gnomeddc_decode_capabilities_async(GVariant *metadata,
+                                   gint status,
+                                   const gchar *message,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data)
+{
+  g_return_if_fail(metadata != NULL);
+  g_return_if_fail(g_variant_is_of_type(metadata, G_VARIANT_TYPE("(syya{ys}a{y(ssa{ys})})")));
+
+  g_autoptr(GTask) task = decode_task_new(metadata, gnomeddc_decode_capabilities_async,
+                                          cancellable, callback, user_data);
+  DecodeData *data = g_task_get_task_data(task);
+  data->status = status;
+  data->message = g_strdup(message);
+  g_task_run_in_thread(task, decode_capabilities_thread);
+}
+
+GnomeDdcCapabilitiesReply *
+gnomeddc_decode_capabilities_finish(GAsyncResult *result, GError **error)
+{
+  g_return_val_if_fail(g_task_is_valid(result, NULL), NULL);
+  g_return_val_if_fail(g_task_get_source_tag(G_TASK(result)) == gnomeddc_decode_capabilities_async, NULL);
+
+  return g_task_propagate_pointer(G_TASK(result), error);
+}
@@ -0,0 +1,68 @@
+#ifndef GNOMEDDC_REPLY_DECODER_H
+#define GNOMEDDC_REPLY_DECODER_H
+
+#include <gio/gio.h>
+
+#include "gnomeddc-capabilities-model.h"
+#include "gnomeddc-vcp-batch.h"
+
+G_BEGIN_DECLS
+
+/* A ListDetected/Detect reply turned into GnomeDdcDisplay objects. */
+typedef struct {
+  GPtrArray *displays;
+  gint status;
+  gchar *message;
+} GnomeDdcDisplayListReply;
+
+/* A parsed capabilities record with its text summary and feature model. */
+typedef struct {
+  /* (syya{ys}a{y(ssa{ys})}), as stored by the capabilities cache */
+  GVariant *metadata;
+  gchar *model_name;
+  guint8 mccs_major;
+  guint8 mccs_minor;
+  gint status;
+  gchar *message;
+  /* Header and command list */
+  gchar *summary;
+  GnomeDdcCapabilitiesModel *features;
+} GnomeDdcCapabilitiesReply;
+
+void gnomeddc_display_list_reply_free(GnomeDdcDisplayListReply *reply);
+void gnomeddc_capabilities_reply_free(GnomeDdcCapabilitiesReply *reply);
+
+void gnomeddc_vcp_values_format(GString *text,
+                                const gchar *indent,
+                                const GnomeDdcVcpValue *values,
+                                gsize n_values);
+
+void gnomeddc_decode_display_list_async(GVariant *reply,
+                                        GCancellable *cancellable,
+                                        GAsyncReadyCallback callback,
+                                        gpointer user_data);
+GnomeDdcDisplayListReply *gnomeddc_decode_display_list_finish(GAsyncResult *result,
+                                                              GError **error);
+
+void gnomeddc_format_vcp_values_async(GVariant *values,
+                                      GCancellable *cancellable,
+                                      GAsyncReadyCallback callback,
+                                      gpointer user_data);
+gchar *gnomeddc_format_vcp_values_finish(GAsyncResult *result,
+                                         GError **error);
+
+void gnomeddc_decode_capabilities_async(GVariant *metadata,
+                                        gint status,
+                                        const gchar *message,
+                                        GCancellable *cancellable,
+                                        GAsyncReadyCallback callback,
+                                        gpointer user_data);
+GnomeDdcCapabilitiesReply *gnomeddc_decode_capabilities_finish(GAsyncResult *result,
+                                                               GError **error);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GnomeDdcDisplayListReply, gnomeddc_display_list_reply_free)
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(GnomeDdcCapabilitiesReply, gnomeddc_capabilities_reply_free)
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_REPLY_DECODER_H */
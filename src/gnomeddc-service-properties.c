@@ -0,0 +1,314 @@
+#include "gnomeddc-service-properties.h"
+
+#define DDCUTIL_INTERFACE_NAME "com.ddcutil.DdcutilInterface"
+
+/* Mirror of ddcutil-service's properties, kept current from the proxy's
+ * g-properties-changed deltas. "changed" is only emitted for values that
+ * actually differ, so tables that never change after start-up, like
+ * StatusValues, are handled once per service (re)start. */
+struct _GnomeDdcServiceProperties {
+  GObject parent_instance;
+
+  GDBusProxy *proxy;
+  GCancellable *cancellable;
+  /* name -> GVariant */
+  GHashTable *values;
+  /* a{is} property name -> (code -> name borrowed from the value), built
+   * on first lookup */
+  GHashTable *tables;
+};
+
+enum {
+  SIGNAL_CHANGED,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+G_DEFINE_FINAL_TYPE(GnomeDdcServiceProperties, gnomeddc_service_properties, G_TYPE_OBJECT)
+
+/* Takes a reference to @value. */
+static void
+update_value(GnomeDdcServiceProperties *self, const gchar *name, GVariant *value)
+{
+  GVariant *old_value = g_hash_table_lookup(self->values, name);
+  if (old_value != NULL && g_variant_equal(old_value, value)) {
+    return;
+  }
+
+  g_hash_table_remove(self->tables, name);
+  g_hash_table_replace(self->values, g_strdup(name), g_variant_ref_sink(value));
+  g_signal_emit(self, signals[SIGNAL_CHANGED], g_quark_from_string(name), name, value);
+}
+
+static void
+merge_dict(GnomeDdcServiceProperties *self, GVariant *dict)
+{
+  GVariantIter iter;
+  const gchar *name;
+  GVariant *value;
+
+  g_variant_iter_init(&iter, dict);
+  while (g_variant_iter_next(&iter, "{&sv}", &name, &value)) {
+    update_value(self, name, value);
+    g_variant_unref(value);
+  }
+}
+
+typedef struct {
+  GnomeDdcServiceProperties *self;
+  gchar *name;
+} GetData;
+
+static void
+get_property_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  GetData *data = user_data;
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) reply = g_dbus_proxy_call_finish(G_DBUS_PROXY(source), result, &error);
+
+  if (reply != NULL) {
+    g_autoptr(GVariant) value = NULL;
+    g_variant_get(reply, "(v)", &value);
+    update_value(data->self, data->name, value);
+  }
+
+  g_object_unref(data->self);
+  g_free(data->name);
+  g_free(data);
+}
+
+static void
+proxy_properties_changed_cb(GDBusProxy *proxy,
+                            GVariant *changed_properties,
+                            GStrv invalidated_properties,
+                            gpointer user_data)
+{
+  GnomeDdcServiceProperties *self = GNOMEDDC_SERVICE_PROPERTIES(user_data);
+
+  merge_dict(self, changed_properties);
+
+  /* The proxy only drops invalidated properties; fetch them again so
+   * listeners still see the new value. */
+  for (guint i = 0; invalidated_properties != NULL && invalidated_properties[i] != NULL; i++) {
+    GetData *data = g_new(GetData, 1);
+    data->self = g_object_ref(self);
+    data->name = g_strdup(invalidated_properties[i]);
+    g_dbus_proxy_call(proxy,
+                      "org.freedesktop.DBus.Properties.Get",
+                      g_variant_new("(ss)", DDCUTIL_INTERFACE_NAME, invalidated_properties[i]),
+                      G_DBUS_CALL_FLAGS_NONE,
+                      -1,
+                      self->cancellable,
+                      get_property_cb,
+                      data);
+  }
+}
+
+static void
+gnomeddc_service_properties_dispose(GObject *object)
+{
+  GnomeDdcServiceProperties *self = GNOMEDDC_SERVICE_PROPERTIES(object);
+
+  g_cancellable_cancel(self->cancellable);
+  gnomeddc_service_properties_set_proxy(self, NULL);
+
+  G_OBJECT_CLASS(gnomeddc_service_properties_parent_class)->dispose(object);
+}
+
+static void
+gnomeddc_service_properties_finalize(GObject *object)
+{
+  GnomeDdcServiceProperties *self = GNOMEDDC_SERVICE_PROPERTIES(object);
+
+  g_clear_object(&self->cancellable);
+  g_clear_pointer(&self->tables, g_hash_table_unref);
+  g_clear_pointer(&self->values, g_hash_table_unref);
+
+  G_OBJECT_CLASS(gnomeddc_service_properties_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_service_properties_class_init(GnomeDdcServicePropertiesClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->dispose = gnomeddc_service_properties_dispose;
+  object_class->finalize = gnomeddc_service_properties_finalize;
+
+  /* A property got a new value; detailed by the property name. */
+  signals[SIGNAL_CHANGED] =
+    g_signal_new("changed",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST | G_SIGNAL_DETAILED,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 2, G_TYPE_STRING, G_TYPE_VARIANT);
+}
+
+static void
+gnomeddc_service_properties_init(GnomeDdcServiceProperties *self)
+{
+  self->cancellable = g_cancellable_new();
+  self->values = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_variant_unref);
+  self->tables = g_hash_table_new_full(g_str_hash, g_str_equal, g_free, (GDestroyNotify) g_hash_table_unref);
+}
+
+GnomeDdcServiceProperties *
+gnomeddc_service_properties_new(void)
+{
+  return g_object_new(GNOMEDDC_TYPE_SERVICE_PROPERTIES, NULL);
+}
+
+/* Takes every property the proxy has cached and follows its changes from
+ * then on. Values from an earlier load_dict() that the service does not
+ * have are dropped. */
+void
+gnomeddc_service_properties_set_proxy(GnomeDdcServiceProperties *self,
+                                      GDBusProxy *proxy)
+{
+  g_return_if_fail(GNOMEDDC_IS_SERVICE_PROPERTIES(self));
+  g_return_if_fail(proxy == NULL || G_IS_DBUS_PROXY(proxy));
+
+  if (self->proxy != NULL) {
+    g_signal_handlers_disconnect_by_data(self->proxy, self);
+    g_clear_object(&self->proxy);
+  }
+
+  if (proxy == NULL) {
+    return;
+  }
+
+  self->proxy = g_object_ref(proxy);
+  g_signal_connect(proxy, "g-properties-changed", G_CALLBACK(proxy_properties_changed_cb), self);
+
+  g_auto(GStrv) names = g_dbus_proxy_get_cached_property_names(proxy);
+  g_autoptr(GHashTable) live = g_hash_table_new(g_str_hash, g_str_equal);
+  for (guint i = 0; names != NULL && names[i] != NULL; i++) {
+    g_autoptr(GVariant) value = g_dbus_proxy_get_cached_property(proxy, names[i]);
+    if (value != NULL) {
+      update_value(self, names[i], value);
+      g_hash_table_add(live, names[i]);
+    }
+  }
+
+  GHashTableIter iter;
+  const gchar *name;
+  g_hash_table_iter_init(&iter, self->values);
+  while (g_hash_table_iter_next(&iter, (gpointer *) &name, NULL)) {
+    if (!g_hash_table_contains(live, name)) {
+      g_hash_table_remove(self->tables, name);
+      g_hash_table_iter_remove(&iter);
+    }
+  }
+}
+
+static void
+get_all_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  GnomeDdcServiceProperties *self = GNOMEDDC_SERVICE_PROPERTIES(user_data);
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) reply = g_dbus_proxy_call_finish(G_DBUS_PROXY(source), result, &error);
+
+  if (reply != NULL) {
+    g_autoptr(GVariant) dict = g_variant_get_child_value(reply, 0);
+    merge_dict(self, dict);
+  } else if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    g_warning("Failed to read service properties: %s", error->message);
+  }
+  g_object_unref(self);
+}
+
+/* One GetAll, for when the service reinitialised itself without changing
+ * its bus name and so without telling the proxy. */
+void
+gnomeddc_service_properties_refresh(GnomeDdcServiceProperties *self)
+{
+  g_return_if_fail(GNOMEDDC_IS_SERVICE_PROPERTIES(self));
+
+  if (self->proxy == NULL) {
+    return;
+  }
+
+  g_dbus_proxy_call(self->proxy,
+                    "org.freedesktop.DBus.Properties.GetAll",
+                    g_variant_new("(s)", DDCUTIL_INTERFACE_NAME),
+                    G_DBUS_CALL_FLAGS_NONE,
+                    -1,
+                    self->cancellable,
+                    get_all_cb,
+                    g_object_ref(self));
+}
+
+/* Seeds the model from an a{sv} saved earlier, e.g. by the state
+ * snapshot, before the proxy is up. */
+void
+gnomeddc_service_properties_load_dict(GnomeDdcServiceProperties *self,
+                                      GVariant *dict)
+{
+  g_return_if_fail(GNOMEDDC_IS_SERVICE_PROPERTIES(self));
+  g_return_if_fail(dict != NULL && g_variant_is_of_type(dict, G_VARIANT_TYPE_VARDICT));
+
+  merge_dict(self, dict);
+}
+
+/* Returns a floating a{sv} of every known property. */
+GVariant *
+gnomeddc_service_properties_dup_dict(GnomeDdcServiceProperties *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_SERVICE_PROPERTIES(self), NULL);
+
+  GVariantBuilder builder;
+  GHashTableIter iter;
+  const gchar *name;
+  GVariant *value;
+
+  g_variant_builder_init(&builder, G_VARIANT_TYPE_VARDICT);
+  g_hash_table_iter_init(&iter, self->values);
+  while (g_hash_table_iter_next(&iter, (gpointer *) &name, (gpointer *) &value)) {
+    g_variant_builder_add(&builder, "{sv}", name, value);
+  }
+  return g_variant_builder_end(&builder);
+}
+
+/* Returns the current value of @name, owned by the model, or NULL. */
+GVariant *
+gnomeddc_service_properties_get_value(GnomeDdcServiceProperties *self,
+                                      const gchar *name)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_SERVICE_PROPERTIES(self), NULL);
+  g_return_val_if_fail(name != NULL, NULL);
+
+  return g_hash_table_lookup(self->values, name);
+}
+
+/* Looks @code up in an a{is} property such as StatusValues or
+ * DisplayEventTypes. The table is indexed on first use and kept until the
+ * property changes; the returned name is owned by the model. */
+const gchar *
+gnomeddc_service_properties_lookup_name(GnomeDdcServiceProperties *self,
+                                        const gchar *table,
+                                        gint code)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_SERVICE_PROPERTIES(self), NULL);
+  g_return_val_if_fail(table != NULL, NULL);
+
+  GHashTable *index = g_hash_table_lookup(self->tables, table);
+  if (index == NULL) {
+    GVariant *value = g_hash_table_lookup(self->values, table);
+    if (value == NULL || !g_variant_is_of_type(value, G_VARIANT_TYPE("a{is}"))) {
+      return NULL;
+    }
+
+    index = g_hash_table_new(NULL, NULL);
+    GVariantIter iter;
+    gint entry_code;
+    const gchar *name;
+    g_variant_iter_init(&iter, value);
+    while (g_variant_iter_next(&iter, "{i&s}", &entry_code, &name)) {
+      g_hash_table_insert(index, GINT_TO_POINTER(entry_code), (gpointer) name);
+    }
+    g_hash_table_insert(self->tables, g_strdup(table), index);
+  }
+
+  return g_hash_table_lookup(index, GINT_TO_POINTER(code));
+}
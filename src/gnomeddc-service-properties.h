@@ -0,0 +1,29 @@
+#ifndef GNOMEDDC_SERVICE_PROPERTIES_H
+#define GNOMEDDC_SERVICE_PROPERTIES_H
+
+#include <gio/gio.h>
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_SERVICE_PROPERTIES (gnomeddc_service_properties_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcServiceProperties, gnomeddc_service_properties, GNOMEDDC, SERVICE_PROPERTIES, GObject)
+
+GnomeDdcServiceProperties *gnomeddc_service_properties_new(void);
+
+void gnomeddc_service_properties_set_proxy(GnomeDdcServiceProperties *self,
+                                           GDBusProxy *proxy);
+void gnomeddc_service_properties_refresh(GnomeDdcServiceProperties *self);
+void gnomeddc_service_properties_load_dict(GnomeDdcServiceProperties *self,
+                                           GVariant *dict);
+GVariant *gnomeddc_service_properties_dup_dict(GnomeDdcServiceProperties *self);
+
+GVariant *gnomeddc_service_properties_get_value(GnomeDdcServiceProperties *self,
+                                                const gchar *name);
+const gchar *gnomeddc_service_properties_lookup_name(GnomeDdcServiceProperties *self,
+                                                     const gchar *table,
+                                                     gint code);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_SERVICE_PROPERTIES_H */
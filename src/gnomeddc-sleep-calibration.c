@@ -0,0 +1,486 @@
+#include "gnomeddc-sleep-calibration.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+
+/*
+ * Finds the lowest sleep multiplier a display tolerates. The multiplier is
+ * stepped down from 1.0; at each step the same feature is read repeatedly,
+ * bypassing the VCP cache, and the step passes when enough reads come back
+ * with status 0. The sweep stops at the first failing step, the last
+ * passing multiplier is applied and saved per EDID in
+ * $XDG_CONFIG_HOME/gnomeddc/calibration.ini.
+ */
+
+#define DEFAULT_READS_PER_STEP 20
+#define DEFAULT_MIN_SUCCESS_RATE 0.95
+#define DEFAULT_FEATURE_CODE 0x10
+
+static const gdouble sweep[] = { 1.0, 0.8, 0.6, 0.5, 0.4, 0.3, 0.2, 0.1 };
+
+struct _GnomeDdcSleepCalibration {
+  GObject parent_instance;
+
+  GnomeDdcClient *client;
+  GnomeDdcDisplay *display;
+  guint reads_per_step;
+  gdouble min_success_rate;
+  guint8 feature_code;
+  GArray *steps;
+  gboolean running;
+};
+
+typedef struct {
+  gdouble original;
+  gdouble chosen;
+  guint step;
+  gint64 read_start;
+  gint64 success_usec;
+} RunData;
+
+enum {
+  SIGNAL_STEP_FINISHED,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+G_DEFINE_FINAL_TYPE(GnomeDdcSleepCalibration, gnomeddc_sleep_calibration, G_TYPE_OBJECT)
+
+static void
+gnomeddc_sleep_calibration_finalize(GObject *object)
+{
+  GnomeDdcSleepCalibration *self = GNOMEDDC_SLEEP_CALIBRATION(object);
+  g_clear_object(&self->client);
+  g_clear_object(&self->display);
+  g_clear_pointer(&self->steps, g_array_unref);
+  G_OBJECT_CLASS(gnomeddc_sleep_calibration_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_sleep_calibration_class_init(GnomeDdcSleepCalibrationClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_sleep_calibration_finalize;
+
+  /* Emitted with the index of each sweep step once its reads are done. */
+  signals[SIGNAL_STEP_FINISHED] =
+    g_signal_new("step-finished",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 1, G_TYPE_UINT);
+}
+
+static void
+gnomeddc_sleep_calibration_init(GnomeDdcSleepCalibration *self)
+{
+  self->reads_per_step = DEFAULT_READS_PER_STEP;
+  self->min_success_rate = DEFAULT_MIN_SUCCESS_RATE;
+  self->feature_code = DEFAULT_FEATURE_CODE;
+  self->steps = g_array_new(FALSE, TRUE, sizeof(GnomeDdcCalibrationStep));
+}
+
+GnomeDdcSleepCalibration *
+gnomeddc_sleep_calibration_new(GnomeDdcClient *client, GnomeDdcDisplay *display)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(client), NULL);
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(display), NULL);
+
+  GnomeDdcSleepCalibration *self = g_object_new(GNOMEDDC_TYPE_SLEEP_CALIBRATION, NULL);
+  self->client = g_object_ref(client);
+  self->display = g_object_ref(display);
+  return self;
+}
+
+void
+gnomeddc_sleep_calibration_set_reads_per_step(GnomeDdcSleepCalibration *self, guint reads)
+{
+  g_return_if_fail(GNOMEDDC_IS_SLEEP_CALIBRATION(self));
+  g_return_if_fail(reads > 0);
+  g_return_if_fail(!self->running);
+  self->reads_per_step = reads;
+}
+
+void
+gnomeddc_sleep_calibration_set_min_success_rate(GnomeDdcSleepCalibration *self, gdouble rate)
+{
+  g_return_if_fail(GNOMEDDC_IS_SLEEP_CALIBRATION(self));
+  g_return_if_fail(rate > 0.0 && rate <= 1.0);
+  g_return_if_fail(!self->running);
+  self->min_success_rate = rate;
+}
+
+/* The feature that is read at every step; should be supported by every
+ * monitor, hence brightness by default. */
+void
+gnomeddc_sleep_calibration_set_feature_code(GnomeDdcSleepCalibration *self, guint8 code)
+{
+  g_return_if_fail(GNOMEDDC_IS_SLEEP_CALIBRATION(self));
+  g_return_if_fail(!self->running);
+  self->feature_code = code;
+}
+
+guint
+gnomeddc_sleep_calibration_get_n_sweep_steps(GnomeDdcSleepCalibration *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_SLEEP_CALIBRATION(self), 0);
+  return G_N_ELEMENTS(sweep);
+}
+
+/* Number of steps measured so far; the sweep may stop before the end. */
+guint
+gnomeddc_sleep_calibration_get_n_steps(GnomeDdcSleepCalibration *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_SLEEP_CALIBRATION(self), 0);
+  return self->steps->len;
+}
+
+gboolean
+gnomeddc_sleep_calibration_get_step(GnomeDdcSleepCalibration *self,
+                                    guint index,
+                                    GnomeDdcCalibrationStep *step)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_SLEEP_CALIBRATION(self), FALSE);
+  g_return_val_if_fail(step != NULL, FALSE);
+
+  if (index >= self->steps->len) {
+    return FALSE;
+  }
+  *step = g_array_index(self->steps, GnomeDdcCalibrationStep, index);
+  return TRUE;
+}
+
+static gchar *
+get_calibration_path(void)
+{
+  return g_build_filename(g_get_user_config_dir(), "gnomeddc", "calibration.ini", NULL);
+}
+
+gboolean
+gnomeddc_sleep_calibration_lookup_saved(const gchar *edid, gdouble *multiplier)
+{
+  g_return_val_if_fail(multiplier != NULL, FALSE);
+
+  if (edid == NULL || *edid == '\0') {
+    return FALSE;
+  }
+
+  g_autofree gchar *path = get_calibration_path();
+  g_autoptr(GKeyFile) key_file = g_key_file_new();
+  if (!g_key_file_load_from_file(key_file, path, G_KEY_FILE_NONE, NULL)) {
+    return FALSE;
+  }
+
+  g_autoptr(GError) error = NULL;
+  gdouble value = g_key_file_get_double(key_file, edid, "multiplier", &error);
+  if (error != NULL) {
+    return FALSE;
+  }
+  *multiplier = value;
+  return TRUE;
+}
+
+static void
+save_result(GnomeDdcSleepCalibration *self, gdouble multiplier, const GnomeDdcCalibrationStep *step)
+{
+  const gchar *edid = gnomeddc_display_get_edid(self->display);
+  if (*edid == '\0') {
+    return;
+  }
+
+  g_autofree gchar *path = get_calibration_path();
+  g_autofree gchar *directory = g_path_get_dirname(path);
+  g_autoptr(GKeyFile) key_file = g_key_file_new();
+  g_autoptr(GError) error = NULL;
+
+  if (!g_key_file_load_from_file(key_file, path, G_KEY_FILE_KEEP_COMMENTS, &error) &&
+      !g_error_matches(error, G_FILE_ERROR, G_FILE_ERROR_NOENT)) {
+    g_warning("Ignoring unreadable %s: %s", path, error->message);
+  }
+  g_clear_error(&error);
+
+  g_autoptr(GDateTime) now = g_date_time_new_now_utc();
+  g_autofree gchar *timestamp = g_date_time_format_iso8601(now);
+  g_key_file_set_double(key_file, edid, "multiplier", multiplier);
+  g_key_file_set_integer(key_file, edid, "reads-per-step", (gint) self->reads_per_step);
+  g_key_file_set_double(key_file, edid, "min-success-rate", self->min_success_rate);
+  g_key_file_set_int64(key_file, edid, "mean-latency-usec", step->mean_usec);
+  g_key_file_set_string(key_file, edid, "calibrated-at", timestamp);
+
+  if (g_mkdir_with_parents(directory, 0700) != 0 ||
+      !g_key_file_save_to_file(key_file, path, &error)) {
+    g_warning("Failed to save sleep calibration to %s: %s",
+              path, error != NULL ? error->message : g_strerror(errno));
+  }
+}
+
+static void
+set_multiplier(GnomeDdcSleepCalibration *self,
+               gdouble multiplier,
+               GCancellable *cancellable,
+               GAsyncReadyCallback callback,
+               gpointer user_data)
+{
+  gnomeddc_client_call_async(self->client,
+                             "SetSleepMultiplier",
+                             g_variant_new("(isdu)",
+                                           gnomeddc_display_get_display_number(self->display),
+                                           gnomeddc_display_get_edid(self->display),
+                                           multiplier,
+                                           0),
+                             cancellable,
+                             callback,
+                             user_data);
+}
+
+static void
+restore_done_cb(GObject *source, GAsyncResult *result, gpointer user_data G_GNUC_UNUSED)
+{
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(GNOMEDDC_CLIENT(source), result, &error);
+  if (error != NULL) {
+    g_warning("Failed to restore the sleep multiplier: %s", error->message);
+  }
+}
+
+/* Puts the original multiplier back; deliberately not cancellable. */
+static void
+fail_and_restore(GTask *task, GError *error)
+{
+  GnomeDdcSleepCalibration *self = g_task_get_source_object(task);
+  RunData *data = g_task_get_task_data(task);
+
+  set_multiplier(self, data->original, NULL, restore_done_cb, NULL);
+  self->running = FALSE;
+  g_task_return_error(task, error);
+}
+
+/* SetSleepMultiplier replies (is); a non-zero status is a failure too. */
+static gboolean
+check_status_reply(GnomeDdcClient *client, GAsyncResult *result, GError **error)
+{
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(client, result, error);
+  if (response == NULL) {
+    return FALSE;
+  }
+
+  gint status = 0;
+  const gchar *message = NULL;
+  g_variant_get(response, "(i&s)", &status, &message);
+  if (status != 0) {
+    g_set_error(error, G_IO_ERROR, G_IO_ERROR_FAILED,
+                "SetSleepMultiplier failed with status %d: %s", status, message);
+    return FALSE;
+  }
+  return TRUE;
+}
+
+static void start_step(GTask *task);
+static void read_next(GTask *task);
+
+static void
+apply_done_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  GnomeDdcSleepCalibration *self = g_task_get_source_object(task);
+  RunData *data = g_task_get_task_data(task);
+  GError *error = NULL;
+
+  if (!check_status_reply(GNOMEDDC_CLIENT(source), result, &error)) {
+    fail_and_restore(task, error);
+    return;
+  }
+
+  /* The last passing step is the one that was chosen. */
+  for (guint i = self->steps->len; i-- > 0;) {
+    const GnomeDdcCalibrationStep *step = &g_array_index(self->steps, GnomeDdcCalibrationStep, i);
+    if (step->multiplier == data->chosen) {
+      save_result(self, data->chosen, step);
+      break;
+    }
+  }
+
+  self->running = FALSE;
+  g_task_return_boolean(task, TRUE);
+}
+
+static void
+finish_sweep(GTask *task)
+{
+  GnomeDdcSleepCalibration *self = g_task_get_source_object(task);
+  RunData *data = g_task_get_task_data(task);
+
+  if (data->chosen <= 0.0) {
+    fail_and_restore(task, g_error_new(G_IO_ERROR, G_IO_ERROR_FAILED,
+                                       "No multiplier reached a %.0f%% success rate",
+                                       self->min_success_rate * 100.0));
+    return;
+  }
+
+  set_multiplier(self, data->chosen, g_task_get_cancellable(task), apply_done_cb, g_object_ref(task));
+}
+
+static void
+read_done_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  GnomeDdcSleepCalibration *self = g_task_get_source_object(task);
+  RunData *data = g_task_get_task_data(task);
+  GnomeDdcCalibrationStep *step = &g_array_index(self->steps, GnomeDdcCalibrationStep, data->step);
+  g_autoptr(GError) error = NULL;
+
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(GNOMEDDC_CLIENT(source), result, &error);
+  gint64 elapsed = g_get_monotonic_time() - data->read_start;
+
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    fail_and_restore(task, g_steal_pointer(&error));
+    return;
+  }
+
+  /* Transport errors count against the multiplier just like DDC errors:
+   * a timed out read is exactly what too short sleeps produce. */
+  step->reads++;
+  if (response != NULL) {
+    gint status = -1;
+    g_variant_get(response, "(qqsis)", NULL, NULL, NULL, &status, NULL);
+    if (status == 0) {
+      step->successes++;
+      data->success_usec += elapsed;
+    }
+  }
+
+  read_next(task);
+}
+
+static void
+read_next(GTask *task)
+{
+  GnomeDdcSleepCalibration *self = g_task_get_source_object(task);
+  RunData *data = g_task_get_task_data(task);
+  GnomeDdcCalibrationStep *step = &g_array_index(self->steps, GnomeDdcCalibrationStep, data->step);
+
+  if (step->reads < self->reads_per_step) {
+    data->read_start = g_get_monotonic_time();
+    gnomeddc_client_get_vcp_async(self->client,
+                                  self->display,
+                                  self->feature_code,
+                                  0,
+                                  GNOMEDDC_CALL_FLAGS_BYPASS_CACHE | GNOMEDDC_CALL_FLAGS_NO_RETRY,
+                                  g_task_get_cancellable(task),
+                                  read_done_cb,
+                                  g_object_ref(task));
+    return;
+  }
+
+  step->mean_usec = step->successes > 0 ? data->success_usec / step->successes : 0;
+  g_signal_emit(self, signals[SIGNAL_STEP_FINISHED], 0, data->step);
+
+  if ((gdouble) step->successes < self->min_success_rate * (gdouble) step->reads) {
+    /* Shorter sleeps only get worse from here. */
+    finish_sweep(task);
+    return;
+  }
+
+  data->chosen = step->multiplier;
+  data->step++;
+  start_step(task);
+}
+
+static void
+step_multiplier_set_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  GError *error = NULL;
+
+  if (!check_status_reply(GNOMEDDC_CLIENT(source), result, &error)) {
+    fail_and_restore(task, error);
+    return;
+  }
+  read_next(task);
+}
+
+static void
+start_step(GTask *task)
+{
+  GnomeDdcSleepCalibration *self = g_task_get_source_object(task);
+  RunData *data = g_task_get_task_data(task);
+
+  if (data->step >= G_N_ELEMENTS(sweep)) {
+    finish_sweep(task);
+    return;
+  }
+
+  GnomeDdcCalibrationStep step = { .multiplier = sweep[data->step] };
+  g_array_append_val(self->steps, step);
+  data->success_usec = 0;
+
+  set_multiplier(self, step.multiplier, g_task_get_cancellable(task), step_multiplier_set_cb, g_object_ref(task));
+}
+
+static void
+original_multiplier_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GTask) task = user_data;
+  GnomeDdcSleepCalibration *self = g_task_get_source_object(task);
+  RunData *data = g_task_get_task_data(task);
+  GError *error = NULL;
+
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(GNOMEDDC_CLIENT(source), result, &error);
+  if (response == NULL) {
+    self->running = FALSE;
+    g_task_return_error(task, error);
+    return;
+  }
+
+  gint status = 0;
+  g_variant_get(response, "(dis)", &data->original, &status, NULL);
+  if (status != 0 || data->original <= 0.0) {
+    data->original = 1.0;
+  }
+  start_step(task);
+}
+
+void
+gnomeddc_sleep_calibration_run_async(GnomeDdcSleepCalibration *self,
+                                     GCancellable *cancellable,
+                                     GAsyncReadyCallback callback,
+                                     gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_SLEEP_CALIBRATION(self));
+  g_return_if_fail(!self->running);
+
+  GTask *task = g_task_new(self, cancellable, callback, user_data);
+  g_task_set_source_tag(task, gnomeddc_sleep_calibration_run_async);
+  g_task_set_task_data(task, g_new0(RunData, 1), g_free);
+
+  self->running = TRUE;
+  g_array_set_size(self->steps, 0);
+
+  gnomeddc_client_call_display_async(self->client,
+                                     "GetSleepMultiplier",
+                                     self->display,
+                                     0,
+                                     GNOMEDDC_CALL_FLAGS_NONE,
+                                     cancellable,
+                                     original_multiplier_cb,
+                                     task);
+}
+
+/* Returns the multiplier that was applied, or a negative value on error. */
+gdouble
+gnomeddc_sleep_calibration_run_finish(GnomeDdcSleepCalibration *self,
+                                      GAsyncResult *result,
+                                      GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_SLEEP_CALIBRATION(self), -1.0);
+  g_return_val_if_fail(g_task_is_valid(result, self), -1.0);
+
+  if (!g_task_propagate_boolean(G_TASK(result), error)) {
+    return -1.0;
+  }
+
+  RunData *data = g_task_get_task_data(G_TASK(result));
+  return data->chosen;
+}
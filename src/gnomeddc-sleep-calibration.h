@@ -0,0 +1,49 @@
+#ifndef GNOMEDDC_SLEEP_CALIBRATION_H
+#define GNOMEDDC_SLEEP_CALIBRATION_H
+
+#include "gnomeddc-client.h"
+#include "gnomeddc-display.h"
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_SLEEP_CALIBRATION (gnomeddc_sleep_calibration_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcSleepCalibration, gnomeddc_sleep_calibration, GNOMEDDC, SLEEP_CALIBRATION, GObject)
+
+typedef struct {
+  gdouble multiplier;
+  guint reads;
+  guint successes;
+  gint64 mean_usec;
+} GnomeDdcCalibrationStep;
+
+GnomeDdcSleepCalibration *gnomeddc_sleep_calibration_new(GnomeDdcClient *client,
+                                                         GnomeDdcDisplay *display);
+
+void gnomeddc_sleep_calibration_set_reads_per_step(GnomeDdcSleepCalibration *self,
+                                                   guint reads);
+void gnomeddc_sleep_calibration_set_min_success_rate(GnomeDdcSleepCalibration *self,
+                                                     gdouble rate);
+void gnomeddc_sleep_calibration_set_feature_code(GnomeDdcSleepCalibration *self,
+                                                 guint8 code);
+
+guint gnomeddc_sleep_calibration_get_n_sweep_steps(GnomeDdcSleepCalibration *self);
+guint gnomeddc_sleep_calibration_get_n_steps(GnomeDdcSleepCalibration *self);
+gboolean gnomeddc_sleep_calibration_get_step(GnomeDdcSleepCalibration *self,
+                                             guint index,
+                                             GnomeDdcCalibrationStep *step);
+
+void gnomeddc_sleep_calibration_run_async(GnomeDdcSleepCalibration *self,
+                                          GCancellable *cancellable,
+                                          GAsyncReadyCallback callback,
+                                          gpointer user_data);
+gdouble gnomeddc_sleep_calibration_run_finish(GnomeDdcSleepCalibration *self,
+                                              GAsyncResult *result,
+                                              GError **error);
+
+gboolean gnomeddc_sleep_calibration_lookup_saved(const gchar *edid,
+                                                 gdouble *multiplier);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_SLEEP_CALIBRATION_H */
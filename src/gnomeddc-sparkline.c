@@ -0,0 +1,127 @@
+#include "gnomeddc-sparkline.h"
+
+#include <string.h>
+
+/*
+ * A small line chart of monitor samples, plotted against time so that the
+ * varying poll interval does not distort it. The vertical range is the
+ * feature's maximum when known, otherwise the largest sample.
+ */
+
+#define SPARKLINE_WIDTH 120
+#define SPARKLINE_HEIGHT 24
+#define LINE_WIDTH 1.5
+
+struct _GnomeDdcSparkline {
+  GtkWidget parent_instance;
+
+  GnomeDdcVcpSample samples[GNOMEDDC_VCP_MONITOR_HISTORY];
+  gsize n_samples;
+  guint16 max_value;
+};
+
+G_DEFINE_FINAL_TYPE(GnomeDdcSparkline, gnomeddc_sparkline, GTK_TYPE_WIDGET)
+
+static void
+gnomeddc_sparkline_measure(GtkWidget *widget G_GNUC_UNUSED,
+                           GtkOrientation orientation,
+                           int for_size G_GNUC_UNUSED,
+                           int *minimum,
+                           int *natural,
+                           int *minimum_baseline G_GNUC_UNUSED,
+                           int *natural_baseline G_GNUC_UNUSED)
+{
+  *minimum = *natural = orientation == GTK_ORIENTATION_HORIZONTAL ? SPARKLINE_WIDTH : SPARKLINE_HEIGHT;
+}
+
+static void
+gnomeddc_sparkline_snapshot(GtkWidget *widget, GtkSnapshot *snapshot)
+{
+  GnomeDdcSparkline *self = GNOMEDDC_SPARKLINE(widget);
+  int width = gtk_widget_get_width(widget);
+  int height = gtk_widget_get_height(widget);
+
+  if (self->n_samples == 0 || width <= 0 || height <= 0) {
+    return;
+  }
+
+  guint16 top = self->max_value;
+  for (gsize i = 0; i < self->n_samples; i++) {
+    top = MAX(top, self->samples[i].value);
+  }
+  if (top == 0) {
+    top = 1;
+  }
+
+  gint64 first = self->samples[0].time;
+  gint64 span = self->samples[self->n_samples - 1].time - first;
+  gdouble usable = height - LINE_WIDTH;
+
+  GdkRGBA color;
+  gtk_widget_get_color(widget, &color);
+
+  cairo_t *cr = gtk_snapshot_append_cairo(snapshot, &GRAPHENE_RECT_INIT(0, 0, width, height));
+  gdk_cairo_set_source_rgba(cr, &color);
+  cairo_set_line_width(cr, LINE_WIDTH);
+  cairo_set_line_join(cr, CAIRO_LINE_JOIN_ROUND);
+
+  for (gsize i = 0; i < self->n_samples; i++) {
+    gdouble x = span > 0 ? (gdouble) (self->samples[i].time - first) * width / span : width;
+    gdouble y = LINE_WIDTH / 2 + usable * (1.0 - (gdouble) self->samples[i].value / top);
+    if (i == 0) {
+      cairo_move_to(cr, span > 0 ? x : 0, y);
+    } else {
+      cairo_line_to(cr, x, y);
+    }
+  }
+  if (self->n_samples == 1) {
+    cairo_rel_line_to(cr, width, 0);
+  }
+  cairo_stroke(cr);
+  cairo_destroy(cr);
+}
+
+static void
+gnomeddc_sparkline_class_init(GnomeDdcSparklineClass *klass)
+{
+  GtkWidgetClass *widget_class = GTK_WIDGET_CLASS(klass);
+  widget_class->measure = gnomeddc_sparkline_measure;
+  widget_class->snapshot = gnomeddc_sparkline_snapshot;
+  gtk_widget_class_set_css_name(widget_class, "sparkline");
+}
+
+static void
+gnomeddc_sparkline_init(GnomeDdcSparkline *self)
+{
+  gtk_widget_set_valign(GTK_WIDGET(self), GTK_ALIGN_CENTER);
+}
+
+GtkWidget *
+gnomeddc_sparkline_new(void)
+{
+  return g_object_new(GNOMEDDC_TYPE_SPARKLINE, NULL);
+}
+
+/* Copies the samples, oldest first; only the most recent
+ * GNOMEDDC_VCP_MONITOR_HISTORY are kept. */
+void
+gnomeddc_sparkline_set_samples(GnomeDdcSparkline *self,
+                               const GnomeDdcVcpSample *samples,
+                               gsize n_samples,
+                               guint16 max_value)
+{
+  g_return_if_fail(GNOMEDDC_IS_SPARKLINE(self));
+  g_return_if_fail(samples != NULL || n_samples == 0);
+
+  if (n_samples > GNOMEDDC_VCP_MONITOR_HISTORY) {
+    samples += n_samples - GNOMEDDC_VCP_MONITOR_HISTORY;
+    n_samples = GNOMEDDC_VCP_MONITOR_HISTORY;
+  }
+
+  if (n_samples > 0) {
+    memcpy(self->samples, samples, n_samples * sizeof(GnomeDdcVcpSample));
+  }
+  self->n_samples = n_samples;
+  self->max_value = max_value;
+  gtk_widget_queue_draw(GTK_WIDGET(self));
+}
@@ -0,0 +1,23 @@
+#ifndef GNOMEDDC_SPARKLINE_H
+#define GNOMEDDC_SPARKLINE_H
+
+#include <gtk/gtk.h>
+
+#include "gnomeddc-vcp-monitor.h"
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_SPARKLINE (gnomeddc_sparkline_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcSparkline, gnomeddc_sparkline, GNOMEDDC, SPARKLINE, GtkWidget)
+
+GtkWidget *gnomeddc_sparkline_new(void);
+
+void gnomeddc_sparkline_set_samples(GnomeDdcSparkline *self,
+                                    const GnomeDdcVcpSample *samples,
+                                    gsize n_samples,
+                                    guint16 max_value);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_SPARKLINE_H */
@@ -0,0 +1,178 @@
+#include "gnomeddc-state-snapshot.h"
+
+#include "gnomeddc-display.h"
+
+#include <errno.h>
+#include <glib/gstdio.h>
+
+/*
+ * The last known display list and service properties, kept so the window
+ * has something to show before ddcutil-service answers:
+ *
+ *   (u format, a(iiisssqsu) displays, a{sv} properties)
+ *
+ * Like the capabilities cache the file is little-endian and is loaded
+ * straight from a mapping.
+ */
+#define SNAPSHOT_FORMAT_VERSION 1
+#define SNAPSHOT_DISPLAYS_TYPE "a" GNOMEDDC_DISPLAY_ENTRY_TYPE
+#define SNAPSHOT_TYPE "(u" SNAPSHOT_DISPLAYS_TYPE "a{sv})"
+
+struct _GnomeDdcStateSnapshot {
+  GObject parent_instance;
+
+  gchar *path;
+  GVariant *displays;
+  GVariant *properties;
+};
+
+G_DEFINE_FINAL_TYPE(GnomeDdcStateSnapshot, gnomeddc_state_snapshot, G_TYPE_OBJECT)
+
+static void
+gnomeddc_state_snapshot_finalize(GObject *object)
+{
+  GnomeDdcStateSnapshot *self = GNOMEDDC_STATE_SNAPSHOT(object);
+  g_clear_pointer(&self->path, g_free);
+  g_clear_pointer(&self->displays, g_variant_unref);
+  g_clear_pointer(&self->properties, g_variant_unref);
+  G_OBJECT_CLASS(gnomeddc_state_snapshot_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_state_snapshot_class_init(GnomeDdcStateSnapshotClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_state_snapshot_finalize;
+}
+
+static void
+gnomeddc_state_snapshot_init(GnomeDdcStateSnapshot *self G_GNUC_UNUSED)
+{
+}
+
+GnomeDdcStateSnapshot *
+gnomeddc_state_snapshot_new(void)
+{
+  g_autofree gchar *path = g_build_filename(g_get_user_cache_dir(), "gnomeddc", "state.gvariant", NULL);
+  return gnomeddc_state_snapshot_new_for_path(path);
+}
+
+GnomeDdcStateSnapshot *
+gnomeddc_state_snapshot_new_for_path(const gchar *path)
+{
+  g_return_val_if_fail(path != NULL, NULL);
+
+  GnomeDdcStateSnapshot *self = g_object_new(GNOMEDDC_TYPE_STATE_SNAPSHOT, NULL);
+  self->path = g_strdup(path);
+  return self;
+}
+
+/* Reads the file synchronously; it is a few hundred bytes and is needed
+ * before the first frame. Returns FALSE when there is no usable snapshot. */
+gboolean
+gnomeddc_state_snapshot_load(GnomeDdcStateSnapshot *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_STATE_SNAPSHOT(self), FALSE);
+
+  g_clear_pointer(&self->displays, g_variant_unref);
+  g_clear_pointer(&self->properties, g_variant_unref);
+
+  GMappedFile *mapped = g_mapped_file_new(self->path, FALSE, NULL);
+  if (mapped == NULL) {
+    return FALSE;
+  }
+
+  g_autoptr(GBytes) bytes = g_mapped_file_get_bytes(mapped);
+  g_mapped_file_unref(mapped);
+
+  g_autoptr(GVariant) snapshot = g_variant_ref_sink(g_variant_new_from_bytes(G_VARIANT_TYPE(SNAPSHOT_TYPE), bytes, FALSE));
+  if (G_BYTE_ORDER != G_LITTLE_ENDIAN) {
+    GVariant *swapped = g_variant_byteswap(snapshot);
+    g_variant_unref(snapshot);
+    snapshot = swapped;
+  }
+
+  guint32 version = 0;
+  g_variant_get_child(snapshot, 0, "u", &version);
+  if (version != SNAPSHOT_FORMAT_VERSION) {
+    return FALSE;
+  }
+
+  g_variant_get(snapshot, "(u@" SNAPSHOT_DISPLAYS_TYPE "@a{sv})", NULL, &self->displays, &self->properties);
+  return TRUE;
+}
+
+gboolean
+gnomeddc_state_snapshot_save(GnomeDdcStateSnapshot *self, GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_STATE_SNAPSHOT(self), FALSE);
+  g_return_val_if_fail(error == NULL || *error == NULL, FALSE);
+
+  GVariant *displays = self->displays != NULL
+                         ? self->displays
+                         : g_variant_new_array(G_VARIANT_TYPE(GNOMEDDC_DISPLAY_ENTRY_TYPE), NULL, 0);
+  GVariant *properties = self->properties != NULL
+                           ? self->properties
+                           : g_variant_new_array(G_VARIANT_TYPE("{sv}"), NULL, 0);
+  g_autoptr(GVariant) snapshot = g_variant_ref_sink(
+    g_variant_new("(u@" SNAPSHOT_DISPLAYS_TYPE "@a{sv})", SNAPSHOT_FORMAT_VERSION, displays, properties));
+
+  g_autoptr(GVariant) on_disk = G_BYTE_ORDER == G_LITTLE_ENDIAN
+                                  ? g_variant_get_normal_form(snapshot)
+                                  : g_variant_byteswap(snapshot);
+  g_autofree gchar *directory = g_path_get_dirname(self->path);
+
+  if (g_mkdir_with_parents(directory, 0700) != 0) {
+    gint saved_errno = errno;
+    g_set_error(error, G_FILE_ERROR, g_file_error_from_errno(saved_errno),
+                "Unable to create %s: %s", directory, g_strerror(saved_errno));
+    return FALSE;
+  }
+
+  return g_file_set_contents(self->path,
+                             g_variant_get_data(on_disk),
+                             g_variant_get_size(on_disk),
+                             error);
+}
+
+/* Returns the a(iiisssqsu) display array, or NULL when none was loaded. */
+GVariant *
+gnomeddc_state_snapshot_get_displays(GnomeDdcStateSnapshot *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_STATE_SNAPSHOT(self), NULL);
+  return self->displays;
+}
+
+/* Returns the a{sv} service property dictionary, or NULL. */
+GVariant *
+gnomeddc_state_snapshot_get_properties(GnomeDdcStateSnapshot *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_STATE_SNAPSHOT(self), NULL);
+  return self->properties;
+}
+
+void
+gnomeddc_state_snapshot_set_displays(GnomeDdcStateSnapshot *self, GVariant *displays)
+{
+  g_return_if_fail(GNOMEDDC_IS_STATE_SNAPSHOT(self));
+  g_return_if_fail(displays == NULL || g_variant_is_of_type(displays, G_VARIANT_TYPE(SNAPSHOT_DISPLAYS_TYPE)));
+
+  if (displays != NULL) {
+    g_variant_ref_sink(displays);
+  }
+  g_clear_pointer(&self->displays, g_variant_unref);
+  self->displays = displays;
+}
+
+void
+gnomeddc_state_snapshot_set_properties(GnomeDdcStateSnapshot *self, GVariant *properties)
+{
+  g_return_if_fail(GNOMEDDC_IS_STATE_SNAPSHOT(self));
+  g_return_if_fail(properties == NULL || g_variant_is_of_type(properties, G_VARIANT_TYPE_VARDICT));
+
+  if (properties != NULL) {
+    g_variant_ref_sink(properties);
+  }
+  g_clear_pointer(&self->properties, g_variant_unref);
+  self->properties = properties;
+}
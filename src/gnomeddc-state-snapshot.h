@@ -0,0 +1,29 @@
+#ifndef GNOMEDDC_STATE_SNAPSHOT_H
+#define GNOMEDDC_STATE_SNAPSHOT_H
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_STATE_SNAPSHOT (gnomeddc_state_snapshot_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcStateSnapshot, gnomeddc_state_snapshot, GNOMEDDC, STATE_SNAPSHOT, GObject)
+
+GnomeDdcStateSnapshot *gnomeddc_state_snapshot_new(void);
+GnomeDdcStateSnapshot *gnomeddc_state_snapshot_new_for_path(const gchar *path);
+
+gboolean gnomeddc_state_snapshot_load(GnomeDdcStateSnapshot *self);
+gboolean gnomeddc_state_snapshot_save(GnomeDdcStateSnapshot *self,
+                                      GError **error);
+
+GVariant *gnomeddc_state_snapshot_get_displays(GnomeDdcStateSnapshot *self);
+GVariant *gnomeddc_state_snapshot_get_properties(GnomeDdcStateSnapshot *self);
+
+void gnomeddc_state_snapshot_set_displays(GnomeDdcStateSnapshot *self,
+                                          GVariant *displays);
+void gnomeddc_state_snapshot_set_properties(GnomeDdcStateSnapshot *self,
+                                            GVariant *properties);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_STATE_SNAPSHOT_H */
@@ -0,0 +1,47 @@
+#include "gnomeddc-trace.h"
+
+#ifdef GNOMEDDC_ENABLE_TRACING
+
+#ifdef HAVE_SYSPROF
+#include <sysprof-capture.h>
+#endif
+
+/* Monotonic microseconds; Sysprof uses the same clock in nanoseconds. */
+gint64
+gnomeddc_trace_now(void)
+{
+  return g_get_monotonic_time();
+}
+
+/* Records a span from @begin to now under @group/@name, with the message
+ * built from @format. Safe to call from worker threads. */
+void
+gnomeddc_trace_mark(gint64 begin,
+                    const gchar *group,
+                    const gchar *name,
+                    const gchar *format,
+                    ...)
+{
+  gint64 duration = g_get_monotonic_time() - begin;
+  va_list args;
+
+  va_start(args, format);
+#ifdef HAVE_SYSPROF
+  if (sysprof_collector_is_active()) {
+    sysprof_collector_mark_vprintf(begin * 1000, duration * 1000, group, name, format, args);
+    va_end(args);
+    return;
+  }
+#endif
+  g_autofree gchar *message = g_strdup_vprintf(format, args);
+  va_end(args);
+  g_debug("%s %s %.3f ms %s", group, name, duration / 1000.0, message);
+}
+
+void
+gnomeddc_trace_span_end(GnomeDdcTraceSpan *span)
+{
+  gnomeddc_trace_mark(span->begin, span->group, span->name, "%s", "");
+}
+
+#endif
@@ -0,0 +1,51 @@
+#ifndef GNOMEDDC_TRACE_H
+#define GNOMEDDC_TRACE_H
+
+#include <glib.h>
+
+G_BEGIN_DECLS
+
+/*
+ * Timing marks for the call, decode and UI pipeline, built with
+ * -Dtracing=true. Marks go to Sysprof when it is recording and to
+ * g_debug() otherwise; without the option everything here compiles away.
+ */
+
+#ifdef GNOMEDDC_ENABLE_TRACING
+
+typedef struct {
+  gint64 begin;
+  const gchar *group;
+  const gchar *name;
+} GnomeDdcTraceSpan;
+
+gint64 gnomeddc_trace_now(void);
+void gnomeddc_trace_mark(gint64 begin,
+                         const gchar *group,
+                         const gchar *name,
+                         const gchar *format,
+                         ...) G_GNUC_PRINTF(4, 5);
+void gnomeddc_trace_span_end(GnomeDdcTraceSpan *span);
+
+G_DEFINE_AUTO_CLEANUP_CLEAR_FUNC(GnomeDdcTraceSpan, gnomeddc_trace_span_end)
+
+/* Marks the time from here to the end of the enclosing function. */
+#define GNOMEDDC_TRACE_FUNCTION(group) \
+  g_auto(GnomeDdcTraceSpan) G_PASTE(gnomeddc_trace_span_, __LINE__) = { gnomeddc_trace_now(), (group), G_STRFUNC }
+
+#else
+
+static inline gint64
+gnomeddc_trace_now(void)
+{
+  return 0;
+}
+
+#define gnomeddc_trace_mark(begin, group, name, ...) G_STMT_START { (void) (begin); } G_STMT_END
+#define GNOMEDDC_TRACE_FUNCTION(group) G_STMT_START { } G_STMT_END
+
+#endif
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_TRACE_H */
@@ -0,0 +1,351 @@
+#include "gnomeddc-vcp-batch.h"
+
+/*
+ * Reads a set of VCP codes from several displays with one GetMultipleVcp per
+ * display. Displays on different buses are read in parallel, displays that
+ * share a bus (see gnomeddc_display_get_bus_key()) are queued behind each
+ * other, so the whole batch takes as long as its slowest bus.
+ */
+
+typedef struct {
+  GnomeDdcDisplay *display;
+  GVariant *codes;
+  GVariant *values;
+  GnomeDdcVcpValue *decoded;
+  gsize n_decoded;
+  gint status;
+  gchar *message;
+  GError *error;
+} BatchEntry;
+
+typedef struct {
+  GQueue pending;
+  guint in_flight;
+} BusLane;
+
+typedef struct {
+  GnomeDdcClient *client;
+  guint flags;
+  GHashTable *lanes;
+  guint outstanding;
+} ReadData;
+
+typedef struct {
+  GTask *task;
+  BatchEntry *entry;
+  BusLane *lane;
+} EntryCall;
+
+struct _GnomeDdcVcpBatch {
+  GObject parent_instance;
+
+  GPtrArray *entries;
+  guint max_per_bus;
+  GnomeDdcCallFlags call_flags;
+  gboolean running;
+};
+
+G_DEFINE_FINAL_TYPE(GnomeDdcVcpBatch, gnomeddc_vcp_batch, G_TYPE_OBJECT)
+
+/* Flattens an a(yqqs) array into a plain C array without copying the
+ * formatted strings; the result must not outlive @values. Free with g_free(). */
+GnomeDdcVcpValue *
+gnomeddc_vcp_values_decode(GVariant *values, gsize *n_values)
+{
+  g_return_val_if_fail(values != NULL, NULL);
+  g_return_val_if_fail(g_variant_is_of_type(values, G_VARIANT_TYPE("a(yqqs)")), NULL);
+  g_return_val_if_fail(n_values != NULL, NULL);
+
+  gsize n_children = g_variant_n_children(values);
+  GnomeDdcVcpValue *decoded = g_new(GnomeDdcVcpValue, MAX(n_children, 1));
+  for (gsize i = 0; i < n_children; i++) {
+    g_variant_get_child(values, i, "(yqq&s)",
+                        &decoded[i].code,
+                        &decoded[i].current,
+                        &decoded[i].max,
+                        &decoded[i].formatted);
+  }
+  *n_values = n_children;
+  return decoded;
+}
+
+static void
+batch_entry_reset(BatchEntry *entry)
+{
+  g_clear_pointer(&entry->decoded, g_free);
+  entry->n_decoded = 0;
+  g_clear_pointer(&entry->values, g_variant_unref);
+  g_clear_pointer(&entry->message, g_free);
+  g_clear_error(&entry->error);
+  entry->status = 0;
+}
+
+static void
+batch_entry_free(BatchEntry *entry)
+{
+  batch_entry_reset(entry);
+  g_clear_object(&entry->display);
+  g_clear_pointer(&entry->codes, g_variant_unref);
+  g_free(entry);
+}
+
+static void
+bus_lane_free(BusLane *lane)
+{
+  g_queue_clear(&lane->pending);
+  g_free(lane);
+}
+
+static void
+read_data_free(ReadData *data)
+{
+  g_clear_object(&data->client);
+  g_clear_pointer(&data->lanes, g_hash_table_unref);
+  g_free(data);
+}
+
+static void
+gnomeddc_vcp_batch_finalize(GObject *object)
+{
+  GnomeDdcVcpBatch *self = GNOMEDDC_VCP_BATCH(object);
+  g_clear_pointer(&self->entries, g_ptr_array_unref);
+  G_OBJECT_CLASS(gnomeddc_vcp_batch_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_vcp_batch_class_init(GnomeDdcVcpBatchClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_vcp_batch_finalize;
+}
+
+static void
+gnomeddc_vcp_batch_init(GnomeDdcVcpBatch *self)
+{
+  self->entries = g_ptr_array_new_with_free_func((GDestroyNotify) batch_entry_free);
+  self->max_per_bus = 1;
+}
+
+GnomeDdcVcpBatch *
+gnomeddc_vcp_batch_new(void)
+{
+  return g_object_new(GNOMEDDC_TYPE_VCP_BATCH, NULL);
+}
+
+void
+gnomeddc_vcp_batch_add(GnomeDdcVcpBatch *self,
+                       GnomeDdcDisplay *display,
+                       const guint8 *codes,
+                       gsize n_codes)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_BATCH(self));
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY(display));
+  g_return_if_fail(codes != NULL || n_codes == 0);
+  g_return_if_fail(!self->running);
+
+  BatchEntry *entry = g_new0(BatchEntry, 1);
+  entry->display = g_object_ref(display);
+  entry->codes = g_variant_ref_sink(g_variant_new_fixed_array(G_VARIANT_TYPE_BYTE, codes, n_codes, sizeof(guint8)));
+  g_ptr_array_add(self->entries, entry);
+}
+
+void
+gnomeddc_vcp_batch_set_max_per_bus(GnomeDdcVcpBatch *self, guint max_per_bus)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_BATCH(self));
+  g_return_if_fail(max_per_bus > 0);
+  self->max_per_bus = max_per_bus;
+}
+
+/* Client call flags used for every read, e.g. to poll in the background. */
+void
+gnomeddc_vcp_batch_set_call_flags(GnomeDdcVcpBatch *self, GnomeDdcCallFlags call_flags)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_BATCH(self));
+  self->call_flags = call_flags;
+}
+
+guint
+gnomeddc_vcp_batch_get_n_entries(GnomeDdcVcpBatch *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_BATCH(self), 0);
+  return self->entries->len;
+}
+
+static BatchEntry *
+get_entry(GnomeDdcVcpBatch *self, guint index)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_BATCH(self), NULL);
+  g_return_val_if_fail(index < self->entries->len, NULL);
+  return g_ptr_array_index(self->entries, index);
+}
+
+GnomeDdcDisplay *
+gnomeddc_vcp_batch_get_display(GnomeDdcVcpBatch *self, guint index)
+{
+  BatchEntry *entry = get_entry(self, index);
+  return entry != NULL ? entry->display : NULL;
+}
+
+/* The a(yqqs) array returned for the entry, or NULL if it failed. */
+GVariant *
+gnomeddc_vcp_batch_get_values(GnomeDdcVcpBatch *self, guint index)
+{
+  BatchEntry *entry = get_entry(self, index);
+  return entry != NULL ? entry->values : NULL;
+}
+
+/* The same values as gnomeddc_vcp_batch_get_values(), decoded once when
+ * the reply arrived. Valid until the batch is read again or freed. */
+const GnomeDdcVcpValue *
+gnomeddc_vcp_batch_get_value_array(GnomeDdcVcpBatch *self, guint index, gsize *n_values)
+{
+  g_return_val_if_fail(n_values != NULL, NULL);
+
+  BatchEntry *entry = get_entry(self, index);
+  *n_values = entry != NULL ? entry->n_decoded : 0;
+  return entry != NULL ? entry->decoded : NULL;
+}
+
+gint
+gnomeddc_vcp_batch_get_status(GnomeDdcVcpBatch *self, guint index)
+{
+  BatchEntry *entry = get_entry(self, index);
+  return entry != NULL ? entry->status : 0;
+}
+
+const gchar *
+gnomeddc_vcp_batch_get_message(GnomeDdcVcpBatch *self, guint index)
+{
+  BatchEntry *entry = get_entry(self, index);
+  return entry != NULL ? entry->message : NULL;
+}
+
+const GError *
+gnomeddc_vcp_batch_get_error(GnomeDdcVcpBatch *self, guint index)
+{
+  BatchEntry *entry = get_entry(self, index);
+  return entry != NULL ? entry->error : NULL;
+}
+
+static void bus_lane_pump(GTask *task, BusLane *lane);
+
+static void
+entry_read_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  EntryCall *call = user_data;
+  GTask *task = call->task;
+  GnomeDdcVcpBatch *self = g_task_get_source_object(task);
+  ReadData *data = g_task_get_task_data(task);
+  BatchEntry *entry = call->entry;
+
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(data->client, result, &entry->error);
+  if (response != NULL) {
+    g_variant_get(response, "(@a(yqqs)is)", &entry->values, &entry->status, &entry->message);
+    entry->decoded = gnomeddc_vcp_values_decode(entry->values, &entry->n_decoded);
+  }
+
+  call->lane->in_flight--;
+  data->outstanding--;
+  bus_lane_pump(task, call->lane);
+
+  if (data->outstanding == 0) {
+    self->running = FALSE;
+    g_task_return_boolean(task, TRUE);
+  }
+
+  g_object_unref(task);
+  g_free(call);
+}
+
+static void
+bus_lane_pump(GTask *task, BusLane *lane)
+{
+  GnomeDdcVcpBatch *self = g_task_get_source_object(task);
+  ReadData *data = g_task_get_task_data(task);
+
+  while (lane->in_flight < self->max_per_bus && !g_queue_is_empty(&lane->pending)) {
+    BatchEntry *entry = g_queue_pop_head(&lane->pending);
+    EntryCall *call = g_new0(EntryCall, 1);
+    call->task = g_object_ref(task);
+    call->entry = entry;
+    call->lane = lane;
+
+    lane->in_flight++;
+    gsize n_codes = 0;
+    const guint8 *codes = g_variant_get_fixed_array(entry->codes, &n_codes, sizeof(guint8));
+    gnomeddc_client_get_multiple_vcp_async(data->client,
+                                           entry->display,
+                                           codes,
+                                           n_codes,
+                                           data->flags,
+                                           self->call_flags,
+                                           g_task_get_cancellable(task),
+                                           entry_read_cb,
+                                           call);
+  }
+}
+
+void
+gnomeddc_vcp_batch_read_async(GnomeDdcVcpBatch *self,
+                              GnomeDdcClient *client,
+                              guint flags,
+                              GCancellable *cancellable,
+                              GAsyncReadyCallback callback,
+                              gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_BATCH(self));
+  g_return_if_fail(GNOMEDDC_IS_CLIENT(client));
+  g_return_if_fail(!self->running);
+
+  GTask *task = g_task_new(self, cancellable, callback, user_data);
+  g_task_set_source_tag(task, gnomeddc_vcp_batch_read_async);
+
+  ReadData *data = g_new0(ReadData, 1);
+  data->client = g_object_ref(client);
+  data->flags = flags;
+  data->lanes = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL, (GDestroyNotify) bus_lane_free);
+  g_task_set_task_data(task, data, (GDestroyNotify) read_data_free);
+
+  for (guint i = 0; i < self->entries->len; i++) {
+    BatchEntry *entry = g_ptr_array_index(self->entries, i);
+    batch_entry_reset(entry);
+    if (g_variant_n_children(entry->codes) == 0) {
+      continue;
+    }
+
+    gpointer bus_key = GINT_TO_POINTER(gnomeddc_display_get_bus_key(entry->display));
+    BusLane *lane = g_hash_table_lookup(data->lanes, bus_key);
+    if (lane == NULL) {
+      lane = g_new0(BusLane, 1);
+      g_queue_init(&lane->pending);
+      g_hash_table_insert(data->lanes, bus_key, lane);
+    }
+    g_queue_push_tail(&lane->pending, entry);
+    data->outstanding++;
+  }
+
+  if (data->outstanding == 0) {
+    g_task_return_boolean(task, TRUE);
+    g_object_unref(task);
+    return;
+  }
+
+  self->running = TRUE;
+
+  GHashTableIter iter;
+  gpointer lane;
+  g_hash_table_iter_init(&iter, data->lanes);
+  while (g_hash_table_iter_next(&iter, NULL, &lane)) {
+    bus_lane_pump(task, lane);
+  }
+  g_object_unref(task);
+}
+
+gboolean
+gnomeddc_vcp_batch_read_finish(GnomeDdcVcpBatch *self, GAsyncResult *result, GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_BATCH(self), FALSE);
+  g_return_val_if_fail(g_task_is_valid(result, self), FALSE);
+  return g_task_propagate_boolean(G_TASK(result), error);
+}
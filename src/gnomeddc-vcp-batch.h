@@ -0,0 +1,63 @@
+#ifndef GNOMEDDC_VCP_BATCH_H
+#define GNOMEDDC_VCP_BATCH_H
+
+#include "gnomeddc-client.h"
+#include "gnomeddc-display.h"
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_VCP_BATCH (gnomeddc_vcp_batch_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcVcpBatch, gnomeddc_vcp_batch, GNOMEDDC, VCP_BATCH, GObject)
+
+/* One element of a GetMultipleVcp a(yqqs) reply; formatted is borrowed
+ * from the reply. */
+typedef struct {
+  guint8 code;
+  guint16 current;
+  guint16 max;
+  const gchar *formatted;
+} GnomeDdcVcpValue;
+
+GnomeDdcVcpValue *gnomeddc_vcp_values_decode(GVariant *values,
+                                             gsize *n_values);
+
+GnomeDdcVcpBatch *gnomeddc_vcp_batch_new(void);
+
+void gnomeddc_vcp_batch_add(GnomeDdcVcpBatch *self,
+                            GnomeDdcDisplay *display,
+                            const guint8 *codes,
+                            gsize n_codes);
+void gnomeddc_vcp_batch_set_max_per_bus(GnomeDdcVcpBatch *self,
+                                        guint max_per_bus);
+void gnomeddc_vcp_batch_set_call_flags(GnomeDdcVcpBatch *self,
+                                       GnomeDdcCallFlags call_flags);
+
+guint gnomeddc_vcp_batch_get_n_entries(GnomeDdcVcpBatch *self);
+GnomeDdcDisplay *gnomeddc_vcp_batch_get_display(GnomeDdcVcpBatch *self,
+                                                guint index);
+GVariant *gnomeddc_vcp_batch_get_values(GnomeDdcVcpBatch *self,
+                                        guint index);
+const GnomeDdcVcpValue *gnomeddc_vcp_batch_get_value_array(GnomeDdcVcpBatch *self,
+                                                           guint index,
+                                                           gsize *n_values);
+gint gnomeddc_vcp_batch_get_status(GnomeDdcVcpBatch *self,
+                                   guint index);
+const gchar *gnomeddc_vcp_batch_get_message(GnomeDdcVcpBatch *self,
+                                            guint index);
+const GError *gnomeddc_vcp_batch_get_error(GnomeDdcVcpBatch *self,
+                                           guint index);
+
+void gnomeddc_vcp_batch_read_async(GnomeDdcVcpBatch *self,
+                                   GnomeDdcClient *client,
+                                   guint flags,
+                                   GCancellable *cancellable,
+                                   GAsyncReadyCallback callback,
+                                   gpointer user_data);
+gboolean gnomeddc_vcp_batch_read_finish(GnomeDdcVcpBatch *self,
+                                        GAsyncResult *result,
+                                        GError **error);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_VCP_BATCH_H */
@@ -0,0 +1,229 @@
+#include "gnomeddc-vcp-cache.h"
+
+#define DEFAULT_TTL_USEC (1 * G_USEC_PER_SEC)
+#define NON_VOLATILE_TTL_USEC (30 * G_USEC_PER_SEC)
+
+typedef struct {
+  guint flags;
+  guint16 current;
+  guint16 max_value;
+  gchar *formatted;
+  gchar *message;
+  gint64 expires_at;
+} CacheEntry;
+
+struct _GnomeDdcVcpCache {
+  GObject parent_instance;
+
+  /* display id -> (VCP code -> CacheEntry) */
+  GHashTable *displays;
+  gint64 default_ttl;
+  gint64 feature_ttls[256];
+};
+
+G_DEFINE_FINAL_TYPE(GnomeDdcVcpCache, gnomeddc_vcp_cache, G_TYPE_OBJECT)
+
+/* Features that only change when somebody writes them (or uses the OSD) are
+ * kept much longer than the default. */
+static const guint8 non_volatile_codes[] = {
+  0x10, /* Brightness */
+  0x12, /* Contrast */
+  0x14, /* Color preset */
+  0x16, /* Red gain */
+  0x18, /* Green gain */
+  0x1A, /* Blue gain */
+  0x60, /* Input source */
+  0x62, /* Audio volume */
+  0xC8, /* Display controller type */
+  0xC9, /* Firmware level */
+  0xDF, /* VCP version */
+};
+
+static void
+cache_entry_free(CacheEntry *entry)
+{
+  g_free(entry->formatted);
+  g_free(entry->message);
+  g_free(entry);
+}
+
+static void
+gnomeddc_vcp_cache_finalize(GObject *object)
+{
+  GnomeDdcVcpCache *self = GNOMEDDC_VCP_CACHE(object);
+  g_clear_pointer(&self->displays, g_hash_table_unref);
+  G_OBJECT_CLASS(gnomeddc_vcp_cache_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_vcp_cache_class_init(GnomeDdcVcpCacheClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_vcp_cache_finalize;
+}
+
+static void
+gnomeddc_vcp_cache_init(GnomeDdcVcpCache *self)
+{
+  self->displays = g_hash_table_new_full(g_int64_hash, g_int64_equal, g_free,
+                                         (GDestroyNotify) g_hash_table_unref);
+  self->default_ttl = DEFAULT_TTL_USEC;
+  for (guint i = 0; i < G_N_ELEMENTS(self->feature_ttls); i++) {
+    self->feature_ttls[i] = -1;
+  }
+  for (guint i = 0; i < G_N_ELEMENTS(non_volatile_codes); i++) {
+    self->feature_ttls[non_volatile_codes[i]] = NON_VOLATILE_TTL_USEC;
+  }
+}
+
+GnomeDdcVcpCache *
+gnomeddc_vcp_cache_new(void)
+{
+  return g_object_new(GNOMEDDC_TYPE_VCP_CACHE, NULL);
+}
+
+void
+gnomeddc_vcp_cache_set_default_ttl(GnomeDdcVcpCache *self, gint64 ttl_usec)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_CACHE(self));
+  self->default_ttl = MAX(ttl_usec, 0);
+}
+
+gint64
+gnomeddc_vcp_cache_get_default_ttl(GnomeDdcVcpCache *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_CACHE(self), 0);
+  return self->default_ttl;
+}
+
+/* A negative TTL makes the feature follow the default again, zero disables
+ * caching for it. */
+void
+gnomeddc_vcp_cache_set_feature_ttl(GnomeDdcVcpCache *self, guint8 vcp_code, gint64 ttl_usec)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_CACHE(self));
+  self->feature_ttls[vcp_code] = ttl_usec < 0 ? -1 : ttl_usec;
+}
+
+gint64
+gnomeddc_vcp_cache_get_feature_ttl(GnomeDdcVcpCache *self, guint8 vcp_code)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_CACHE(self), 0);
+  gint64 ttl = self->feature_ttls[vcp_code];
+  return ttl < 0 ? self->default_ttl : ttl;
+}
+
+gboolean
+gnomeddc_vcp_cache_lookup(GnomeDdcVcpCache *self,
+                          guint64 display_id,
+                          guint8 vcp_code,
+                          guint flags,
+                          guint16 *current,
+                          guint16 *max_value,
+                          const gchar **formatted,
+                          const gchar **message)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_CACHE(self), FALSE);
+
+  if (display_id == 0) {
+    return FALSE;
+  }
+
+  GHashTable *features = g_hash_table_lookup(self->displays, &display_id);
+  if (features == NULL) {
+    return FALSE;
+  }
+
+  CacheEntry *entry = g_hash_table_lookup(features, GUINT_TO_POINTER(vcp_code));
+  if (entry == NULL || entry->flags != flags) {
+    return FALSE;
+  }
+
+  if (g_get_monotonic_time() >= entry->expires_at) {
+    g_hash_table_remove(features, GUINT_TO_POINTER(vcp_code));
+    return FALSE;
+  }
+
+  if (current != NULL) {
+    *current = entry->current;
+  }
+  if (max_value != NULL) {
+    *max_value = entry->max_value;
+  }
+  if (formatted != NULL) {
+    *formatted = entry->formatted;
+  }
+  if (message != NULL) {
+    *message = entry->message;
+  }
+  return TRUE;
+}
+
+void
+gnomeddc_vcp_cache_store(GnomeDdcVcpCache *self,
+                         guint64 display_id,
+                         guint8 vcp_code,
+                         guint flags,
+                         guint16 current,
+                         guint16 max_value,
+                         const gchar *formatted,
+                         const gchar *message)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_CACHE(self));
+
+  if (display_id == 0) {
+    return;
+  }
+
+  gint64 ttl = gnomeddc_vcp_cache_get_feature_ttl(self, vcp_code);
+  if (ttl == 0) {
+    return;
+  }
+
+  GHashTable *features = g_hash_table_lookup(self->displays, &display_id);
+  if (features == NULL) {
+    features = g_hash_table_new_full(g_direct_hash, g_direct_equal, NULL,
+                                     (GDestroyNotify) cache_entry_free);
+    g_hash_table_insert(self->displays, g_memdup2(&display_id, sizeof(display_id)), features);
+  }
+
+  CacheEntry *entry = g_new0(CacheEntry, 1);
+  entry->flags = flags;
+  entry->current = current;
+  entry->max_value = max_value;
+  entry->formatted = g_strdup(formatted != NULL ? formatted : "");
+  entry->message = g_strdup(message != NULL ? message : "");
+  entry->expires_at = g_get_monotonic_time() + ttl;
+  g_hash_table_replace(features, GUINT_TO_POINTER(vcp_code), entry);
+}
+
+void
+gnomeddc_vcp_cache_invalidate(GnomeDdcVcpCache *self, guint64 display_id, guint8 vcp_code)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_CACHE(self));
+
+  GHashTable *features = g_hash_table_lookup(self->displays, &display_id);
+  if (features != NULL) {
+    g_hash_table_remove(features, GUINT_TO_POINTER(vcp_code));
+  }
+}
+
+void
+gnomeddc_vcp_cache_invalidate_display(GnomeDdcVcpCache *self, guint64 display_id)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_CACHE(self));
+
+  if (display_id == 0) {
+    gnomeddc_vcp_cache_clear(self);
+    return;
+  }
+
+  g_hash_table_remove(self->displays, &display_id);
+}
+
+void
+gnomeddc_vcp_cache_clear(GnomeDdcVcpCache *self)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_CACHE(self));
+  g_hash_table_remove_all(self->displays);
+}
@@ -0,0 +1,49 @@
+#ifndef GNOMEDDC_VCP_CACHE_H
+#define GNOMEDDC_VCP_CACHE_H
+
+#include <glib-object.h>
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_VCP_CACHE (gnomeddc_vcp_cache_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcVcpCache, gnomeddc_vcp_cache, GNOMEDDC, VCP_CACHE, GObject)
+
+GnomeDdcVcpCache *gnomeddc_vcp_cache_new(void);
+
+void gnomeddc_vcp_cache_set_default_ttl(GnomeDdcVcpCache *self,
+                                        gint64 ttl_usec);
+gint64 gnomeddc_vcp_cache_get_default_ttl(GnomeDdcVcpCache *self);
+void gnomeddc_vcp_cache_set_feature_ttl(GnomeDdcVcpCache *self,
+                                        guint8 vcp_code,
+                                        gint64 ttl_usec);
+gint64 gnomeddc_vcp_cache_get_feature_ttl(GnomeDdcVcpCache *self,
+                                          guint8 vcp_code);
+
+gboolean gnomeddc_vcp_cache_lookup(GnomeDdcVcpCache *self,
+                                   guint64 display_id,
+                                   guint8 vcp_code,
+                                   guint flags,
+                                   guint16 *current,
+                                   guint16 *max_value,
+                                   const gchar **formatted,
+                                   const gchar **message);
+void gnomeddc_vcp_cache_store(GnomeDdcVcpCache *self,
+                              guint64 display_id,
+                              guint8 vcp_code,
+                              guint flags,
+                              guint16 current,
+                              guint16 max_value,
+                              const gchar *formatted,
+                              const gchar *message);
+
+void gnomeddc_vcp_cache_invalidate(GnomeDdcVcpCache *self,
+                                   guint64 display_id,
+                                   guint8 vcp_code);
+void gnomeddc_vcp_cache_invalidate_display(GnomeDdcVcpCache *self,
+                                           guint64 display_id);
+void gnomeddc_vcp_cache_clear(GnomeDdcVcpCache *self);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_VCP_CACHE_H */
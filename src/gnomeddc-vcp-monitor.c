@@ -0,0 +1,378 @@
+#include "gnomeddc-vcp-monitor.h"
+
+#include "gnomeddc-vcp-batch.h"
+
+/*
+ * Polls a set of VCP codes on one display with a single GetMultipleVcp per
+ * round. The interval starts at its minimum, doubles after every round in
+ * which nothing changed and drops back to the minimum as soon as a value
+ * moves, either in a poll or through a VcpValueChanged signal. Polls run in
+ * the client's background lane and refresh the shared VCP cache.
+ */
+
+#define DEFAULT_MIN_INTERVAL_MSEC 500
+#define DEFAULT_MAX_INTERVAL_MSEC 8000
+
+typedef struct {
+  guint8 code;
+  guint16 max_value;
+  guint head;
+  guint n_samples;
+  GnomeDdcVcpSample samples[GNOMEDDC_VCP_MONITOR_HISTORY];
+} Track;
+
+struct _GnomeDdcVcpMonitor {
+  GObject parent_instance;
+
+  GnomeDdcClient *client;
+  GnomeDdcDisplay *display;
+  GnomeDdcVcpBatch *batch;
+  Track *tracks;
+  guint n_tracks;
+
+  guint min_interval;
+  guint max_interval;
+  guint interval;
+  guint poll_source_id;
+  GCancellable *cancellable;
+  gboolean running;
+  gboolean paused;
+  gboolean reading;
+};
+
+enum {
+  SIGNAL_UPDATED,
+  N_SIGNALS
+};
+
+static guint signals[N_SIGNALS];
+
+G_DEFINE_FINAL_TYPE(GnomeDdcVcpMonitor, gnomeddc_vcp_monitor, G_TYPE_OBJECT)
+
+static void schedule_poll(GnomeDdcVcpMonitor *self, guint delay_msec);
+
+static void
+gnomeddc_vcp_monitor_dispose(GObject *object)
+{
+  GnomeDdcVcpMonitor *self = GNOMEDDC_VCP_MONITOR(object);
+  gnomeddc_vcp_monitor_stop(self);
+  if (self->client != NULL) {
+    g_signal_handlers_disconnect_by_data(self->client, self);
+  }
+  G_OBJECT_CLASS(gnomeddc_vcp_monitor_parent_class)->dispose(object);
+}
+
+static void
+gnomeddc_vcp_monitor_finalize(GObject *object)
+{
+  GnomeDdcVcpMonitor *self = GNOMEDDC_VCP_MONITOR(object);
+  g_clear_object(&self->client);
+  g_clear_object(&self->display);
+  g_clear_object(&self->batch);
+  g_clear_pointer(&self->tracks, g_free);
+  G_OBJECT_CLASS(gnomeddc_vcp_monitor_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_vcp_monitor_class_init(GnomeDdcVcpMonitorClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->dispose = gnomeddc_vcp_monitor_dispose;
+  object_class->finalize = gnomeddc_vcp_monitor_finalize;
+
+  /* Emitted whenever new samples were recorded. */
+  signals[SIGNAL_UPDATED] =
+    g_signal_new("updated",
+                 G_TYPE_FROM_CLASS(klass),
+                 G_SIGNAL_RUN_LAST,
+                 0,
+                 NULL, NULL, NULL,
+                 G_TYPE_NONE, 0);
+}
+
+static void
+gnomeddc_vcp_monitor_init(GnomeDdcVcpMonitor *self)
+{
+  self->min_interval = DEFAULT_MIN_INTERVAL_MSEC;
+  self->max_interval = DEFAULT_MAX_INTERVAL_MSEC;
+  self->interval = DEFAULT_MIN_INTERVAL_MSEC;
+}
+
+static Track *
+find_track(GnomeDdcVcpMonitor *self, guint8 code)
+{
+  for (guint i = 0; i < self->n_tracks; i++) {
+    if (self->tracks[i].code == code) {
+      return &self->tracks[i];
+    }
+  }
+  return NULL;
+}
+
+/* Appends a sample; returns TRUE if it differs from the previous one. */
+static gboolean
+track_push(Track *track, gint64 time, guint16 value)
+{
+  gboolean changed = TRUE;
+  if (track->n_samples > 0) {
+    guint last = (track->head + GNOMEDDC_VCP_MONITOR_HISTORY - 1) % GNOMEDDC_VCP_MONITOR_HISTORY;
+    changed = track->samples[last].value != value;
+  }
+
+  track->samples[track->head].time = time;
+  track->samples[track->head].value = value;
+  track->head = (track->head + 1) % GNOMEDDC_VCP_MONITOR_HISTORY;
+  if (track->n_samples < GNOMEDDC_VCP_MONITOR_HISTORY) {
+    track->n_samples++;
+  }
+  return changed;
+}
+
+static void
+client_vcp_value_changed_cb(GnomeDdcClient *client G_GNUC_UNUSED,
+                            gint display_number G_GNUC_UNUSED,
+                            const gchar *edid,
+                            guint code,
+                            guint value,
+                            const gchar *source_client_name G_GNUC_UNUSED,
+                            const gchar *source_client_context G_GNUC_UNUSED,
+                            guint flags G_GNUC_UNUSED,
+                            gpointer user_data)
+{
+  GnomeDdcVcpMonitor *self = GNOMEDDC_VCP_MONITOR(user_data);
+
+  if (!self->running || g_strcmp0(edid, gnomeddc_display_get_edid(self->display)) != 0) {
+    return;
+  }
+
+  Track *track = find_track(self, code);
+  if (track == NULL) {
+    return;
+  }
+
+  track_push(track, g_get_monotonic_time(), value);
+  g_signal_emit(self, signals[SIGNAL_UPDATED], 0);
+
+  /* Somebody is adjusting the display; follow along closely. */
+  self->interval = self->min_interval;
+  schedule_poll(self, self->interval);
+}
+
+static void
+poll_finished_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GnomeDdcVcpMonitor) self = user_data;
+  GnomeDdcVcpBatch *batch = GNOMEDDC_VCP_BATCH(source);
+  g_autoptr(GError) error = NULL;
+
+  self->reading = FALSE;
+  if (!gnomeddc_vcp_batch_read_finish(batch, result, &error)) {
+    if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      /* Stopped, or stopped and started again while this read ran. */
+      schedule_poll(self, 0);
+      return;
+    }
+  }
+
+  gboolean changed = FALSE;
+  gsize n_values = 0;
+  const GnomeDdcVcpValue *values = gnomeddc_vcp_batch_get_value_array(batch, 0, &n_values);
+  gint64 now = g_get_monotonic_time();
+
+  for (gsize i = 0; i < n_values; i++) {
+    Track *track = find_track(self, values[i].code);
+    if (track != NULL) {
+      track->max_value = values[i].max;
+      changed |= track_push(track, now, values[i].current);
+    }
+  }
+  if (n_values > 0) {
+    g_signal_emit(self, signals[SIGNAL_UPDATED], 0);
+  }
+
+  self->interval = changed ? self->min_interval : MIN(self->interval * 2, self->max_interval);
+  schedule_poll(self, self->interval);
+}
+
+static gboolean
+poll_timeout_cb(gpointer user_data)
+{
+  GnomeDdcVcpMonitor *self = GNOMEDDC_VCP_MONITOR(user_data);
+
+  self->poll_source_id = 0;
+  self->reading = TRUE;
+  gnomeddc_vcp_batch_read_async(self->batch,
+                                self->client,
+                                0,
+                                self->cancellable,
+                                poll_finished_cb,
+                                g_object_ref(self));
+  return G_SOURCE_REMOVE;
+}
+
+/* A read in flight reschedules itself when it finishes. */
+static void
+schedule_poll(GnomeDdcVcpMonitor *self, guint delay_msec)
+{
+  g_clear_handle_id(&self->poll_source_id, g_source_remove);
+  if (!self->running || self->paused || self->reading) {
+    return;
+  }
+  self->poll_source_id = g_timeout_add(delay_msec, poll_timeout_cb, self);
+}
+
+GnomeDdcVcpMonitor *
+gnomeddc_vcp_monitor_new(GnomeDdcClient *client, GnomeDdcDisplay *display, const guint8 *codes, gsize n_codes)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(client), NULL);
+  g_return_val_if_fail(GNOMEDDC_IS_DISPLAY(display), NULL);
+  g_return_val_if_fail(codes != NULL || n_codes == 0, NULL);
+
+  GnomeDdcVcpMonitor *self = g_object_new(GNOMEDDC_TYPE_VCP_MONITOR, NULL);
+  self->client = g_object_ref(client);
+  self->display = g_object_ref(display);
+  self->tracks = g_new0(Track, MAX(n_codes, 1));
+  for (gsize i = 0; i < n_codes; i++) {
+    if (find_track(self, codes[i]) == NULL) {
+      self->tracks[self->n_tracks++].code = codes[i];
+    }
+  }
+
+  /* Polling bypasses the cache so values changed on the monitor's own
+   * buttons show up; the replies still refresh it for everyone else. */
+  g_autofree guint8 *unique_codes = g_new(guint8, MAX(self->n_tracks, 1));
+  for (guint i = 0; i < self->n_tracks; i++) {
+    unique_codes[i] = self->tracks[i].code;
+  }
+  self->batch = gnomeddc_vcp_batch_new();
+  gnomeddc_vcp_batch_add(self->batch, display, unique_codes, self->n_tracks);
+  gnomeddc_vcp_batch_set_call_flags(self->batch,
+                                    GNOMEDDC_CALL_FLAGS_BACKGROUND | GNOMEDDC_CALL_FLAGS_BYPASS_CACHE);
+
+  g_signal_connect(client, "vcp-value-changed", G_CALLBACK(client_vcp_value_changed_cb), self);
+  return self;
+}
+
+void
+gnomeddc_vcp_monitor_set_interval_range(GnomeDdcVcpMonitor *self, guint min_msec, guint max_msec)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_MONITOR(self));
+  g_return_if_fail(min_msec > 0 && min_msec <= max_msec);
+
+  self->min_interval = min_msec;
+  self->max_interval = max_msec;
+  self->interval = CLAMP(self->interval, min_msec, max_msec);
+}
+
+/* The delay before the next poll, in milliseconds. */
+guint
+gnomeddc_vcp_monitor_get_interval(GnomeDdcVcpMonitor *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_MONITOR(self), 0);
+  return self->interval;
+}
+
+void
+gnomeddc_vcp_monitor_start(GnomeDdcVcpMonitor *self)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_MONITOR(self));
+
+  if (self->running) {
+    return;
+  }
+
+  self->running = TRUE;
+  self->interval = self->min_interval;
+  self->cancellable = g_cancellable_new();
+  schedule_poll(self, 0);
+}
+
+void
+gnomeddc_vcp_monitor_stop(GnomeDdcVcpMonitor *self)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_MONITOR(self));
+
+  self->running = FALSE;
+  g_clear_handle_id(&self->poll_source_id, g_source_remove);
+  g_cancellable_cancel(self->cancellable);
+  g_clear_object(&self->cancellable);
+}
+
+gboolean
+gnomeddc_vcp_monitor_is_running(GnomeDdcVcpMonitor *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_MONITOR(self), FALSE);
+  return self->running;
+}
+
+/* While paused no polls are issued; resuming polls right away. */
+void
+gnomeddc_vcp_monitor_set_paused(GnomeDdcVcpMonitor *self, gboolean paused)
+{
+  g_return_if_fail(GNOMEDDC_IS_VCP_MONITOR(self));
+
+  paused = !!paused;
+  if (self->paused == paused) {
+    return;
+  }
+
+  self->paused = paused;
+  if (paused) {
+    g_clear_handle_id(&self->poll_source_id, g_source_remove);
+  } else {
+    self->interval = self->min_interval;
+    schedule_poll(self, 0);
+  }
+}
+
+GnomeDdcDisplay *
+gnomeddc_vcp_monitor_get_display(GnomeDdcVcpMonitor *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_MONITOR(self), NULL);
+  return self->display;
+}
+
+guint
+gnomeddc_vcp_monitor_get_n_codes(GnomeDdcVcpMonitor *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_MONITOR(self), 0);
+  return self->n_tracks;
+}
+
+guint8
+gnomeddc_vcp_monitor_get_code(GnomeDdcVcpMonitor *self, guint index)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_MONITOR(self), 0);
+  g_return_val_if_fail(index < self->n_tracks, 0);
+  return self->tracks[index].code;
+}
+
+/* The maximum reported by the last poll, or 0 before the first one. */
+guint16
+gnomeddc_vcp_monitor_get_max_value(GnomeDdcVcpMonitor *self, guint index)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_MONITOR(self), 0);
+  g_return_val_if_fail(index < self->n_tracks, 0);
+  return self->tracks[index].max_value;
+}
+
+/* Copies up to @n_samples of the most recent samples, oldest first, and
+ * returns how many were copied. */
+gsize
+gnomeddc_vcp_monitor_copy_history(GnomeDdcVcpMonitor *self,
+                                  guint index,
+                                  GnomeDdcVcpSample *samples,
+                                  gsize n_samples)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_VCP_MONITOR(self), 0);
+  g_return_val_if_fail(index < self->n_tracks, 0);
+  g_return_val_if_fail(samples != NULL || n_samples == 0, 0);
+
+  const Track *track = &self->tracks[index];
+  gsize n = MIN(n_samples, track->n_samples);
+  guint start = (track->head + GNOMEDDC_VCP_MONITOR_HISTORY - n) % GNOMEDDC_VCP_MONITOR_HISTORY;
+  for (gsize i = 0; i < n; i++) {
+    samples[i] = track->samples[(start + i) % GNOMEDDC_VCP_MONITOR_HISTORY];
+  }
+  return n;
+}
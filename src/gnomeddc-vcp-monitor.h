@@ -0,0 +1,50 @@
+#ifndef GNOMEDDC_VCP_MONITOR_H
+#define GNOMEDDC_VCP_MONITOR_H
+
+#include "gnomeddc-client.h"
+#include "gnomeddc-display.h"
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_VCP_MONITOR (gnomeddc_vcp_monitor_get_type())
+
+/* Number of samples kept per code. */
+#define GNOMEDDC_VCP_MONITOR_HISTORY 120
+
+G_DECLARE_FINAL_TYPE(GnomeDdcVcpMonitor, gnomeddc_vcp_monitor, GNOMEDDC, VCP_MONITOR, GObject)
+
+typedef struct {
+  gint64 time;
+  guint16 value;
+} GnomeDdcVcpSample;
+
+GnomeDdcVcpMonitor *gnomeddc_vcp_monitor_new(GnomeDdcClient *client,
+                                             GnomeDdcDisplay *display,
+                                             const guint8 *codes,
+                                             gsize n_codes);
+
+void gnomeddc_vcp_monitor_set_interval_range(GnomeDdcVcpMonitor *self,
+                                             guint min_msec,
+                                             guint max_msec);
+guint gnomeddc_vcp_monitor_get_interval(GnomeDdcVcpMonitor *self);
+
+void gnomeddc_vcp_monitor_start(GnomeDdcVcpMonitor *self);
+void gnomeddc_vcp_monitor_stop(GnomeDdcVcpMonitor *self);
+gboolean gnomeddc_vcp_monitor_is_running(GnomeDdcVcpMonitor *self);
+void gnomeddc_vcp_monitor_set_paused(GnomeDdcVcpMonitor *self,
+                                     gboolean paused);
+
+GnomeDdcDisplay *gnomeddc_vcp_monitor_get_display(GnomeDdcVcpMonitor *self);
+guint gnomeddc_vcp_monitor_get_n_codes(GnomeDdcVcpMonitor *self);
+guint8 gnomeddc_vcp_monitor_get_code(GnomeDdcVcpMonitor *self,
+                                     guint index);
+guint16 gnomeddc_vcp_monitor_get_max_value(GnomeDdcVcpMonitor *self,
+                                           guint index);
+gsize gnomeddc_vcp_monitor_copy_history(GnomeDdcVcpMonitor *self,
+                                        guint index,
+                                        GnomeDdcVcpSample *samples,
+                                        gsize n_samples);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_VCP_MONITOR_H */
@@ -1,23 +1,67 @@
 #include "gnomeddc-window.h"
 
+#include "gnomeddc-capabilities-cache.h"
+#include "gnomeddc-capabilities-model.h"
 #include "gnomeddc-client.h"
 #include "gnomeddc-display.h"
+#include "gnomeddc-display-model.h"
+#include "gnomeddc-group-store.h"
+#include "gnomeddc-group-write.h"
+#include "gnomeddc-profile-apply.h"
+#include "gnomeddc-profile-store.h"
+#include "gnomeddc-reply-decoder.h"
+#include "gnomeddc-service-properties.h"
+#include "gnomeddc-sleep-calibration.h"
+#include "gnomeddc-sparkline.h"
+#include "gnomeddc-trace.h"
+#include "gnomeddc-vcp-batch.h"
+#include "gnomeddc-vcp-monitor.h"
+#include "gnomeddc-write-coalescer.h"
 
 #include <glib/gi18n.h>
 #include <math.h>
 
-#define DDCUTIL_INTERFACE_NAME "com.ddcutil.DdcutilInterface"
+
+/* Reads that target the selected display. Each kind has its own cancellable
+ * so repeating a request drops the stale one, and changing the selection
+ * drops all of them. */
+typedef enum {
+  DISPLAY_OPERATION_STATE,
+  DISPLAY_OPERATION_SLEEP_MULTIPLIER,
+  DISPLAY_OPERATION_VCP,
+  DISPLAY_OPERATION_MULTIPLE_VCP,
+  DISPLAY_OPERATION_VCP_METADATA,
+  DISPLAY_OPERATION_CAPABILITIES,
+  N_DISPLAY_OPERATIONS
+} DisplayOperation;
 
 struct _GnomeDdcWindow {
   AdwApplicationWindow parent_instance;
 
+  /* Owned by the application and shared with its other windows */
   GnomeDdcClient *client;
-  GListStore *display_store;
+  GnomeDdcDisplayModel *display_model;
+  GnomeDdcWriteCoalescer *write_coalescer;
+  GnomeDdcCapabilitiesCache *capabilities_cache;
+  GnomeDdcProfileStore *profile_store;
+  GnomeDdcGroupStore *group_store;
+  GCancellable *profile_cancellable;
   GtkCustomFilter *search_filter;
   GtkFilterListModel *filter_model;
   GtkSingleSelection *selection;
+  /* What the overview rows currently show */
+  GnomeDdcDisplay *shown_display;
   gchar *search_text;
   guint pending_calls;
+  GCancellable *display_operations[N_DISPLAY_OPERATIONS];
+  /* Bit per DisplayOperation issued by the selection prefetch */
+  guint prefetched_operations;
+  GCancellable *read_all_cancellable;
+  GnomeDdcSleepCalibration *calibration;
+  GCancellable *calibration_cancellable;
+  GnomeDdcVcpMonitor *monitor;
+  GPtrArray *monitor_rows;
+  GPtrArray *monitor_sparklines;
   gboolean updating_service_properties;
 
   AdwToastOverlay *toast_overlay;
@@ -32,13 +76,25 @@ struct _GnomeDdcWindow {
   GtkButton *sleep_multiplier_refresh_button;
   GtkButton *get_vcp_button;
   GtkButton *get_multiple_vcp_button;
+  GtkButton *read_all_displays_button;
   GtkButton *set_vcp_button;
   GtkButton *set_vcp_context_button;
   GtkButton *get_vcp_metadata_button;
   GtkButton *get_capabilities_button;
   GtkButton *get_capabilities_metadata_button;
+  GtkButton *reprobe_capabilities_button;
   GtkButton *set_sleep_multiplier_button;
+  GtkButton *calibrate_sleep_button;
+  GtkButton *apply_profile_button;
+  GtkButton *delete_profile_button;
+  GtkButton *save_profile_button;
+  GtkButton *join_group_button;
+  GtkButton *leave_group_button;
+  GtkButton *monitor_button;
   GtkButton *restart_button;
+  GtkButton *performance_refresh_button;
+  GtkButton *performance_reset_button;
+  GtkButton *performance_export_button;
 
   AdwActionRow *name_row;
   AdwActionRow *model_row;
@@ -51,12 +107,24 @@ struct _GnomeDdcWindow {
   AdwActionRow *sleep_multiplier_row;
   AdwActionRow *get_vcp_row;
   AdwActionRow *get_multiple_vcp_row;
+  AdwActionRow *read_all_displays_row;
   AdwActionRow *set_vcp_row;
   AdwActionRow *set_vcp_context_row;
   AdwActionRow *get_vcp_metadata_row;
   AdwActionRow *get_capabilities_row;
   AdwActionRow *get_capabilities_metadata_row;
   AdwActionRow *set_sleep_multiplier_row;
+  AdwActionRow *calibrate_sleep_row;
+  AdwActionRow *apply_profile_row;
+  AdwComboRow *profile_combo_row;
+  AdwEntryRow *profile_name_entry;
+  GtkStringList *profile_names;
+  AdwComboRow *write_target_row;
+  GtkStringList *write_target_names;
+  AdwEntryRow *group_name_entry;
+  AdwPreferencesGroup *monitor_group;
+  AdwEntryRow *monitor_codes_entry;
+  AdwActionRow *monitor_row;
   AdwActionRow *service_version_row;
   AdwActionRow *ddcutil_version_row;
   AdwActionRow *service_parameters_locked_row;
@@ -75,6 +143,8 @@ struct _GnomeDdcWindow {
   AdwEntryRow *sleep_multiplier_entry;
   AdwEntryRow *restart_options_entry;
 
+  AdwSwitchRow *prefetch_row;
+  AdwEntryRow *prefetch_codes_entry;
   AdwSwitchRow *dynamic_sleep_row;
   AdwSwitchRow *info_logging_row;
   AdwSwitchRow *connectivity_signals_row;
@@ -85,7 +155,17 @@ struct _GnomeDdcWindow {
   AdwSpinRow *restart_syslog_row;
   AdwSpinRow *restart_flags_row;
 
+  AdwPreferencesGroup *performance_methods_group;
+  GtkWidget *performance_page;
+  GPtrArray *performance_rows;
+
   GtkTextView *capabilities_text_view;
+  AdwPreferencesGroup *capabilities_features_group;
+  GtkSearchEntry *capabilities_search_entry;
+  GtkListView *capabilities_feature_list;
+  GtkFilterListModel *feature_filter_model;
+  GtkCustomFilter *feature_filter;
+  gchar *feature_search_text;
   GtkWidget *view_stack;
 };
 
@@ -96,7 +176,6 @@ static void gnomeddc_window_start_operation(GnomeDdcWindow *self);
 static void gnomeddc_window_finish_operation(GnomeDdcWindow *self);
 static void gnomeddc_window_refresh_displays(GnomeDdcWindow *self, gboolean detect);
 static void gnomeddc_window_update_selection(GnomeDdcWindow *self);
-static void gnomeddc_window_refresh_service_properties(GnomeDdcWindow *self);
 static void gnomeddc_window_query_state(GnomeDdcWindow *self);
 static void gnomeddc_window_query_sleep_multiplier(GnomeDdcWindow *self);
 
@@ -108,23 +187,12 @@ display_filter_func(gpointer item, gpointer user_data)
     return TRUE;
   }
 
+  /* search_text is already case-folded, see search_changed_cb(). The EDID
+   * matches by prefix, as the CLI and app.brightness-step selectors do. */
   GnomeDdcDisplay *display = GNOMEDDC_DISPLAY(item);
-  g_autofree gchar *folded_search = g_utf8_casefold(self->search_text, -1);
-  g_autofree gchar *folded_manufacturer = g_utf8_casefold(gnomeddc_display_get_manufacturer(display), -1);
-  g_autofree gchar *folded_model = g_utf8_casefold(gnomeddc_display_get_model(display), -1);
-  g_autofree gchar *folded_serial = g_utf8_casefold(gnomeddc_display_get_serial(display), -1);
-  g_autofree gchar *folded_edid = g_utf8_casefold(gnomeddc_display_get_edid(display), -1);
-
-  if (strstr(folded_manufacturer, folded_search) != NULL ||
-      strstr(folded_model, folded_search) != NULL ||
-      strstr(folded_serial, folded_search) != NULL ||
-      strstr(folded_edid, folded_search) != NULL) {
-    return TRUE;
-  }
-
-  g_autofree gchar *full_name = gnomeddc_display_dup_full_name(display);
-  g_autofree gchar *folded_full_name = g_utf8_casefold(full_name, -1);
-  return strstr(folded_full_name, folded_search) != NULL;
+  return strstr(gnomeddc_display_get_search_key(display), self->search_text) != NULL ||
+         g_ascii_strncasecmp(gnomeddc_display_get_edid(display), self->search_text,
+                             strlen(self->search_text)) == 0;
 }
 
 static void
@@ -141,6 +209,14 @@ show_toast(GnomeDdcWindow *self, const gchar *format, ...)
   adw_toast_overlay_add_toast(self->toast_overlay, toast);
 }
 
+/* Reply handlers hold a reference, so they can run after the window was
+ * closed; dispose has dropped the widgets and shared objects by then. */
+static gboolean
+window_is_disposed(GnomeDdcWindow *self)
+{
+  return self->client == NULL;
+}
+
 static void
 set_busy(GnomeDdcWindow *self, gboolean busy)
 {
@@ -173,10 +249,51 @@ gnomeddc_window_finish_operation(GnomeDdcWindow *self)
   }
 }
 
+static GCancellable *
+begin_display_operation(GnomeDdcWindow *self, DisplayOperation operation)
+{
+  if (self->display_operations[operation] != NULL) {
+    g_cancellable_cancel(self->display_operations[operation]);
+    g_object_unref(self->display_operations[operation]);
+  }
+
+  self->display_operations[operation] = g_cancellable_new();
+  self->prefetched_operations &= ~(1u << operation);
+  return self->display_operations[operation];
+}
+
+static GCancellable *
+begin_prefetch_operation(GnomeDdcWindow *self, DisplayOperation operation)
+{
+  GCancellable *cancellable = begin_display_operation(self, operation);
+  self->prefetched_operations |= 1u << operation;
+  return cancellable;
+}
+
+/* Prefetch failures go to the row they were meant for rather than raising
+ * a toast every time the selection moves. */
+static gboolean
+is_prefetched(GnomeDdcWindow *self, DisplayOperation operation)
+{
+  return (self->prefetched_operations & (1u << operation)) != 0;
+}
+
+static void
+cancel_display_operations(GnomeDdcWindow *self)
+{
+  for (guint i = 0; i < N_DISPLAY_OPERATIONS; i++) {
+    if (self->display_operations[i] != NULL) {
+      g_cancellable_cancel(self->display_operations[i]);
+      g_clear_object(&self->display_operations[i]);
+    }
+  }
+  self->prefetched_operations = 0;
+}
+
 static void
 update_empty_state(GnomeDdcWindow *self)
 {
-  gboolean has_items = g_list_model_get_n_items(G_LIST_MODEL(self->display_store)) > 0;
+  gboolean has_items = g_list_model_get_n_items(G_LIST_MODEL(self->display_model)) > 0;
   gtk_widget_set_visible(GTK_WIDGET(self->empty_status), !has_items);
   gtk_widget_set_sensitive(self->view_stack, has_items);
 }
@@ -205,6 +322,9 @@ update_overview_rows(GnomeDdcWindow *self, GnomeDdcDisplay *display)
     adw_action_row_set_subtitle(self->usb_row, "");
     adw_action_row_set_subtitle(self->state_row, "");
     adw_action_row_set_subtitle(self->sleep_multiplier_row, "");
+    if (self->calibration == NULL) {
+      adw_action_row_set_subtitle(self->calibrate_sleep_row, "");
+    }
     return;
   }
 
@@ -223,140 +343,159 @@ update_overview_rows(GnomeDdcWindow *self, GnomeDdcDisplay *display)
                                                gnomeddc_display_get_usb_device(display)));
   adw_action_row_set_subtitle(self->state_row, _("Press Refresh to query"));
   adw_action_row_set_subtitle(self->sleep_multiplier_row, _("Press Refresh to query"));
+
+  if (self->calibration == NULL) {
+    gdouble saved = 0.0;
+    if (gnomeddc_sleep_calibration_lookup_saved(gnomeddc_display_get_edid(display), &saved)) {
+      g_autofree gchar *subtitle = g_strdup_printf(_("Calibrated to %.2f"), saved);
+      adw_action_row_set_subtitle(self->calibrate_sleep_row, subtitle);
+    } else {
+      adw_action_row_set_subtitle(self->calibrate_sleep_row, _("Not calibrated yet"));
+    }
+  }
 }
 
 
 static void
-update_service_rows_from_dict(GnomeDdcWindow *self, GVariant *dict)
+apply_string_row(GtkWidget *row, GVariant *value)
 {
-  self->updating_service_properties = TRUE;
+  adw_action_row_set_subtitle(ADW_ACTION_ROW(row), g_variant_get_string(value, NULL));
+}
+
+static void
+apply_yes_no_row(GtkWidget *row, GVariant *value)
+{
+  adw_action_row_set_subtitle(ADW_ACTION_ROW(row), g_variant_get_boolean(value) ? _("Yes") : _("No"));
+}
+
+static void
+apply_string_list_row(GtkWidget *row, GVariant *value)
+{
+  g_autofree const gchar **strv = g_variant_get_strv(value, NULL);
+  g_autofree gchar *text = g_strjoinv(", ", (gchar **) strv);
+  adw_action_row_set_subtitle(ADW_ACTION_ROW(row), text);
+}
 
+static void
+apply_code_table(GtkWidget *row, GVariant *value, const gchar *format)
+{
+  g_autoptr(GString) str = g_string_new(NULL);
   GVariantIter iter;
-  const gchar *key;
-  GVariant *value;
-  g_variant_iter_init(&iter, dict);
-  while (g_variant_iter_loop(&iter, "{sv}", &key, &value)) {
-    if (g_strcmp0(key, "ServiceInterfaceVersion") == 0) {
-      adw_action_row_set_subtitle(self->service_version_row, g_variant_get_string(value, NULL));
-    } else if (g_strcmp0(key, "DdcutilVersion") == 0) {
-      adw_action_row_set_subtitle(self->ddcutil_version_row, g_variant_get_string(value, NULL));
-    } else if (g_strcmp0(key, "ServiceParametersLocked") == 0) {
-      adw_action_row_set_subtitle(self->service_parameters_locked_row,
-                                  g_variant_get_boolean(value) ? _("Yes") : _("No"));
-    } else if (g_strcmp0(key, "AttributesReturnedByDetect") == 0) {
-      GVariantIter array_iter;
-      const gchar *attr;
-      g_autoptr(GString) str = g_string_new(NULL);
-      g_variant_iter_init(&array_iter, value);
-      gboolean first = TRUE;
-      while (g_variant_iter_loop(&array_iter, "s", &attr)) {
-        if (!first) {
-          g_string_append(str, ", ");
-        }
-        first = FALSE;
-        g_string_append(str, attr);
-      }
-      adw_action_row_set_subtitle(self->attributes_row, str->str);
-    } else if (g_strcmp0(key, "StatusValues") == 0) {
-      GVariantIter status_iter;
-      gint code;
-      const gchar *text_value;
-      g_autoptr(GString) str = g_string_new(NULL);
-      gboolean first = TRUE;
-      g_variant_iter_init(&status_iter, value);
-      while (g_variant_iter_loop(&status_iter, "{is}", &code, &text_value)) {
-        if (!first) {
-          g_string_append_c(str, '\n');
-        }
-        first = FALSE;
-        g_string_append_printf(str, "%d: %s", code, text_value);
-      }
-      adw_action_row_set_subtitle(self->status_values_row, str->str);
-    } else if (g_strcmp0(key, "DisplayEventTypes") == 0) {
-      GVariantIter event_iter;
-      gint event_code;
-      const gchar *event_text;
-      g_autoptr(GString) str = g_string_new(NULL);
-      gboolean first = TRUE;
-      g_variant_iter_init(&event_iter, value);
-      while (g_variant_iter_loop(&event_iter, "{is}", &event_code, &event_text)) {
-        if (!first) {
-          g_string_append_c(str, '\n');
-        }
-        first = FALSE;
-        g_string_append_printf(str, "%d: %s", event_code, event_text);
-      }
-      adw_action_row_set_subtitle(self->display_event_types_row, str->str);
-    } else if (g_strcmp0(key, "ServiceFlagOptions") == 0) {
-      GVariantIter flag_iter;
-      gint flag;
-      const gchar *flag_name;
-      g_autoptr(GString) str = g_string_new(NULL);
-      gboolean first = TRUE;
-      g_variant_iter_init(&flag_iter, value);
-      while (g_variant_iter_loop(&flag_iter, "{is}", &flag, &flag_name)) {
-        if (!first) {
-          g_string_append_c(str, '\n');
-        }
-        first = FALSE;
-        g_string_append_printf(str, "0x%X: %s", flag, flag_name);
-      }
-      adw_action_row_set_subtitle(self->flag_options_row, str->str);
-    } else if (g_strcmp0(key, "DdcutilDynamicSleep") == 0) {
-      adw_switch_row_set_active(self->dynamic_sleep_row, g_variant_get_boolean(value));
-    } else if (g_strcmp0(key, "ServiceInfoLogging") == 0) {
-      adw_switch_row_set_active(self->info_logging_row, g_variant_get_boolean(value));
-    } else if (g_strcmp0(key, "ServiceEmitConnectivitySignals") == 0) {
-      adw_switch_row_set_active(self->connectivity_signals_row, g_variant_get_boolean(value));
-    } else if (g_strcmp0(key, "DdcutilOutputLevel") == 0) {
-      adw_spin_row_set_value(self->output_level_row, g_variant_get_uint32(value));
-    } else if (g_strcmp0(key, "ServicePollInterval") == 0) {
-      adw_spin_row_set_value(self->poll_interval_row, g_variant_get_uint32(value));
-    } else if (g_strcmp0(key, "ServicePollCascadeInterval") == 0) {
-      adw_spin_row_set_value(self->poll_cascade_row, g_variant_get_double(value));
+  gint code;
+  const gchar *name;
+
+  g_variant_iter_init(&iter, value);
+  while (g_variant_iter_next(&iter, "{i&s}", &code, &name)) {
+    if (str->len > 0) {
+      g_string_append_c(str, '\n');
     }
+    g_string_append_printf(str, format, code, name);
   }
+  adw_action_row_set_subtitle(ADW_ACTION_ROW(row), str->str);
+}
 
-  self->updating_service_properties = FALSE;
+static void
+apply_status_table_row(GtkWidget *row, GVariant *value)
+{
+  apply_code_table(row, value, "%d: %s");
 }
 
 static void
-handle_get_all_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+apply_flag_table_row(GtkWidget *row, GVariant *value)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
-  g_autoptr(GError) error = NULL;
-  g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
-  gnomeddc_window_finish_operation(self);
+  apply_code_table(row, value, "0x%X: %s");
+}
 
-  if (error != NULL) {
-    show_toast(self, _("Failed to read service properties: %s"), error->message);
-    return;
-  }
+static void
+apply_switch_row(GtkWidget *row, GVariant *value)
+{
+  adw_switch_row_set_active(ADW_SWITCH_ROW(row), g_variant_get_boolean(value));
+}
 
-  if (response == NULL) {
+static void
+apply_uint_spin_row(GtkWidget *row, GVariant *value)
+{
+  adw_spin_row_set_value(ADW_SPIN_ROW(row), g_variant_get_uint32(value));
+}
+
+static void
+apply_double_spin_row(GtkWidget *row, GVariant *value)
+{
+  adw_spin_row_set_value(ADW_SPIN_ROW(row), g_variant_get_double(value));
+}
+
+/* Which row shows which service property. The client's property model
+ * only reports values that changed, so each row is touched when its own
+ * property does and the static tables are formatted once per service
+ * start. */
+typedef struct {
+  const gchar *name;
+  const gchar *type;
+  void (*apply)(GtkWidget *row, GVariant *value);
+  glong row_offset;
+} ServiceRowHandler;
+
+#define SERVICE_ROW(name, type, apply, row) { name, type, apply, G_STRUCT_OFFSET(GnomeDdcWindow, row) }
+
+static const ServiceRowHandler service_row_handlers[] = {
+  SERVICE_ROW("ServiceInterfaceVersion", "s", apply_string_row, service_version_row),
+  SERVICE_ROW("DdcutilVersion", "s", apply_string_row, ddcutil_version_row),
+  SERVICE_ROW("ServiceParametersLocked", "b", apply_yes_no_row, service_parameters_locked_row),
+  SERVICE_ROW("AttributesReturnedByDetect", "as", apply_string_list_row, attributes_row),
+  SERVICE_ROW("StatusValues", "a{is}", apply_status_table_row, status_values_row),
+  SERVICE_ROW("DisplayEventTypes", "a{is}", apply_status_table_row, display_event_types_row),
+  SERVICE_ROW("ServiceFlagOptions", "a{is}", apply_flag_table_row, flag_options_row),
+  SERVICE_ROW("DdcutilDynamicSleep", "b", apply_switch_row, dynamic_sleep_row),
+  SERVICE_ROW("ServiceInfoLogging", "b", apply_switch_row, info_logging_row),
+  SERVICE_ROW("ServiceEmitConnectivitySignals", "b", apply_switch_row, connectivity_signals_row),
+  SERVICE_ROW("DdcutilOutputLevel", "u", apply_uint_spin_row, output_level_row),
+  SERVICE_ROW("ServicePollInterval", "u", apply_uint_spin_row, poll_interval_row),
+  SERVICE_ROW("ServicePollCascadeInterval", "d", apply_double_spin_row, poll_cascade_row),
+};
+
+#undef SERVICE_ROW
+
+/* property name -> ServiceRowHandler, filled in class_init */
+static GHashTable *service_row_handler_index;
+
+static void
+apply_service_row(GnomeDdcWindow *self, const ServiceRowHandler *handler, GVariant *value)
+{
+  if (!g_variant_is_of_type(value, G_VARIANT_TYPE(handler->type))) {
     return;
   }
 
-  GVariant *dict = NULL;
-  g_variant_get(response, "(@a{sv})", &dict);
-  update_service_rows_from_dict(self, dict);
-  g_variant_unref(dict);
+  /* Setting a switch or spin row must not write the value back. */
+  self->updating_service_properties = TRUE;
+  handler->apply(G_STRUCT_MEMBER(GtkWidget *, self, handler->row_offset), value);
+  self->updating_service_properties = FALSE;
 }
 
 static void
-gnomeddc_window_refresh_service_properties(GnomeDdcWindow *self)
+service_property_changed_cb(GnomeDdcServiceProperties *properties G_GNUC_UNUSED,
+                            const gchar *name,
+                            GVariant *value,
+                            gpointer user_data)
 {
-  if (!gnomeddc_client_is_connected(self->client)) {
-    return;
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  const ServiceRowHandler *handler = g_hash_table_lookup(service_row_handler_index, name);
+
+  if (handler != NULL) {
+    apply_service_row(self, handler, value);
   }
+}
 
-  gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "org.freedesktop.DBus.Properties.GetAll",
-                             g_variant_new("(s)", DDCUTIL_INTERFACE_NAME),
-                             NULL,
-                             handle_get_all_finished,
-                             self);
+static void
+apply_all_service_rows(GnomeDdcWindow *self)
+{
+  GnomeDdcServiceProperties *properties = gnomeddc_client_get_service_properties(self->client);
+
+  for (guint i = 0; i < G_N_ELEMENTS(service_row_handlers); i++) {
+    GVariant *value = gnomeddc_service_properties_get_value(properties, service_row_handlers[i].name);
+    if (value != NULL) {
+      apply_service_row(self, &service_row_handlers[i], value);
+    }
+  }
 }
 
 static void
@@ -364,74 +503,34 @@ clear_capabilities_view(GnomeDdcWindow *self)
 {
   GtkTextBuffer *buffer = gtk_text_view_get_buffer(self->capabilities_text_view);
   gtk_text_buffer_set_text(buffer, "", -1);
+  gtk_filter_list_model_set_model(self->feature_filter_model, NULL);
+  gtk_widget_set_visible(GTK_WIDGET(self->capabilities_features_group), FALSE);
 }
 
 static void
-handle_list_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+handle_refresh_finished(GObject *source, GAsyncResult *result, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
-  g_autoptr(GError) error = NULL;
-  g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
-  gnomeddc_window_finish_operation(self);
-
-  if (error != NULL) {
-    show_toast(self, _("Detection failed: %s"), error->message);
-    return;
-  }
-
-  if (response == NULL) {
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
     return;
   }
-
-  gint ddc_status = 0;
+  g_autoptr(GError) error = NULL;
   g_autofree gchar *message = NULL;
-  GVariant *array = NULL;
-  gint reported_count = 0;
-  g_variant_get(response, "(ia(iiisssqsu)is)", &reported_count, &array, &ddc_status, &message);
-
-  g_list_store_remove_all(self->display_store);
+  gboolean refreshed = gnomeddc_display_model_refresh_finish(GNOMEDDC_DISPLAY_MODEL(source), result,
+                                                             &message, &error);
+  gnomeddc_window_finish_operation(self);
 
-  GVariantIter iter;
-  gint display_number;
-  gint usb_bus;
-  gint usb_device;
-  guint16 product_code;
-  guint32 binary_serial;
-  const gchar *manufacturer;
-  const gchar *model;
-  const gchar *serial;
-  const gchar *edid;
-
-  g_variant_iter_init(&iter, array);
-  while (g_variant_iter_loop(&iter, "(iiisssqsu)",
-                             &display_number,
-                             &usb_bus,
-                             &usb_device,
-                             &manufacturer,
-                             &model,
-                             &serial,
-                             &product_code,
-                             &edid,
-                             &binary_serial)) {
-    GnomeDdcDisplay *display = gnomeddc_display_new(display_number,
-                                                   usb_bus,
-                                                   usb_device,
-                                                   manufacturer,
-                                                   model,
-                                                   serial,
-                                                   product_code,
-                                                   edid,
-                                                   binary_serial);
-    g_list_store_append(self->display_store, display);
-    g_object_unref(display);
+  if (!refreshed) {
+    /* Overtaken by a newer result, which is applied instead. */
+    if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      show_toast(self, _("Detection failed: %s"), error->message);
+    }
+    return;
   }
-  g_variant_unref(array);
-
-  update_empty_state(self);
-  gnomeddc_window_update_selection(self);
 
   show_toast(self, _("Detected %u displays (%s)"),
-             g_list_model_get_n_items(G_LIST_MODEL(self->display_store)),
+             g_list_model_get_n_items(G_LIST_MODEL(self->display_model)),
              message != NULL ? message : "");
 }
 
@@ -445,12 +544,11 @@ gnomeddc_window_refresh_displays(GnomeDdcWindow *self, gboolean detect)
   }
 
   gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             detect ? "Detect" : "ListDetected",
-                             g_variant_new("(u)", 0),
-                             NULL,
-                             handle_list_finished,
-                             self);
+  gnomeddc_display_model_refresh_async(self->display_model,
+                                       detect,
+                                       NULL,
+                                       handle_refresh_finished,
+                                       g_object_ref(self));
 }
 
 static gboolean
@@ -513,49 +611,55 @@ parse_double_from_entry(AdwEntryRow *entry, gdouble *out_value)
   return TRUE;
 }
 
-static GVariant *
-build_vcp_code_array(const gchar *text)
+/* Parses a list of codes separated by commas, semicolons or spaces into a
+ * plain byte buffer; returns NULL if any of them is not a byte. */
+static GByteArray *
+parse_vcp_codes(const gchar *text)
 {
+  g_autoptr(GByteArray) codes = g_byte_array_new();
   if (text == NULL || *text == '\0') {
-    return g_variant_new_array(G_VARIANT_TYPE_BYTE, NULL, 0);
+    return g_steal_pointer(&codes);
   }
 
-  g_autoptr(GPtrArray) codes = g_ptr_array_new();
-  gchar **parts = g_strsplit_set(text, ",; ", -1);
+  g_auto(GStrv) parts = g_strsplit_set(text, ",; ", -1);
   for (gint i = 0; parts[i] != NULL; i++) {
     if (parts[i][0] == '\0') {
       continue;
     }
     gchar *endptr = NULL;
-    guint value = (guint) g_ascii_strtoull(parts[i], &endptr, 0);
+    guint64 value = g_ascii_strtoull(parts[i], &endptr, 0);
     if (endptr == NULL || *endptr != '\0' || value > G_MAXUINT8) {
-      g_strfreev(parts);
       return NULL;
     }
-    g_ptr_array_add(codes, GINT_TO_POINTER((gint) value));
-  }
-  g_strfreev(parts);
-
-  GVariantBuilder builder;
-  g_variant_builder_init(&builder, G_VARIANT_TYPE("ay"));
-  for (guint i = 0; i < codes->len; i++) {
-    guint8 code = (guint8) GPOINTER_TO_INT(g_ptr_array_index(codes, i));
-    g_variant_builder_add(&builder, "y", code);
+    guint8 code = (guint8) value;
+    g_byte_array_append(codes, &code, 1);
   }
-  return g_variant_builder_end(&builder);
+  return g_steal_pointer(&codes);
 }
 
 
 static void
 handle_get_state_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
   g_autoptr(GError) error = NULL;
   g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
   gnomeddc_window_finish_operation(self);
 
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return;
+  }
+
   if (error != NULL) {
-    show_toast(self, _("Failed to get display state: %s"), error->message);
+    if (is_prefetched(self, DISPLAY_OPERATION_STATE)) {
+      adw_action_row_set_subtitle(self->state_row, error->message);
+    } else {
+      show_toast(self, _("Failed to get display state: %s"), error->message);
+    }
     return;
   }
 
@@ -580,27 +684,38 @@ gnomeddc_window_query_state(GnomeDdcWindow *self)
   }
 
   gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "GetDisplayState",
-                             g_variant_new("(isu)",
-                                           gnomeddc_display_get_display_number(display),
-                                           gnomeddc_display_get_edid(display),
-                                           0),
-                             NULL,
-                             handle_get_state_finished,
-                             self);
+  gnomeddc_client_call_display_async(self->client,
+                                     "GetDisplayState",
+                                     display,
+                                     0,
+                                     GNOMEDDC_CALL_FLAGS_NONE,
+                                     begin_display_operation(self, DISPLAY_OPERATION_STATE),
+                                     handle_get_state_finished,
+                                     g_object_ref(self));
 }
 
 static void
 handle_get_sleep_multiplier_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
   g_autoptr(GError) error = NULL;
   g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
   gnomeddc_window_finish_operation(self);
 
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return;
+  }
+
   if (error != NULL) {
-    show_toast(self, _("Failed to read sleep multiplier: %s"), error->message);
+    if (is_prefetched(self, DISPLAY_OPERATION_SLEEP_MULTIPLIER)) {
+      adw_action_row_set_subtitle(self->sleep_multiplier_row, error->message);
+    } else {
+      show_toast(self, _("Failed to read sleep multiplier: %s"), error->message);
+    }
     return;
   }
 
@@ -629,21 +744,24 @@ gnomeddc_window_query_sleep_multiplier(GnomeDdcWindow *self)
   }
 
   gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "GetSleepMultiplier",
-                             g_variant_new("(isu)",
-                                           gnomeddc_display_get_display_number(display),
-                                           gnomeddc_display_get_edid(display),
-                                           0),
-                             NULL,
-                             handle_get_sleep_multiplier_finished,
-                             self);
+  gnomeddc_client_call_display_async(self->client,
+                                     "GetSleepMultiplier",
+                                     display,
+                                     0,
+                                     GNOMEDDC_CALL_FLAGS_NONE,
+                                     begin_display_operation(self, DISPLAY_OPERATION_SLEEP_MULTIPLIER),
+                                     handle_get_sleep_multiplier_finished,
+                                     g_object_ref(self));
 }
 
 static void
 handle_set_sleep_multiplier_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
   g_autoptr(GError) error = NULL;
   g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
   gnomeddc_window_finish_operation(self);
@@ -665,11 +783,19 @@ handle_set_sleep_multiplier_finished(GObject *source G_GNUC_UNUSED, GAsyncResult
 static void
 handle_get_vcp_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
   g_autoptr(GError) error = NULL;
   g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
   gnomeddc_window_finish_operation(self);
 
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return;
+  }
+
   if (error != NULL) {
     show_toast(self, _("Failed to read VCP: %s"), error->message);
     return;
@@ -692,16 +818,46 @@ handle_get_vcp_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpo
 }
 
 
+static void
+handle_multiple_vcp_formatted(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
+  g_autofree gchar *text = gnomeddc_format_vcp_values_finish(result, NULL);
+
+  if (text == NULL) {
+    return;
+  }
+
+  GtkTextBuffer *buffer = gtk_text_view_get_buffer(self->capabilities_text_view);
+  gtk_text_buffer_set_text(buffer, text, -1);
+}
+
 static void
 handle_get_multiple_vcp_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
   g_autoptr(GError) error = NULL;
   g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
   gnomeddc_window_finish_operation(self);
 
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return;
+  }
+
   if (error != NULL) {
-    show_toast(self, _("Failed to read multiple VCP values: %s"), error->message);
+    if (is_prefetched(self, DISPLAY_OPERATION_MULTIPLE_VCP)) {
+      adw_action_row_set_subtitle(self->get_multiple_vcp_row, error->message);
+    } else {
+      show_toast(self, _("Failed to read multiple VCP values: %s"), error->message);
+    }
     return;
   }
 
@@ -713,39 +869,109 @@ handle_get_multiple_vcp_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *re
   gint status = 0;
   g_autofree gchar *message = NULL;
   g_variant_get(response, "(@a(yqqs) is)", &array, &status, &message);
+
+  /* The capabilities text is left to the prefetched capabilities; the few
+   * common codes fit in the row itself. */
+  if (is_prefetched(self, DISPLAY_OPERATION_MULTIPLE_VCP)) {
+    gsize n_values = 0;
+    g_autofree GnomeDdcVcpValue *values = gnomeddc_vcp_values_decode(array, &n_values);
+    g_autoptr(GString) text = g_string_new(NULL);
+    gnomeddc_vcp_values_format(text, "", values, n_values);
+    if (text->len > 0) {
+      g_string_truncate(text, text->len - 1);
+    }
+    adw_action_row_set_subtitle(self->get_multiple_vcp_row, text->str);
+    g_variant_unref(array);
+    return;
+  }
+
   adw_action_row_set_subtitle(self->get_multiple_vcp_row,
                               g_strdup_printf(_("Status %d — %s"), status,
                                               message != NULL ? message : ""));
 
-  GtkTextBuffer *buffer = gtk_text_view_get_buffer(self->capabilities_text_view);
-  gtk_text_buffer_set_text(buffer, "", -1);
+  /* Still current: a newer request or a selection change would have
+   * cancelled this reply. */
+  gnomeddc_format_vcp_values_async(array,
+                                   self->display_operations[DISPLAY_OPERATION_MULTIPLE_VCP],
+                                   handle_multiple_vcp_formatted,
+                                   g_object_ref(self));
+  g_variant_unref(array);
+}
 
-  GVariantIter iter;
-  guint8 code;
-  guint16 current;
-  guint16 max_value;
-  const gchar *formatted;
-  g_variant_iter_init(&iter, array);
-  while (g_variant_iter_loop(&iter, "(yqqs)", &code, &current, &max_value, &formatted)) {
-    g_autofree gchar *line = g_strdup_printf("0x%02X — %u/%u — %s\n",
-                                             code,
-                                             current,
-                                             max_value,
-                                             formatted != NULL ? formatted : "");
-    gtk_text_buffer_insert_at_cursor(buffer, line, -1);
+static void
+handle_read_all_displays_finished(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
   }
+  GnomeDdcVcpBatch *batch = GNOMEDDC_VCP_BATCH(source);
+  g_autoptr(GError) error = NULL;
+  gboolean completed = gnomeddc_vcp_batch_read_finish(batch, result, &error);
+  gnomeddc_window_finish_operation(self);
 
-  g_variant_unref(array);
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return;
+  }
+
+  if (!completed) {
+    show_toast(self, _("Failed to read displays: %s"), error->message);
+    return;
+  }
+
+  guint n_entries = gnomeddc_vcp_batch_get_n_entries(batch);
+  guint n_failed = 0;
+  g_autoptr(GString) text = g_string_new(NULL);
+  for (guint i = 0; i < n_entries; i++) {
+    GnomeDdcDisplay *display = gnomeddc_vcp_batch_get_display(batch, i);
+    g_autofree gchar *name = gnomeddc_display_dup_full_name(display);
+    g_string_append_printf(text, "Display %d — %s\n", gnomeddc_display_get_display_number(display), name);
+
+    const GError *entry_error = gnomeddc_vcp_batch_get_error(batch, i);
+    if (entry_error != NULL || gnomeddc_vcp_batch_get_values(batch, i) == NULL) {
+      g_string_append_printf(text, "  %s\n\n", entry_error != NULL ? entry_error->message : _("No reply"));
+      n_failed++;
+      continue;
+    }
+
+    gint status = gnomeddc_vcp_batch_get_status(batch, i);
+    if (status != 0) {
+      const gchar *message = gnomeddc_vcp_batch_get_message(batch, i);
+      g_string_append_printf(text, "  Status %d — %s\n", status, message != NULL ? message : "");
+      n_failed++;
+    }
+
+    gsize n_values = 0;
+    const GnomeDdcVcpValue *values = gnomeddc_vcp_batch_get_value_array(batch, i, &n_values);
+    gnomeddc_vcp_values_format(text, "  ", values, n_values);
+    g_string_append_c(text, '\n');
+  }
+
+  g_autofree gchar *subtitle = g_strdup_printf(_("%u displays read, %u with errors"), n_entries, n_failed);
+  adw_action_row_set_subtitle(self->read_all_displays_row, subtitle);
+
+  GtkTextBuffer *buffer = gtk_text_view_get_buffer(self->capabilities_text_view);
+  gtk_text_buffer_set_text(buffer, text->str, (gint) text->len);
 }
 
 static void
 handle_set_vcp_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
   g_autoptr(GError) error = NULL;
-  g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
+  g_autoptr(GVariant) response = gnomeddc_write_coalescer_set_vcp_finish(self->write_coalescer, result, &error);
   gnomeddc_window_finish_operation(self);
 
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    /* A newer value for the same feature replaced this one. */
+    return;
+  }
+
   if (error != NULL) {
     show_toast(self, _("Failed to set VCP: %s"), error->message);
     return;
@@ -762,11 +988,19 @@ handle_set_vcp_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpo
 static void
 handle_get_vcp_metadata_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
   g_autoptr(GError) error = NULL;
   g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
   gnomeddc_window_finish_operation(self);
 
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return;
+  }
+
   if (error != NULL) {
     show_toast(self, _("Failed to read VCP metadata: %s"), error->message);
     return;
@@ -819,14 +1053,58 @@ handle_get_vcp_metadata_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *re
   gtk_text_buffer_insert_at_cursor(buffer, details, -1);
 }
 
+static void
+show_capabilities_string(GnomeDdcWindow *self, const gchar *caps_text, gint status, const gchar *message)
+{
+  adw_action_row_set_subtitle(self->get_capabilities_row,
+                              g_strdup_printf(_("Status %d — %s"), status, message));
+  GtkTextBuffer *buffer = gtk_text_view_get_buffer(self->capabilities_text_view);
+  gtk_text_buffer_set_text(buffer, caps_text, -1);
+}
+
+/* Capabilities replies are cached under the EDID they were requested for,
+ * not whatever is selected by the time they arrive. */
+typedef struct {
+  GnomeDdcWindow *self;
+  gchar *edid;
+} CapabilitiesCall;
+
+static CapabilitiesCall *
+capabilities_call_new(GnomeDdcWindow *self, GnomeDdcDisplay *display)
+{
+  CapabilitiesCall *call = g_new(CapabilitiesCall, 1);
+  call->self = g_object_ref(self);
+  call->edid = g_strdup(gnomeddc_display_get_edid(display));
+  return call;
+}
+
+static void
+capabilities_call_free(CapabilitiesCall *call)
+{
+  g_object_unref(call->self);
+  g_free(call->edid);
+  g_free(call);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(CapabilitiesCall, capabilities_call_free)
+
 static void
 handle_get_capabilities_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(CapabilitiesCall) call = user_data;
+  GnomeDdcWindow *self = call->self;
+  if (window_is_disposed(self)) {
+    return;
+  }
   g_autoptr(GError) error = NULL;
   g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
   gnomeddc_window_finish_operation(self);
 
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return;
+  }
+
   if (error != NULL) {
     show_toast(self, _("Failed to read capabilities string: %s"), error->message);
     return;
@@ -839,24 +1117,173 @@ handle_get_capabilities_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *re
   const gchar *caps_text;
   gint status = 0;
   const gchar *message;
-  g_variant_get(response, "(&sis)", &caps_text, &status, &message);
+  g_variant_get(response, "(&si&s)", &caps_text, &status, &message);
 
-  adw_action_row_set_subtitle(self->get_capabilities_row,
-                              g_strdup_printf(_("Status %d — %s"), status, message));
-  GtkTextBuffer *buffer = gtk_text_view_get_buffer(self->capabilities_text_view);
-  gtk_text_buffer_set_text(buffer, caps_text, -1);
-}
+  if (status == 0) {
+    gnomeddc_capabilities_cache_store_string(self->capabilities_cache, call->edid, caps_text);
+  }
+
+  show_capabilities_string(self, caps_text, status, message);
+}
 
+/* The header and the short command list go to the text view; the feature
+ * table, which can have hundreds of value names, goes to a list view that
+ * only builds its visible rows. */
 static void
-handle_get_capabilities_metadata_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+handle_capabilities_decoded(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
+  g_autoptr(GnomeDdcCapabilitiesReply) reply = gnomeddc_decode_capabilities_finish(result, NULL);
+
+  if (reply == NULL) {
+    return;
+  }
+
+  g_autofree gchar *subtitle = g_strdup_printf(_("%s — MCCS %u.%u (status %d)"),
+                                               reply->model_name,
+                                               reply->mccs_major,
+                                               reply->mccs_minor,
+                                               reply->status);
+  adw_action_row_set_subtitle(self->get_capabilities_metadata_row, subtitle);
+
+  GtkTextBuffer *buffer = gtk_text_view_get_buffer(self->capabilities_text_view);
+  gtk_text_buffer_set_text(buffer, reply->summary, -1);
+
+  gtk_filter_list_model_set_model(self->feature_filter_model, G_LIST_MODEL(reply->features));
+  gtk_widget_set_visible(GTK_WIDGET(self->capabilities_features_group), TRUE);
+}
+
+/* The text and the feature model are built on a worker thread; the
+ * capabilities operation's cancellable drops the result if the selection
+ * moves on meanwhile. */
+static void
+show_capabilities_metadata(GnomeDdcWindow *self, GVariant *metadata, gint status, const gchar *message)
+{
+  gnomeddc_decode_capabilities_async(metadata,
+                                     status,
+                                     message,
+                                     self->display_operations[DISPLAY_OPERATION_CAPABILITIES],
+                                     handle_capabilities_decoded,
+                                     g_object_ref(self));
+}
+
+static gboolean
+feature_filter_func(gpointer item, gpointer user_data)
 {
   GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  return gnomeddc_capability_feature_matches(GNOMEDDC_CAPABILITY_FEATURE(item), self->feature_search_text);
+}
+
+/* An empty query drops the filter altogether, so that the unfiltered list
+ * does not instantiate every feature just to accept it. */
+static void
+feature_search_changed_cb(GtkSearchEntry *entry, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  const gchar *text = gtk_editable_get_text(GTK_EDITABLE(entry));
+
+  g_clear_pointer(&self->feature_search_text, g_free);
+  if (text == NULL || *text == '\0') {
+    gtk_filter_list_model_set_filter(self->feature_filter_model, NULL);
+    return;
+  }
+
+  self->feature_search_text = g_utf8_casefold(text, -1);
+  gint64 trace_begin = gnomeddc_trace_now();
+  gtk_filter_list_model_set_filter(self->feature_filter_model, GTK_FILTER(self->feature_filter));
+  gtk_filter_changed(GTK_FILTER(self->feature_filter), GTK_FILTER_CHANGE_DIFFERENT);
+  gnomeddc_trace_mark(trace_begin, "ui", "feature-filter", "%u shown",
+                      g_list_model_get_n_items(G_LIST_MODEL(self->feature_filter_model)));
+}
+
+static GListModel *
+create_feature_values_model(gpointer item, gpointer user_data G_GNUC_UNUSED)
+{
+  if (!GNOMEDDC_IS_CAPABILITY_FEATURE(item) ||
+      gnomeddc_capability_feature_get_n_values(GNOMEDDC_CAPABILITY_FEATURE(item)) == 0) {
+    return NULL;
+  }
+  return gnomeddc_capability_feature_create_values_model(GNOMEDDC_CAPABILITY_FEATURE(item));
+}
+
+static void
+feature_list_setup(GtkSignalListItemFactory *factory G_GNUC_UNUSED, GtkListItem *list_item, gpointer user_data G_GNUC_UNUSED)
+{
+  GtkWidget *expander = gtk_tree_expander_new();
+  GtkWidget *row = g_object_new(ADW_TYPE_ACTION_ROW,
+                                "activatable", FALSE,
+                                NULL);
+  gtk_tree_expander_set_child(GTK_TREE_EXPANDER(expander), row);
+  gtk_list_item_set_child(list_item, expander);
+  gtk_list_item_set_activatable(list_item, FALSE);
+}
+
+static void
+feature_list_bind(GtkSignalListItemFactory *factory G_GNUC_UNUSED, GtkListItem *list_item, gpointer user_data G_GNUC_UNUSED)
+{
+  GtkTreeListRow *tree_row = GTK_TREE_LIST_ROW(gtk_list_item_get_item(list_item));
+  GtkTreeExpander *expander = GTK_TREE_EXPANDER(gtk_list_item_get_child(list_item));
+  AdwActionRow *row = ADW_ACTION_ROW(gtk_tree_expander_get_child(expander));
+  g_autoptr(GObject) item = gtk_tree_list_row_get_item(tree_row);
+  gtk_tree_expander_set_list_row(expander, tree_row);
+
+  if (GNOMEDDC_IS_CAPABILITY_FEATURE(item)) {
+    GnomeDdcCapabilityFeature *feature = GNOMEDDC_CAPABILITY_FEATURE(item);
+    guint n_values = gnomeddc_capability_feature_get_n_values(feature);
+    g_autofree gchar *title = g_strdup_printf("0x%02X — %s",
+                                              gnomeddc_capability_feature_get_code(feature),
+                                              gnomeddc_capability_feature_get_name(feature));
+    g_autofree gchar *subtitle = n_values > 0
+                                   ? g_strdup_printf(g_dngettext(NULL, "%s (%u value)", "%s (%u values)", n_values),
+                                                     gnomeddc_capability_feature_get_description(feature),
+                                                     n_values)
+                                   : g_strdup(gnomeddc_capability_feature_get_description(feature));
+    adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row), title);
+    adw_action_row_set_subtitle(row, subtitle);
+  } else if (GNOMEDDC_IS_CAPABILITY_VALUE(item)) {
+    GnomeDdcCapabilityValue *value = GNOMEDDC_CAPABILITY_VALUE(item);
+    g_autofree gchar *title = g_strdup_printf("0x%02X — %s",
+                                              gnomeddc_capability_value_get_code(value),
+                                              gnomeddc_capability_value_get_name(value));
+    adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row), title);
+    adw_action_row_set_subtitle(row, "");
+  }
+}
+
+static void
+feature_list_unbind(GtkSignalListItemFactory *factory G_GNUC_UNUSED, GtkListItem *list_item, gpointer user_data G_GNUC_UNUSED)
+{
+  GtkTreeExpander *expander = GTK_TREE_EXPANDER(gtk_list_item_get_child(list_item));
+  gtk_tree_expander_set_list_row(expander, NULL);
+}
+
+static void
+handle_get_capabilities_metadata_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(CapabilitiesCall) call = user_data;
+  GnomeDdcWindow *self = call->self;
+  if (window_is_disposed(self)) {
+    return;
+  }
   g_autoptr(GError) error = NULL;
   g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
   gnomeddc_window_finish_operation(self);
 
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return;
+  }
+
   if (error != NULL) {
-    show_toast(self, _("Failed to read parsed capabilities: %s"), error->message);
+    if (is_prefetched(self, DISPLAY_OPERATION_CAPABILITIES)) {
+      adw_action_row_set_subtitle(self->get_capabilities_metadata_row, error->message);
+    } else {
+      show_toast(self, _("Failed to read parsed capabilities: %s"), error->message);
+    }
     return;
   }
 
@@ -864,90 +1291,36 @@ handle_get_capabilities_metadata_finished(GObject *source G_GNUC_UNUSED, GAsyncR
     return;
   }
 
-  const gchar *model_name;
-  guint8 mccs_major = 0;
-  guint8 mccs_minor = 0;
-  GVariant *commands = NULL;
-  GVariant *features = NULL;
+  /* Split the reply into the cacheable metadata and its status tail. */
+  GVariant *children[5];
+  for (guint i = 0; i < G_N_ELEMENTS(children); i++) {
+    children[i] = g_variant_get_child_value(response, i);
+  }
+  g_autoptr(GVariant) metadata = g_variant_ref_sink(g_variant_new_tuple(children, G_N_ELEMENTS(children)));
+  for (guint i = 0; i < G_N_ELEMENTS(children); i++) {
+    g_variant_unref(children[i]);
+  }
+
   gint status = 0;
   const gchar *message;
-  g_variant_get(response, "(&syy@a{ys}@a{y(ssa{ys})}is)",
-                &model_name,
-                &mccs_major,
-                &mccs_minor,
-                &commands,
-                &features,
-                &status,
-                &message);
-
-  adw_action_row_set_subtitle(self->get_capabilities_metadata_row,
-                              g_strdup_printf(_("%s — MCCS %u.%u (status %d)"),
-                                              model_name,
-                                              mccs_major,
-                                              mccs_minor,
-                                              status));
-
-  GtkTextBuffer *buffer = gtk_text_view_get_buffer(self->capabilities_text_view);
-  gtk_text_buffer_set_text(buffer, "", -1);
+  g_variant_get_child(response, 5, "i", &status);
+  g_variant_get_child(response, 6, "&s", &message);
 
-  g_autofree gchar *header = g_strdup_printf("Model: %s\n"
-                                             "MCCS: %u.%u\n"
-                                             "Status: %d (%s)\n"
-                                             "\n"
-                                             "Commands:\n",
-                                             model_name,
-                                             mccs_major,
-                                             mccs_minor,
-                                             status,
-                                             message);
-  gtk_text_buffer_insert_at_cursor(buffer, header, -1);
-
-  GVariantIter cmd_iter;
-  guint8 cmd_code;
-  const gchar *cmd_desc;
-  g_variant_iter_init(&cmd_iter, commands);
-  while (g_variant_iter_loop(&cmd_iter, "{ys}", &cmd_code, &cmd_desc)) {
-    g_autofree gchar *line = g_strdup_printf("  0x%02X — %s\n", cmd_code, cmd_desc);
-    gtk_text_buffer_insert_at_cursor(buffer, line, -1);
-  }
-
-  gtk_text_buffer_insert_at_cursor(buffer, "\nFeatures:\n", -1);
-  GVariantIter feature_iter;
-  guint8 feature_code;
-  const gchar *feature_name;
-  const gchar *feature_desc;
-  GVariant *permitted = NULL;
-  g_variant_iter_init(&feature_iter, features);
-  while (g_variant_iter_loop(&feature_iter, "{y(ssa{ys})}",
-                             &feature_code,
-                             &feature_name,
-                             &feature_desc,
-                             &permitted)) {
-    g_autofree gchar *line = g_strdup_printf("  0x%02X — %s (%s)\n",
-                                             feature_code,
-                                             feature_name,
-                                             feature_desc);
-    gtk_text_buffer_insert_at_cursor(buffer, line, -1);
-    GVariantIter value_iter;
-    guint8 value_code;
-    const gchar *value_name;
-    g_variant_iter_init(&value_iter, permitted);
-    while (g_variant_iter_loop(&value_iter, "{ys}", &value_code, &value_name)) {
-      g_autofree gchar *value_line = g_strdup_printf("    %u — %s\n",
-                                                     value_code,
-                                                     value_name);
-      gtk_text_buffer_insert_at_cursor(buffer, value_line, -1);
-    }
+  if (status == 0) {
+    gnomeddc_capabilities_cache_store_metadata(self->capabilities_cache, call->edid, metadata);
   }
 
-  g_variant_unref(commands);
-  g_variant_unref(features);
+  show_capabilities_metadata(self, metadata, status, message);
 }
 
 static void
 handle_restart_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
   g_autoptr(GError) error = NULL;
   g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
   gnomeddc_window_finish_operation(self);
@@ -970,6 +1343,7 @@ static void
 selection_changed_cb(GtkSelectionModel *model G_GNUC_UNUSED, guint position G_GNUC_UNUSED, guint n_items G_GNUC_UNUSED, gpointer user_data)
 {
   GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  cancel_display_operations(self);
   gnomeddc_window_update_selection(self);
 }
 
@@ -977,9 +1351,31 @@ static void
 search_changed_cb(GtkSearchEntry *entry, gpointer user_data)
 {
   GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
-  g_clear_pointer(&self->search_text, g_free);
-  self->search_text = g_strdup(gtk_editable_get_text(GTK_EDITABLE(entry)));
-  gtk_filter_changed(GTK_FILTER(self->search_filter), GTK_FILTER_CHANGE_DIFFERENT);
+  gchar *folded = g_utf8_casefold(gtk_editable_get_text(GTK_EDITABLE(entry)), -1);
+  const gchar *previous = self->search_text != NULL ? self->search_text : "";
+
+  if (g_str_equal(previous, folded)) {
+    g_free(folded);
+    return;
+  }
+
+  /* The filter model can refine its current result when the text only grew
+   * or shrank at the end; that holds for the EDID prefix match as well as
+   * for the substring match. */
+  GtkFilterChange change = GTK_FILTER_CHANGE_DIFFERENT;
+  if (g_str_has_prefix(folded, previous)) {
+    change = GTK_FILTER_CHANGE_MORE_STRICT;
+  } else if (g_str_has_prefix(previous, folded)) {
+    change = GTK_FILTER_CHANGE_LESS_STRICT;
+  }
+
+  g_free(self->search_text);
+  self->search_text = folded;
+  gint64 trace_begin = gnomeddc_trace_now();
+  gtk_filter_changed(GTK_FILTER(self->search_filter), change);
+  gnomeddc_trace_mark(trace_begin, "ui", "display-filter", "%u of %u shown",
+                      g_list_model_get_n_items(G_LIST_MODEL(self->filter_model)),
+                      g_list_model_get_n_items(G_LIST_MODEL(self->display_model)));
 }
 
 static void
@@ -997,46 +1393,576 @@ list_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
 }
 
 static void
-state_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+state_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  gnomeddc_window_query_state(self);
+}
+
+static void
+sleep_refresh_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  gnomeddc_window_query_sleep_multiplier(self);
+}
+
+static void
+sleep_set_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  g_autoptr(GnomeDdcDisplay) display = get_selected_display(self);
+  if (display == NULL) {
+    show_toast(self, _("Select a display first"));
+    return;
+  }
+
+  gdouble multiplier = 0.0;
+  if (!parse_double_from_entry(self->sleep_multiplier_entry, &multiplier)) {
+    show_toast(self, _("Enter a valid multiplier"));
+    return;
+  }
+
+  gnomeddc_window_start_operation(self);
+  gnomeddc_client_call_async(self->client,
+                             "SetSleepMultiplier",
+                             g_variant_new("(isdu)",
+                                           gnomeddc_display_get_display_number(display),
+                                           gnomeddc_display_get_edid(display),
+                                           multiplier,
+                                           0),
+                             NULL,
+                             handle_set_sleep_multiplier_finished,
+                             g_object_ref(self));
+}
+
+static void
+calibration_step_finished_cb(GnomeDdcSleepCalibration *calibration, guint index, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GnomeDdcCalibrationStep step;
+  if (!gnomeddc_sleep_calibration_get_step(calibration, index, &step)) {
+    return;
+  }
+
+  g_autofree gchar *subtitle = g_strdup_printf(_("Step %u of %u: %.2f — %u/%u reads, %.1f ms"),
+                                               index + 1,
+                                               gnomeddc_sleep_calibration_get_n_sweep_steps(calibration),
+                                               step.multiplier,
+                                               step.successes,
+                                               step.reads,
+                                               step.mean_usec / 1000.0);
+  adw_action_row_set_subtitle(self->calibrate_sleep_row, subtitle);
+}
+
+static void
+handle_calibration_finished(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
+  GnomeDdcSleepCalibration *calibration = GNOMEDDC_SLEEP_CALIBRATION(source);
+  g_autoptr(GError) error = NULL;
+  gdouble multiplier = gnomeddc_sleep_calibration_run_finish(calibration, result, &error);
+  gnomeddc_window_finish_operation(self);
+
+  if (calibration != self->calibration) {
+    return;
+  }
+  g_signal_handlers_disconnect_by_data(calibration, self);
+  g_clear_object(&self->calibration);
+  g_clear_object(&self->calibration_cancellable);
+  gtk_button_set_label(self->calibrate_sleep_button, _("Calibrate"));
+
+  if (error != NULL) {
+    adw_action_row_set_subtitle(self->calibrate_sleep_row, error->message);
+    if (!g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+      show_toast(self, _("Calibration failed: %s"), error->message);
+    }
+    return;
+  }
+
+  g_autofree gchar *subtitle = g_strdup_printf(_("Calibrated to %.2f"), multiplier);
+  adw_action_row_set_subtitle(self->calibrate_sleep_row, subtitle);
+  show_toast(self, _("Sleep multiplier calibrated to %.2f"), multiplier);
+  gnomeddc_window_query_sleep_multiplier(self);
+}
+
+/* Toggles between starting a calibration for the selected display and
+ * cancelling the one in progress. */
+static void
+calibrate_sleep_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+
+  if (self->calibration != NULL) {
+    g_cancellable_cancel(self->calibration_cancellable);
+    return;
+  }
+
+  g_autoptr(GnomeDdcDisplay) display = get_selected_display(self);
+  if (display == NULL) {
+    show_toast(self, _("Select a display first"));
+    return;
+  }
+
+  self->calibration = gnomeddc_sleep_calibration_new(self->client, display);
+  self->calibration_cancellable = g_cancellable_new();
+  g_signal_connect(self->calibration, "step-finished", G_CALLBACK(calibration_step_finished_cb), self);
+  gtk_button_set_label(self->calibrate_sleep_button, _("Cancel"));
+  adw_action_row_set_subtitle(self->calibrate_sleep_row, _("Measuring…"));
+
+  gnomeddc_window_start_operation(self);
+  gnomeddc_sleep_calibration_run_async(self->calibration,
+                                       self->calibration_cancellable,
+                                       handle_calibration_finished,
+                                       g_object_ref(self));
+}
+
+static void
+refresh_profile_names(GnomeDdcWindow *self, const gchar *select)
+{
+  g_auto(GStrv) names = gnomeddc_profile_store_dup_names(self->profile_store);
+  guint n_items = g_list_model_get_n_items(G_LIST_MODEL(self->profile_names));
+  gtk_string_list_splice(self->profile_names, 0, n_items, (const char * const *) names);
+
+  guint n_names = g_strv_length(names);
+  for (guint i = 0; select != NULL && i < n_names; i++) {
+    if (g_strcmp0(names[i], select) == 0) {
+      adw_combo_row_set_selected(self->profile_combo_row, i);
+      break;
+    }
+  }
+  gtk_widget_set_sensitive(GTK_WIDGET(self->apply_profile_button), n_names > 0);
+  gtk_widget_set_sensitive(GTK_WIDGET(self->delete_profile_button), n_names > 0);
+}
+
+/* The display group picked in "Write to", or NULL for the selected
+ * display. */
+static const gchar *
+get_write_target_group(GnomeDdcWindow *self)
+{
+  if (adw_combo_row_get_selected(self->write_target_row) == 0) {
+    return NULL;
+  }
+  GtkStringObject *item = adw_combo_row_get_selected_item(self->write_target_row);
+  return item != NULL ? gtk_string_object_get_string(item) : NULL;
+}
+
+/* "Write to" always starts with the selected display; the groups follow. */
+static void
+refresh_group_names(GnomeDdcWindow *self, const gchar *select)
+{
+  g_autofree gchar *previous = g_strdup(get_write_target_group(self));
+  g_auto(GStrv) names = gnomeddc_group_store_dup_names(self->group_store);
+  g_autoptr(GStrvBuilder) builder = g_strv_builder_new();
+  g_strv_builder_add(builder, _("Selected display"));
+  g_strv_builder_addv(builder, (const gchar **) names);
+  g_auto(GStrv) targets = g_strv_builder_end(builder);
+
+  guint n_items = g_list_model_get_n_items(G_LIST_MODEL(self->write_target_names));
+  gtk_string_list_splice(self->write_target_names, 0, n_items, (const char * const *) targets);
+
+  if (select == NULL) {
+    select = previous;
+  }
+  guint selected = 0;
+  for (guint i = 0; select != NULL && names[i] != NULL; i++) {
+    if (g_str_equal(names[i], select)) {
+      selected = i + 1;
+      break;
+    }
+  }
+  adw_combo_row_set_selected(self->write_target_row, selected);
+}
+
+/* Windows share the stores, so changes made in another one show up here. */
+static void
+group_store_changed_cb(GnomeDdcGroupStore *store G_GNUC_UNUSED, gpointer user_data)
+{
+  refresh_group_names(GNOMEDDC_WINDOW(user_data), NULL);
+}
+
+static void
+join_group_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  g_autoptr(GnomeDdcDisplay) display = get_selected_display(self);
+  if (display == NULL) {
+    show_toast(self, _("Select a display first"));
+    return;
+  }
+
+  g_autofree gchar *name = g_strstrip(g_strdup(gtk_editable_get_text(GTK_EDITABLE(self->group_name_entry))));
+  if (*name == '\0') {
+    show_toast(self, _("Enter a group name"));
+    return;
+  }
+  if (!gnomeddc_group_store_add_member(self->group_store, name, gnomeddc_display_get_edid(display))) {
+    show_toast(self, _("This display cannot be added to “%s”"), name);
+    return;
+  }
+
+  g_autoptr(GError) error = NULL;
+  if (!gnomeddc_group_store_save(self->group_store, &error)) {
+    show_toast(self, _("Failed to save groups: %s"), error->message);
+  }
+  refresh_group_names(self, name);
+}
+
+static void
+leave_group_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  g_autoptr(GnomeDdcDisplay) display = get_selected_display(self);
+  if (display == NULL) {
+    show_toast(self, _("Select a display first"));
+    return;
+  }
+
+  g_autofree gchar *name = g_strstrip(g_strdup(gtk_editable_get_text(GTK_EDITABLE(self->group_name_entry))));
+  if (*name == '\0') {
+    show_toast(self, _("Enter a group name"));
+    return;
+  }
+  gnomeddc_group_store_remove_member(self->group_store, name, gnomeddc_display_get_edid(display));
+
+  g_autoptr(GError) error = NULL;
+  if (!gnomeddc_group_store_save(self->group_store, &error)) {
+    show_toast(self, _("Failed to save groups: %s"), error->message);
+  }
+  refresh_group_names(self, NULL);
+}
+
+static const gchar *
+get_selected_profile(GnomeDdcWindow *self)
+{
+  GtkStringObject *item = adw_combo_row_get_selected_item(self->profile_combo_row);
+  return item != NULL ? gtk_string_object_get_string(item) : NULL;
+}
+
+static void
+profile_store_changed_cb(GnomeDdcProfileStore *store G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  g_autofree gchar *previous = g_strdup(get_selected_profile(self));
+  refresh_profile_names(self, previous);
+}
+
+static void
+handle_apply_profile_finished(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
+  GnomeDdcProfileApply *apply = GNOMEDDC_PROFILE_APPLY(source);
+  g_autoptr(GError) error = NULL;
+  gboolean completed = gnomeddc_profile_apply_run_finish(apply, result, &error);
+  gnomeddc_window_finish_operation(self);
+
+  if (g_error_matches(error, G_IO_ERROR, G_IO_ERROR_CANCELLED)) {
+    return;
+  }
+  if (!completed) {
+    show_toast(self, _("Failed to apply profile: %s"), error->message);
+    return;
+  }
+
+  guint written = 0;
+  guint skipped = 0;
+  guint failed = 0;
+  const gchar *first_error = NULL;
+  for (guint i = 0; i < gnomeddc_profile_apply_get_n_entries(apply); i++) {
+    written += gnomeddc_profile_apply_get_n_written(apply, i);
+    skipped += gnomeddc_profile_apply_get_n_skipped(apply, i);
+    failed += gnomeddc_profile_apply_get_n_failed(apply, i);
+    if (first_error == NULL) {
+      first_error = gnomeddc_profile_apply_get_error(apply, i);
+    }
+  }
+
+  g_autofree gchar *subtitle = g_strdup_printf(_("%u written, %u already set, %u failed"),
+                                               written, skipped, failed);
+  adw_action_row_set_subtitle(self->apply_profile_row, subtitle);
+  if (first_error != NULL) {
+    show_toast(self, _("Some settings could not be applied: %s"), first_error);
+  }
+}
+
+static void
+apply_profile_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  const gchar *name = get_selected_profile(self);
+  if (name == NULL) {
+    show_toast(self, _("Select a profile first"));
+    return;
+  }
+
+  GListModel *model = G_LIST_MODEL(self->display_model);
+  g_autoptr(GPtrArray) displays = g_ptr_array_new_with_free_func(g_object_unref);
+  for (guint i = 0; i < g_list_model_get_n_items(model); i++) {
+    g_ptr_array_add(displays, g_list_model_get_item(model, i));
+  }
+
+  g_autoptr(GnomeDdcProfileApply) apply = gnomeddc_profile_apply_new();
+  if (gnomeddc_profile_apply_add_profile(apply, self->profile_store, name, displays) == 0) {
+    show_toast(self, _("Profile “%s” has no settings for the detected displays"), name);
+    return;
+  }
+
+  g_cancellable_cancel(self->profile_cancellable);
+  g_clear_object(&self->profile_cancellable);
+  self->profile_cancellable = g_cancellable_new();
+
+  gnomeddc_window_start_operation(self);
+  gnomeddc_profile_apply_run_async(apply, self->client, 0, self->profile_cancellable,
+                                   handle_apply_profile_finished, g_object_ref(self));
+}
+
+static void
+delete_profile_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  const gchar *name = get_selected_profile(self);
+  if (name == NULL) {
+    return;
+  }
+
+  g_autofree gchar *removed = g_strdup(name);
+  g_autoptr(GError) error = NULL;
+  gnomeddc_profile_store_remove(self->profile_store, removed);
+  if (!gnomeddc_profile_store_save(self->profile_store, &error)) {
+    show_toast(self, _("Failed to save profiles: %s"), error->message);
+  }
+  refresh_profile_names(self, NULL);
+  show_toast(self, _("Deleted profile “%s”"), removed);
+}
+
+/* The values are saved under the profile name and EDID taken when Save was
+ * pressed. */
+typedef struct {
+  GnomeDdcWindow *self;
+  gchar *name;
+  gchar *edid;
+} SaveProfileCall;
+
+static SaveProfileCall *
+save_profile_call_new(GnomeDdcWindow *self, const gchar *name, GnomeDdcDisplay *display)
+{
+  SaveProfileCall *call = g_new(SaveProfileCall, 1);
+  call->self = g_object_ref(self);
+  call->name = g_strdup(name);
+  call->edid = g_strdup(gnomeddc_display_get_edid(display));
+  return call;
+}
+
+static void
+save_profile_call_free(SaveProfileCall *call)
+{
+  g_object_unref(call->self);
+  g_free(call->name);
+  g_free(call->edid);
+  g_free(call);
+}
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC(SaveProfileCall, save_profile_call_free)
+
+static void
+handle_save_profile_read_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(SaveProfileCall) call = user_data;
+  GnomeDdcWindow *self = call->self;
+  const gchar *name = call->name;
+  if (window_is_disposed(self)) {
+    return;
+  }
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GVariant) response = gnomeddc_client_call_finish(self->client, result, &error);
+  gnomeddc_window_finish_operation(self);
+
+  if (response == NULL) {
+    show_toast(self, _("Failed to read current values: %s"), error->message);
+    return;
+  }
+
+  g_autoptr(GVariant) array = NULL;
+  gint status = 0;
+  const gchar *message = NULL;
+  g_variant_get(response, "(@a(yqqs)i&s)", &array, &status, &message);
+  if (status != 0) {
+    show_toast(self, _("Failed to read current values: %s"), message);
+    return;
+  }
+
+  gsize n_values = 0;
+  g_autofree GnomeDdcVcpValue *values = gnomeddc_vcp_values_decode(array, &n_values);
+  g_autoptr(GArray) settings = g_array_sized_new(FALSE, FALSE, sizeof(GnomeDdcProfileSetting), n_values);
+  for (gsize i = 0; i < n_values; i++) {
+    GnomeDdcProfileSetting setting = { values[i].code, values[i].current };
+    g_array_append_val(settings, setting);
+  }
+
+  if (!gnomeddc_profile_store_set_settings(self->profile_store, name,
+                                           call->edid,
+                                           (const GnomeDdcProfileSetting *) settings->data,
+                                           settings->len)) {
+    show_toast(self, _("Profiles need a display with an EDID and a name without brackets"));
+    return;
+  }
+  if (!gnomeddc_profile_store_save(self->profile_store, &error)) {
+    show_toast(self, _("Failed to save profiles: %s"), error->message);
+    return;
+  }
+
+  refresh_profile_names(self, name);
+  show_toast(self, _("Saved %u values to “%s”"), settings->len, name);
+}
+
+/* Reads the codes from the multiple VCP entry on the selected display and
+ * stores their current values in the named profile. */
+static void
+save_profile_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  g_autoptr(GnomeDdcDisplay) display = get_selected_display(self);
+  if (display == NULL) {
+    show_toast(self, _("Select a display first"));
+    return;
+  }
+
+  g_autofree gchar *name = g_strstrip(g_strdup(gtk_editable_get_text(GTK_EDITABLE(self->profile_name_entry))));
+  if (*name == '\0') {
+    show_toast(self, _("Enter a profile name"));
+    return;
+  }
+
+  g_autoptr(GByteArray) codes = parse_vcp_codes(gtk_editable_get_text(GTK_EDITABLE(self->multiple_vcp_codes_entry)));
+  if (codes == NULL || codes->len == 0) {
+    show_toast(self, _("Enter valid VCP codes"));
+    return;
+  }
+
+  gnomeddc_window_start_operation(self);
+  gnomeddc_client_get_multiple_vcp_async(self->client,
+                                         display,
+                                         codes->data,
+                                         codes->len,
+                                         0,
+                                         GNOMEDDC_CALL_FLAGS_BYPASS_CACHE,
+                                         NULL,
+                                         handle_save_profile_read_finished,
+                                         save_profile_call_new(self, name, display));
+}
+
+static void
+stop_monitor(GnomeDdcWindow *self)
+{
+  if (self->monitor == NULL) {
+    return;
+  }
+
+  g_signal_handlers_disconnect_by_data(self->monitor, self);
+  gnomeddc_vcp_monitor_stop(self->monitor);
+  g_clear_object(&self->monitor);
+
+  for (guint i = 0; i < self->monitor_rows->len; i++) {
+    adw_preferences_group_remove(self->monitor_group, g_ptr_array_index(self->monitor_rows, i));
+  }
+  g_ptr_array_set_size(self->monitor_rows, 0);
+  g_ptr_array_set_size(self->monitor_sparklines, 0);
+
+  gtk_button_set_label(self->monitor_button, _("Start"));
+  adw_action_row_set_subtitle(self->monitor_row, "");
+}
+
+/* Polling only makes sense while somebody is looking at the window. */
+static void
+update_monitor_paused(GnomeDdcWindow *self)
+{
+  if (self->monitor != NULL) {
+    gboolean visible = gtk_window_is_active(GTK_WINDOW(self)) && gtk_widget_get_mapped(GTK_WIDGET(self));
+    gnomeddc_vcp_monitor_set_paused(self->monitor, !visible);
+    if (!visible) {
+      adw_action_row_set_subtitle(self->monitor_row, _("Paused while the window is in the background"));
+    }
+  }
+}
+
+static void
+window_is_active_cb(GObject *object G_GNUC_UNUSED, GParamSpec *pspec G_GNUC_UNUSED, gpointer user_data)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
-  gnomeddc_window_query_state(self);
+  update_monitor_paused(GNOMEDDC_WINDOW(user_data));
 }
 
 static void
-sleep_refresh_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+monitor_updated_cb(GnomeDdcVcpMonitor *monitor, gpointer user_data)
 {
   GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
-  gnomeddc_window_query_sleep_multiplier(self);
+  GnomeDdcVcpSample samples[GNOMEDDC_VCP_MONITOR_HISTORY];
+
+  for (guint i = 0; i < self->monitor_rows->len; i++) {
+    gsize n_samples = gnomeddc_vcp_monitor_copy_history(monitor, i, samples, G_N_ELEMENTS(samples));
+    guint16 max_value = gnomeddc_vcp_monitor_get_max_value(monitor, i);
+    if (n_samples == 0) {
+      continue;
+    }
+
+    g_autofree gchar *value = g_strdup_printf(_("%u of %u"), samples[n_samples - 1].value, max_value);
+    gnomeddc_sparkline_set_samples(g_ptr_array_index(self->monitor_sparklines, i), samples, n_samples, max_value);
+    adw_action_row_set_subtitle(g_ptr_array_index(self->monitor_rows, i), value);
+  }
+
+  g_autofree gchar *interval = g_strdup_printf(_("Next poll in %.1f s"),
+                                               gnomeddc_vcp_monitor_get_interval(monitor) / 1000.0);
+  adw_action_row_set_subtitle(self->monitor_row, interval);
 }
 
 static void
-sleep_set_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+monitor_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
 {
   GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+
+  if (self->monitor != NULL) {
+    stop_monitor(self);
+    return;
+  }
+
   g_autoptr(GnomeDdcDisplay) display = get_selected_display(self);
   if (display == NULL) {
     show_toast(self, _("Select a display first"));
     return;
   }
 
-  gdouble multiplier = 0.0;
-  if (!parse_double_from_entry(self->sleep_multiplier_entry, &multiplier)) {
-    show_toast(self, _("Enter a valid multiplier"));
+  g_autoptr(GByteArray) codes = parse_vcp_codes(gtk_editable_get_text(GTK_EDITABLE(self->monitor_codes_entry)));
+  if (codes == NULL || codes->len == 0) {
+    show_toast(self, _("Enter valid VCP codes"));
     return;
   }
 
-  gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "SetSleepMultiplier",
-                             g_variant_new("(isdu)",
-                                           gnomeddc_display_get_display_number(display),
-                                           gnomeddc_display_get_edid(display),
-                                           multiplier,
-                                           0),
-                             NULL,
-                             handle_set_sleep_multiplier_finished,
-                             self);
+  self->monitor = gnomeddc_vcp_monitor_new(self->client, display, codes->data, codes->len);
+
+  guint n_tracks = gnomeddc_vcp_monitor_get_n_codes(self->monitor);
+  for (guint i = 0; i < n_tracks; i++) {
+    g_autofree gchar *title = g_strdup_printf("0x%02X", gnomeddc_vcp_monitor_get_code(self->monitor, i));
+    GtkWidget *row = adw_action_row_new();
+    GtkWidget *sparkline = gnomeddc_sparkline_new();
+    adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row), title);
+    adw_action_row_add_suffix(ADW_ACTION_ROW(row), sparkline);
+    adw_preferences_group_add(self->monitor_group, row);
+    g_ptr_array_add(self->monitor_rows, row);
+    g_ptr_array_add(self->monitor_sparklines, sparkline);
+  }
+
+  g_signal_connect(self->monitor, "updated", G_CALLBACK(monitor_updated_cb), self);
+  gtk_button_set_label(self->monitor_button, _("Stop"));
+  adw_action_row_set_subtitle(self->monitor_row, _("Waiting for the first reading…"));
+  gnomeddc_vcp_monitor_start(self->monitor);
+  update_monitor_paused(self);
 }
 
 static void
@@ -1058,16 +1984,14 @@ get_vcp_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
   }
 
   gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "GetVcp",
-                             g_variant_new("(isyu)",
-                                           gnomeddc_display_get_display_number(display),
-                                           gnomeddc_display_get_edid(display),
-                                           vcp_code,
-                                           flags),
-                             NULL,
-                             handle_get_vcp_finished,
-                             self);
+  gnomeddc_client_get_vcp_async(self->client,
+                                display,
+                                vcp_code,
+                                flags,
+                                GNOMEDDC_CALL_FLAGS_NONE,
+                                begin_display_operation(self, DISPLAY_OPERATION_VCP),
+                                handle_get_vcp_finished,
+                                g_object_ref(self));
 }
 
 static void
@@ -1080,7 +2004,7 @@ get_multiple_vcp_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
     return;
   }
 
-  g_autoptr(GVariant) codes = build_vcp_code_array(gtk_editable_get_text(GTK_EDITABLE(self->multiple_vcp_codes_entry)));
+  g_autoptr(GByteArray) codes = parse_vcp_codes(gtk_editable_get_text(GTK_EDITABLE(self->multiple_vcp_codes_entry)));
   if (codes == NULL) {
     show_toast(self, _("Enter valid VCP codes"));
     return;
@@ -1092,24 +2016,91 @@ get_multiple_vcp_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
   }
 
   gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "GetMultipleVcp",
-                             g_variant_new("(isayu)",
-                                           gnomeddc_display_get_display_number(display),
-                                           gnomeddc_display_get_edid(display),
-                                           codes,
-                                           flags),
-                             NULL,
-                             handle_get_multiple_vcp_finished,
-                             self);
+  gnomeddc_client_get_multiple_vcp_async(self->client,
+                                         display,
+                                         codes->data,
+                                         codes->len,
+                                         flags,
+                                         GNOMEDDC_CALL_FLAGS_NONE,
+                                         begin_display_operation(self, DISPLAY_OPERATION_MULTIPLE_VCP),
+                                         handle_get_multiple_vcp_finished,
+                                         g_object_ref(self));
+}
+
+static void
+read_all_displays_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  GListModel *model = G_LIST_MODEL(self->display_model);
+  guint n_displays = g_list_model_get_n_items(model);
+  if (n_displays == 0) {
+    show_toast(self, _("No displays detected"));
+    return;
+  }
+
+  g_autoptr(GByteArray) codes = parse_vcp_codes(gtk_editable_get_text(GTK_EDITABLE(self->multiple_vcp_codes_entry)));
+  if (codes == NULL || codes->len == 0) {
+    show_toast(self, _("Enter valid VCP codes"));
+    return;
+  }
+  guint flags = 0;
+  if (!parse_uint_from_entry(self->vcp_flags_entry, &flags)) {
+    show_toast(self, _("Enter valid flags"));
+    return;
+  }
+
+  g_autoptr(GnomeDdcVcpBatch) batch = gnomeddc_vcp_batch_new();
+  for (guint i = 0; i < n_displays; i++) {
+    g_autoptr(GnomeDdcDisplay) display = g_list_model_get_item(model, i);
+    gnomeddc_vcp_batch_add(batch, display, codes->data, codes->len);
+  }
+
+  g_cancellable_cancel(self->read_all_cancellable);
+  g_clear_object(&self->read_all_cancellable);
+  self->read_all_cancellable = g_cancellable_new();
+
+  gnomeddc_window_start_operation(self);
+  gnomeddc_vcp_batch_read_async(batch,
+                                self->client,
+                                flags,
+                                self->read_all_cancellable,
+                                handle_read_all_displays_finished,
+                                g_object_ref(self));
+}
+
+static void
+handle_group_write_finished(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  GNOMEDDC_TRACE_FUNCTION("ui");
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
+  g_autoptr(GError) error = NULL;
+  guint n_written = 0;
+  guint n_failed = 0;
+  gboolean started = gnomeddc_group_write_set_vcp_finish(self->write_coalescer, result,
+                                                         &n_written, &n_failed, &error);
+  gnomeddc_window_finish_operation(self);
+
+  if (!started) {
+    show_toast(self, _("Failed to set VCP: %s"), error->message);
+    return;
+  }
+  /* Every member was superseded by a newer group write. */
+  if (n_written == 0 && n_failed == 0) {
+    return;
+  }
+  show_toast(self, _("Set VCP on %u displays, %u failed"), n_written, n_failed);
 }
 
 static void
 set_vcp_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
 {
   GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  const gchar *group = get_write_target_group(self);
   g_autoptr(GnomeDdcDisplay) display = get_selected_display(self);
-  if (display == NULL) {
+  if (display == NULL && group == NULL) {
     show_toast(self, _("Select a display first"));
     return;
   }
@@ -1124,18 +2115,32 @@ set_vcp_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
     return;
   }
 
+  if (group != NULL) {
+    gnomeddc_window_start_operation(self);
+    gnomeddc_group_write_set_vcp_async(self->write_coalescer,
+                                       self->group_store,
+                                       group,
+                                       G_LIST_MODEL(self->display_model),
+                                       vcp_code,
+                                       value,
+                                       flags,
+                                       NULL,
+                                       handle_group_write_finished,
+                                       g_object_ref(self));
+    return;
+  }
+
   gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "SetVcp",
-                             g_variant_new("(isyqu)",
-                                           gnomeddc_display_get_display_number(display),
-                                           gnomeddc_display_get_edid(display),
-                                           vcp_code,
-                                           value,
-                                           flags),
-                             NULL,
-                             handle_set_vcp_finished,
-                             self);
+  gnomeddc_write_coalescer_set_vcp_async(self->write_coalescer,
+                                         gnomeddc_display_get_display_number(display),
+                                         gnomeddc_display_get_edid(display),
+                                         vcp_code,
+                                         value,
+                                         NULL,
+                                         flags,
+                                         NULL,
+                                         handle_set_vcp_finished,
+                                         g_object_ref(self));
 }
 
 static void
@@ -1160,18 +2165,16 @@ set_vcp_context_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
   }
 
   gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "SetVcpWithContext",
-                             g_variant_new("(isyqsu)",
-                                           gnomeddc_display_get_display_number(display),
-                                           gnomeddc_display_get_edid(display),
-                                           vcp_code,
-                                           value,
-                                           context != NULL ? context : "",
-                                           flags),
-                             NULL,
-                             handle_set_vcp_finished,
-                             self);
+  gnomeddc_write_coalescer_set_vcp_async(self->write_coalescer,
+                                         gnomeddc_display_get_display_number(display),
+                                         gnomeddc_display_get_edid(display),
+                                         vcp_code,
+                                         value,
+                                         context != NULL ? context : "",
+                                         flags,
+                                         NULL,
+                                         handle_set_vcp_finished,
+                                         g_object_ref(self));
 }
 
 static void
@@ -1191,16 +2194,14 @@ get_vcp_metadata_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
     return;
   }
   gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "GetVcpMetadata",
-                             g_variant_new("(isyu)",
-                                           gnomeddc_display_get_display_number(display),
-                                           gnomeddc_display_get_edid(display),
-                                           vcp_code,
-                                           flags),
-                             NULL,
-                             handle_get_vcp_metadata_finished,
-                             self);
+  gnomeddc_client_get_vcp_metadata_async(self->client,
+                                         display,
+                                         vcp_code,
+                                         flags,
+                                         GNOMEDDC_CALL_FLAGS_NONE,
+                                         begin_display_operation(self, DISPLAY_OPERATION_VCP_METADATA),
+                                         handle_get_vcp_metadata_finished,
+                                         g_object_ref(self));
 }
 
 static void
@@ -1217,23 +2218,30 @@ get_capabilities_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
     show_toast(self, _("Enter valid flags"));
     return;
   }
+
+  g_autofree gchar *cached = gnomeddc_capabilities_cache_dup_string(self->capabilities_cache,
+                                                                    gnomeddc_display_get_edid(display));
+  if (cached != NULL) {
+    begin_display_operation(self, DISPLAY_OPERATION_CAPABILITIES);
+    show_capabilities_string(self, cached, 0, _("cached"));
+    return;
+  }
+
   clear_capabilities_view(self);
   gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "GetCapabilitiesString",
-                             g_variant_new("(isu)",
-                                           gnomeddc_display_get_display_number(display),
-                                           gnomeddc_display_get_edid(display),
-                                           flags),
-                             NULL,
-                             handle_get_capabilities_finished,
-                             self);
+  gnomeddc_client_call_display_async(self->client,
+                                     "GetCapabilitiesString",
+                                     display,
+                                     flags,
+                                     GNOMEDDC_CALL_FLAGS_NONE,
+                                     begin_display_operation(self, DISPLAY_OPERATION_CAPABILITIES),
+                                     handle_get_capabilities_finished,
+                                     capabilities_call_new(self, display));
 }
 
 static void
-get_capabilities_metadata_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+request_capabilities_metadata(GnomeDdcWindow *self, gboolean use_cache)
 {
-  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
   g_autoptr(GnomeDdcDisplay) display = get_selected_display(self);
   if (display == NULL) {
     show_toast(self, _("Select a display first"));
@@ -1244,17 +2252,43 @@ get_capabilities_metadata_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer u
     show_toast(self, _("Enter valid flags"));
     return;
   }
+
+  const gchar *edid = gnomeddc_display_get_edid(display);
+  if (use_cache) {
+    g_autoptr(GVariant) cached = gnomeddc_capabilities_cache_lookup_metadata(self->capabilities_cache, edid);
+    if (cached != NULL) {
+      begin_display_operation(self, DISPLAY_OPERATION_CAPABILITIES);
+      show_capabilities_metadata(self, cached, 0, _("cached"));
+      return;
+    }
+  } else {
+    gnomeddc_capabilities_cache_remove(self->capabilities_cache, edid);
+  }
+
   clear_capabilities_view(self);
   gnomeddc_window_start_operation(self);
-  gnomeddc_client_call_async(self->client,
-                             "GetCapabilitiesMetadata",
-                             g_variant_new("(isu)",
-                                           gnomeddc_display_get_display_number(display),
-                                           gnomeddc_display_get_edid(display),
-                                           flags),
-                             NULL,
-                             handle_get_capabilities_metadata_finished,
-                             self);
+  gnomeddc_client_call_display_async(self->client,
+                                     "GetCapabilitiesMetadata",
+                                     display,
+                                     flags,
+                                     GNOMEDDC_CALL_FLAGS_NONE,
+                                     begin_display_operation(self, DISPLAY_OPERATION_CAPABILITIES),
+                                     handle_get_capabilities_metadata_finished,
+                                     capabilities_call_new(self, display));
+}
+
+static void
+get_capabilities_metadata_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  request_capabilities_metadata(self, TRUE);
+}
+
+static void
+reprobe_capabilities_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  request_capabilities_metadata(self, FALSE);
 }
 
 static void
@@ -1271,7 +2305,150 @@ restart_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
                              g_variant_new("(suu)", options != NULL ? options : "", syslog_level, flags),
                              NULL,
                              handle_restart_finished,
-                             self);
+                             g_object_ref(self));
+}
+
+static gchar *
+format_latency(gint64 usec)
+{
+  if (usec >= 1000000) {
+    return g_strdup_printf(_("%.2f s"), usec / 1000000.0);
+  }
+  if (usec >= 1000) {
+    return g_strdup_printf(_("%.1f ms"), usec / 1000.0);
+  }
+  return g_strdup_printf(_("%" G_GINT64_FORMAT " µs"), usec);
+}
+
+static void
+refresh_performance_page(GnomeDdcWindow *self)
+{
+  for (guint i = 0; i < self->performance_rows->len; i++) {
+    adw_preferences_group_remove(self->performance_methods_group, g_ptr_array_index(self->performance_rows, i));
+  }
+  g_ptr_array_set_size(self->performance_rows, 0);
+
+  GnomeDdcCallStats *stats = gnomeddc_client_get_call_stats(self->client);
+  g_auto(GStrv) methods = gnomeddc_call_stats_dup_methods(stats);
+
+  if (methods[0] == NULL) {
+    GtkWidget *row = adw_action_row_new();
+    adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row), _("No calls recorded yet"));
+    adw_preferences_group_add(self->performance_methods_group, row);
+    g_ptr_array_add(self->performance_rows, row);
+    return;
+  }
+
+  for (guint i = 0; methods[i] != NULL; i++) {
+    GnomeDdcCallSummary summary;
+    if (!gnomeddc_call_stats_get_summary(stats, methods[i], &summary)) {
+      continue;
+    }
+
+    g_autofree gchar *p50 = format_latency(summary.p50_usec);
+    g_autofree gchar *p95 = format_latency(summary.p95_usec);
+    g_autofree gchar *p99 = format_latency(summary.p99_usec);
+    g_autoptr(GString) subtitle = g_string_new(NULL);
+    g_string_append_printf(subtitle,
+                           _("%" G_GUINT64_FORMAT " calls, %u in flight, %" G_GUINT64_FORMAT " failed, %" G_GUINT64_FORMAT " cached, %" G_GUINT64_FORMAT " retried\n"
+                             "p50 %s · p95 %s · p99 %s"),
+                           summary.calls, summary.in_flight, summary.errors, summary.cache_hits,
+                           summary.retries, p50, p95, p99);
+
+    g_autoptr(GVariant) status_counts = gnomeddc_call_stats_dup_status_counts(stats, methods[i]);
+    if (g_variant_n_children(status_counts) > 0) {
+      GVariantIter iter;
+      gint code;
+      guint count;
+      gboolean first = TRUE;
+      g_string_append(subtitle, _("\nStatus: "));
+      g_variant_iter_init(&iter, status_counts);
+      while (g_variant_iter_next(&iter, "{iu}", &code, &count)) {
+        g_string_append_printf(subtitle, "%s%d × %u", first ? "" : ", ", code, count);
+        first = FALSE;
+      }
+    }
+
+    GtkWidget *row = adw_action_row_new();
+    adw_preferences_row_set_title(ADW_PREFERENCES_ROW(row), methods[i]);
+    adw_action_row_set_subtitle(ADW_ACTION_ROW(row), subtitle->str);
+    adw_preferences_group_add(self->performance_methods_group, row);
+    g_ptr_array_add(self->performance_rows, row);
+  }
+}
+
+static void
+performance_refresh_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  refresh_performance_page(GNOMEDDC_WINDOW(user_data));
+}
+
+static void
+performance_reset_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  gnomeddc_call_stats_reset(gnomeddc_client_get_call_stats(self->client));
+  refresh_performance_page(self);
+}
+
+static void
+performance_export_written_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
+  g_autoptr(GError) error = NULL;
+
+  if (!g_file_replace_contents_finish(G_FILE(source), result, NULL, &error)) {
+    show_toast(self, _("Failed to export statistics: %s"), error->message);
+    return;
+  }
+  show_toast(self, _("Statistics exported"));
+}
+
+static void
+performance_export_dialog_cb(GObject *source, GAsyncResult *result, gpointer user_data)
+{
+  g_autoptr(GnomeDdcWindow) self = user_data;
+  if (window_is_disposed(self)) {
+    return;
+  }
+  g_autoptr(GError) error = NULL;
+  g_autoptr(GFile) file = gtk_file_dialog_save_finish(GTK_FILE_DIALOG(source), result, &error);
+  if (file == NULL) {
+    return;
+  }
+
+  gchar *json = gnomeddc_call_stats_to_json(gnomeddc_client_get_call_stats(self->client));
+  g_autoptr(GBytes) bytes = g_bytes_new_take(json, strlen(json));
+  g_file_replace_contents_bytes_async(file,
+                                      bytes,
+                                      NULL,
+                                      FALSE,
+                                      G_FILE_CREATE_REPLACE_DESTINATION,
+                                      NULL,
+                                      performance_export_written_cb,
+                                      g_object_ref(self));
+}
+
+static void
+performance_export_clicked_cb(GtkButton *button G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  g_autoptr(GtkFileDialog) dialog = gtk_file_dialog_new();
+  gtk_file_dialog_set_title(dialog, _("Export call statistics"));
+  gtk_file_dialog_set_initial_name(dialog, "gnomeddc-call-stats.json");
+  gtk_file_dialog_save(dialog, GTK_WINDOW(self), NULL, performance_export_dialog_cb, g_object_ref(self));
+}
+
+static void
+view_stack_visible_child_cb(GObject *object G_GNUC_UNUSED, GParamSpec *pspec G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  if (adw_view_stack_get_visible_child(ADW_VIEW_STACK(self->view_stack)) == self->performance_page) {
+    refresh_performance_page(self);
+  }
 }
 
 static void
@@ -1295,12 +2472,12 @@ service_switch_toggled_cb(AdwSwitchRow *row, GParamSpec *pspec G_GNUC_UNUSED, gp
     return;
   }
 
-  gnomeddc_client_set_property_async(self->client,
-                                     property_name,
-                                     g_variant_new_boolean(adw_switch_row_get_active(row)),
-                                     NULL,
-                                     NULL,
-                                     NULL);
+  gnomeddc_write_coalescer_set_property_async(self->write_coalescer,
+                                              property_name,
+                                              g_variant_new_boolean(adw_switch_row_get_active(row)),
+                                              NULL,
+                                              NULL,
+                                              NULL);
 }
 
 static void
@@ -1311,48 +2488,155 @@ spin_row_value_changed_cb(GObject *object, GParamSpec *pspec G_GNUC_UNUSED, gpoi
     return;
   }
 
+  /* notify::value fires for every step while a spin row is dragged or held;
+   * the coalescer only keeps the newest value per property. */
   const gchar *property_name = NULL;
-  gdouble value = 0.0;
+  GVariant *value = NULL;
   if (object == G_OBJECT(self->output_level_row)) {
     property_name = "DdcutilOutputLevel";
-    value = adw_spin_row_get_value(self->output_level_row);
-    gnomeddc_client_set_property_async(self->client,
-                                       property_name,
-                                       g_variant_new_uint32((guint32) value),
-                                       NULL,
-                                       NULL,
-                                       NULL);
+    value = g_variant_new_uint32((guint32) adw_spin_row_get_value(self->output_level_row));
+  } else if (object == G_OBJECT(self->poll_interval_row)) {
+    property_name = "ServicePollInterval";
+    value = g_variant_new_uint32((guint32) adw_spin_row_get_value(self->poll_interval_row));
+  } else if (object == G_OBJECT(self->poll_cascade_row)) {
+    property_name = "ServicePollCascadeInterval";
+    value = g_variant_new_double(adw_spin_row_get_value(self->poll_cascade_row));
+  }
+
+  if (property_name == NULL) {
     return;
   }
-  if (object == G_OBJECT(self->poll_interval_row)) {
-    property_name = "ServicePollInterval";
-    value = adw_spin_row_get_value(self->poll_interval_row);
-    gnomeddc_client_set_property_async(self->client,
-                                       property_name,
-                                       g_variant_new_uint32((guint32) value),
-                                       NULL,
-                                       NULL,
-                                       NULL);
+
+  gnomeddc_write_coalescer_set_property_async(self->write_coalescer,
+                                              property_name,
+                                              value,
+                                              NULL,
+                                              NULL,
+                                              NULL);
+}
+
+
+/* The display model runs the first ListDetected itself. */
+static void
+client_connected_cb(GnomeDdcClient *client G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  gnomeddc_window_finish_operation(self);
+}
+
+static void
+client_connection_failed_cb(GnomeDdcClient *client G_GNUC_UNUSED, const gchar *message, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  gnomeddc_window_finish_operation(self);
+  show_toast(self, "%s", message != NULL ? message : _("Unable to reach ddcutil-service"));
+}
+
+/* The shared model also changes on hotplug and from other windows, so the
+ * overview follows wherever the selection ends up. */
+static void
+display_model_items_changed_cb(GListModel *model G_GNUC_UNUSED,
+                               guint position G_GNUC_UNUSED,
+                               guint removed G_GNUC_UNUSED,
+                               guint added G_GNUC_UNUSED,
+                               gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  g_autoptr(GnomeDdcDisplay) current_selection = get_selected_display(self);
+
+  update_empty_state(self);
+  /* GtkSingleSelection does not emit selection-changed for moves caused by
+   * items-changed, so drop the previous display's reads here. */
+  if (current_selection != self->shown_display) {
+    cancel_display_operations(self);
+    gnomeddc_window_update_selection(self);
+  }
+}
+
+/* Queues every overview read for @display at once instead of one per
+ * click. The calls run at background priority, so anything the user asks
+ * for meanwhile still goes first, and each reply fills in its row as it
+ * arrives. A later selection cancels whatever has not answered yet. */
+static void
+prefetch_display(GnomeDdcWindow *self, GnomeDdcDisplay *display)
+{
+  if (!adw_switch_row_get_active(self->prefetch_row) || !gnomeddc_client_is_connected(self->client)) {
     return;
   }
-  if (object == G_OBJECT(self->poll_cascade_row)) {
-    property_name = "ServicePollCascadeInterval";
-    value = adw_spin_row_get_value(self->poll_cascade_row);
-    gnomeddc_client_set_property_async(self->client,
-                                       property_name,
-                                       g_variant_new_double(value),
-                                       NULL,
-                                       NULL,
-                                       NULL);
+
+  gnomeddc_window_start_operation(self);
+  gnomeddc_client_call_display_async(self->client,
+                                     "GetDisplayState",
+                                     display,
+                                     0,
+                                     GNOMEDDC_CALL_FLAGS_BACKGROUND,
+                                     begin_prefetch_operation(self, DISPLAY_OPERATION_STATE),
+                                     handle_get_state_finished,
+                                     g_object_ref(self));
+
+  gnomeddc_window_start_operation(self);
+  gnomeddc_client_call_display_async(self->client,
+                                     "GetSleepMultiplier",
+                                     display,
+                                     0,
+                                     GNOMEDDC_CALL_FLAGS_BACKGROUND,
+                                     begin_prefetch_operation(self, DISPLAY_OPERATION_SLEEP_MULTIPLIER),
+                                     handle_get_sleep_multiplier_finished,
+                                     g_object_ref(self));
+
+  g_autoptr(GByteArray) codes = parse_vcp_codes(gtk_editable_get_text(GTK_EDITABLE(self->prefetch_codes_entry)));
+  if (codes != NULL && codes->len > 0) {
+    gnomeddc_window_start_operation(self);
+    gnomeddc_client_get_multiple_vcp_async(self->client,
+                                           display,
+                                           codes->data,
+                                           codes->len,
+                                           0,
+                                           GNOMEDDC_CALL_FLAGS_BACKGROUND,
+                                           begin_prefetch_operation(self, DISPLAY_OPERATION_MULTIPLE_VCP),
+                                           handle_get_multiple_vcp_finished,
+                                           g_object_ref(self));
+  }
+
+  g_autoptr(GVariant) cached = gnomeddc_capabilities_cache_lookup_metadata(self->capabilities_cache,
+                                                                            gnomeddc_display_get_edid(display));
+  if (cached != NULL) {
+    begin_prefetch_operation(self, DISPLAY_OPERATION_CAPABILITIES);
+    show_capabilities_metadata(self, cached, 0, _("cached"));
+    return;
   }
+
+  clear_capabilities_view(self);
+  gnomeddc_window_start_operation(self);
+  gnomeddc_client_call_display_async(self->client,
+                                     "GetCapabilitiesMetadata",
+                                     display,
+                                     0,
+                                     GNOMEDDC_CALL_FLAGS_BACKGROUND,
+                                     begin_prefetch_operation(self, DISPLAY_OPERATION_CAPABILITIES),
+                                     handle_get_capabilities_metadata_finished,
+                                     capabilities_call_new(self, display));
 }
 
+static void
+prefetch_toggled_cb(AdwSwitchRow *row G_GNUC_UNUSED, GParamSpec *pspec G_GNUC_UNUSED, gpointer user_data)
+{
+  GnomeDdcWindow *self = GNOMEDDC_WINDOW(user_data);
+  g_autoptr(GnomeDdcDisplay) display = get_selected_display(self);
+  if (display != NULL) {
+    prefetch_display(self, display);
+  }
+}
 
 static void
 gnomeddc_window_update_selection(GnomeDdcWindow *self)
 {
   g_autoptr(GnomeDdcDisplay) display = get_selected_display(self);
+  g_set_object(&self->shown_display, display);
   update_overview_rows(self, display);
+  if (self->monitor != NULL && gnomeddc_vcp_monitor_get_display(self->monitor) != display) {
+    stop_monitor(self);
+  }
   if (display == NULL) {
     clear_capabilities_view(self);
     adw_action_row_set_subtitle(self->get_vcp_row, "");
@@ -1362,6 +2646,7 @@ gnomeddc_window_update_selection(GnomeDdcWindow *self)
     adw_action_row_set_subtitle(self->get_capabilities_metadata_row, "");
     return;
   }
+  prefetch_display(self, display);
 }
 
 
@@ -1392,12 +2677,55 @@ static void
 gnomeddc_window_dispose(GObject *object)
 {
   GnomeDdcWindow *self = GNOMEDDC_WINDOW(object);
+  cancel_display_operations(self);
+  g_cancellable_cancel(self->read_all_cancellable);
+  g_clear_object(&self->read_all_cancellable);
+  g_cancellable_cancel(self->calibration_cancellable);
+  g_clear_object(&self->calibration_cancellable);
+  if (self->calibration != NULL) {
+    g_signal_handlers_disconnect_by_data(self->calibration, self);
+    g_clear_object(&self->calibration);
+  }
+  if (self->monitor != NULL) {
+    g_signal_handlers_disconnect_by_data(self->monitor, self);
+    gnomeddc_vcp_monitor_stop(self->monitor);
+    g_clear_object(&self->monitor);
+  }
+  g_clear_pointer(&self->monitor_rows, g_ptr_array_unref);
+  g_clear_pointer(&self->monitor_sparklines, g_ptr_array_unref);
+  if (self->client != NULL) {
+    g_signal_handlers_disconnect_by_data(self->client, self);
+    g_signal_handlers_disconnect_by_data(gnomeddc_client_get_service_properties(self->client), self);
+  }
+  if (self->display_model != NULL) {
+    g_signal_handlers_disconnect_by_data(self->display_model, self);
+  }
+  g_clear_object(&self->write_coalescer);
+  g_clear_object(&self->capabilities_cache);
+  g_cancellable_cancel(self->profile_cancellable);
+  g_clear_object(&self->profile_cancellable);
+  if (self->profile_store != NULL) {
+    g_signal_handlers_disconnect_by_data(self->profile_store, self);
+    g_clear_object(&self->profile_store);
+  }
+  if (self->group_store != NULL) {
+    g_signal_handlers_disconnect_by_data(self->group_store, self);
+    g_clear_object(&self->group_store);
+  }
   g_clear_object(&self->client);
-  g_clear_object(&self->display_store);
+  g_clear_object(&self->display_model);
+  g_clear_object(&self->shown_display);
   g_clear_object(&self->filter_model);
   g_clear_object(&self->search_filter);
   g_clear_object(&self->selection);
   g_clear_pointer(&self->search_text, g_free);
+  g_clear_object(&self->feature_filter_model);
+  g_clear_object(&self->feature_filter);
+  g_clear_pointer(&self->feature_search_text, g_free);
+  if (self->view_stack != NULL) {
+    g_signal_handlers_disconnect_by_data(self->view_stack, self);
+  }
+  g_clear_pointer(&self->performance_rows, g_ptr_array_unref);
   G_OBJECT_CLASS(gnomeddc_window_parent_class)->dispose(object);
 }
 
@@ -1408,6 +2736,13 @@ gnomeddc_window_class_init(GnomeDdcWindowClass *klass)
   GObjectClass *object_class = G_OBJECT_CLASS(klass);
   object_class->dispose = gnomeddc_window_dispose;
 
+  service_row_handler_index = g_hash_table_new(g_str_hash, g_str_equal);
+  for (guint i = 0; i < G_N_ELEMENTS(service_row_handlers); i++) {
+    g_hash_table_insert(service_row_handler_index,
+                        (gpointer) service_row_handlers[i].name,
+                        (gpointer) &service_row_handlers[i]);
+  }
+
   gtk_widget_class_set_template_from_resource(widget_class,
                                               "/com/ddcutil/GnomeDDC/ui/gnomeddc-window.ui");
 
@@ -1423,13 +2758,27 @@ gnomeddc_window_class_init(GnomeDdcWindowClass *klass)
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, sleep_multiplier_refresh_button);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, get_vcp_button);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, get_multiple_vcp_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, read_all_displays_button);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, set_vcp_button);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, set_vcp_context_button);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, get_vcp_metadata_button);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, get_capabilities_button);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, get_capabilities_metadata_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, reprobe_capabilities_button);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, set_sleep_multiplier_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, calibrate_sleep_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, apply_profile_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, delete_profile_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, save_profile_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, join_group_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, leave_group_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, monitor_button);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, restart_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, performance_refresh_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, performance_reset_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, performance_export_button);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, performance_methods_group);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, performance_page);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, name_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, model_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, manufacturer_row);
@@ -1441,12 +2790,24 @@ gnomeddc_window_class_init(GnomeDdcWindowClass *klass)
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, sleep_multiplier_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, get_vcp_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, get_multiple_vcp_row);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, read_all_displays_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, set_vcp_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, set_vcp_context_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, get_vcp_metadata_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, get_capabilities_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, get_capabilities_metadata_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, set_sleep_multiplier_row);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, calibrate_sleep_row);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, apply_profile_row);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, profile_combo_row);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, profile_name_entry);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, profile_names);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, write_target_row);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, write_target_names);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, group_name_entry);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, monitor_group);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, monitor_codes_entry);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, monitor_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, service_version_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, ddcutil_version_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, service_parameters_locked_row);
@@ -1463,6 +2824,8 @@ gnomeddc_window_class_init(GnomeDdcWindowClass *klass)
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, set_vcp_context_entry);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, sleep_multiplier_entry);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, restart_options_entry);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, prefetch_row);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, prefetch_codes_entry);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, dynamic_sleep_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, info_logging_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, connectivity_signals_row);
@@ -1472,6 +2835,9 @@ gnomeddc_window_class_init(GnomeDdcWindowClass *klass)
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, restart_syslog_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, restart_flags_row);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, capabilities_text_view);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, capabilities_features_group);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, capabilities_search_entry);
+  gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, capabilities_feature_list);
   gtk_widget_class_bind_template_child(widget_class, GnomeDdcWindow, view_stack);
 }
 
@@ -1480,10 +2846,12 @@ gnomeddc_window_init(GnomeDdcWindow *self)
 {
   gtk_widget_init_template(GTK_WIDGET(self));
 
-  self->client = gnomeddc_client_new();
-  self->display_store = g_list_store_new(GNOMEDDC_TYPE_DISPLAY);
+  self->performance_rows = g_ptr_array_new();
+  self->monitor_rows = g_ptr_array_new();
+  self->monitor_sparklines = g_ptr_array_new();
   self->search_filter = gtk_custom_filter_new(display_filter_func, self, NULL);
-  self->filter_model = gtk_filter_list_model_new(G_LIST_MODEL(self->display_store), GTK_FILTER(self->search_filter));
+  /* The display model is only known once the window has an application. */
+  self->filter_model = gtk_filter_list_model_new(NULL, GTK_FILTER(self->search_filter));
   self->selection = gtk_single_selection_new(G_LIST_MODEL(self->filter_model));
 
   GtkListItemFactory *factory = gtk_signal_list_item_factory_new();
@@ -1494,23 +2862,58 @@ gnomeddc_window_init(GnomeDdcWindow *self)
 
   gtk_list_view_set_model(self->display_list, GTK_SELECTION_MODEL(self->selection));
 
+  self->feature_filter = gtk_custom_filter_new(feature_filter_func, self, NULL);
+  self->feature_filter_model = gtk_filter_list_model_new(NULL, NULL);
+  GtkTreeListModel *feature_tree = gtk_tree_list_model_new(g_object_ref(G_LIST_MODEL(self->feature_filter_model)),
+                                                           FALSE,
+                                                           FALSE,
+                                                           create_feature_values_model,
+                                                           NULL,
+                                                           NULL);
+  GtkNoSelection *feature_selection = gtk_no_selection_new(G_LIST_MODEL(feature_tree));
+  gtk_list_view_set_model(self->capabilities_feature_list, GTK_SELECTION_MODEL(feature_selection));
+  g_object_unref(feature_selection);
+
+  GtkListItemFactory *feature_factory = gtk_signal_list_item_factory_new();
+  g_signal_connect(feature_factory, "setup", G_CALLBACK(feature_list_setup), self);
+  g_signal_connect(feature_factory, "bind", G_CALLBACK(feature_list_bind), self);
+  g_signal_connect(feature_factory, "unbind", G_CALLBACK(feature_list_unbind), self);
+  gtk_list_view_set_factory(self->capabilities_feature_list, feature_factory);
+  g_object_unref(feature_factory);
+
   g_signal_connect(self->selection, "selection-changed", G_CALLBACK(selection_changed_cb), self);
   g_signal_connect(self->display_search_entry, "search-changed", G_CALLBACK(search_changed_cb), self);
+  g_signal_connect(self->capabilities_search_entry, "search-changed", G_CALLBACK(feature_search_changed_cb), self);
   g_signal_connect(self->refresh_button, "clicked", G_CALLBACK(refresh_clicked_cb), self);
   g_signal_connect(self->list_detected_button, "clicked", G_CALLBACK(list_clicked_cb), self);
   g_signal_connect(self->detect_button, "clicked", G_CALLBACK(refresh_clicked_cb), self);
   g_signal_connect(self->query_state_button, "clicked", G_CALLBACK(state_clicked_cb), self);
   g_signal_connect(self->sleep_multiplier_refresh_button, "clicked", G_CALLBACK(sleep_refresh_clicked_cb), self);
   g_signal_connect(self->set_sleep_multiplier_button, "clicked", G_CALLBACK(sleep_set_clicked_cb), self);
+  g_signal_connect(self->calibrate_sleep_button, "clicked", G_CALLBACK(calibrate_sleep_clicked_cb), self);
+  g_signal_connect(self->apply_profile_button, "clicked", G_CALLBACK(apply_profile_clicked_cb), self);
+  g_signal_connect(self->delete_profile_button, "clicked", G_CALLBACK(delete_profile_clicked_cb), self);
+  g_signal_connect(self->save_profile_button, "clicked", G_CALLBACK(save_profile_clicked_cb), self);
+  g_signal_connect(self->join_group_button, "clicked", G_CALLBACK(join_group_clicked_cb), self);
+  g_signal_connect(self->leave_group_button, "clicked", G_CALLBACK(leave_group_clicked_cb), self);
+  g_signal_connect(self->monitor_button, "clicked", G_CALLBACK(monitor_clicked_cb), self);
+  g_signal_connect(self, "notify::is-active", G_CALLBACK(window_is_active_cb), self);
   g_signal_connect(self->get_vcp_button, "clicked", G_CALLBACK(get_vcp_clicked_cb), self);
   g_signal_connect(self->get_multiple_vcp_button, "clicked", G_CALLBACK(get_multiple_vcp_clicked_cb), self);
+  g_signal_connect(self->read_all_displays_button, "clicked", G_CALLBACK(read_all_displays_clicked_cb), self);
   g_signal_connect(self->set_vcp_button, "clicked", G_CALLBACK(set_vcp_clicked_cb), self);
   g_signal_connect(self->set_vcp_context_button, "clicked", G_CALLBACK(set_vcp_context_clicked_cb), self);
   g_signal_connect(self->get_vcp_metadata_button, "clicked", G_CALLBACK(get_vcp_metadata_clicked_cb), self);
   g_signal_connect(self->get_capabilities_button, "clicked", G_CALLBACK(get_capabilities_clicked_cb), self);
   g_signal_connect(self->get_capabilities_metadata_button, "clicked", G_CALLBACK(get_capabilities_metadata_clicked_cb), self);
+  g_signal_connect(self->reprobe_capabilities_button, "clicked", G_CALLBACK(reprobe_capabilities_clicked_cb), self);
   g_signal_connect(self->restart_button, "clicked", G_CALLBACK(restart_clicked_cb), self);
+  g_signal_connect(self->performance_refresh_button, "clicked", G_CALLBACK(performance_refresh_clicked_cb), self);
+  g_signal_connect(self->performance_reset_button, "clicked", G_CALLBACK(performance_reset_clicked_cb), self);
+  g_signal_connect(self->performance_export_button, "clicked", G_CALLBACK(performance_export_clicked_cb), self);
+  g_signal_connect(self->view_stack, "notify::visible-child", G_CALLBACK(view_stack_visible_child_cb), self);
 
+  g_signal_connect(self->prefetch_row, "notify::active", G_CALLBACK(prefetch_toggled_cb), self);
   g_signal_connect(self->dynamic_sleep_row, "notify::active", G_CALLBACK(service_switch_toggled_cb), self);
   g_signal_connect(self->info_logging_row, "notify::active", G_CALLBACK(service_switch_toggled_cb), self);
   g_signal_connect(self->connectivity_signals_row, "notify::active", G_CALLBACK(service_switch_toggled_cb), self);
@@ -1518,15 +2921,45 @@ gnomeddc_window_init(GnomeDdcWindow *self)
   g_signal_connect(self->output_level_row, "notify::value", G_CALLBACK(spin_row_value_changed_cb), self);
   g_signal_connect(self->poll_interval_row, "notify::value", G_CALLBACK(spin_row_value_changed_cb), self);
   g_signal_connect(self->poll_cascade_row, "notify::value", G_CALLBACK(spin_row_value_changed_cb), self);
+}
+
+/* Opens a window on @application's client, display model and caches. */
+GnomeDdcWindow *
+gnomeddc_window_new(GnomeDdcApplication *application)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_APPLICATION(application), NULL);
+
+  GnomeDdcWindow *self = g_object_new(GNOMEDDC_TYPE_WINDOW,
+                                      "application", application,
+                                      NULL);
+  self->client = g_object_ref(gnome_ddc_application_get_client(application));
+  self->display_model = g_object_ref(gnome_ddc_application_get_display_model(application));
+  self->write_coalescer = g_object_ref(gnome_ddc_application_get_write_coalescer(application));
+  self->capabilities_cache = g_object_ref(gnome_ddc_application_get_capabilities_cache(application));
+  self->profile_store = g_object_ref(gnome_ddc_application_get_profile_store(application));
+  self->group_store = g_object_ref(gnome_ddc_application_get_group_store(application));
+
+  g_signal_connect(self->profile_store, "changed", G_CALLBACK(profile_store_changed_cb), self);
+  g_signal_connect(self->group_store, "changed", G_CALLBACK(group_store_changed_cb), self);
+  refresh_profile_names(self, NULL);
+  refresh_group_names(self, NULL);
+
+  gtk_filter_list_model_set_model(self->filter_model, G_LIST_MODEL(self->display_model));
+  g_signal_connect(self->display_model, "items-changed", G_CALLBACK(display_model_items_changed_cb), self);
+
+  GnomeDdcServiceProperties *service_properties = gnomeddc_client_get_service_properties(self->client);
+  g_signal_connect(service_properties, "changed", G_CALLBACK(service_property_changed_cb), self);
+  apply_all_service_rows(self);
 
   update_empty_state(self);
 
-  if (!gnomeddc_client_is_connected(self->client)) {
-    const gchar *error = gnomeddc_client_get_last_error(self->client);
-    show_toast(self, "%s", error != NULL ? error : _("Unable to reach ddcutil-service"));
-  } else {
-    gnomeddc_window_refresh_displays(self, FALSE);
-    gnomeddc_window_refresh_service_properties(self);
+  /* The client connects in the background; the window is shown right away
+   * and stays busy until the first connection attempt has an outcome. */
+  if (!gnomeddc_client_is_connected(self->client) && gnomeddc_client_get_last_error(self->client) == NULL) {
+    gnomeddc_window_start_operation(self);
   }
+  g_signal_connect(self->client, "connected", G_CALLBACK(client_connected_cb), self);
+  g_signal_connect(self->client, "connection-failed", G_CALLBACK(client_connection_failed_cb), self);
+  gnomeddc_window_update_selection(self);
+  return self;
 }
-
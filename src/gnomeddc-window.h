@@ -3,12 +3,16 @@
 
 #include <adwaita.h>
 
+#include "gnomeddc-application.h"
+
 G_BEGIN_DECLS
 
 #define GNOMEDDC_TYPE_WINDOW (gnomeddc_window_get_type())
 
 G_DECLARE_FINAL_TYPE(GnomeDdcWindow, gnomeddc_window, GNOMEDDC, WINDOW, AdwApplicationWindow)
 
+GnomeDdcWindow *gnomeddc_window_new(GnomeDdcApplication *application);
+
 G_END_DECLS
 
 #endif /* GNOMEDDC_WINDOW_H */
@@ -0,0 +1,450 @@
+#include "gnomeddc-write-coalescer.h"
+
+#include <string.h>
+
+/*
+ * Continuous controls (sliders, spin rows) produce far more values than a
+ * monitor can absorb. Every display gets at most one SetVcp in flight; while
+ * it runs, only the newest value per VCP code is kept and anything it
+ * replaces completes with G_IO_ERROR_CANCELLED. Service properties follow the
+ * same rule per property name.
+ *
+ * Displays that share a bus (see gnomeddc_display_get_bus_key()) also share
+ * a lane: one write is on the bus at a time, and the displays waiting on it
+ * take turns. Writes to displays on different buses run in parallel.
+ */
+
+typedef struct {
+  guint8 code;
+  guint16 value;
+  guint flags;
+  gchar *context;
+  GTask *task;
+} PendingWrite;
+
+typedef struct {
+  gint bus_key;
+  gboolean busy;
+  /* DisplayQueues with writes waiting for the bus */
+  GQueue waiting;
+} BusLane;
+
+typedef struct {
+  guint64 display_id;
+  gint display_number;
+  gchar *edid;
+  BusLane *lane;
+  gboolean in_flight;
+  gboolean waiting;
+  GQueue pending;
+} DisplayQueue;
+
+typedef struct {
+  gchar *name;
+  gboolean in_flight;
+  GVariant *pending_value;
+  GTask *pending_task;
+} PropertySlot;
+
+struct _GnomeDdcWriteCoalescer {
+  GObject parent_instance;
+
+  GnomeDdcClient *client;
+  /* display id -> DisplayQueue */
+  GHashTable *displays;
+  /* bus key -> BusLane */
+  GHashTable *lanes;
+  GHashTable *properties;
+};
+
+G_DEFINE_FINAL_TYPE(GnomeDdcWriteCoalescer, gnomeddc_write_coalescer, G_TYPE_OBJECT)
+
+static void
+supersede_task(GTask *task)
+{
+  g_task_return_new_error(task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                          "Superseded by a newer value");
+  g_object_unref(task);
+}
+
+static void
+pending_write_free(PendingWrite *write)
+{
+  g_free(write->context);
+  g_clear_object(&write->task);
+  g_free(write);
+}
+
+static void
+display_queue_free(DisplayQueue *queue)
+{
+  g_queue_clear_full(&queue->pending, (GDestroyNotify) pending_write_free);
+  g_free(queue->edid);
+  g_free(queue);
+}
+
+static void
+bus_lane_free(BusLane *lane)
+{
+  g_queue_clear(&lane->waiting);
+  g_free(lane);
+}
+
+static void
+property_slot_free(PropertySlot *slot)
+{
+  g_free(slot->name);
+  g_clear_pointer(&slot->pending_value, g_variant_unref);
+  g_clear_object(&slot->pending_task);
+  g_free(slot);
+}
+
+static void
+gnomeddc_write_coalescer_finalize(GObject *object)
+{
+  GnomeDdcWriteCoalescer *self = GNOMEDDC_WRITE_COALESCER(object);
+  g_clear_pointer(&self->displays, g_hash_table_unref);
+  g_clear_pointer(&self->lanes, g_hash_table_unref);
+  g_clear_pointer(&self->properties, g_hash_table_unref);
+  g_clear_object(&self->client);
+  G_OBJECT_CLASS(gnomeddc_write_coalescer_parent_class)->finalize(object);
+}
+
+static void
+gnomeddc_write_coalescer_class_init(GnomeDdcWriteCoalescerClass *klass)
+{
+  GObjectClass *object_class = G_OBJECT_CLASS(klass);
+  object_class->finalize = gnomeddc_write_coalescer_finalize;
+}
+
+static void
+gnomeddc_write_coalescer_init(GnomeDdcWriteCoalescer *self)
+{
+  self->displays = g_hash_table_new_full(g_int64_hash, g_int64_equal, NULL,
+                                         (GDestroyNotify) display_queue_free);
+  self->lanes = g_hash_table_new_full(NULL, NULL, NULL, (GDestroyNotify) bus_lane_free);
+  self->properties = g_hash_table_new_full(g_str_hash, g_str_equal, NULL,
+                                           (GDestroyNotify) property_slot_free);
+}
+
+GnomeDdcWriteCoalescer *
+gnomeddc_write_coalescer_new(GnomeDdcClient *client)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_CLIENT(client), NULL);
+
+  GnomeDdcWriteCoalescer *self = g_object_new(GNOMEDDC_TYPE_WRITE_COALESCER, NULL);
+  self->client = g_object_ref(client);
+  return self;
+}
+
+GnomeDdcClient *
+gnomeddc_write_coalescer_get_client(GnomeDdcWriteCoalescer *self)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_WRITE_COALESCER(self), NULL);
+  return self->client;
+}
+
+static void display_queue_pump(GnomeDdcWriteCoalescer *self, DisplayQueue *queue);
+
+static BusLane *
+lookup_lane(GnomeDdcWriteCoalescer *self, gint bus_key)
+{
+  BusLane *lane = g_hash_table_lookup(self->lanes, GINT_TO_POINTER(bus_key));
+  if (lane == NULL) {
+    lane = g_new0(BusLane, 1);
+    lane->bus_key = bus_key;
+    g_queue_init(&lane->waiting);
+    g_hash_table_insert(self->lanes, GINT_TO_POINTER(bus_key), lane);
+  }
+  return lane;
+}
+
+static void
+bus_lane_pump(GnomeDdcWriteCoalescer *self, BusLane *lane)
+{
+  while (!lane->busy && !g_queue_is_empty(&lane->waiting)) {
+    DisplayQueue *queue = g_queue_pop_head(&lane->waiting);
+    queue->waiting = FALSE;
+    display_queue_pump(self, queue);
+  }
+}
+
+static void
+set_vcp_done_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  GTask *task = user_data;
+  GnomeDdcWriteCoalescer *self = g_task_get_source_object(task);
+  DisplayQueue *queue = g_task_get_task_data(task);
+  GError *error = NULL;
+
+  GVariant *response = gnomeddc_client_call_finish(self->client, result, &error);
+  queue->in_flight = FALSE;
+  queue->lane->busy = FALSE;
+
+  if (response == NULL) {
+    g_task_return_error(task, error);
+  } else {
+    g_task_return_pointer(task, response, (GDestroyNotify) g_variant_unref);
+  }
+
+  /* Go to the back of the lane so the other displays on the bus get
+   * their turn. */
+  if (!g_queue_is_empty(&queue->pending) && !queue->waiting) {
+    queue->waiting = TRUE;
+    g_queue_push_tail(&queue->lane->waiting, queue);
+  }
+  bus_lane_pump(self, queue->lane);
+  g_object_unref(task);
+}
+
+static void
+display_queue_pump(GnomeDdcWriteCoalescer *self, DisplayQueue *queue)
+{
+  if (queue->in_flight || g_queue_is_empty(&queue->pending)) {
+    return;
+  }
+  if (queue->lane->busy) {
+    if (!queue->waiting) {
+      queue->waiting = TRUE;
+      g_queue_push_tail(&queue->lane->waiting, queue);
+    }
+    return;
+  }
+
+  PendingWrite *write = g_queue_pop_head(&queue->pending);
+  GTask *task = g_steal_pointer(&write->task);
+  GVariant *parameters;
+  const gchar *method;
+
+  if (write->context != NULL) {
+    method = "SetVcpWithContext";
+    parameters = g_variant_new("(isyqsu)", queue->display_number, queue->edid,
+                               write->code, write->value, write->context, write->flags);
+  } else {
+    method = "SetVcp";
+    parameters = g_variant_new("(isyqu)", queue->display_number, queue->edid,
+                               write->code, write->value, write->flags);
+  }
+  pending_write_free(write);
+
+  queue->in_flight = TRUE;
+  queue->lane->busy = TRUE;
+  g_task_set_task_data(task, queue, NULL);
+  gnomeddc_client_call_async(self->client,
+                             method,
+                             parameters,
+                             g_task_get_cancellable(task),
+                             set_vcp_done_cb,
+                             task);
+}
+
+/* @display_id is 0 for displays without an EDID, which are told apart by
+ * number, as the client does. */
+static void
+queue_set_vcp(GnomeDdcWriteCoalescer *self,
+              guint64 display_id,
+              gint display_number,
+              const gchar *edid,
+              gint bus_key,
+              guint8 vcp_code,
+              guint16 value,
+              const gchar *context,
+              guint flags,
+              GTask *task)
+{
+  if (display_id == 0) {
+    g_autofree gchar *key = g_strdup_printf("#%d", display_number);
+    display_id = gnomeddc_edid_hash((const guint8 *) key, strlen(key));
+  }
+
+  DisplayQueue *queue = g_hash_table_lookup(self->displays, &display_id);
+  if (queue == NULL) {
+    queue = g_new0(DisplayQueue, 1);
+    queue->display_id = display_id;
+    queue->display_number = display_number;
+    queue->edid = g_strdup(edid != NULL ? edid : "");
+    g_queue_init(&queue->pending);
+    g_hash_table_insert(self->displays, &queue->display_id, queue);
+  }
+  queue->display_number = display_number;
+
+  /* A display that was replugged elsewhere moves once it is idle. */
+  if (queue->lane == NULL || (queue->lane->bus_key != bus_key && !queue->in_flight && !queue->waiting)) {
+    queue->lane = lookup_lane(self, bus_key);
+  }
+
+  PendingWrite *write = NULL;
+  for (GList *l = queue->pending.head; l != NULL; l = l->next) {
+    PendingWrite *candidate = l->data;
+    if (candidate->code == vcp_code) {
+      write = candidate;
+      break;
+    }
+  }
+
+  if (write != NULL) {
+    supersede_task(g_steal_pointer(&write->task));
+    g_clear_pointer(&write->context, g_free);
+  } else {
+    write = g_new0(PendingWrite, 1);
+    write->code = vcp_code;
+    g_queue_push_tail(&queue->pending, write);
+  }
+
+  write->value = value;
+  write->flags = flags;
+  write->context = g_strdup(context);
+  write->task = task;
+
+  display_queue_pump(self, queue);
+}
+
+/* Without the display object the bus is unknown, so the display is taken
+ * to be on an I2C bus of its own, as gnomeddc_display_get_bus_key() does
+ * for non-USB displays. */
+void
+gnomeddc_write_coalescer_set_vcp_async(GnomeDdcWriteCoalescer *self,
+                                       gint display_number,
+                                       const gchar *edid,
+                                       guint8 vcp_code,
+                                       guint16 value,
+                                       const gchar *context,
+                                       guint flags,
+                                       GCancellable *cancellable,
+                                       GAsyncReadyCallback callback,
+                                       gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_WRITE_COALESCER(self));
+
+  GTask *task = g_task_new(self, cancellable, callback, user_data);
+  g_task_set_source_tag(task, gnomeddc_write_coalescer_set_vcp_async);
+
+  queue_set_vcp(self, gnomeddc_display_id_for_edid(edid), display_number, edid, -(display_number + 1),
+                vcp_code, value, context, flags, task);
+}
+
+/* Like gnomeddc_write_coalescer_set_vcp_async(), but queues the write on
+ * the lane of the bus @display is attached to. Finish with
+ * gnomeddc_write_coalescer_set_vcp_finish(). */
+void
+gnomeddc_write_coalescer_set_display_vcp_async(GnomeDdcWriteCoalescer *self,
+                                               GnomeDdcDisplay *display,
+                                               guint8 vcp_code,
+                                               guint16 value,
+                                               const gchar *context,
+                                               guint flags,
+                                               GCancellable *cancellable,
+                                               GAsyncReadyCallback callback,
+                                               gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_WRITE_COALESCER(self));
+  g_return_if_fail(GNOMEDDC_IS_DISPLAY(display));
+
+  GTask *task = g_task_new(self, cancellable, callback, user_data);
+  g_task_set_source_tag(task, gnomeddc_write_coalescer_set_vcp_async);
+
+  const gchar *edid = gnomeddc_display_get_edid(display);
+  queue_set_vcp(self,
+                *edid != '\0' ? gnomeddc_display_get_id(display) : 0,
+                gnomeddc_display_get_display_number(display),
+                edid,
+                gnomeddc_display_get_bus_key(display),
+                vcp_code, value, context, flags, task);
+}
+
+GVariant *
+gnomeddc_write_coalescer_set_vcp_finish(GnomeDdcWriteCoalescer *self,
+                                        GAsyncResult *result,
+                                        GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_WRITE_COALESCER(self), NULL);
+  g_return_val_if_fail(g_task_is_valid(result, self), NULL);
+  return g_task_propagate_pointer(G_TASK(result), error);
+}
+
+static void property_slot_pump(GnomeDdcWriteCoalescer *self, PropertySlot *slot);
+
+static void
+set_property_done_cb(GObject *source G_GNUC_UNUSED, GAsyncResult *result, gpointer user_data)
+{
+  GTask *task = user_data;
+  GnomeDdcWriteCoalescer *self = g_task_get_source_object(task);
+  PropertySlot *slot = g_task_get_task_data(task);
+  GError *error = NULL;
+
+  GVariant *response = gnomeddc_client_set_property_finish(self->client, result, &error);
+  slot->in_flight = FALSE;
+
+  if (response == NULL) {
+    g_task_return_error(task, error);
+  } else {
+    g_task_return_pointer(task, response, (GDestroyNotify) g_variant_unref);
+  }
+
+  property_slot_pump(self, slot);
+  g_object_unref(task);
+}
+
+static void
+property_slot_pump(GnomeDdcWriteCoalescer *self, PropertySlot *slot)
+{
+  if (slot->in_flight || slot->pending_task == NULL) {
+    return;
+  }
+
+  GTask *task = g_steal_pointer(&slot->pending_task);
+  GVariant *value = g_steal_pointer(&slot->pending_value);
+
+  slot->in_flight = TRUE;
+  g_task_set_task_data(task, slot, NULL);
+  gnomeddc_client_set_property_async(self->client,
+                                     slot->name,
+                                     value,
+                                     g_task_get_cancellable(task),
+                                     set_property_done_cb,
+                                     task);
+  g_variant_unref(value);
+}
+
+void
+gnomeddc_write_coalescer_set_property_async(GnomeDdcWriteCoalescer *self,
+                                            const gchar *property_name,
+                                            GVariant *value,
+                                            GCancellable *cancellable,
+                                            GAsyncReadyCallback callback,
+                                            gpointer user_data)
+{
+  g_return_if_fail(GNOMEDDC_IS_WRITE_COALESCER(self));
+  g_return_if_fail(property_name != NULL);
+  g_return_if_fail(value != NULL);
+
+  GTask *task = g_task_new(self, cancellable, callback, user_data);
+  g_task_set_source_tag(task, gnomeddc_write_coalescer_set_property_async);
+
+  PropertySlot *slot = g_hash_table_lookup(self->properties, property_name);
+  if (slot == NULL) {
+    slot = g_new0(PropertySlot, 1);
+    slot->name = g_strdup(property_name);
+    g_hash_table_insert(self->properties, slot->name, slot);
+  }
+
+  if (slot->pending_task != NULL) {
+    supersede_task(g_steal_pointer(&slot->pending_task));
+  }
+  g_clear_pointer(&slot->pending_value, g_variant_unref);
+
+  slot->pending_value = g_variant_ref_sink(value);
+  slot->pending_task = task;
+
+  property_slot_pump(self, slot);
+}
+
+GVariant *
+gnomeddc_write_coalescer_set_property_finish(GnomeDdcWriteCoalescer *self,
+                                             GAsyncResult *result,
+                                             GError **error)
+{
+  g_return_val_if_fail(GNOMEDDC_IS_WRITE_COALESCER(self), NULL);
+  g_return_val_if_fail(g_task_is_valid(result, self), NULL);
+  return g_task_propagate_pointer(G_TASK(result), error);
+}
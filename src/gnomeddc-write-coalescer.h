@@ -0,0 +1,55 @@
+#ifndef GNOMEDDC_WRITE_COALESCER_H
+#define GNOMEDDC_WRITE_COALESCER_H
+
+#include "gnomeddc-client.h"
+#include "gnomeddc-display.h"
+
+G_BEGIN_DECLS
+
+#define GNOMEDDC_TYPE_WRITE_COALESCER (gnomeddc_write_coalescer_get_type())
+
+G_DECLARE_FINAL_TYPE(GnomeDdcWriteCoalescer, gnomeddc_write_coalescer, GNOMEDDC, WRITE_COALESCER, GObject)
+
+GnomeDdcWriteCoalescer *gnomeddc_write_coalescer_new(GnomeDdcClient *client);
+
+GnomeDdcClient *gnomeddc_write_coalescer_get_client(GnomeDdcWriteCoalescer *self);
+
+void gnomeddc_write_coalescer_set_vcp_async(GnomeDdcWriteCoalescer *self,
+                                            gint display_number,
+                                            const gchar *edid,
+                                            guint8 vcp_code,
+                                            guint16 value,
+                                            const gchar *context,
+                                            guint flags,
+                                            GCancellable *cancellable,
+                                            GAsyncReadyCallback callback,
+                                            gpointer user_data);
+
+void gnomeddc_write_coalescer_set_display_vcp_async(GnomeDdcWriteCoalescer *self,
+                                                    GnomeDdcDisplay *display,
+                                                    guint8 vcp_code,
+                                                    guint16 value,
+                                                    const gchar *context,
+                                                    guint flags,
+                                                    GCancellable *cancellable,
+                                                    GAsyncReadyCallback callback,
+                                                    gpointer user_data);
+
+GVariant *gnomeddc_write_coalescer_set_vcp_finish(GnomeDdcWriteCoalescer *self,
+                                                  GAsyncResult *result,
+                                                  GError **error);
+
+void gnomeddc_write_coalescer_set_property_async(GnomeDdcWriteCoalescer *self,
+                                                 const gchar *property_name,
+                                                 GVariant *value,
+                                                 GCancellable *cancellable,
+                                                 GAsyncReadyCallback callback,
+                                                 gpointer user_data);
+
+GVariant *gnomeddc_write_coalescer_set_property_finish(GnomeDdcWriteCoalescer *self,
+                                                       GAsyncResult *result,
+                                                       GError **error);
+
+G_END_DECLS
+
+#endif /* GNOMEDDC_WRITE_COALESCER_H */
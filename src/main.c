@@ -1,8 +1,14 @@
 #include "gnomeddc-application.h"
+#include "gnomeddc-cli.h"
 
 int
 main(int argc, char *argv[])
 {
+  /* Scripted use must not pay for GTK start-up. */
+  if (gnomeddc_cli_is_requested(argc, argv)) {
+    return gnomeddc_cli_run(argc, argv);
+  }
+
   g_autoptr(GnomeDdcApplication) app = gnome_ddc_application_new();
   return g_application_run(G_APPLICATION(app), argc, argv);
 }